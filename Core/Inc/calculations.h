@@ -28,9 +28,55 @@
 /******************************************************************************
  * Defines
  *****************************************************************************/
+/** Identifies the lookup tables, increase whenever a table changes */
+#define CALC_CALIBRATION	1
 
+#define CALC_WINDOW			50			///< Samples of an accurate value
+#define CALC_WINDOW_MIN		12			///< One mains period
+
+#define CALC_COIL_STEP		20			///< mm between the coil table entries
+#define CALC_CURRENT_LOW	1200		///< mA of lut_coil_1_2
+#define CALC_CURRENT_HIGH	5000		///< mA of lut_coil_5
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Conductor, selects the thresholds */
+typedef enum {
+	CALC_WIRE = 0,						///< Single wire
+	CALC_CABLE,							///< Cable with several conductors
+	CALC_KINDS
+} CALC_kind_t;
+
+/** Thresholds of the mean pad RMS value for the distance */
+typedef struct {
+	int32_t zero;						///< From this value on: distance 0
+	int32_t out;						///< Up to this value: out of range
+} CALC_pad_limits_t;
+
+/** Thresholds of the mean coil RMS value for the current */
+typedef struct {
+	int32_t low_min;					///< 1.2 A from this value ...
+	int32_t low_max;					///< ... up to this value
+	int32_t high_min;					///< Otherwise 5 A above this value
+} CALC_coil_limits_t;
+
+/** All thresholds of the calculations */
+typedef struct {
+	CALC_pad_limits_t pad[CALC_KINDS];	///< Distance per conductor
+	CALC_coil_limits_t coil[CALC_KINDS];	///< Current per conductor
+} CALC_limits_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
 extern bool CALC_degree_left;		///< Flag for the direction of the signal
 extern bool CALC_degree_right;		///< Flag for the direction of the signal
+extern CALC_limits_t CALC_limits;	///< Thresholds used by the firmware
+extern uint32_t CALC_window;		///< Samples of an accurate value, max. ADC_NUMS
+extern int32_t CALC_current_half;	///< 95 % half width of current() in mA, -1 unknown
 
 /******************************************************************************
  * Functions
@@ -41,6 +87,15 @@ int32_t standard_deviation(int32_t avg, int32_t numb_samples, int32_t arr[]);
 int32_t distance_to_cable(int32_t meas_mode);
 int32_t angle_to_cable(void);
 int32_t current(int32_t meas_mode);
+int32_t CALC_distance(CALC_kind_t kind, int32_t e_val,
+		const CALC_limits_t *limits);
+int32_t CALC_current(CALC_kind_t kind, int32_t b_val,
+		const CALC_limits_t *limits);
+int32_t CALC_distance_half(CALC_kind_t kind, int32_t e_val, int32_t e_half);
+int32_t CALC_estimate_current(int32_t distance, int32_t dist_half,
+		int32_t b_val, int32_t b_half, int32_t *half);
+uint32_t CALC_sqrt(uint32_t value);
+uint32_t CALC_sqrt64(uint64_t value);
 
 
 
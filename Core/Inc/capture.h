@@ -0,0 +1,73 @@
+/** ***************************************************************************
+ * @file
+ * @brief See capture.c
+ *
+ * Prefix CAP
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef CAP_H_
+#define CAP_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "stm32f429i_discovery_lcd.h"
+
+#include "measuring.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define CAP_MAGIC			0x43524452UL	///< "RDRC" in the first 4 bytes
+#define CAP_VERSION			1			///< Format version written
+#define CAP_HEADER_SIZE		32			///< Bytes of the file header
+#define CAP_FRAME_HEADER	4			///< Bytes before the samples of a frame
+#define CAP_BITS			12			///< Bits per sample
+/** Bytes of a frame with count samples per input */
+#define CAP_FRAME_SIZE(count)	(CAP_FRAME_HEADER + ((count)*INPUTS_NUMS*3+1)/2)
+
+/** SDRAM after the two layer framebuffers holds the capture on the target,
+ * the rest is the ring of the recorder (record.h) */
+#define CAP_SDRAM_ADDR		(LCD_FRAME_BUFFER + 2*BUFFER_OFFSET)
+#define CAP_SDRAM_SIZE		0x00100000UL	///< 1 MByte, minutes of frames
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Inputs which may be stored in a column of a capture */
+typedef enum {
+	CAP_PAD1 = 0, CAP_PAD2, CAP_COIL1, CAP_COIL2
+} CAP_input_t;
+
+/** A capture in memory, for writing or reading */
+typedef struct {
+	uint8_t *data;						///< Start of the capture, the header
+	uint32_t size;						///< Bytes available
+	uint32_t used;						///< Bytes written or read
+	uint32_t rate;						///< Sample rate in Hz
+	uint32_t calibration;				///< CALC_CALIBRATION of the recording
+	uint32_t frames;					///< Frames in the capture
+	uint8_t map[INPUTS_NUMS];			///< Input of each stored column
+} CAP_t;
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+bool CAP_create(CAP_t *cap, void *buffer, uint32_t size, uint32_t rate,
+		uint32_t calibration);
+bool CAP_put(CAP_t *cap, const FRAME_t *frame);
+bool CAP_open(CAP_t *cap, void *buffer, uint32_t size);
+bool CAP_next(CAP_t *cap, FRAME_t *frame, uint32_t *samples, uint32_t max);
+void CAP_rewind(CAP_t *cap);
+
+
+#endif
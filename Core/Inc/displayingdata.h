@@ -18,16 +18,111 @@
  * Includes
  *****************************************************************************/
 #include <stdbool.h>
+#include <stdint.h>
+#include "stm32f429i_discovery_lcd.h"
+
+#include "sequential.h"
 
 
 /******************************************************************************
  * Defines
  *****************************************************************************/
+#define DISP_BG_BUFFER	LCD_FRAME_BUFFER	///< Framebuffer of the static layer
+#define DISP_FG_BUFFER	(LCD_FRAME_BUFFER + BUFFER_OFFSET)	///< Dynamic layer
+
+#define DISP_ITEMS_MAX	16				///< Max. dynamic items of a layout
+
+/* States of a result screen, a layout item is shown if one of its states is */
+#define DISP_IN_RANGE	0x01			///< Distance is valid
+#define DISP_OUT_RANGE	0x02			///< Distance is out of range
+#define DISP_LEFT		0x04			///< Signal comes from the left
+#define DISP_RIGHT		0x08			///< Signal comes from the right
+#define DISP_NO_VALUE	0x10			///< No direction
+#define DISP_ADAPTIVE	0x20			///< Sequential measurement, see sequential.c
+#define DISP_CURRENT_KNOWN	0x40		///< Half width of the current is known
+#define DISP_CONVERGED	0x80			///< Sequential measurement reached the precision
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Screens with static parts on the background layer */
+typedef enum {
+	DISP_SCREEN_NONE = 0, DISP_SCREEN_HINT, DISP_SCREEN_WIRE,
+	DISP_SCREEN_CABLE, DISP_SCREEN_ANGLE, DISP_SCREEN_STRIP,
+	DISP_SCREEN_WATERFALL, DISP_SCREEN_DEBUG
+} DISP_screen_t;
+
+
+/** Kinds of layout items */
+typedef enum {
+	DISP_TEXT = 0,						///< Fixed text
+	DISP_FIELD,							///< Label, value and unit, see format.c
+	DISP_TRACE,							///< Samples as line graph
+	DISP_RING,							///< Circle outline
+	DISP_DOT							///< Filled circle
+} DISP_kind_t;
+
+/** Values which can be shown in a field */
+typedef enum {
+	DISP_DIST_SINGLE = 0, DISP_DIST_ACCU, DISP_CURRENT_SINGLE,
+	DISP_CURRENT_ACCU, DISP_ANGLE, DISP_LATENCY_TOUCH, DISP_LATENCY_DATA,
+	DISP_CONFIDENCE, DISP_SAMPLES, DISP_CURRENT_HALF, DISP_TRACE_SAMPLES,
+	DISP_VALUES
+} DISP_value_t;
+
+/** One item of a layout, held in const tables */
+typedef struct {
+	uint8_t kind;						///< DISP_kind_t
+	uint8_t show;						///< States DISP_IN_RANGE... or 0 = always
+	uint8_t align;						///< Text_AlignModeTypdef of texts
+	uint8_t value;						///< DISP_value_t of a field or
+										///< of the sample count of a trace
+	sFONT *font;						///< Font of texts and fields
+	uint32_t color;						///< Text or drawing color
+	uint16_t x;							///< Left edge, center of circles
+	uint16_t y;							///< Top edge, center of circles,
+										///< zero line of traces
+	uint16_t r;							///< Radius of circles
+	const char *text;					///< Text or label of a field
+	const int32_t *samples;				///< Up to ADC_NUMS samples of a trace
+	uint8_t width;						///< Digits of the value of a field
+	const char *unit;					///< After the value of a field or NULL
+} DISP_item_t;
+
+/** Layout of a screen: static items on the background, dynamic ones on top */
+typedef struct {
+	DISP_screen_t screen;				///< Screen of the background layer
+	const char *title;					///< Title in the upper left corner
+	const DISP_item_t *statics;			///< Drawn once on the background
+	uint8_t static_count;				///< Number of static items
+	const DISP_item_t *dynamics;		///< Drawn on the foreground if dirty
+	uint8_t dynamic_count;				///< Number of dynamic items
+} DISP_layout_t;
+
+/** Calculated values of a result screen, from the compute to the display */
+typedef struct {
+	const DISP_layout_t *layout;		///< Screen to show the values on
+	uint32_t state;						///< DISP_IN_RANGE...
+	int32_t values[DISP_VALUES];		///< Values of the fields
+} DISP_result_t;
 
 
 /******************************************************************************
  * Functions
  *****************************************************************************/
+void DISP_layers_init(void);
+bool DISP_static_begin(DISP_screen_t screen);
+void DISP_dynamic_begin(void);
+DISP_screen_t DISP_get_screen(void);
+void DISP_clear(void);
+void DISP_render(const DISP_layout_t *layout, uint32_t state,
+		const int32_t values[DISP_VALUES]);
+void DISP_calc_wire(DISP_result_t *result);
+void DISP_calc_cable(DISP_result_t *result);
+void DISP_calc_angle(DISP_result_t *result);
+void DISP_calc_sequential(DISP_result_t *result, const SEQ_result_t *seq);
+void DISP_show(const DISP_result_t *result);
 void DISP_show_data_wire(void);
 void DISP_show_data_cable(void);
 void DISP_show_data_angle(void);
@@ -0,0 +1,66 @@
+/** ***************************************************************************
+ * @file
+ * @brief See events.c
+ *
+ * Prefix EVT
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef EVT_H_
+#define EVT_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdint.h>
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define EVT_TICK_PERIOD		10		///< ms between two EVT_TICK events
+
+#define EVT_FRAME			(1UL << 0)	///< New frame in the frame ring
+#define EVT_BUTTON			(1UL << 1)	///< USER pushbutton pressed
+#define EVT_TICK			(1UL << 2)	///< Time base of periodic tasks
+#define EVT_TOUCH			(1UL << 3)	///< Touchscreen interrupt
+#define EVT_REMOTE			(1UL << 4)	///< Command bytes on the serial port
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Latency statistics in microseconds */
+typedef struct {
+	uint32_t last;						///< Latest measurement
+	uint32_t min;						///< Shortest since start
+	uint32_t max;						///< Longest since start
+	uint32_t count;						///< Number of measurements
+	uint64_t sum;						///< Sum for the mean value
+} EVT_latency_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern EVT_latency_t EVT_touch_latency;		///< Touch to measurement start
+extern EVT_latency_t EVT_display_latency;	///< Acquisition to display
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void EVT_init(void);
+void EVT_post(uint32_t events);
+uint32_t EVT_poll(void);
+uint32_t EVT_wait(void);
+void EVT_tick(void);
+uint32_t EVT_timestamp(void);
+void EVT_latency_record(EVT_latency_t *latency, uint32_t start);
+void EVT_latency_add(EVT_latency_t *latency, uint32_t cycles);
+
+
+#endif
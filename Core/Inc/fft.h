@@ -17,19 +17,20 @@
 /******************************************************************************
  * Includes
  *****************************************************************************/
-
+#include <stdint.h>
 
 
 /******************************************************************************
  * Defines
  *****************************************************************************/
-
+#define FFT_MAX_N		64			///< Maximum block length
 
 
 /******************************************************************************
  * Functions
  *****************************************************************************/
-
+void FFT_init(uint32_t n);
+void FFT_spectrum(const int32_t x[], uint32_t mag[], uint32_t bins);
 
 
 
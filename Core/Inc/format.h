@@ -0,0 +1,58 @@
+/** ***************************************************************************
+ * @file
+ * @brief See format.c
+ *
+ * Prefix FMT
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef FMT_H_
+#define FMT_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "stm32f429i_discovery_lcd.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define FMT_LEN				32			///< Max. glyphs of a text
+#define FMT_GLYPH(c)		((uint8_t)((c) - ' '))	///< Glyph of a character
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Text as glyph indexes into the font tables, see BSP_LCD_DisplayGlyphs() */
+typedef struct {
+	uint8_t len;						///< Glyphs in use
+	uint8_t glyph[FMT_LEN];				///< Character - ' '
+} FMT_text_t;
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void FMT_clear(FMT_text_t *text);
+void FMT_string(FMT_text_t *text, const char *s);
+void FMT_column(FMT_text_t *text, uint32_t column);
+void FMT_uint(FMT_text_t *text, uint32_t value, uint32_t width);
+void FMT_int(FMT_text_t *text, int32_t value, uint32_t width);
+void FMT_fixed(FMT_text_t *text, int32_t value, uint32_t decimals,
+		uint32_t width);
+void FMT_unit(FMT_text_t *text, int32_t value, uint32_t width,
+		const char *unit);
+void FMT_draw(const FMT_text_t *text, uint16_t x, uint16_t y,
+		Text_AlignModeTypdef align);
+uint32_t FMT_chars(const FMT_text_t *text, char *s, uint32_t size);
+
+
+#endif
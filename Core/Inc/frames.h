@@ -0,0 +1,57 @@
+/** ***************************************************************************
+ * @file
+ * @brief See frames.c
+ *
+ * Prefix FRAME
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef FRAME_H_
+#define FRAME_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define FRAME_SLOTS			4		///< Frames in the ring (power of 2)
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Descriptor of one acquired frame */
+typedef struct {
+	const uint32_t *samples;			///< Interleaved samples of all inputs
+	uint32_t count;						///< Samples per input
+	uint32_t seq;						///< Number of the frame since reset
+	uint32_t time;						///< EVT_timestamp() of the last sample
+	uint32_t overruns;					///< Frames dropped right before this one
+} FRAME_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern volatile uint32_t FRAME_overruns;	///< Frames dropped since reset
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void FRAME_reset(void);
+bool FRAME_put(const uint32_t *samples, uint32_t count);
+uint32_t FRAME_count(void);
+const FRAME_t *FRAME_peek(void);
+void FRAME_release(void);
+
+
+#endif
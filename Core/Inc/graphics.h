@@ -0,0 +1,104 @@
+/** ***************************************************************************
+ * @file
+ * @brief See graphics.c
+ *
+ * Prefix GFX
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef GFX_H_
+#define GFX_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define GFX_QUEUE_SIZE		32		///< Number of queued DMA2D commands (power of 2)
+
+#define GFX_CM_ARGB8888		0		///< DMA2D color mode ARGB8888
+#define GFX_CM_RGB888		1		///< DMA2D color mode RGB888
+#define GFX_CM_RGB565		2		///< DMA2D color mode RGB565
+#define GFX_CM_A8			9		///< DMA2D color mode A8 (alpha only)
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** DMA2D operations which can be queued */
+typedef enum {
+	GFX_FILL = 0, GFX_COPY, GFX_CONVERT, GFX_BLEND, GFX_MARK
+} GFX_op_t;
+
+/** One queued DMA2D command */
+typedef struct {
+	GFX_op_t op;						///< Operation
+	uint32_t fg;						///< Foreground address or fill color
+	uint32_t bg;						///< Background address (blend only)
+	uint32_t dst;						///< Output address
+	uint16_t width;						///< Pixels per line
+	uint16_t height;					///< Number of lines
+	uint16_t fg_offset;					///< Pixels skipped after each fg line
+	uint16_t bg_offset;					///< Pixels skipped after each bg line
+	uint16_t dst_offset;				///< Pixels skipped after each out line
+	uint8_t fg_mode;					///< Foreground color mode GFX_CM_*
+	uint8_t fg_alpha;					///< Foreground alpha (blend only)
+	uint32_t fg_color;					///< Foreground color for A8 input
+} GFX_cmd_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern volatile bool GFX_pending;		///< DMA2D has queued or running work
+extern volatile uint32_t GFX_mark_tag;	///< Tag of the last passed GFX_mark()
+extern volatile uint32_t GFX_mark_time;	///< EVT_timestamp() when it passed
+#ifdef GFX_STATS
+extern uint32_t GFX_cpu_pixels;			///< Pixels read or written by the CPU
+#endif
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void GFX_init(void);
+void GFX_fill(uint32_t dst, uint32_t width, uint32_t height,
+		uint32_t dst_offset, uint32_t color);
+void GFX_copy(uint32_t src, uint32_t src_offset, uint32_t dst,
+		uint32_t dst_offset, uint32_t width, uint32_t height);
+void GFX_convert(uint32_t src, uint32_t src_mode, uint32_t dst,
+		uint32_t width, uint32_t height, uint32_t dst_offset);
+void GFX_blend(uint32_t fg, uint32_t fg_offset, uint32_t fg_mode,
+		uint32_t fg_color, uint8_t alpha, uint32_t bg, uint32_t bg_offset,
+		uint32_t dst, uint32_t dst_offset, uint32_t width, uint32_t height);
+void GFX_mark(uint32_t tag);
+void GFX_fence(void);
+uint32_t GFX_get_queued(void);
+
+
+/** ***************************************************************************
+ * @brief Wait for the DMA2D before the CPU touches the framebuffer
+ *
+ * Cheap enough to be called for every pixel the CPU draws.
+ * @n With GFX_STATS defined (host build) the pixels are counted.
+ *****************************************************************************/
+static inline void GFX_sync(void)
+{
+#ifdef GFX_STATS
+	GFX_cpu_pixels++;
+#endif
+	if (GFX_pending) {
+		GFX_fence();
+	}
+}
+
+
+#endif
@@ -17,17 +17,22 @@
  * Includes
  *****************************************************************************/
 #include <stdbool.h>
+#include <stdint.h>
+
+#include "frames.h"
 
 
 /******************************************************************************
  * Defines
  *****************************************************************************/
+#define ADC_FS          600         ///< Sampling freq. => 12 samples for a 50Hz period
 #define ADC_DAC_RES     12          ///< Resolution
 #define ADC_NUMS        60          ///< Number of samples
 #define INPUTS_NUMS     4		    ///< Number of inputs
 #define MEAS_RES		12			///< Resolution in bits
+#define ADC_STREAM_NUMS	(ADC_NUMS/2)	///< Samples per half in continuous mode
 
-extern bool MEAS_data_ready;
+extern volatile bool MEAS_continuous;		///< Continuous acquisition running
 
 extern bool MEAS_data_wire;				///< Allow for wire data displaying
 extern bool MEAS_data_cable;			///< Allow for cable data displaying
@@ -42,6 +47,7 @@ extern int32_t PAD1_samples[ADC_NUMS];		///< Array for the PAD1 samples for calc
 extern int32_t PAD2_samples[ADC_NUMS];		///< Array for the PAD2 samples for calculation and displaying
 extern int32_t COIL1_samples[ADC_NUMS];		///< Array for the COIL1 samples for calculation and displaying
 extern int32_t COIL2_samples[ADC_NUMS];		///< Array for the COIL2 samples for calculation and displaying
+extern uint32_t MEAS_sorted_count;		///< Valid entries of the arrays above
 
 
 /******************************************************************************
@@ -54,9 +60,11 @@ void DAC_init(void);
 void DAC_increment(void);
 void ADC_reset(void);
 void MEAS_CLEAR_buffer_flags(void);
-void MEAS_sort_data(void);
+void MEAS_sort_data(const FRAME_t *frame);
 void ADC3_scan_init(void);
+void ADC3_scan_continuous_init(void);
 void ADC3_scan_start(void);
+void ADC3_scan_stop(void);
 
 void ADC1_IN13_ADC2_IN5_dual_init(void);
 void ADC1_IN13_ADC2_IN5_dual_start(void);
@@ -19,7 +19,7 @@
 /******************************************************************************
  * Defines
  *****************************************************************************/
-#define MENU_ENTRY_COUNT		3		///< Number of menu entries
+#define MENU_ENTRY_COUNT		4		///< Number of menu entries
 
 
 /******************************************************************************
@@ -27,7 +27,8 @@
  *****************************************************************************/
 /** Enumeration of possible menu items */
 typedef enum {
-	MENU_ZERO = 0, MENU_ONE, MENU_TWO, MENU_THREE, MENU_NONE
+	MENU_ZERO = 0, MENU_ONE, MENU_TWO, MENU_THREE, MENU_NONE,
+	MENU_CONTENT						///< Held above the menu bar, see menu.c
 } MENU_item_t;
 /** Struct with fields of a menu entry */
 typedef struct {
@@ -47,6 +48,7 @@ void MENU_set_entry(const MENU_item_t item, const MENU_entry_t entry);
 MENU_entry_t MENU_get_entry(const MENU_item_t item);
 void MENU_check_transition(void);
 MENU_item_t MENU_get_transition(void);
+uint32_t MENU_get_touch_time(void);
 void MANUAL_shut_off(void);
 
 
@@ -0,0 +1,68 @@
+/** ***************************************************************************
+ * @file
+ * @brief See pipeline.c
+ *
+ * Prefix PIPE
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef PIPE_H_
+#define PIPE_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "frames.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define PIPE_FLIGHT			4		///< Frames in the display stage (power of 2)
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Stages a frame passes through */
+typedef enum {
+	PIPE_ACQUIRE = 0, PIPE_COMPUTE, PIPE_DISPLAY, PIPE_STAGES
+} PIPE_stage_t;
+
+/** Timing and occupancy of a stage */
+typedef struct {
+	uint32_t frames;					///< Frames passed through the stage
+	uint32_t last;						///< Time of the last frame in us
+	uint32_t max;						///< Longest time in us
+	uint32_t depth;						///< Frames currently in the stage
+	uint32_t depth_max;					///< Most frames in the stage at once
+	uint32_t occupancy;					///< Busy in the last report period in %
+	uint64_t busy;						///< Busy CPU cycles since reset
+} PIPE_stats_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern PIPE_stats_t PIPE_stats[PIPE_STAGES];	///< Statistics per stage
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void PIPE_reset(void);
+void PIPE_acquire_start(void);
+uint32_t PIPE_compute_begin(const FRAME_t *frame);
+uint32_t PIPE_compute_end(uint32_t start);
+void PIPE_display_end(uint32_t start, uint32_t acquired);
+void PIPE_poll(void);
+bool PIPE_report(void);
+
+
+#endif
@@ -0,0 +1,47 @@
+/** ***************************************************************************
+ * @file
+ * @brief Placement of hot buffers and code in the memories of the F429
+ *
+ * Prefix PLACE
+ *
+ * The sections are collected by STM32F429ZITX_FLASH.ld:
+ * - PLACE_CCM: the 64 KByte core coupled memory at 0x10000000.
+ *   Only the CPU reaches it over the D-bus, no DMA or DMA2D can.
+ *   For working buffers the CPU alone reads and writes, zeroed at reset,
+ *   initialised variables are not copied there.
+ * - PLACE_DMA: SRAM2 at 0x2001C000, its own slave of the bus matrix.
+ *   For the buffers the DMA streams write or read, so their transfers
+ *   do not stall the CPU on SRAM1, zeroed at reset.
+ * - PLACE_RAMFUNC: code copied into SRAM1 with .data at reset.
+ *   For the interrupt handlers, they run without flash wait states
+ *   and do not compete with the ART accelerator for the flash.
+ *   The callees of the handlers are in RAM as well: on the path of every
+ *   half FRAME_put(), REC_put(), REC_position(), TRIG_awd(), EVT_post()
+ *   and EVT_timestamp(), after every DMA2D transfer GFX_start_next() and
+ *   after every telemetry chunk TEL_start_next().
+ *   Copy loops are not turned into memcpy() calls.
+ *   Still in the flash, reached through a long branch veneer:
+ *   HAL_GetTick() in TRIG_awd(), the DMA start of REC_put() in the BSP
+ *   and HAL, PROBE_record() of the debug build in the handlers.
+ *
+ * Check the placement in the map file with Host/build/memmap.
+ * @n Host/Inc/placement.h replaces this header in the host build.
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef PLACE_H_
+#define PLACE_H_
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define PLACE_CCM		__attribute__((section(".ccmram")))	///< CPU only buffer
+#define PLACE_DMA		__attribute__((section(".dma")))	///< DMA buffer
+#define PLACE_RAMFUNC	__attribute__((section(".RamFunc"), noinline, \
+		optimize("no-tree-loop-distribute-patterns")))	///< Code in RAM
+
+
+#endif
@@ -0,0 +1,69 @@
+/** ***************************************************************************
+ * @file
+ * @brief See plotting.c
+ *
+ * Prefix PLOT
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef PLOT_H_
+#define PLOT_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "frames.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define PLOT_TRACES		3			///< Traces in the strip-chart
+#define PLOT_BINS		16			///< Spectrum bins incl. DC (0..300 Hz)
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Views of the continuous monitoring */
+typedef enum {
+	PLOT_OFF = 0, PLOT_STRIP, PLOT_WATERFALL
+} PLOT_view_t;
+
+/** Calculated column of a view, from the compute to the display stage */
+typedef struct {
+	PLOT_view_t view;					///< View the column was calculated for
+	int32_t dist;						///< Distance in mm, -1 = out of range
+	int32_t average;					///< Distance over the last second
+	int32_t current;					///< mA over the last second, -1 = none
+	int32_t row[PLOT_TRACES];			///< Rows of the strip-chart traces
+	uint8_t level[PLOT_BINS];			///< Color levels of the waterfall
+	uint32_t mag[PLOT_BINS];			///< Spectrum of the waterfall, telemetry
+} PLOT_column_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern PLOT_view_t PLOT_view;			///< Active view, PLOT_OFF if stopped
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void PLOT_start(PLOT_view_t view);
+void PLOT_set_view(PLOT_view_t view);
+void PLOT_stop(void);
+void PLOT_compute(PLOT_column_t *column);
+void PLOT_draw(const PLOT_column_t *column);
+void PLOT_update(const FRAME_t *frame);
+void PLOT_show_load(void);
+
+
+#endif
@@ -0,0 +1,105 @@
+/** ***************************************************************************
+ * @file
+ * @brief See probe.c
+ *
+ * Prefix PROBE
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef PROBE_H_
+#define PROBE_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdint.h>
+#include "stm32f4xx.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+/** The debug build is instrumented, define PROBE_ENABLE to force it */
+#if defined(DEBUG) && !defined(PROBE_ENABLE)
+#define PROBE_ENABLE
+#endif
+
+/** Host tools with several threads keep one table per thread */
+#ifdef PROBE_THREADS
+#define PROBE_LOCAL			_Thread_local
+#else
+#define PROBE_LOCAL
+#endif
+
+#define PROBE_BINS			16		///< Histogram bins per probe
+#define PROBE_BIN_SHIFT		7		///< Bin 0: < 2^7 cycles, then one per octave
+
+#ifdef PROBE_ENABLE
+/** Start timing a probe in the current block */
+#define PROBE_BEGIN(id)		const uint32_t PROBE_start_##id = DWT->CYCCNT
+/** Record the time since PROBE_BEGIN() of the same probe */
+#define PROBE_END(id)		PROBE_record((id), DWT->CYCCNT - PROBE_start_##id)
+/** Time the following statement or block, which must not return or break */
+#define PROBE_SCOPE(id) \
+	for (uint32_t PROBE_start = DWT->CYCCNT, PROBE_once = 1; PROBE_once; \
+			PROBE_once = 0, PROBE_record((id), DWT->CYCCNT - PROBE_start))
+#else
+#define PROBE_BEGIN(id)
+#define PROBE_END(id)
+#define PROBE_SCOPE(id)
+#define PROBE_reset()		((void)0)
+#define PROBE_show()		((void)0)
+#define PROBE_refresh()		((void)0)
+#endif
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** The probes, one per timed stage or interrupt handler */
+typedef enum {
+	PROBE_ISR_ADC = 0,					///< DMA2_Stream1_IRQHandler()
+	PROBE_ISR_DMA2D,					///< DMA2D_IRQHandler()
+	PROBE_ISR_TOUCH,					///< EXTI15_10_IRQHandler()
+	PROBE_SORT,							///< MEAS_sort_data()
+	PROBE_RMS,							///< RMS()
+	PROBE_DISTANCE,						///< distance_to_cable()
+	PROBE_CALC,							///< DISP_calc_wire/cable/angle()
+	PROBE_SHOW,							///< DISP_show()
+	PROBE_COLUMN,						///< PLOT_compute()
+	PROBE_DRAW,							///< PLOT_draw()
+	PROBE_COUNT
+} PROBE_id_t;
+
+/** Statistics of one probe in CPU clock cycles */
+typedef struct {
+	uint32_t count;						///< Recorded runs
+	uint32_t min;						///< Shortest run
+	uint32_t max;						///< Longest run
+	uint64_t sum;						///< All runs, for the mean
+	uint32_t hist[PROBE_BINS];			///< Runs per octave of duration
+} PROBE_stats_t;
+
+
+#ifdef PROBE_ENABLE
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern PROBE_LOCAL PROBE_stats_t PROBE_stats[PROBE_COUNT];	///< Statistics per probe
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void PROBE_record(PROBE_id_t id, uint32_t cycles);
+void PROBE_reset(void);
+void PROBE_show(void);
+void PROBE_refresh(void);
+void PROBE_export(void);
+#endif
+
+
+#endif
@@ -0,0 +1,71 @@
+/** ***************************************************************************
+ * @file
+ * @brief See record.c
+ *
+ * Prefix REC
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef REC_H_
+#define REC_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "stm32f4xx.h"
+#include "stm32f429i_discovery_lcd.h"
+
+#include "capture.h"
+#include "frames.h"
+#include "measuring.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+/** SDRAM behind the capture holds the ring on the target */
+#define REC_SDRAM_ADDR		(CAP_SDRAM_ADDR + CAP_SDRAM_SIZE)
+#define REC_SDRAM_SIZE		(SDRAM_DEVICE_SIZE - 2*BUFFER_OFFSET - CAP_SDRAM_SIZE)
+
+#define REC_BLOCK_SAMPLES	ADC_STREAM_NUMS	///< Samples per input and block
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** One half buffer of the continuous mode in the ring */
+typedef struct {
+	uint32_t seq;						///< Block number since REC_start()
+	uint32_t time;						///< HAL_GetTick() of the last sample
+	uint32_t dropped;					///< Halves not recorded since REC_start()
+	uint32_t count;						///< REC_BLOCK_SAMPLES, 0 if not valid
+	uint32_t samples[REC_BLOCK_SAMPLES*INPUTS_NUMS];	///< Like ADC_samples
+} REC_block_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern volatile uint32_t REC_dropped;	///< Halves not recorded, DMA was busy
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void REC_init(void *base, uint32_t size);
+void REC_start(void);
+void REC_stop(void);
+void REC_put(const uint32_t *samples, uint32_t count);
+void REC_range(uint32_t *first, uint32_t *end);
+uint32_t REC_read(uint32_t first, uint32_t count, uint32_t *samples);
+bool REC_frame(uint32_t block, FRAME_t *frame, uint32_t *samples);
+uint32_t REC_seconds(void);
+uint32_t REC_position(void);
+
+
+#endif
@@ -0,0 +1,79 @@
+/** ***************************************************************************
+ * @file
+ * @brief See remote.c
+ *
+ * Prefix REM
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef REM_H_
+#define REM_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "trigger.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define REM_RX_SIZE			256			///< Receive ring in bytes (power of 2)
+#define REM_MAX_PAYLOAD		12			///< Longest command payload
+#define REM_TIMEOUT			1000		///< ms until a measurement is given up
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Commands, the type of a packet from the host, see remote.c */
+typedef enum {
+	REM_MODE = 0,						///< Select wire, cable or angle
+	REM_MEASURE,						///< Run a number of measurements
+	REM_WINDOW,							///< Samples of an accurate value
+	REM_STREAM,							///< Telemetry types to send
+	REM_HEADLESS,						///< Skip the result screens
+	REM_TRIGGER,						///< Arm the triggered capture
+	REM_PRECISION,						///< Precision of the distance
+	REM_COMMANDS
+} REM_command_t;
+
+/** Measurement selected by REM_MODE */
+typedef enum {
+	REM_WIRE = 0, REM_CABLE, REM_ANGLE, REM_MODES
+} REM_mode_t;
+
+/** Status in the reply to a command */
+typedef enum {
+	REM_OK = 0,							///< Done
+	REM_BAD_COMMAND,					///< Unknown command type
+	REM_BAD_LENGTH,						///< Payload length does not fit
+	REM_BAD_VALUE						///< Value out of range
+} REM_status_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern bool REM_headless;				///< Results are not rendered
+extern uint32_t REM_lost;				///< Measurements given up, no result
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void REM_init(void);
+bool REM_poll(void);
+bool REM_next(REM_mode_t *mode);
+bool REM_trigger(TRIG_config_t *config);
+void REM_done(void);
+uint32_t REM_pending(void);
+
+
+#endif
@@ -0,0 +1,69 @@
+/** ***************************************************************************
+ * @file
+ * @brief See scheduler.c
+ *
+ * Prefix SCHED
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef SCHED_H_
+#define SCHED_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+/** Task table entry: name, function, priority (0 = highest),
+ * EVT_* bits which release it, period in ms (0 = none),
+ * deadline in us from the release to the end of the run */
+#define SCHED_TASK(name, run, priority, events, period, deadline) \
+	{ name, run, priority, events, period, deadline, false, 0, 0, \
+	  0, 0, 0, 0, 0, 0 }
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** A run-to-completion task with its statistics */
+typedef struct {
+	const char *name;					///< Name for reports
+	void (*run)(void);					///< Runs once per release
+	uint8_t priority;					///< 0 = highest
+	uint32_t events;					///< EVT_* bits which release the task
+	uint32_t period;					///< ms between releases, 0 = none
+	uint32_t deadline;					///< us from release to end of run
+	bool ready;							///< Released and not yet run
+	uint32_t release;					///< EVT_timestamp() of the release
+	uint32_t due;						///< HAL_GetTick() of the next period
+	uint32_t runs;						///< Number of runs
+	uint32_t overruns;					///< Runs which missed the deadline
+	uint32_t skipped;					///< Releases while still ready
+	uint32_t last;						///< Time of the last run in us
+	uint32_t max;						///< Longest release to end in us
+	uint64_t busy;						///< CPU cycles spent in the task
+} SCHED_task_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern SCHED_task_t *SCHED_tasks;		///< Task table of SCHED_run()
+extern uint32_t SCHED_task_count;		///< Entries in the task table
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void SCHED_run(SCHED_task_t *tasks, uint32_t count);
+
+
+#endif
@@ -0,0 +1,75 @@
+/** ***************************************************************************
+ * @file
+ * @brief See sequential.c
+ *
+ * Prefix SEQ
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef SEQ_H_
+#define SEQ_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "calculations.h"
+#include "measuring.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define SEQ_PRECISION		5			///< Default half width of the distance in mm
+#define SEQ_CURRENT_PRECISION	250		///< Half width of the current in mA
+#define SEQ_PERIOD			CALC_WINDOW_MIN	///< Samples of one RMS value
+#define SEQ_MIN_PERIODS		2			///< Periods before an interval exists
+#define SEQ_MAX_PERIODS		25			///< Periods until given up, 0.5 s
+#define SEQ_FRACTION		4			///< Fraction bits of the RMS values
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Sums of the RMS values of one input, SEQ_FRACTION fraction bits */
+typedef struct {
+	uint32_t n;							///< RMS values so far
+	uint32_t sum;						///< Their sum
+	uint64_t squares;					///< Sum of their squares
+} SEQ_stat_t;
+
+/** Estimate of a sequential measurement */
+typedef struct {
+	CALC_kind_t kind;					///< Wire or cable
+	int32_t distance;					///< mm like CALC_distance()
+	int32_t distance_half;				///< 95 % half width in mm, -1 unknown
+	int32_t current;					///< mA like CALC_estimate_current()
+	int32_t current_half;				///< 95 % half width in mA, -1 unknown
+	int32_t first_distance;				///< After the first period
+	int32_t first_current;				///< After the first period
+	uint32_t samples;					///< Samples per input used
+	bool converged;						///< Precision reached
+} SEQ_result_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern uint32_t SEQ_precision;			///< Requested half width in mm, 0 = off
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void SEQ_begin(void);
+bool SEQ_running(void);
+bool SEQ_add(CALC_kind_t kind, uint32_t count);
+void SEQ_get(SEQ_result_t *result);
+
+
+#endif
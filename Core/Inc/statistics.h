@@ -0,0 +1,60 @@
+/** ***************************************************************************
+ * @file
+ * @brief See statistics.c
+ *
+ * Prefix STAT
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef STAT_H_
+#define STAT_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "frames.h"
+#include "measuring.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define STAT_HISTORY		ADC_FS		///< Samples of the longest window, 1 s
+#define STAT_RESYNC			STAT_HISTORY	///< Samples between recalculations
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Sliding windows, see STAT_length in statistics.c */
+typedef enum {
+	STAT_SINGLE = 0,					///< 10 samples like a single value
+	STAT_ACCURATE,						///< CALC_WINDOW samples
+	STAT_SECOND,						///< STAT_HISTORY samples
+	STAT_WINDOWS
+} STAT_window_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern uint32_t STAT_mismatches;		///< Running sums found wrong
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void STAT_reset(void);
+void STAT_add(const FRAME_t *frame);
+uint32_t STAT_count(STAT_window_t window);
+int32_t STAT_mean(uint32_t input, STAT_window_t window);
+int32_t STAT_deviation(uint32_t input, STAT_window_t window);
+
+
+#endif
@@ -0,0 +1,77 @@
+/** ***************************************************************************
+ * @file
+ * @brief See telemetry.c
+ *
+ * Prefix TEL
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef TEL_H_
+#define TEL_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "displayingdata.h"
+#include "frames.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define TEL_BAUD			921600		///< USART1 to the ST-LINK virtual COM port
+#define TEL_SYNC0			0xA5		///< First byte of a packet
+#define TEL_SYNC1			0x5A		///< Second byte of a packet
+#define TEL_VERSION			1			///< Packet format version
+#define TEL_HEADER_SIZE		8			///< Bytes before the payload
+#define TEL_CRC_SIZE		2			///< Bytes after the payload
+#define TEL_MAX_PAYLOAD		1024		///< Longest payload
+#define TEL_BUFFER_SIZE		8192		///< Transmit ring in bytes (power of 2)
+#define TEL_RESERVE			(TEL_BUFFER_SIZE/4)	///< Kept free for small packets
+#define TEL_MASK_ALL		0xFFFFFFFFUL	///< All types in TEL_mask
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Packet types, see telemetry.c for the payloads */
+typedef enum {
+	TEL_RESULT = 0,						///< Values of a result screen
+	TEL_FRAME,							///< Raw samples of an acquired frame
+	TEL_SPECTRUM,						///< Spectrum of the coils
+	TEL_PROFILE,						///< Counters of the pipeline and tasks
+	TEL_REPLY,							///< Answer to a command, see remote.c
+	TEL_TRIGGER,						///< Part of a triggered window
+	TEL_TYPES
+} TEL_type_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern uint32_t TEL_sent[TEL_TYPES];	///< Packets queued per type
+extern uint32_t TEL_dropped[TEL_TYPES];	///< Packets dropped per type, ring full
+extern uint32_t TEL_mask;				///< Bit 1 << type set = type is sent
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void TEL_init(void);
+bool TEL_send(TEL_type_t type, const uint8_t *payload, uint32_t length);
+bool TEL_result(const DISP_result_t *result);
+bool TEL_frame(const FRAME_t *frame);
+bool TEL_spectrum(uint32_t seq, const uint32_t *mag, uint32_t bins);
+bool TEL_profile(void);
+bool TEL_trigger(uint32_t offset, uint32_t count);
+uint32_t TEL_queued(void);
+uint16_t TEL_crc(uint16_t crc, const uint8_t *data, uint32_t length);
+
+
+#endif
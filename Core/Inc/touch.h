@@ -0,0 +1,62 @@
+/** ***************************************************************************
+ * @file
+ * @brief See touch.c
+ *
+ * Prefix TOUCH
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef TOUCH_H_
+#define TOUCH_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define TOUCH_POLL_PERIOD	10		///< ms between reads while touched
+#define TOUCH_DEBOUNCE		20		///< ms a press or release must be stable
+#define TOUCH_QUEUE_SIZE	8		///< Queued touch events (power of 2)
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Kinds of touch events */
+typedef enum {
+	TOUCH_PRESS = 0, TOUCH_RELEASE
+} TOUCH_type_t;
+
+/** One debounced touch event, coordinates of the display */
+typedef struct {
+	TOUCH_type_t type;					///< Press or release
+	uint16_t x;							///< Column
+	uint16_t y;							///< Row
+	uint32_t time;						///< EVT_timestamp() of the interrupt
+} TOUCH_event_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern uint32_t TOUCH_reads;			///< Reads of the touch controller
+extern uint32_t TOUCH_dropped;			///< Events lost with a full queue
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void TOUCH_init(void);
+void TOUCH_update(void);
+bool TOUCH_get(TOUCH_event_t *event);
+
+
+#endif
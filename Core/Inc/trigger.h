@@ -0,0 +1,74 @@
+/** ***************************************************************************
+ * @file
+ * @brief See trigger.c
+ *
+ * Prefix TRIG
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef TRIG_H_
+#define TRIG_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "frames.h"
+#include "measuring.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define TRIG_MAX_SAMPLES	(10*ADC_NUMS)	///< Longest window, 1 s
+#define TRIG_ALL_INPUTS		INPUTS_NUMS	///< Watch all inputs
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** States of the trigger */
+typedef enum {
+	TRIG_IDLE = 0,						///< Not armed
+	TRIG_ARMED,							///< Waiting for the analog watchdog
+	TRIG_FIRED,							///< Waiting for the post-trigger samples
+	TRIG_DONE							///< Window frozen in TRIG_samples
+} TRIG_state_t;
+
+/** Trigger setup */
+typedef struct {
+	uint32_t input;						///< 0 .. INPUTS_NUMS-1 or TRIG_ALL_INPUTS
+	uint32_t low;						///< Fires below this ADC value
+	uint32_t high;						///< Fires above this ADC value
+	uint32_t pre;						///< Samples per input before the trigger
+	uint32_t post;						///< Samples per input from the trigger on
+} TRIG_config_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern volatile TRIG_state_t TRIG_state;	///< Written by the ISR and main
+extern uint32_t TRIG_sample;			///< Number of the trigger sample, see REC
+extern uint32_t TRIG_time;				///< HAL_GetTick() of the trigger
+extern uint32_t TRIG_pre;				///< Samples before the trigger in the window
+extern uint32_t TRIG_count;				///< Samples per input in the window
+extern uint32_t TRIG_samples[TRIG_MAX_SAMPLES*INPUTS_NUMS];	///< The window
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+bool TRIG_check(const TRIG_config_t *config);
+bool TRIG_arm(const TRIG_config_t *config);
+void TRIG_disarm(void);
+void TRIG_awd(void);
+bool TRIG_poll(void);
+
+
+#endif
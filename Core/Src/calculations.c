@@ -16,7 +16,6 @@
  * Includes
  *****************************************************************************/
 #include <stdio.h>
-#include <math.h>
 #include "stm32f4xx.h"
 #include "stm32f429i_discovery.h"
 #include "stm32f429i_discovery_lcd.h"
@@ -25,6 +24,8 @@
 #include "calculations.h"
 #include "measuring.h"
 #include "displayingdata.h"
+#include "placement.h"
+#include "probe.h"
 
 
 
@@ -45,6 +46,25 @@ int32_t lut_coil_5[] ={
 		#include "lut_coil_5.csv"
 		};								///< Lookup table of the coils for 5A
 
+/** Entries of the pad lookup tables, one per mm */
+#define CALC_LUT_PAD_LENGTH	((int32_t)(sizeof(lut_pad_wire)/sizeof(lut_pad_wire[0])))
+/** Entries of the coil lookup tables, one per CALC_COIL_STEP mm */
+#define CALC_LUT_COIL_LENGTH ((int32_t)(sizeof(lut_coil_1_2)/sizeof(lut_coil_1_2[0])))
+
+#define CALC_Q				16			///< Fraction bits of the fixed point values
+#define CALC_ONE			(1L << CALC_Q)	///< 1.0 in fixed point
+/** 1 / CALC_COIL_STEP in fixed point, the table position without a division */
+#define CALC_STEP_RECIPROCAL	((CALC_ONE + CALC_COIL_STEP / 2) / CALC_COIL_STEP)
+#define CALC_T95_COUNT		4			///< Entries of CALC_t95
+
+#define CALC_ANGLE_MAX		45			///< Degree at the limits of the pad difference
+#define CALC_LEFT_SPAN		232			///< Pad difference at 45° to the left
+#define CALC_RIGHT_SPAN		222			///< Pad difference at 45° to the right
+/** Degree per pad difference in fixed point, rounded up so that the spans
+ * give exactly CALC_ANGLE_MAX */
+#define CALC_LEFT_SCALE		(((CALC_ANGLE_MAX << CALC_Q) + CALC_LEFT_SPAN - 1) / CALC_LEFT_SPAN)
+#define CALC_RIGHT_SCALE	(((CALC_ANGLE_MAX << CALC_Q) + CALC_RIGHT_SPAN - 1) / CALC_RIGHT_SPAN)
+
 /******************************************************************************
  * Variables
  *****************************************************************************/
@@ -56,11 +76,37 @@ int32_t pad2 = 0; ///< Values for pad2
 bool CALC_degree_center = false; ///< Flag for the direction of the signal
 bool CALC_degree_left = false;	///< Flag for the direction of the signal
 bool CALC_degree_right = false;	///< Flag for the direction of the signal
+uint32_t CALC_window = CALC_WINDOW;	///< Samples of an accurate value, max. ADC_NUMS
+int32_t CALC_current_half = -1;	///< 95 % half width of current() in mA, -1 unknown
+
+/** mA per ADC count between the coil tables in fixed point, see CALC_prepare() */
+static int32_t CALC_coil_gain[CALC_LUT_COIL_LENGTH] PLACE_CCM;
+static bool CALC_prepared = false;	///< CALC_coil_gain is filled in
+
+/** Student t times 100, 95 % two-sided, for 1 .. CALC_T95_COUNT degrees of
+ * freedom. ADC_NUMS samples have at most 5 periods. */
+static const int32_t CALC_t95[CALC_T95_COUNT] = { 1271, 430, 318, 278 };
+
+/** Thresholds of the RMS values, found on the bench.
+ * The wire has 1.2 A above 400, the cable from 250, 5 A above 850 and 400. */
+CALC_limits_t CALC_limits = {
+	.pad = {
+		[CALC_WIRE] = { .zero = 900, .out = 96 },
+		[CALC_CABLE] = { .zero = 500, .out = 72 },
+	},
+	.coil = {
+		[CALC_WIRE] = { .low_min = 401, .low_max = 850, .high_min = 850 },
+		[CALC_CABLE] = { .low_min = 250, .low_max = 420, .high_min = 400 },
+	},
+};
 
 /******************************************************************************
  * Functions
  *****************************************************************************/
-
+static void CALC_prepare(void);
+static int32_t CALC_current_at(int32_t distance, int32_t b_val, int32_t *gain);
+static int32_t CALC_period_half(int32_t numb_samples, int32_t arr[]);
+static int32_t CALC_saturate(int64_t value, int32_t min, int32_t max);
 
 /** **************************************************************************
  * @brief 	Calculate the average of the ADC samples
@@ -89,23 +135,39 @@ int32_t average(int32_t numb_samples, int32_t arr[]){
  * @return 	calculated RMS value
  *****************************************************************************/
 int32_t RMS(int32_t numb_samples, int32_t arr[]){
-	int i;
 	int32_t avg = 0;
 	int32_t rms = 0;
-	int32_t tmp = 0;
-	int32_t diff = 0;
+	PROBE_BEGIN(PROBE_RMS);
 
 	avg = average(numb_samples, arr);
+	rms = standard_deviation(avg, numb_samples, arr);
+
+	PROBE_END(PROBE_RMS);
+	return rms;
+}
+
+/** **************************************************************************
+ * @brief 	calculate the standard deviation around a given average
+ * @param	avg	average of the samples, see average()
+ * @param	numb_samples: number of samples
+ * @param	arr[]: array filled with samples
+ * @note	Without the offset this is the RMS value of the signal.
+ * 			For the continuous mode see STAT_deviation() in statistics.c,
+ * 			which does not go through all samples for every value.
+ * @return 	standard deviation
+ *****************************************************************************/
+int32_t standard_deviation(int32_t avg, int32_t numb_samples, int32_t arr[]){
+	int i;
+	int32_t sum = 0;
+	int32_t diff = 0;
 
 	for(i = 0; i < numb_samples; i++){
 		diff = arr[i] - avg;
-		tmp = diff * diff;
-		rms = rms + tmp;
+		sum = sum + diff * diff;
 	}
-	rms = rms / numb_samples;
-	rms = sqrt(rms);
+	sum = sum / numb_samples;
 
-	return rms;
+	return (int32_t)CALC_sqrt((uint32_t)sum);
 }
 
 
@@ -115,14 +177,13 @@ int32_t RMS(int32_t numb_samples, int32_t arr[]){
  * @brief find the distance between device and cable
  * @note  	measure in the range of [5,200]mm and has a precision of -/+30%
  * @param 	meas_mode	1 = single measurement (10 samples),
- * 			else = accurate measurement (50 samples)
+ * 			else = accurate measurement (CALC_window samples)
  * @param	meas_type	1 = wire
  * 						else = cable
  * @return 	distance to the cable up to 200mm
  *****************************************************************************/
 int32_t distance_to_cable(int32_t meas_mode){
 
-	int32_t dist = 0;
 	int32_t e_val = 0; //< e_val is the electrical field value
 
 
@@ -132,44 +193,17 @@ int32_t distance_to_cable(int32_t meas_mode){
 			pad2 = RMS(10, PAD2_samples);
 		}
 		else{
-			pad1 = RMS(50, PAD1_samples);
-			pad2 = RMS(50, PAD2_samples);
+			pad1 = RMS(CALC_window, PAD1_samples);
+			pad2 = RMS(CALC_window, PAD2_samples);
 		}
 		e_val = (pad1 + pad2) / 2;
 
 	if(MEAS_data_wire){
-
-		if(e_val >= 900){
-			dist = 0;
-			return dist;
-		}
-		else if(e_val <= 96){
-			dist = -1;
-			return dist;
-		}
-		else{
-			while(lut_pad_wire[dist] > e_val){
-				dist++;
-			}
-			return dist;}
-		}
-		else if(MEAS_data_cable){
-		if(e_val >= 500){
-			dist = 0;
-			return dist;
-		}
-		else if(e_val <= 72){
-			dist = -1;
-			return dist;
-		}
-		else{
-			while(lut_pad_wire[dist]>e_val){
-				dist++;
-			}
-			return dist;
-		}
-
-		}
+		return CALC_distance(CALC_WIRE, e_val, &CALC_limits);
+	}
+	else if(MEAS_data_cable){
+		return CALC_distance(CALC_CABLE, e_val, &CALC_limits);
+	}
 
 	return -1;
 }
@@ -178,102 +212,360 @@ int32_t distance_to_cable(int32_t meas_mode){
  * @brief 	calculate the angle to the cable
  * @note  	range [-45,45]°, precision -/+15
  * 			calibrated @ 20mm distance to wire/cable
+ * 			Integer only, the spans are divided by a fixed point
+ * 			multiplication.
  * @n		The field is very location and board depending.
  * @return	angle to wire/cable
  *****************************************************************************/
 int32_t angle_to_cable(){
 
-	float diff;
-	float ratio;
-	float angle;
+	int32_t diff;
+	int32_t angle;
 	int32_t pad1 = 0;
 	int32_t pad2 = 0;
 
-	pad1 = RMS(50, PAD1_samples);
-	pad2 = RMS(50, PAD2_samples);
-
-	diff = pad1 - pad2;
-
-	if(diff > 232){
-		diff = 232;
-	}
+	pad1 = RMS(CALC_window, PAD1_samples);
+	pad2 = RMS(CALC_window, PAD2_samples);
 
-	if(diff < -222){
-		diff = -222;
-	}
+	diff = CALC_saturate(pad1 - pad2, -CALC_RIGHT_SPAN, CALC_LEFT_SPAN);
 
+	// Multiply with the reciprocal of the span, rounded toward 0
 	if(diff > 20)
 	{
-		ratio = diff / 232;
-		angle = 45 * ratio;
+		angle = (diff * CALC_LEFT_SCALE) >> CALC_Q;
 		CALC_degree_left = true;
 	}
 	else
 	{
-		ratio = diff / 222;
-		angle = 45 * ratio;
+		angle = (diff < 0) ? -((-diff * CALC_RIGHT_SCALE) >> CALC_Q)
+				: (diff * CALC_RIGHT_SCALE) >> CALC_Q;
 		CALC_degree_right = true;
 	}
 
-
-
 	return angle;
 
 }
 
 
-
 /** **************************************************************************
  * @brief 	calculate the current in a wire or cable
  * @param	meas_mode	1 = single, else = accurate
- * @note  	return expected current 5A or 1.2A
+ * @note  	The current is interpolated between the coil tables at the
+ * 			distance from the pads, see CALC_estimate_current().
  * 			The field is very location and board depending.
- * @return	-1 if no clear value
+ * @n		Sets CALC_current_half from the spread of the mains periods,
+ * 			unknown for a single value, which has less than one period.
+ * @return	current in mA, -1 if the distance is out of range
  *****************************************************************************/
 int32_t current(int32_t meas_mode){
 
+	int32_t n = (meas_mode == 1) ? 10 : (int32_t)CALC_window;
 	int32_t coil1 = 0;
 	int32_t coil2 = 0;
-	int32_t b_val = 0; //<
-	int current = 0;
+	int32_t b_val = 0; //< b_val is the magnetic field value
+	int32_t e_val = 0;
+	CALC_kind_t kind = CALC_WIRE;
 
-	//Calculate RMS for single / accu value
-	if(meas_mode == 1){
-		coil1 = RMS(10, COIL1_samples);
-		coil2 = RMS(10, COIL2_samples);
+	CALC_current_half = -1;
+	if(MEAS_data_cable && !MEAS_data_wire){
+		kind = CALC_CABLE;
 	}
-	else{
-		coil1 = RMS(50, COIL1_samples);
-		coil2 = RMS(50, COIL2_samples);
+	else if(!MEAS_data_wire){
+		return -1;
 	}
+	coil1 = RMS(n, COIL1_samples);
+	coil2 = RMS(n, COIL2_samples);
 
 	// Mean value for the b-field. The field is very location and board depending.
 	b_val = (coil1 + coil2) / 2;
+	e_val = (RMS(n, PAD1_samples) + RMS(n, PAD2_samples)) / 2;
 
-	if(MEAS_data_wire){
+	int32_t distance = CALC_distance(kind, e_val, &CALC_limits);
+	int32_t e_half = CALC_period_half(n, PAD1_samples);
+	int32_t b_half = CALC_period_half(n, COIL1_samples);
+	if((e_half < 0) || (b_half < 0)){
+		return CALC_estimate_current(distance, -1, b_val, -1, NULL);
+	}
+	e_half = (e_half + CALC_period_half(n, PAD2_samples)) / 2;
+	b_half = (b_half + CALC_period_half(n, COIL2_samples)) / 2;
+	int32_t dist_half = CALC_distance_half(kind, e_val, e_half);
+	return CALC_estimate_current(distance, dist_half, b_val, b_half,
+			&CALC_current_half);
+}
+
+
+/** **************************************************************************
+ * @brief 	distance for an electrical field value
+ * @param	kind	wire or cable
+ * @param	e_val	mean RMS value of the pads
+ * @param	limits	thresholds, CALC_limits on the target
+ * @note	Does not access any other state, the host tools evaluate
+ * 			different limits in parallel.
+ * @return 	distance in mm, 0 if touching, -1 if out of range
+ *****************************************************************************/
+int32_t CALC_distance(CALC_kind_t kind, int32_t e_val,
+		const CALC_limits_t *limits){
+
+	const CALC_pad_limits_t *pad = &limits->pad[kind];
+	int32_t dist = 0;
+
+	if(e_val >= pad->zero){
+		return 0;
+	}
+	else if(e_val <= pad->out){
+		return -1;
+	}
+	// Stop at the end of the table if the limit is below the last entry
+	const int32_t *lut = (CALC_CABLE == kind) ? lut_pad_cable : lut_pad_wire;
+	while((dist < CALC_LUT_PAD_LENGTH - 1) && (lut[dist] > e_val)){
+		dist++;
+	}
+	return dist;
+}
+
+
+/** **************************************************************************
+ * @brief 	current for a magnetic field value
+ * @param	kind	wire or cable
+ * @param	b_val	mean RMS value of the coils
+ * @param	limits	thresholds, CALC_limits on the target
+ * @note	Does not access any other state, see CALC_distance().
+ * 			Classifies with the thresholds found on the bench,
+ * 			current() estimates continuously with CALC_estimate_current().
+ * @return	current in mA, 1200 or 5000, -1 if no clear value
+ *****************************************************************************/
+int32_t CALC_current(CALC_kind_t kind, int32_t b_val,
+		const CALC_limits_t *limits){
+
+	const CALC_coil_limits_t *coil = &limits->coil[kind];
 
-		if((b_val <= 850) && (b_val > 400)){
-			current = 1200;
-			return current;
+	if((b_val >= coil->low_min) && (b_val <= coil->low_max)){
+		return 1200;
+	}
+	else if(b_val > coil->high_min){
+		return 5000;
+	}
+	return -1;
+}
+
+
+/** **************************************************************************
+ * @brief 	half width of a distance for the half width of the pad value
+ * @param	kind	wire or cable
+ * @param	e_val	mean RMS value of the pads
+ * @param	e_half	half width of e_val in ADC counts
+ * @note	CALC_distance() at both ends of the interval.
+ * @return	half width in mm, 0 if out of range for sure,
+ * 			-1 if it could be out of range
+ *****************************************************************************/
+int32_t CALC_distance_half(CALC_kind_t kind, int32_t e_val, int32_t e_half){
+
+	int32_t near = CALC_distance(kind, e_val + e_half, &CALC_limits);
+	int32_t far = CALC_distance(kind, e_val - e_half, &CALC_limits);
+
+	if((near < 0) && (far < 0)){
+		return 0;
+	}
+	else if((near < 0) || (far < 0)){
+		return -1;
+	}
+	return (far - near + 1) / 2;
+}
+
+
+/** **************************************************************************
+ * @brief 	continuous current for a magnetic field value at a distance
+ * @param	distance	mm from the pads, see CALC_distance()
+ * @param	dist_half	half width of distance in mm, -1 unknown
+ * @param	b_val		mean RMS value of the coils
+ * @param	b_half		half width of b_val in ADC counts, -1 unknown
+ * @param	half		set to the half width of the current in mA,
+ * 						-1 if unknown, may be NULL
+ * @note	The field of a conductor is proportional to its current, so at a
+ * 			fixed distance the current is linear between the value of
+ * 			lut_coil_1_2 and lut_coil_5 there. Both tables are interpolated
+ * 			at the distance, the slope comes from CALC_coil_gain, so there
+ * 			is no division per value. Fixed point with CALC_Q fraction bits
+ * 			and 64 bit products, cheap enough for every half of the
+ * 			continuous mode.
+ * @n		The half widths of the field and of the distance are combined as
+ * 			independent, the pads and the coils have their own noise.
+ * @return	current in mA, -1 if the distance is out of range
+ *****************************************************************************/
+int32_t CALC_estimate_current(int32_t distance, int32_t dist_half,
+		int32_t b_val, int32_t b_half, int32_t *half){
+
+	int32_t gain = 0;
+	int32_t other = 0;
+
+	if(NULL != half){
+		*half = -1;
+	}
+	if(distance < 0){
+		return -1;
+	}
+	int32_t i = CALC_current_at(distance, b_val, &gain);
+	if((NULL != half) && (dist_half >= 0) && (b_half >= 0)){
+		int32_t i_b = (int32_t)(((int64_t)gain * b_half) >> CALC_Q);
+		int32_t near = CALC_current_at((distance > dist_half) ? distance - dist_half : 0,
+				b_val, &other);
+		int32_t far = CALC_current_at(distance + dist_half, b_val, &other);
+		int32_t i_d = (far > near) ? (far - near) / 2 : (near - far) / 2;
+		*half = (int32_t)CALC_sqrt64((uint64_t)((int64_t)i_b * i_b + (int64_t)i_d * i_d));
+	}
+	return CALC_saturate(i, 0, INT32_MAX);
+}
+
+
+/** **************************************************************************
+ * @brief 	fill in the reciprocal table of the coil tables once
+ * @note	(CALC_CURRENT_HIGH - CALC_CURRENT_LOW) / (lut_coil_5 - lut_coil_1_2)
+ * 			per entry. The 5 A table is above the 1.2 A table everywhere.
+ *****************************************************************************/
+static void CALC_prepare(void){
+
+	for(int32_t k = 0; k < CALC_LUT_COIL_LENGTH; k++){
+		CALC_coil_gain[k] = ((CALC_CURRENT_HIGH - CALC_CURRENT_LOW) << CALC_Q)
+				/ (lut_coil_5[k] - lut_coil_1_2[k]);
+	}
+	CALC_prepared = true;
+}
+
+
+/** **************************************************************************
+ * @brief 	current at a distance without the half width
+ * @param	distance	mm, clamped to the coil tables
+ * @param	b_val		mean RMS value of the coils
+ * @param	gain		set to the mA per ADC count there in fixed point
+ * @return	current in mA, negative below the 1.2 A table
+ *****************************************************************************/
+static int32_t CALC_current_at(int32_t distance, int32_t b_val, int32_t *gain){
+
+	if(!CALC_prepared){
+		CALC_prepare();
+	}
+	int32_t pos = distance * CALC_STEP_RECIPROCAL;
+	int32_t k = pos >> CALC_Q;
+	int32_t frac = pos & (CALC_ONE - 1);
+	if(k >= CALC_LUT_COIL_LENGTH - 1){
+		k = CALC_LUT_COIL_LENGTH - 2;
+		frac = CALC_ONE;
+	}
+	int32_t low = (lut_coil_1_2[k] << CALC_Q)
+			+ (lut_coil_1_2[k + 1] - lut_coil_1_2[k]) * frac;
+	*gain = CALC_coil_gain[k] + (int32_t)(((int64_t)(CALC_coil_gain[k + 1]
+			- CALC_coil_gain[k]) * frac) >> CALC_Q);
+	int64_t delta = ((int64_t)b_val << CALC_Q) - low;
+	return CALC_saturate(CALC_CURRENT_LOW + ((delta * *gain) >> (2 * CALC_Q)),
+			INT32_MIN, INT32_MAX);
+}
+
+
+/** **************************************************************************
+ * @brief 	half width of an RMS value from the spread of the mains periods
+ * @param	numb_samples	number of samples
+ * @param	arr[]	array filled with samples
+ * @note	One RMS value per whole period of CALC_WINDOW_MIN samples,
+ * 			the Student t interval of their mean like in sequential.c.
+ * @return	95 % half width in ADC counts, -1 below two periods
+ *****************************************************************************/
+static int32_t CALC_period_half(int32_t numb_samples, int32_t arr[]){
+
+	int32_t periods = numb_samples / CALC_WINDOW_MIN;
+	int32_t sum = 0;
+	int32_t squares = 0;
+
+	if(periods < 2){
+		return -1;
+	}
+	for(int32_t p = 0; p < periods; p++){
+		int32_t rms = RMS(CALC_WINDOW_MIN, &arr[p * CALC_WINDOW_MIN]);
+		sum += rms;
+		squares += rms * rms;
+	}
+	int32_t df = (periods - 1 < CALC_T95_COUNT) ? periods - 1 : CALC_T95_COUNT;
+	// Variance of the mean times 100^2, the root keeps two decimals
+	int64_t var = ((int64_t)periods * squares - (int64_t)sum * sum) * 10000
+			/ (periods * (periods - 1) * periods);
+	int64_t half = ((int64_t)CALC_t95[df - 1] * CALC_sqrt64((uint64_t)var) + 5000) / 10000;
+	return CALC_saturate(half, 0, INT32_MAX);
+}
+
+
+/** **************************************************************************
+ * @brief 	integer square root, rounded down
+ * @param	value
+ * @note	The same result as (int32_t)sqrt(value) on every build,
+ * 			a bit per iteration from the highest one of value.
+ * @return	the largest root whose square does not exceed value
+ *****************************************************************************/
+uint32_t CALC_sqrt(uint32_t value){
+
+	uint32_t root = 0;
+	uint32_t bit = 1UL << 30;
+
+	while(bit > value){
+		bit >>= 2;
+	}
+	while(bit != 0){
+		if(value >= root + bit){
+			value -= root + bit;
+			root = (root >> 1) + bit;
 		}
-		else if(b_val > 850){
-			current = 5000;
-			return current;
+		else{
+			root >>= 1;
 		}
+		bit >>= 2;
 	}
-	else if(MEAS_data_cable){
+	return root;
+}
+
+
+/** **************************************************************************
+ * @brief 	integer square root of a 64 bit value, rounded down
+ * @param	value	e.g. a sum of squares of many samples
+ * @note	See CALC_sqrt(), which is used when the value fits 32 bits.
+ * @return	the largest root whose square does not exceed value
+ *****************************************************************************/
+uint32_t CALC_sqrt64(uint64_t value){
+
+	uint64_t root = 0;
+	uint64_t bit = 1ULL << 62;
 
-		if((b_val <= 420) && (b_val >= 250)){
-			current = 1200;
-			return current;
+	if(value <= UINT32_MAX){
+		return CALC_sqrt((uint32_t)value);
+	}
+	while(bit > value){
+		bit >>= 2;
+	}
+	while(bit != 0){
+		if(value >= root + bit){
+			value -= root + bit;
+			root = (root >> 1) + bit;
 		}
-		else if((b_val > 400)){
-			current = 5000;
-			return current;
+		else{
+			root >>= 1;
 		}
+		bit >>= 2;
 	}
-	return -1;
+	return (uint32_t)root;
 }
 
 
+/** **************************************************************************
+ * @brief 	limit a value to a range instead of letting it wrap around
+ * @param	value	result of a wider calculation
+ * @param	min		lowest value returned
+ * @param	max		highest value returned
+ * @return	value within [min, max]
+ *****************************************************************************/
+static int32_t CALC_saturate(int64_t value, int32_t min, int32_t max){
 
+	if(value < min){
+		return min;
+	}
+	else if(value > max){
+		return max;
+	}
+	return (int32_t)value;
+}
@@ -0,0 +1,272 @@
+/** ***************************************************************************
+ * @file
+ * @brief Binary captures of acquired frames for record and replay
+ *
+ * ==============================================================
+ *
+ * A capture is a block of memory: SDRAM on the target, a file on the host.
+ * All fields are little endian.
+ *
+ * Header, CAP_HEADER_SIZE bytes:
+ * | Offset | Size | Content                                          |
+ * |--------|------|--------------------------------------------------|
+ * | 0      | 4    | CAP_MAGIC, "RDRC"                                |
+ * | 4      | 2    | Format version, CAP_VERSION                      |
+ * | 6      | 2    | Header size, readers skip unknown fields         |
+ * | 8      | 4    | Sample rate in Hz                                |
+ * | 12     | 1    | Inputs per sample (4)                            |
+ * | 13     | 1    | Bits per sample (12)                             |
+ * | 14     | 2    | Reserved, 0                                      |
+ * | 16     | 4    | Input of each column, CAP_input_t, a permutation |
+ * | 20     | 4    | Calibration, CALC_CALIBRATION of the recording   |
+ * | 24     | 4    | Number of frames                                 |
+ * | 28     | 4    | Bytes of all frames                              |
+ *
+ * Frame, CAP_FRAME_SIZE(count) bytes:
+ * | Offset | Size | Content                                          |
+ * |--------|------|--------------------------------------------------|
+ * | 0      | 2    | Samples per input (count)                        |
+ * | 2      | 2    | Lower 16 bits of the frame sequence number       |
+ * | 4      | ...  | count*4 samples interleaved like ADC_samples,    |
+ * |        |      | two samples of 12 bit packed into 3 bytes        |
+ *
+ * The header is updated after every frame,
+ * so a capture is always complete up to its last frame.
+ *
+ * On the target main() records every acquired frame to CAP_SDRAM_ADDR
+ * until the CAP_SDRAM_SIZE bytes are full.
+ * Longer periods of the continuous mode are kept by the recorder,
+ * see record.c.
+ * Export it with the debugger, bytes 28 to 31 give the length - 32:
+ * @verbatim
+   (gdb) dump binary memory field.rdc 0xD00A0000 (0xD00A0000+32+*(int*)0xD00A001C)
+   @endverbatim
+ * On the host Host/build/replay records synthetic captures
+ * and replays captures through the calculations.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <string.h>
+
+#include "capture.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define CAP_MASK			((1U << CAP_BITS) - 1)	///< Bits of a sample
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static void CAP_put16(uint8_t *p, uint32_t value);
+static void CAP_put32(uint8_t *p, uint32_t value);
+static uint32_t CAP_get16(const uint8_t *p);
+static uint32_t CAP_get32(const uint8_t *p);
+static void CAP_update(CAP_t *cap);
+
+
+/** ***************************************************************************
+ * @brief Start an empty capture in a buffer
+ * @param cap capture to set up
+ * @param buffer memory for the header and the frames
+ * @param size bytes of the buffer
+ * @param rate sample rate in Hz
+ * @param calibration CALC_CALIBRATION
+ * @return false if the buffer cannot hold the header
+ *****************************************************************************/
+bool CAP_create(CAP_t *cap, void *buffer, uint32_t size, uint32_t rate,
+		uint32_t calibration)
+{
+	if (size < CAP_HEADER_SIZE) {
+		return false;
+	}
+	cap->data = buffer;
+	cap->size = size;
+	cap->used = CAP_HEADER_SIZE;
+	cap->rate = rate;
+	cap->calibration = calibration;
+	cap->frames = 0;
+	for (uint32_t i = 0; i < INPUTS_NUMS; i++) {
+		cap->map[i] = i;				// Columns like ADC_samples
+	}
+	memset(cap->data, 0, CAP_HEADER_SIZE);
+	CAP_put32(&cap->data[0], CAP_MAGIC);
+	CAP_put16(&cap->data[4], CAP_VERSION);
+	CAP_put16(&cap->data[6], CAP_HEADER_SIZE);
+	CAP_put32(&cap->data[8], rate);
+	cap->data[12] = INPUTS_NUMS;
+	cap->data[13] = CAP_BITS;
+	memcpy(&cap->data[16], cap->map, INPUTS_NUMS);
+	CAP_put32(&cap->data[20], calibration);
+	CAP_update(cap);
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Append a frame
+ * @param cap capture from CAP_create()
+ * @param frame samples interleaved like ADC_samples
+ * @return false if the capture is full, the frame is not stored
+ *****************************************************************************/
+bool CAP_put(CAP_t *cap, const FRAME_t *frame)
+{
+	uint32_t bytes = CAP_FRAME_SIZE(frame->count);
+	if ((frame->count > UINT16_MAX) || (bytes > cap->size - cap->used)) {
+		return false;
+	}
+	uint8_t *p = &cap->data[cap->used];
+	const uint32_t *src = frame->samples;
+	CAP_put16(&p[0], frame->count);
+	CAP_put16(&p[2], frame->seq);
+	p += CAP_FRAME_HEADER;
+	for (uint32_t i = 0; i < frame->count*INPUTS_NUMS; i += 2) {
+		uint32_t a = src[i] & CAP_MASK;
+		uint32_t b = src[i + 1] & CAP_MASK;
+		p[0] = a;
+		p[1] = (a >> 8) | (b << 4);
+		p[2] = b >> 4;
+		p += 3;
+	}
+	cap->used += bytes;
+	cap->frames++;
+	CAP_update(cap);
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Check a capture and prepare reading its first frame
+ * @param cap capture to set up
+ * @param buffer memory with the capture
+ * @param size bytes of the buffer
+ * @return false if it is no capture, a newer version, truncated or if
+ * the columns do not map to every input once
+ *****************************************************************************/
+bool CAP_open(CAP_t *cap, void *buffer, uint32_t size)
+{
+	const uint8_t *p = buffer;
+	if ((size < CAP_HEADER_SIZE) || (CAP_MAGIC != CAP_get32(&p[0]))
+			|| (CAP_VERSION < CAP_get16(&p[4]))) {
+		return false;
+	}
+	uint32_t header = CAP_get16(&p[6]);
+	uint32_t bytes = CAP_get32(&p[28]);
+	if ((header < CAP_HEADER_SIZE) || (INPUTS_NUMS != p[12])
+			|| (CAP_BITS != p[13]) || (header > size)
+			|| (bytes > size - header)) {
+		return false;
+	}
+	uint32_t seen = 0;					// Every input exactly once
+	for (uint32_t i = 0; i < INPUTS_NUMS; i++) {
+		if ((p[16 + i] >= INPUTS_NUMS) || (seen & (1U << p[16 + i]))) {
+			return false;
+		}
+		seen |= 1U << p[16 + i];
+		cap->map[i] = p[16 + i];
+	}
+	cap->data = buffer;
+	cap->size = header + bytes;			// End of the frames
+	cap->rate = CAP_get32(&p[8]);
+	cap->calibration = CAP_get32(&p[20]);
+	cap->frames = CAP_get32(&p[24]);
+	cap->used = header;
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Read the next frame
+ * @param cap capture from CAP_open()
+ * @param frame set to the samples, the count and the sequence number
+ * @param samples memory for max samples per input, like ADC_samples
+ * @param max samples per input which fit into samples
+ * @return false at the end of the capture or if a frame is broken
+ *****************************************************************************/
+bool CAP_next(CAP_t *cap, FRAME_t *frame, uint32_t *samples, uint32_t max)
+{
+	if (cap->size - cap->used < CAP_FRAME_HEADER) {
+		return false;
+	}
+	const uint8_t *p = &cap->data[cap->used];
+	uint32_t count = CAP_get16(&p[0]);
+	uint32_t bytes = CAP_FRAME_SIZE(count);
+	if ((count > max) || (bytes > cap->size - cap->used)) {
+		return false;
+	}
+	frame->samples = samples;
+	frame->count = count;
+	frame->seq = CAP_get16(&p[2]);
+	frame->time = 0;
+	frame->overruns = 0;
+	p += CAP_FRAME_HEADER;
+	for (uint32_t i = 0; i < count*INPUTS_NUMS; i += INPUTS_NUMS) {
+		uint32_t v[INPUTS_NUMS];
+		for (uint32_t j = 0; j < INPUTS_NUMS; j += 2) {
+			v[j] = p[0] | ((p[1] & 0x0FU) << 8);
+			v[j + 1] = (p[1] >> 4) | ((uint32_t)p[2] << 4);
+			p += 3;
+		}
+		for (uint32_t j = 0; j < INPUTS_NUMS; j++) {
+			samples[i + cap->map[j]] = v[j];
+		}
+	}
+	cap->used += bytes;
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Read the capture again from the first frame
+ * @param cap capture from CAP_open()
+ *****************************************************************************/
+void CAP_rewind(CAP_t *cap)
+{
+	cap->used = CAP_get16(&cap->data[6]);
+}
+
+
+/** ***************************************************************************
+ * @brief Write the number of frames and bytes into the header
+ * @param cap capture
+ *****************************************************************************/
+static void CAP_update(CAP_t *cap)
+{
+	CAP_put32(&cap->data[24], cap->frames);
+	CAP_put32(&cap->data[28], cap->used - CAP_HEADER_SIZE);
+}
+
+
+/** ***************************************************************************
+ * @brief Little endian access
+ *****************************************************************************/
+static void CAP_put16(uint8_t *p, uint32_t value)
+{
+	p[0] = value;
+	p[1] = value >> 8;
+}
+
+static void CAP_put32(uint8_t *p, uint32_t value)
+{
+	CAP_put16(&p[0], value);
+	CAP_put16(&p[2], value >> 16);
+}
+
+static uint32_t CAP_get16(const uint8_t *p)
+{
+	return p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t CAP_get32(const uint8_t *p)
+{
+	return CAP_get16(&p[0]) | (CAP_get16(&p[2]) << 16);
+}
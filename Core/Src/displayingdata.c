@@ -4,6 +4,13 @@
  *
  * ==============================================================
  *
+ * The result screens are described by layout tables in flash:
+ * texts, fields with a label, width and unit, traces and circles with font,
+ * color, position and the states in which they are shown (DISP_item_t).
+ * @n The texts are formatted into glyphs by format.c, without printf.
+ * @n DISP_render() interprets a layout.
+ * Static items are drawn once on the background layer.
+ * Dynamic items are drawn on the foreground layer and only if they are dirty.
  *
  * ----------------------------------------------------------------------------
  * @author Stefan Kneubühl, kneubste@students.zhaw.ch
@@ -14,8 +21,7 @@
 /******************************************************************************
  * Includes
  *****************************************************************************/
-#include <stdio.h>
-#include <math.h>
+#include <string.h>
 #include "stm32f4xx.h"
 #include "stm32f429i_discovery.h"
 #include "stm32f429i_discovery_lcd.h"
@@ -24,317 +30,617 @@
 #include "measuring.h"
 #include "calculations.h"
 #include "displayingdata.h"
+#include "events.h"
+#include "format.h"
+#include "probe.h"
 
 /******************************************************************************
  * Defines
  *****************************************************************************/
+#define DISP_X_SIZE			240			///< Width of the display
+#define DISP_CONTENT_HEIGHT	281			///< Rows above the menu bar
+#define DISP_COLOR_KEY		0x00FFFFFF	///< Transparent color of the foreground
+#define DISP_TRACE_STEP		4			///< Pixels between two samples
+#define DISP_TRACE_SCALE	((6 << ADC_DAC_RES) / 280 + 1)	///< Counts per pixel
+#define DISP_TRACE_MAX		(((1 << ADC_DAC_RES) - 1) / DISP_TRACE_SCALE)
+										///< Max. height of a trace
+
+/** Layout item: fixed text */
+#define DISP_ITEM_TEXT(show, font, color, x, y, align, text) \
+	{ DISP_TEXT, show, align, 0, font, color, x, y, 0, text, NULL, 0, NULL }
+/** Layout item: label, value right aligned to width digits and unit */
+#define DISP_ITEM_FIELD(show, font, color, x, y, value, label, width, unit) \
+	{ DISP_FIELD, show, LEFT_MODE, value, font, color, x, y, 0, label, NULL, \
+		width, unit }
+/** Layout item: trace of DISP_TRACE_SAMPLES samples above the zero line */
+#define DISP_ITEM_TRACE(show, color, zero, samples) \
+	{ DISP_TRACE, show, 0, DISP_TRACE_SAMPLES, NULL, color, 0, zero, 0, NULL, \
+		samples, 0, NULL }
+/** Layout item: circle, kind DISP_RING or DISP_DOT */
+#define DISP_ITEM_CIRCLE(kind, show, color, x, y, r) \
+	{ kind, show, 0, 0, NULL, color, x, y, r, NULL, NULL, 0, NULL }
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** What is on the foreground for a dynamic item */
+typedef struct {
+	bool shown;							///< Item is drawn
+	uint8_t len;						///< Length of the drawn text
+	int32_t value;						///< Drawn value of a field
+} DISP_cache_t;
 
 
 
 /******************************************************************************
  * Variables
  *****************************************************************************/
-
-int32_t dist_single = 0; 	 	///< Value for single measurement
-int32_t dist_accu = 0; 	 	///< Value for accurate measurement
-float 	current_single = 0; 	///< Value for single measurement
-float 	current_accu = 0;		///< Value for accurate measurement
+static DISP_screen_t DISP_screen = DISP_SCREEN_NONE;	///< Screen on background
+static const DISP_layout_t *DISP_layout = NULL;	///< Layout on the foreground
+static DISP_cache_t DISP_cache[DISP_ITEMS_MAX];	///< Drawn dynamic items
+
+/*
+ * Layout tables of the result screens.
+ * Dynamic items are sorted by font and color where they do not overlap,
+ * so that the renderer changes the drawing state as seldom as possible.
+ * Overlapping items are drawn in table order.
+ */
+
+/** Static items of the wire and the cable screen */
+static const DISP_item_t DISP_result_static[] = {
+		DISP_ITEM_TEXT(0, &Font20, LCD_COLOR_BLACK, 5, 50, LEFT_MODE, "Single"),
+		DISP_ITEM_TEXT(0, &Font20, LCD_COLOR_BLACK, 5, 110, LEFT_MODE, "Accurate"),
+		DISP_ITEM_TEXT(0, &Font12, LCD_COLOR_BLACK, 5, 165, LEFT_MODE, "Pad:"),
+		DISP_ITEM_TEXT(0, &Font12, LCD_COLOR_BLACK, 5, 225, LEFT_MODE, "Coil:"),
+};
+
+/** Latencies in the upper right corner of every result screen */
+#define DISP_LATENCY_ITEMS \
+		DISP_ITEM_FIELD(0, &Font12, LCD_COLOR_DARKGRAY, 138, 8, \
+				DISP_LATENCY_TOUCH, "Touch ", 5, " us"), \
+		DISP_ITEM_FIELD(0, &Font12, LCD_COLOR_DARKGRAY, 138, 22, \
+				DISP_LATENCY_DATA, "Data  ", 5, " us")
+
+/** Dynamic items of the wire and the cable screen */
+static const DISP_item_t DISP_result_dynamic[] = {
+		DISP_ITEM_FIELD(0, &Font16, LCD_COLOR_BLACK, 5, 70,
+				DISP_DIST_SINGLE, "Distance: ", 4, NULL),
+		DISP_ITEM_FIELD(DISP_IN_RANGE, &Font16, LCD_COLOR_BLACK, 5, 85,
+				DISP_CURRENT_SINGLE, "Current:  ", 4, NULL),
+		DISP_ITEM_FIELD(0, &Font16, LCD_COLOR_BLACK, 5, 130,
+				DISP_DIST_ACCU, "Distance: ", 4, NULL),
+		DISP_ITEM_FIELD(DISP_IN_RANGE, &Font16, LCD_COLOR_BLACK, 5, 145,
+				DISP_CURRENT_ACCU, "Current:  ", 4, NULL),
+		DISP_ITEM_TEXT(DISP_OUT_RANGE, &Font24, LCD_COLOR_RED, 5, 180,
+				CENTER_MODE, "OUT OF RANGE"),
+		DISP_ITEM_FIELD(DISP_CONVERGED, &Font12, LCD_COLOR_DARKGRAY, 125, 106,
+				DISP_CONFIDENCE, "+/-", 3, " mm"),
+		DISP_ITEM_FIELD(DISP_ADAPTIVE, &Font12, LCD_COLOR_DARKGRAY, 125, 119,
+				DISP_SAMPLES, "", 3, " samples"),
+		DISP_ITEM_FIELD(DISP_CURRENT_KNOWN, &Font12, LCD_COLOR_DARKGRAY, 163, 149,
+				DISP_CURRENT_HALF, "+/-", 4, " mA"),
+		DISP_ITEM_TRACE(DISP_IN_RANGE, LCD_COLOR_BLUE, 220, PAD1_samples),
+		DISP_ITEM_TRACE(DISP_IN_RANGE, LCD_COLOR_RED, 220, PAD2_samples),
+		DISP_ITEM_TRACE(DISP_IN_RANGE, LCD_COLOR_DARKCYAN, 280, COIL1_samples),
+		DISP_ITEM_TRACE(DISP_IN_RANGE, LCD_COLOR_ORANGE, 280, COIL2_samples),
+		DISP_LATENCY_ITEMS,
+};
+
+/** Static items of the angle screen */
+static const DISP_item_t DISP_angle_static[] = {
+		DISP_ITEM_TEXT(0, &Font20, LCD_COLOR_BLACK, 5, 50, LEFT_MODE,
+				"Value in Degree"),
+		DISP_ITEM_CIRCLE(DISP_RING, 0, LCD_COLOR_BLACK, 45, 220, 20),
+		DISP_ITEM_CIRCLE(DISP_RING, 0, LCD_COLOR_BLACK, 195, 220, 20),
+};
+
+/** Dynamic items of the angle screen */
+static const DISP_item_t DISP_angle_dynamic[] = {
+		DISP_ITEM_FIELD(DISP_LEFT, &Font20, LCD_COLOR_BLACK, 5, 90,
+				DISP_ANGLE, "Angle:  ", 4, NULL),
+		DISP_ITEM_FIELD(DISP_RIGHT, &Font20, LCD_COLOR_BLACK, 5, 90,
+				DISP_ANGLE, "Angle: ", 4, NULL),
+		DISP_ITEM_CIRCLE(DISP_DOT, DISP_LEFT, LCD_COLOR_GREEN, 45, 220, 10),
+		DISP_ITEM_CIRCLE(DISP_DOT, DISP_RIGHT, LCD_COLOR_GREEN, 195, 220, 10),
+		DISP_ITEM_TEXT(DISP_NO_VALUE, &Font20, LCD_COLOR_RED, 5, 90,
+				CENTER_MODE, "NO VALUE"),
+		DISP_ITEM_CIRCLE(DISP_DOT, DISP_NO_VALUE, LCD_COLOR_RED, 120, 150, 10),
+		DISP_ITEM_CIRCLE(DISP_DOT, DISP_NO_VALUE, LCD_COLOR_RED, 45, 220, 10),
+		DISP_ITEM_CIRCLE(DISP_DOT, DISP_NO_VALUE, LCD_COLOR_RED, 195, 220, 10),
+		DISP_LATENCY_ITEMS,
+};
+
+#define DISP_COUNT(a)	(sizeof(a)/sizeof((a)[0]))	///< Items of a table
+
+/** Layout of the wire screen */
+static const DISP_layout_t DISP_wire_layout = {
+		DISP_SCREEN_WIRE, "Wire",
+		DISP_result_static, DISP_COUNT(DISP_result_static),
+		DISP_result_dynamic, DISP_COUNT(DISP_result_dynamic)
+};
+
+/** Layout of the cable screen */
+static const DISP_layout_t DISP_cable_layout = {
+		DISP_SCREEN_CABLE, "Cable",
+		DISP_result_static, DISP_COUNT(DISP_result_static),
+		DISP_result_dynamic, DISP_COUNT(DISP_result_dynamic)
+};
+
+/** Layout of the angle screen */
+static const DISP_layout_t DISP_angle_layout = {
+		DISP_SCREEN_ANGLE, "Angle",
+		DISP_angle_static, DISP_COUNT(DISP_angle_static),
+		DISP_angle_dynamic, DISP_COUNT(DISP_angle_dynamic)
+};
 
 /******************************************************************************
  * Functions
  *****************************************************************************/
 
 /** **************************************************************************
- * @brief Function for displaying the wire data
- * @note  	This function calls the required functions to display the data for a wire measurement
- * @n		Clears the ADC_samples array after displaying all the data
+ * @brief Initialize the background and the foreground layer
+ * @note  	Static parts of a screen (titles, labels, circles, menu bar)
+ * 			are drawn once on the background layer.
+ * @n		Values and traces are drawn on the foreground layer.
+ * 			White pixels of the foreground are made transparent by color keying
+ * 			so that the background shows through.
  *****************************************************************************/
-void DISP_show_data_wire(void)
+void DISP_layers_init(void)
 {
-	const uint32_t Y_OFFSET_PAD = 220;					//Offset for pad-graph
-	const uint32_t Y_OFFSET_COIL = 280;					//0ffset for coil-graph
-	const uint32_t X_SIZE = 240;
-	const uint32_t f = (6 << ADC_DAC_RES) /	Y_OFFSET_COIL + 1;   	// Scaling factor
-	uint32_t data;
-	uint32_t data_last;
+	BSP_LCD_LayerDefaultInit(LCD_BACKGROUND_LAYER, DISP_BG_BUFFER);
+	BSP_LCD_LayerDefaultInit(LCD_FOREGROUND_LAYER, DISP_FG_BUFFER);
+	BSP_LCD_SetColorKeying(LCD_FOREGROUND_LAYER, DISP_COLOR_KEY);
+	BSP_LCD_SelectLayer(LCD_BACKGROUND_LAYER);
+	BSP_LCD_Clear(LCD_COLOR_WHITE);
+	BSP_LCD_SelectLayer(LCD_FOREGROUND_LAYER);
+	BSP_LCD_Clear(LCD_COLOR_WHITE);
+	DISP_screen = DISP_SCREEN_NONE;
+}
 
 
-	// Call for calculations
-	dist_single = distance_to_cable(1);
-	dist_accu = distance_to_cable(0);
-	current_single=current(1);
-	current_accu=current(0);
+/** **************************************************************************
+ * @brief Select the background layer if a different screen is shown now
+ * @param	screen	the screen which is about to be drawn
+ * @return	true if the static parts of the screen have to be drawn
+ * @note  	The background layer stays selected if true is returned.
+ * 			Call DISP_dynamic_begin() afterwards.
+ *****************************************************************************/
+bool DISP_static_begin(DISP_screen_t screen)
+{
+	if (screen == DISP_screen) {
+		return false;					// Background is up to date
+	}
+	DISP_screen = screen;
+	BSP_LCD_SelectLayer(LCD_BACKGROUND_LAYER);
+	BSP_LCD_SetTextColor(LCD_COLOR_WHITE);
+	BSP_LCD_FillRect(0, 0, DISP_X_SIZE, DISP_CONTENT_HEIGHT);
+	return true;
+}
 
-	if((dist_accu < 0)||(dist_single < 0)){
-		/* Clear the display */
-		BSP_LCD_SetTextColor(LCD_COLOR_WHITE);
-		BSP_LCD_FillRect(0, 0, X_SIZE, Y_OFFSET_COIL + 1);
-		/* Write single and accurate measurement of wire */
-	    BSP_LCD_SetFont(&Font24);
-		BSP_LCD_SetBackColor(LCD_COLOR_WHITE);
-		BSP_LCD_SetTextColor(LCD_COLOR_BLACK);
-		char text[16];
-		BSP_LCD_DisplayStringAt(5,10, (uint8_t *)"Wire", LEFT_MODE);
-		BSP_LCD_SetFont(&Font20);
-		BSP_LCD_DisplayStringAt(5,50, (uint8_t *)"Single", LEFT_MODE);
-		BSP_LCD_SetFont(&Font16);
-		snprintf(text, 15, "Distance: %4d", (int)(dist_single));
-		BSP_LCD_DisplayStringAt(5, 70, (uint8_t *)text, LEFT_MODE);
-		BSP_LCD_SetFont(&Font20);
-		BSP_LCD_DisplayStringAt(5,110, (uint8_t *)"Accurate", LEFT_MODE);
-		BSP_LCD_SetFont(&Font16);
-		snprintf(text, 15, "Distance: %4d", (int)(dist_accu));
-		BSP_LCD_DisplayStringAt(5, 130, (uint8_t *)text, LEFT_MODE);
-		BSP_LCD_SetFont(&Font24);
-		BSP_LCD_SetTextColor(LCD_COLOR_RED);
-		BSP_LCD_DisplayStringAt(5,180, (uint8_t *)"OUT OF RANGE", CENTER_MODE);
 
-	}
-	else{
-	/* Clear the display */
+/** **************************************************************************
+ * @brief Select the foreground layer and clear its content area
+ * @note  	The menu bar is not touched.
+ * @n		The next DISP_render() draws all dynamic items.
+ *****************************************************************************/
+void DISP_dynamic_begin(void)
+{
+	DISP_layout = NULL;					// Nothing of a layout is drawn
+	BSP_LCD_SelectLayer(LCD_FOREGROUND_LAYER);
+	BSP_LCD_SetTextColor(LCD_COLOR_WHITE);	// Transparent on the foreground
+	BSP_LCD_FillRect(0, 0, DISP_X_SIZE, DISP_CONTENT_HEIGHT);
+}
+
+
+/** **************************************************************************
+ * @brief Get the screen on the background layer
+ * @return	the screen of the last DISP_static_begin()
+ *****************************************************************************/
+DISP_screen_t DISP_get_screen(void)
+{
+	return DISP_screen;
+}
+
+
+/** **************************************************************************
+ * @brief Clear the content area of both layers
+ * @note  	The foreground layer is selected afterwards.
+ *****************************************************************************/
+void DISP_clear(void)
+{
+	DISP_screen = DISP_SCREEN_NONE;
+	BSP_LCD_SelectLayer(LCD_BACKGROUND_LAYER);
 	BSP_LCD_SetTextColor(LCD_COLOR_WHITE);
-	BSP_LCD_FillRect(0, 0, X_SIZE, Y_OFFSET_COIL + 1);
-	/* Write single and accurate measurement of wire */
-    BSP_LCD_SetFont(&Font24);
-	BSP_LCD_SetBackColor(LCD_COLOR_WHITE);
-	BSP_LCD_SetTextColor(LCD_COLOR_BLACK);
-	char text[16];
-	BSP_LCD_DisplayStringAt(5,10, (uint8_t *)"Wire", LEFT_MODE);
-	BSP_LCD_SetFont(&Font20);
-	BSP_LCD_DisplayStringAt(5,50, (uint8_t *)"Single", LEFT_MODE);
-	BSP_LCD_SetFont(&Font16);
-	snprintf(text, 15, "Distance: %4d", (int)(dist_single));
-	BSP_LCD_DisplayStringAt(5, 70, (uint8_t *)text, LEFT_MODE);
-	snprintf(text, 15, "Current:  %4d", (int)(current_single));
-	BSP_LCD_DisplayStringAt(5, 85, (uint8_t *)text, LEFT_MODE);
-	BSP_LCD_SetFont(&Font20);
-	BSP_LCD_DisplayStringAt(5,110, (uint8_t *)"Accurate", LEFT_MODE);
-	BSP_LCD_SetFont(&Font16);
-	snprintf(text, 15, "Distance: %4d", (int)(dist_accu));
-	BSP_LCD_DisplayStringAt(5, 130, (uint8_t *)text, LEFT_MODE);
-	snprintf(text, 15, "Current:  %4d", (int)(current_accu));
-	BSP_LCD_DisplayStringAt(5, 145, (uint8_t *)text, LEFT_MODE);
-	BSP_LCD_SetFont(&Font12);
-	BSP_LCD_DisplayStringAt(5,165, (uint8_t *)"Pad:", LEFT_MODE);
-	BSP_LCD_DisplayStringAt(5,225, (uint8_t *)"Coil:", LEFT_MODE);
-
-	/* draw value of pad1 in a graph */
-	BSP_LCD_SetTextColor(LCD_COLOR_BLUE);
-	data = PAD1_samples[0] / f;
-	for (uint32_t i = 1; i < ADC_NUMS; i++){
-		data_last = data;
-		data = (PAD1_samples[(i)]) / f;
-			if (data > Y_OFFSET_PAD) { data = Y_OFFSET_PAD; }// Limit value, prevent crash
-			BSP_LCD_DrawLine(4*(i-1), Y_OFFSET_PAD-data_last, 4*i, Y_OFFSET_PAD-data);
-	}
-	/* draw value of pad2 in a graph*/
-		BSP_LCD_SetTextColor(LCD_COLOR_RED);
-		data = PAD2_samples[0] / f;
-		for (uint32_t i = 1; i < ADC_NUMS; i++){
-			data_last = data;
-			data = (PAD2_samples[i]) / f;
-			if (data > Y_OFFSET_PAD) { data = Y_OFFSET_PAD; }// Limit value, prevent crash
-			BSP_LCD_DrawLine(4*(i-1), Y_OFFSET_PAD-data_last, 4*i, Y_OFFSET_PAD-data);
-		}
+	BSP_LCD_FillRect(0, 0, DISP_X_SIZE, DISP_CONTENT_HEIGHT);
+	DISP_dynamic_begin();
+}
+
 
-	/* draw the value of coil1 in a graph */
-	BSP_LCD_SetTextColor(LCD_COLOR_DARKCYAN);
-	data = COIL1_samples[0] / f;
-	for (uint32_t i = 1; i < ADC_NUMS; i++){
-		data_last = data;
-		data = (COIL1_samples[i]) / f;
-		if (data > Y_OFFSET_COIL) { data = Y_OFFSET_COIL; }// Limit value, prevent crash
-		BSP_LCD_DrawLine(4*(i-1), Y_OFFSET_COIL-data_last, 4*i, Y_OFFSET_COIL-data);
+/** **************************************************************************
+ * @brief Glyphs of a text or a field
+ * @param	item	layout item
+ * @param	values	values of the fields, NULL for static items
+ * @param	text	formatted glyphs, empty for other items
+ *****************************************************************************/
+static void DISP_format(const DISP_item_t *item, const int32_t *values,
+		FMT_text_t *text)
+{
+	FMT_clear(text);
+	if (DISP_TEXT == item->kind) {
+		FMT_string(text, item->text);
+	} else if ((DISP_FIELD == item->kind) && (NULL != values)) {
+		FMT_string(text, item->text);
+		FMT_unit(text, values[item->value], item->width, item->unit);
 	}
-		/* 	draw the value of coil 2 in a graph */
+}
 
-		BSP_LCD_SetTextColor(LCD_COLOR_ORANGE);
-		data = COIL2_samples[0] / f;
-		for (uint32_t i = 1; i < ADC_NUMS; i++){
-			data_last = data;
-			data = (COIL2_samples[i]) / f;
-			if (data > Y_OFFSET_COIL) { data = Y_OFFSET_COIL; }// Limit value, prevent crash
-			BSP_LCD_DrawLine(4*(i-1), Y_OFFSET_COIL-data_last, 4*i, Y_OFFSET_COIL-data);
 
+/** **************************************************************************
+ * @brief Samples of a trace
+ * @param	count	DISP_TRACE_SAMPLES of the values
+ * @return	count limited to 2...ADC_NUMS
+ *****************************************************************************/
+static uint32_t DISP_trace_count(int32_t count)
+{
+	if (count < 2) { return 2; }
+	return (count > ADC_NUMS) ? ADC_NUMS : (uint32_t)count;
+}
+
+
+/** **************************************************************************
+ * @brief Bounding rectangle of a dynamic item
+ * @param	item	layout item
+ * @param	len		length of the text of texts and fields,
+ * 					samples of traces
+ * @param	rect	x, y, width and height
+ *****************************************************************************/
+static void DISP_item_rect(const DISP_item_t *item, uint32_t len,
+		uint16_t rect[4])
+{
+	uint32_t w = 0;
+	switch (item->kind) {
+	case DISP_TEXT:
+	case DISP_FIELD:
+		w = item->font->Width;
+		rect[0] = item->x;
+		if (CENTER_MODE == item->align) {	// Same as BSP_LCD_DisplayStringAt()
+			rect[0] = item->x + ((DISP_X_SIZE / w - len) * w) / 2;
 		}
+		rect[1] = item->y;
+		rect[2] = len * w;
+		rect[3] = item->font->Height;
+		break;
+	case DISP_TRACE:
+		w = DISP_TRACE_MAX;
+		if (w > item->y) { w = item->y; }
+		rect[0] = 0;
+		rect[1] = item->y - w;
+		rect[2] = DISP_TRACE_STEP * (len - 1) + 1;
+		rect[3] = w + 1;
+		break;
+	default:							// Circles
+		rect[0] = item->x - item->r;
+		rect[1] = item->y - item->r;
+		rect[2] = 2 * item->r + 1;
+		rect[3] = 2 * item->r + 1;
+		break;
 	}
-	MEAS_CLEAR_buffer_flags();
 }
 
 
 /** **************************************************************************
- * @brief Function for displaying the cable data
- * @note  	This function calls the required functions to display the data for a cable measurement
- * @n		Clears the ADC_samples array after displaying all the data
+ * @brief Check if two rectangles overlap
+ * @param	a	x, y, width and height
+ * @param	b	x, y, width and height
+ * @return	true if at least one pixel is in both
  *****************************************************************************/
+static bool DISP_overlap(const uint16_t a[4], const uint16_t b[4])
+{
+	return (a[0] < b[0] + b[2]) && (b[0] < a[0] + a[2])
+			&& (a[1] < b[1] + b[3]) && (b[1] < a[1] + a[3]);
+}
 
-void DISP_show_data_cable(void)
+
+/** **************************************************************************
+ * @brief Draw one layout item on the selected layer
+ * @param	item	layout item
+ * @param	text	glyphs of texts and fields, see DISP_format()
+ * @param	count	samples of a trace
+ * @note  	Font and colors are only set if they differ from the last item,
+ * 			the tables are sorted by font and color to batch the draws.
+ *****************************************************************************/
+static void DISP_draw_item(const DISP_item_t *item, const FMT_text_t *text,
+		uint32_t count)
 {
-	const uint32_t Y_OFFSET_PAD = 220;					//Offset for pad-graph
-	const uint32_t Y_OFFSET_COIL = 280;					//0ffset for coil-graph
-	const uint32_t X_SIZE = 240;
-	const uint32_t f = (6 << ADC_DAC_RES) /	Y_OFFSET_COIL + 1;   	// Scaling factor
+	static const uint32_t f = DISP_TRACE_SCALE;
 	uint32_t data;
 	uint32_t data_last;
+	if (item->color != BSP_LCD_GetTextColor()) {
+		BSP_LCD_SetTextColor(item->color);
+	}
+	switch (item->kind) {
+	case DISP_TEXT:
+	case DISP_FIELD:
+		if (item->font != BSP_LCD_GetFont()) {
+			BSP_LCD_SetFont(item->font);
+		}
+		FMT_draw(text, item->x, item->y, (Text_AlignModeTypdef)item->align);
+		break;
+	case DISP_TRACE:
+		data = item->samples[0] / f;
+		for (uint32_t i = 1; i < count; i++) {
+			data_last = data;
+			data = item->samples[i] / f;
+			if (data > item->y) { data = item->y; }	// Limit value, prevent crash
+			BSP_LCD_DrawLine(DISP_TRACE_STEP*(i-1), item->y-data_last,
+					DISP_TRACE_STEP*i, item->y-data);
+		}
+		break;
+	case DISP_RING:
+		BSP_LCD_DrawCircle(item->x, item->y, item->r);
+		break;
+	case DISP_DOT:
+		BSP_LCD_FillCircle(item->x, item->y, item->r);
+		break;
+	default:							// Should never occur
+		break;
+	}
+}
 
-	current_single = current(1);
-	current_accu = current(0);
-
-	//Call for calculations
-	dist_single = distance_to_cable(1);
-	dist_accu = distance_to_cable(0);
-	if((dist_accu < 0)||(dist_single < 0)){
-		/* Clear the display */
-		BSP_LCD_SetTextColor(LCD_COLOR_WHITE);
-		BSP_LCD_FillRect(0, 0, X_SIZE, Y_OFFSET_COIL + 1);
-		/* Write single and accurate measurement of wire */
-	    BSP_LCD_SetFont(&Font24);
-		BSP_LCD_SetBackColor(LCD_COLOR_WHITE);
-		BSP_LCD_SetTextColor(LCD_COLOR_BLACK);
-		char text[16];
-		BSP_LCD_DisplayStringAt(5,10, (uint8_t *)"Cable", LEFT_MODE);
-		BSP_LCD_SetFont(&Font20);
-		BSP_LCD_DisplayStringAt(5,50, (uint8_t *)"Single", LEFT_MODE);
-		BSP_LCD_SetFont(&Font16);
-		snprintf(text, 15, "Distance: %4d", (int)(dist_single));
-		BSP_LCD_DisplayStringAt(5, 70, (uint8_t *)text, LEFT_MODE);
-		BSP_LCD_SetFont(&Font20);
-		BSP_LCD_DisplayStringAt(5,110, (uint8_t *)"Accurate", LEFT_MODE);
-		BSP_LCD_SetFont(&Font16);
-		snprintf(text, 15, "Distance: %4d", (int)(dist_accu));
-		BSP_LCD_DisplayStringAt(5, 130, (uint8_t *)text, LEFT_MODE);
-		BSP_LCD_SetFont(&Font24);
-		BSP_LCD_SetTextColor(LCD_COLOR_RED);
-		BSP_LCD_DisplayStringAt(5,180, (uint8_t *)"OUT OF RANGE", CENTER_MODE);
 
-	}
-	else{
+/** **************************************************************************
+ * @brief Render a screen from its layout table
+ * @param	layout	layout of the screen
+ * @param	state	current state DISP_IN_RANGE...
+ * @param	values	values shown in the fields
+ * @note  	If the screen changes, the static items are drawn on the
+ * 			background layer and all visible dynamic items on the foreground.
+ * @n		Otherwise only dirty items are redrawn:
+ * 			fields with a new value, items which appear or disappear and
+ * 			traces (new samples every time).
+ * 			Items overlapping a redrawn or cleared area are redrawn as well.
+ *****************************************************************************/
+void DISP_render(const DISP_layout_t *layout, uint32_t state,
+		const int32_t values[DISP_VALUES])
+{
+	FMT_text_t text[DISP_ITEMS_MAX];
+	uint16_t rect[DISP_ITEMS_MAX][4];
+	bool dirty[DISP_ITEMS_MAX];
+	bool shown[DISP_ITEMS_MAX];
+	uint32_t count = layout->dynamic_count;
+	if (count > DISP_ITEMS_MAX) { count = DISP_ITEMS_MAX; }
 
-	/* Clear the display */
-	BSP_LCD_SetTextColor(LCD_COLOR_WHITE);
-	BSP_LCD_FillRect(0, 0, X_SIZE, Y_OFFSET_COIL + 1);
-	/* Write single and accurate measurement of wire */
-    BSP_LCD_SetFont(&Font24);
 	BSP_LCD_SetBackColor(LCD_COLOR_WHITE);
-	BSP_LCD_SetTextColor(LCD_COLOR_BLACK);
-	char text[16];
-	BSP_LCD_DisplayStringAt(5,10, (uint8_t *)"Cable", LEFT_MODE);
-	BSP_LCD_SetFont(&Font20);
-	BSP_LCD_DisplayStringAt(5,50, (uint8_t *)"Single", LEFT_MODE);
-	BSP_LCD_SetFont(&Font16);
-	snprintf(text, 15, "Distance: %4d", (int)(dist_single));
-	BSP_LCD_DisplayStringAt(5, 70, (uint8_t *)text, LEFT_MODE);
-	snprintf(text, 15, "Current:  %4d", (int)(current_single));
-	BSP_LCD_DisplayStringAt(5, 85, (uint8_t *)text, LEFT_MODE);
-	BSP_LCD_SetFont(&Font20);
-	BSP_LCD_DisplayStringAt(5,110, (uint8_t *)"Accurate", LEFT_MODE);
-	BSP_LCD_SetFont(&Font16);
-	snprintf(text, 15, "Distance: %4d", (int)(dist_accu));
-	BSP_LCD_DisplayStringAt(5, 130, (uint8_t *)text, LEFT_MODE);
-	snprintf(text, 15, "Current:  %4d", (int)(current_accu));
-	BSP_LCD_DisplayStringAt(5, 145, (uint8_t *)text, LEFT_MODE);
-	BSP_LCD_SetFont(&Font12);
-	BSP_LCD_DisplayStringAt(5,165, (uint8_t *)"Pad:", LEFT_MODE);
-	BSP_LCD_DisplayStringAt(5,225, (uint8_t *)"Coil:", LEFT_MODE);
-
-	/* draw value of pad1 in a graph */
-	BSP_LCD_SetTextColor(LCD_COLOR_BLUE);
-	data = PAD1_samples[0] / f;
-	for (uint32_t i = 1; i < ADC_NUMS; i++){
-		data_last = data;
-		data = (PAD1_samples[(i)]) / f;
-			if (data > Y_OFFSET_PAD) { data = Y_OFFSET_PAD; }// Limit value, prevent crash
-			BSP_LCD_DrawLine(4*(i-1), Y_OFFSET_PAD-data_last, 4*i, Y_OFFSET_PAD-data);
-	}
-	/* draw value of pad2 in a graph*/
-		BSP_LCD_SetTextColor(LCD_COLOR_RED);
-		data = PAD2_samples[0] / f;
-		for (uint32_t i = 1; i < ADC_NUMS; i++){
-			data_last = data;
-			data = (PAD2_samples[i]) / f;
-			if (data > Y_OFFSET_PAD) { data = Y_OFFSET_PAD; }// Limit value, prevent crash
-			BSP_LCD_DrawLine(4*(i-1), Y_OFFSET_PAD-data_last, 4*i, Y_OFFSET_PAD-data);
+	if (DISP_static_begin(layout->screen) || (layout != DISP_layout)) {
+		BSP_LCD_SelectLayer(LCD_BACKGROUND_LAYER);
+		BSP_LCD_SetFont(&Font24);
+		BSP_LCD_SetTextColor(LCD_COLOR_BLACK);
+		BSP_LCD_DisplayStringAt(5, 10, (uint8_t *)layout->title, LEFT_MODE);
+		for (uint32_t i = 0; i < layout->static_count; i++) {
+			FMT_text_t label;
+			DISP_format(&layout->statics[i], NULL, &label);
+			DISP_draw_item(&layout->statics[i], &label, 0);
+		}
+		DISP_dynamic_begin();			// Clears the foreground
+		DISP_layout = layout;
+		for (uint32_t i = 0; i < DISP_ITEMS_MAX; i++) {
+			DISP_cache[i].shown = false;
 		}
+	} else {
+		BSP_LCD_SelectLayer(LCD_FOREGROUND_LAYER);
+	}
 
-	/* draw the value of coil1 in a graph */
-	BSP_LCD_SetTextColor(LCD_COLOR_DARKCYAN);
-	data = COIL1_samples[0] / f;
-	for (uint32_t i = 1; i < ADC_NUMS; i++){
-		data_last = data;
-		data = (COIL1_samples[i]) / f;
-		if (data > Y_OFFSET_COIL) { data = Y_OFFSET_COIL; }// Limit value, prevent crash
-		BSP_LCD_DrawLine(4*(i-1), Y_OFFSET_COIL-data_last, 4*i, Y_OFFSET_COIL-data);
+	/* Decide what is dirty, clear items which disappear, shrink or move */
+	for (uint32_t i = 0; i < count; i++) {
+		const DISP_item_t *item = &layout->dynamics[i];
+		DISP_cache_t *cache = &DISP_cache[i];
+		uint32_t len = 0;
+		shown[i] = (0 == item->show) || (0 != (item->show & state));
+		dirty[i] = (shown[i] != cache->shown);
+		DISP_format(item, values, &text[i]);
+		if (DISP_FIELD == item->kind) {
+			dirty[i] |= shown[i] && (values[item->value] != cache->value);
+			cache->value = values[item->value];
+		}
+		len = text[i].len;
+		if (DISP_TRACE == item->kind) {
+			dirty[i] |= shown[i];		// New samples every time
+			len = DISP_trace_count(values[item->value]);
+		}
+		DISP_item_rect(item, len, rect[i]);
+		if (dirty[i] && cache->shown) {
+			uint16_t old[4];
+			DISP_item_rect(item, cache->len, old);
+			if (!shown[i] || (DISP_TRACE == item->kind) || (len < cache->len)) {
+				BSP_LCD_SetTextColor(LCD_COLOR_WHITE);	// Transparent
+				BSP_LCD_FillRect(old[0], old[1], old[2], old[3]);
+			}
+			if (len < cache->len) {
+				memcpy(rect[i], old, sizeof(old));	// Larger one counts
+			}
+		}
+		cache->shown = shown[i];
+		cache->len = len;
 	}
-		/* 	draw the value of coil 2 in a graph */
 
-		BSP_LCD_SetTextColor(LCD_COLOR_ORANGE);
-		data = COIL2_samples[0] / f;
-		for (uint32_t i = 1; i < ADC_NUMS; i++){
-			data_last = data;
-			data = (COIL2_samples[i]) / f;
-			if (data > Y_OFFSET_COIL) { data = Y_OFFSET_COIL; }// Limit value, prevent crash
-			BSP_LCD_DrawLine(4*(i-1), Y_OFFSET_COIL-data_last, 4*i, Y_OFFSET_COIL-data);
+	/* Items overlapping a dirty one have to be redrawn too */
+	for (bool again = true; again; ) {
+		again = false;
+		for (uint32_t i = 0; i < count; i++) {
+			for (uint32_t k = 0; (k < count) && dirty[i]; k++) {
+				if (!dirty[k] && shown[k] && DISP_overlap(rect[i], rect[k])) {
+					dirty[k] = true;
+					again = true;
+				}
+			}
+		}
+	}
 
+	/* Draw in table order */
+	for (uint32_t i = 0; i < count; i++) {
+		if (dirty[i] && shown[i]) {
+			DISP_draw_item(&layout->dynamics[i], &text[i], DISP_cache[i].len);
 		}
 	}
-	MEAS_CLEAR_buffer_flags();
 }
 
 
 /** **************************************************************************
- * @brief Function for displaying the angle data
- * @note  	This function calls the required functions to display the data for an angle measurement.
- * @n		Shows 2 dots on the screen for visualization of the direction
- * @n		Shows an error on display if the data is unclear
- * @n		Clears the ADC_samples array after displaying all the data
+ * @brief Calculate distance and current for a result screen
+ * @param	result	values and state for DISP_show()
+ * @param	layout	DISP_wire_layout or DISP_cable_layout
+ * @note  	Clears the ADC_samples array after the calculation
  *****************************************************************************/
+static void DISP_calc_result(DISP_result_t *result, const DISP_layout_t *layout)
+{
+	memset(result, 0, sizeof(*result));
+	result->layout = layout;
+	PROBE_SCOPE(PROBE_DISTANCE) {
+		result->values[DISP_DIST_SINGLE] = distance_to_cable(1);
+	}
+	PROBE_SCOPE(PROBE_DISTANCE) {
+		result->values[DISP_DIST_ACCU] = distance_to_cable(0);
+	}
+	result->values[DISP_CURRENT_SINGLE] = current(1);
+	result->values[DISP_CURRENT_ACCU] = current(0);
+	result->values[DISP_CURRENT_HALF] = CALC_current_half;
+	result->values[DISP_TRACE_SAMPLES] = (int32_t)MEAS_sorted_count;
+	result->state = ((result->values[DISP_DIST_ACCU] < 0)
+			|| (result->values[DISP_DIST_SINGLE] < 0)) ?
+					DISP_OUT_RANGE : DISP_IN_RANGE;
+	if ((DISP_IN_RANGE == result->state) && (CALC_current_half >= 0)) {
+		result->state |= DISP_CURRENT_KNOWN;
+	}
+	MEAS_CLEAR_buffer_flags();
+}
 
-void DISP_show_data_angle(void)
+
+/** **************************************************************************
+ * @brief Calculate the values of the wire screen
+ * @param	result	values and state for DISP_show()
+ *****************************************************************************/
+void DISP_calc_wire(DISP_result_t *result)
 {
-	const uint32_t X_SIZE = 240;
-	const uint32_t Y_OFFSET_PAD = 280;
-	char text[16];
+	DISP_calc_result(result, &DISP_wire_layout);
+}
 
-	int32_t angle = 666;
-	angle = angle_to_cable();
 
-	/* Clear the display */
-	BSP_LCD_SetTextColor(LCD_COLOR_WHITE);
-	BSP_LCD_FillRect(0, 0, X_SIZE, Y_OFFSET_PAD + 1);
-	/* Write the measurement of the angle */
-	BSP_LCD_SetFont(&Font24);
-	BSP_LCD_SetBackColor(LCD_COLOR_WHITE);
-	BSP_LCD_SetTextColor(LCD_COLOR_BLACK);
-	BSP_LCD_DisplayStringAt(5,10, (uint8_t *)"Angle", LEFT_MODE);
-	BSP_LCD_SetFont(&Font20);
-	BSP_LCD_DisplayStringAt(5,50, (uint8_t *)"Value in Degree", LEFT_MODE);
+/** **************************************************************************
+ * @brief Calculate the values of the cable screen
+ * @param	result	values and state for DISP_show()
+ *****************************************************************************/
+void DISP_calc_cable(DISP_result_t *result)
+{
+	DISP_calc_result(result, &DISP_cable_layout);
+}
 
-	//Two points for a rough indication of direction
-	BSP_LCD_DrawCircle(45,220,20);
-	BSP_LCD_DrawCircle(195,220,20);
 
-	//Color middle part for direction / error
-	if(CALC_degree_left){
+/** **************************************************************************
+ * @brief Calculate the values of the angle screen
+ * @param	result	values and state for DISP_show()
+ * @note  	The state selects the dot for the direction
+ * or an error if the data is unclear
+ *****************************************************************************/
+void DISP_calc_angle(DISP_result_t *result)
+{
+	memset(result, 0, sizeof(*result));
+	result->layout = &DISP_angle_layout;
+	result->values[DISP_ANGLE] = angle_to_cable();
+	result->state = DISP_NO_VALUE;
+	if (CALC_degree_left) {
 		CALC_degree_left = false;
-		snprintf(text, 15, "Angle:  %4d", (int)(angle));
-		BSP_LCD_DisplayStringAt(5, 90, (uint8_t *)text, LEFT_MODE);
-		BSP_LCD_SetTextColor(LCD_COLOR_GREEN);
-		BSP_LCD_FillCircle(45,220,10);
-	}
-	else if(CALC_degree_right){
+		result->state = DISP_LEFT;
+	} else if (CALC_degree_right) {
 		CALC_degree_right = false;
-		snprintf(text, 15, "Angle: %4d", (int)(angle));
-		BSP_LCD_DisplayStringAt(5, 90, (uint8_t *)text, LEFT_MODE);
-		BSP_LCD_SetTextColor(LCD_COLOR_GREEN);
-		BSP_LCD_FillCircle(195,220,10);
+		result->state = DISP_RIGHT;
 	}
-	else{
-		BSP_LCD_SetTextColor(LCD_COLOR_RED);
-		BSP_LCD_DisplayStringAt(5,90, (uint8_t *)"NO VALUE", CENTER_MODE);
-		BSP_LCD_FillCircle(120,150,10);
-		BSP_LCD_FillCircle(45,220,10);
-		BSP_LCD_FillCircle(195,220,10);
+	MEAS_CLEAR_buffer_flags();
+}
+
+
+/** **************************************************************************
+ * @brief Values of a sequential measurement for the wire or cable screen
+ * @param	result	values and state for DISP_show()
+ * @param	seq		estimate from SEQ_get()
+ * @note	Single shows the first period, accurate the final estimate
+ * with its half width, hidden (DISP_CONVERGED not set) if the precision
+ * was not reached.
+ *****************************************************************************/
+void DISP_calc_sequential(DISP_result_t *result, const SEQ_result_t *seq)
+{
+	memset(result, 0, sizeof(*result));
+	result->layout = (CALC_CABLE == seq->kind) ?
+			&DISP_cable_layout : &DISP_wire_layout;
+	result->values[DISP_DIST_SINGLE] = seq->first_distance;
+	result->values[DISP_DIST_ACCU] = seq->distance;
+	result->values[DISP_CURRENT_SINGLE] = seq->first_current;
+	result->values[DISP_CURRENT_ACCU] = seq->current;
+	result->values[DISP_CONFIDENCE] = seq->converged ? seq->distance_half : -1;
+	result->values[DISP_SAMPLES] = (int32_t)seq->samples;
+	result->values[DISP_CURRENT_HALF] = seq->current_half;
+	result->values[DISP_TRACE_SAMPLES] = (int32_t)MEAS_sorted_count;	// Last half
+	result->state = ((seq->distance < 0) || (seq->first_distance < 0)) ?
+			DISP_OUT_RANGE : DISP_IN_RANGE;
+	if ((DISP_IN_RANGE == result->state) && (seq->current_half >= 0)) {
+		result->state |= DISP_CURRENT_KNOWN;
 	}
+	result->state |= DISP_ADAPTIVE;
+	if (seq->converged) {
+		result->state |= DISP_CONVERGED;
+	}
+}
 
-	MEAS_CLEAR_buffer_flags();
+
+/** **************************************************************************
+ * @brief Render calculated values with the latest latencies
+ * @param	result	from DISP_calc_wire(), DISP_calc_cable() or DISP_calc_angle()
+ * @note	The data latency ends when a screen is drawn,
+ * so the value shown is the one of the previous screen.
+ *****************************************************************************/
+void DISP_show(const DISP_result_t *result)
+{
+	int32_t values[DISP_VALUES];
+	memcpy(values, result->values, sizeof(values));
+	values[DISP_LATENCY_TOUCH] = (int32_t)EVT_touch_latency.last;
+	values[DISP_LATENCY_DATA] = (int32_t)EVT_display_latency.last;
+	DISP_render(result->layout, result->state, values);
+}
+
+
+/** **************************************************************************
+ * @brief Function for displaying the wire data
+ * @note  	Clears the ADC_samples array after displaying all the data
+ *****************************************************************************/
+void DISP_show_data_wire(void)
+{
+	DISP_result_t result;
+	DISP_calc_wire(&result);
+	DISP_show(&result);
+}
+
+
+/** **************************************************************************
+ * @brief Function for displaying the cable data
+ * @note  	Clears the ADC_samples array after displaying all the data
+ *****************************************************************************/
+void DISP_show_data_cable(void)
+{
+	DISP_result_t result;
+	DISP_calc_cable(&result);
+	DISP_show(&result);
+}
+
+
+/** **************************************************************************
+ * @brief Function for displaying the angle data
+ * @note  	Shows 2 dots on the screen for visualization of the direction
+ * @n		Shows an error on display if the data is unclear
+ * @n		Clears the ADC_samples array after displaying all the data
+ *****************************************************************************/
+void DISP_show_data_angle(void)
+{
+	DISP_result_t result;
+	DISP_calc_angle(&result);
+	DISP_show(&result);
 }
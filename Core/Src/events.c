@@ -0,0 +1,154 @@
+/** ***************************************************************************
+ * @file
+ * @brief Events from the interrupt handlers to the main loop
+ *
+ * ==============================================================
+ *
+ * Interrupt handlers post events with EVT_post().
+ * The main loop takes all pending events with EVT_wait()
+ * and sleeps in __WFI() while there are none.
+ * @n SysTick posts EVT_TICK every EVT_TICK_PERIOD ms for the work which
+ * has no interrupt of its own, i.e. the periodic tasks of the scheduler.
+ *
+ * The DWT cycle counter gives timestamps with a resolution of one CPU clock.
+ * EVT_latency_record() collects the time from an event to its handling.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include "stm32f4xx.h"
+
+#include "events.h"
+#include "placement.h"
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+EVT_latency_t EVT_touch_latency;		///< Touch to measurement start
+EVT_latency_t EVT_display_latency;		///< Acquisition to display
+
+static volatile uint32_t EVT_pending = 0;	///< Posted and not yet taken
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Start the DWT cycle counter for the timestamps
+ *****************************************************************************/
+void EVT_init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;	// Enable trace and DWT
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;	// Enable the cycle counter
+}
+
+
+/** ***************************************************************************
+ * @brief Post events, may be called from any interrupt handler
+ * @param events EVT_* bits
+ *
+ * Handlers of different priority may preempt each other,
+ * so the bits are set with an exclusive read-modify-write.
+ *****************************************************************************/
+PLACE_RAMFUNC void EVT_post(uint32_t events)
+{
+	__atomic_fetch_or(&EVT_pending, events, __ATOMIC_RELAXED);
+}
+
+
+/** ***************************************************************************
+ * @brief Take all pending events without waiting
+ * @return EVT_* bits posted since the last call, 0 if none
+ *****************************************************************************/
+uint32_t EVT_poll(void)
+{
+	return __atomic_exchange_n(&EVT_pending, 0, __ATOMIC_RELAXED);
+}
+
+
+/** ***************************************************************************
+ * @brief Sleep until at least one event is pending, then take all of them
+ * @return EVT_* bits posted since the last call
+ *
+ * Interrupts are masked between the check and __WFI(),
+ * so an event posted in between cannot be missed.
+ * A pending interrupt wakes up the core even while it is masked,
+ * its handler runs as soon as they are unmasked again.
+ *****************************************************************************/
+uint32_t EVT_wait(void)
+{
+	uint32_t events;
+	__disable_irq();
+	while (0U == EVT_pending) {
+		__WFI();
+		__enable_irq();					// Let the handler run
+		__disable_irq();
+	}
+	events = EVT_pending;
+	EVT_pending = 0;
+	__enable_irq();
+	return events;
+}
+
+
+/** ***************************************************************************
+ * @brief Post EVT_TICK every EVT_TICK_PERIOD ms, called by SysTick_Handler()
+ *****************************************************************************/
+void EVT_tick(void)
+{
+	static uint32_t ms = 0;
+	if (EVT_TICK_PERIOD <= ++ms) {
+		ms = 0;
+		EVT_post(EVT_TICK);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Current time
+ * @return CPU clock cycles, wraps around after 2^32 cycles (25 s at 168 MHz)
+ *****************************************************************************/
+PLACE_RAMFUNC uint32_t EVT_timestamp(void)
+{
+	return DWT->CYCCNT;
+}
+
+
+/** ***************************************************************************
+ * @brief Add the time since a timestamp to a latency statistic
+ * @param latency statistic to update
+ * @param start EVT_timestamp() of the event
+ *****************************************************************************/
+void EVT_latency_record(EVT_latency_t *latency, uint32_t start)
+{
+	EVT_latency_add(latency, EVT_timestamp() - start);
+}
+
+
+/** ***************************************************************************
+ * @brief Add a latency measured elsewhere to a latency statistic
+ * @param latency statistic to update
+ * @param cycles latency in CPU clock cycles
+ *****************************************************************************/
+void EVT_latency_add(EVT_latency_t *latency, uint32_t cycles)
+{
+	uint32_t us = cycles / (SystemCoreClock / 1000000U);
+	latency->last = us;
+	if ((0U == latency->count) || (us < latency->min)) {
+		latency->min = us;
+	}
+	if (us > latency->max) {
+		latency->max = us;
+	}
+	latency->sum += us;
+	latency->count++;
+}
@@ -4,7 +4,11 @@
  *
  * ==============================================================
  *
- *
+ * Magnitude spectrum of one block of samples for the waterfall view.
+ * @n The blocks are short (ADC_STREAM_NUMS = 30 samples at 600 Hz),
+ * so a direct DFT of the lower bins with a Q15 twiddle table is used.
+ * The bin spacing is ADC_FS / n = 20 Hz, mains 50/60 Hz and its
+ * harmonics fall into bins 2..3, 5, 7, ...
  *
  * ----------------------------------------------------------------------------
  * @author Stefan Kneubühl, kneubste@students.zhaw.ch
@@ -14,24 +18,88 @@
 /******************************************************************************
  * Includes
  *****************************************************************************/
+#include <math.h>
+#include "stm32f4xx.h"
 
-
+#include "fft.h"
+#include "calculations.h"
+#include "placement.h"
 
 
 /******************************************************************************
  * Defines
  *****************************************************************************/
+#define FFT_PI			3.14159265f	///< Pi for the twiddle table
+#define FFT_FRACTION	8			///< Fraction bits of the scaled bins
+/** Q15 twiddles and the amplitude of n/2: the bin divided by 2^15 * n / 2,
+ * with FFT_FRACTION bits left over */
+#define FFT_SCALE_SHIFT	(15 - 1 - FFT_FRACTION)
 
 
 /******************************************************************************
  * Variables
  *****************************************************************************/
+static int16_t FFT_cos[FFT_MAX_N] PLACE_CCM;	///< cos(2*pi*k/n) in Q15
+static int16_t FFT_sin[FFT_MAX_N] PLACE_CCM;	///< sin(2*pi*k/n) in Q15
+static uint32_t FFT_n = 0;				///< Block length of the table
+static uint32_t FFT_scale = 0;			///< 2^32 / (2^FFT_SCALE_SHIFT * n)
 
 
 /******************************************************************************
  * Functions
  *****************************************************************************/
 
+/** ***************************************************************************
+ * @brief Calculate the twiddle table for a block length
+ * @param n block length, at most FFT_MAX_N
+ *****************************************************************************/
+void FFT_init(uint32_t n)
+{
+	if (n > FFT_MAX_N) { n = FFT_MAX_N; }
+	for (uint32_t k = 0; k < n; k++) {
+		FFT_cos[k] = (int16_t)(32767.0f * cosf(2.0f * FFT_PI * k / n));
+		FFT_sin[k] = (int16_t)(32767.0f * sinf(2.0f * FFT_PI * k / n));
+	}
+	FFT_n = n;
+	FFT_scale = (uint32_t)((1ULL << 32) / ((uint64_t)n << FFT_SCALE_SHIFT));
+}
+
+
+/** ***************************************************************************
+ * @brief Magnitude spectrum of one block of samples
+ * @param x[] samples, the mean is removed before the transformation
+ * @param mag[] output, magnitude of bins 0 .. bins-1 in ADC counts
+ * @param bins number of bins, at most n/2
+ * @note FFT_init() has to be called with the block length first.
+ * @n Integer only: the bins are scaled by a multiplication with the
+ * reciprocal from FFT_init() and the magnitude is an integer square root.
+ *****************************************************************************/
+void FFT_spectrum(const int32_t x[], uint32_t mag[], uint32_t bins)
+{
+	const uint32_t n = FFT_n;
+	int32_t avg = 0;
+	for (uint32_t i = 0; i < n; i++) {
+		avg += x[i];
+	}
+	avg /= (int32_t)n;
+	for (uint32_t b = 0; b < bins; b++) {
+		int64_t re = 0;
+		int64_t im = 0;
+		uint32_t k = 0;					// Index b*i mod n
+		for (uint32_t i = 0; i < n; i++) {
+			int32_t v = x[i] - avg;
+			re += (int64_t)v * FFT_cos[k];
+			im -= (int64_t)v * FFT_sin[k];
+			k += b;
+			if (k >= n) { k -= n; }
+		}
+		/* Scale back from Q15 and normalize to the amplitude */
+		int64_t fre = (re * FFT_scale) >> 32;
+		int64_t fim = (im * FFT_scale) >> 32;
+		mag[b] = CALC_sqrt64((uint64_t)(fre*fre + fim*fim)) >> FFT_FRACTION;
+	}
+}
+
 
 
 
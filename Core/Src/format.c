@@ -0,0 +1,259 @@
+/** ***************************************************************************
+ * @file
+ * @brief Numeric formatting for the display without printf
+ *
+ * ==============================================================
+ *
+ * The screens show a few integers at fixed positions, several times a
+ * second. snprintf() parses its format string at every call and pulls the
+ * whole formatter of the C library into the image.
+ * @n A text is built here piece by piece instead: labels, integers right
+ * aligned to a width like "%4d", fixed point values like "%4.2f" of an
+ * integer and values with a unit. Nothing is allocated, a FMT_text_t
+ * lives on the stack of the caller.
+ *
+ * The text holds glyph indexes (character - ' '), the offsets into the
+ * font tables. BSP_LCD_DisplayGlyphs() draws them without looking at the
+ * characters again. FMT_chars() gives a C string for other outputs.
+ * @n A text is cut at FMT_LEN glyphs like snprintf() cuts at its size.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include "format.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define FMT_DIGITS			10			///< Max. decimal digits of a uint32_t
+#define FMT_DECIMALS		4			///< Max. decimals of FMT_fixed()
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+/** Scale of the decimals of FMT_fixed() */
+static const uint32_t FMT_scale[FMT_DECIMALS + 1] = { 1, 10, 100, 1000, 10000 };
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static void FMT_put(FMT_text_t *text, uint8_t glyph);
+static uint32_t FMT_digits(uint32_t value, uint32_t min, uint8_t digit[FMT_DIGITS]);
+static void FMT_number(FMT_text_t *text, bool minus, uint32_t whole,
+		uint32_t decimals, uint32_t fraction, uint32_t width);
+
+
+/** ***************************************************************************
+ * @brief Start an empty text
+ * @param text text to build
+ *****************************************************************************/
+void FMT_clear(FMT_text_t *text)
+{
+	text->len = 0;
+}
+
+
+/** ***************************************************************************
+ * @brief Append a label
+ * @param text text to build
+ * @param s printable ASCII characters, NULL for none
+ *****************************************************************************/
+void FMT_string(FMT_text_t *text, const char *s)
+{
+	if (NULL == s) {
+		return;
+	}
+	while ('\0' != *s) {
+		FMT_put(text, FMT_GLYPH(*s++));
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Append spaces up to a column, like "%-6s" after a label
+ * @param text text to build
+ * @param column glyphs the text has afterwards, at least
+ *****************************************************************************/
+void FMT_column(FMT_text_t *text, uint32_t column)
+{
+	while (text->len < column) {
+		FMT_put(text, FMT_GLYPH(' '));
+		if (FMT_LEN == text->len) {
+			break;
+		}
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Append an unsigned integer, like "%*u"
+ * @param text text to build
+ * @param value value
+ * @param width right aligned to this many glyphs, more if it is longer
+ *****************************************************************************/
+void FMT_uint(FMT_text_t *text, uint32_t value, uint32_t width)
+{
+	FMT_number(text, false, value, 0, 0, width);
+}
+
+
+/** ***************************************************************************
+ * @brief Append a signed integer, like "%*d"
+ * @param text text to build
+ * @param value value
+ * @param width right aligned to this many glyphs, more if it is longer
+ *****************************************************************************/
+void FMT_int(FMT_text_t *text, int32_t value, uint32_t width)
+{
+	uint32_t magnitude = (value < 0) ? 0U - (uint32_t)value : (uint32_t)value;
+	FMT_number(text, value < 0, magnitude, 0, 0, width);
+}
+
+
+/** ***************************************************************************
+ * @brief Append a fixed point value, like "%*.*f"
+ * @param text text to build
+ * @param value value times 10^decimals, e.g. 1087 mA with 3 for "1.087" A
+ * @param decimals digits after the point, at most FMT_DECIMALS
+ * @param width right aligned to this many glyphs, point included
+ *
+ * The decimals are cut, not rounded: round the value first if needed.
+ *****************************************************************************/
+void FMT_fixed(FMT_text_t *text, int32_t value, uint32_t decimals,
+		uint32_t width)
+{
+	if (decimals > FMT_DECIMALS) {
+		decimals = FMT_DECIMALS;
+	}
+	uint32_t magnitude = (value < 0) ? 0U - (uint32_t)value : (uint32_t)value;
+	FMT_number(text, value < 0, magnitude / FMT_scale[decimals], decimals,
+			magnitude % FMT_scale[decimals], width);
+}
+
+
+/** ***************************************************************************
+ * @brief Append an integer with its unit, like "%*d mm"
+ * @param text text to build
+ * @param value value
+ * @param width of the number, see FMT_int()
+ * @param unit appended as it is, e.g. " mm", NULL for none
+ *****************************************************************************/
+void FMT_unit(FMT_text_t *text, int32_t value, uint32_t width,
+		const char *unit)
+{
+	FMT_int(text, value, width);
+	FMT_string(text, unit);
+}
+
+
+/** ***************************************************************************
+ * @brief Draw a text with the font and the colors set on the LCD
+ * @param text glyphs of the font set
+ * @param x left edge
+ * @param y top edge
+ * @param align like BSP_LCD_DisplayStringAt()
+ *****************************************************************************/
+void FMT_draw(const FMT_text_t *text, uint16_t x, uint16_t y,
+		Text_AlignModeTypdef align)
+{
+	BSP_LCD_DisplayGlyphs(x, y, text->glyph, text->len, align);
+}
+
+
+/** ***************************************************************************
+ * @brief Copy a text as C string, e.g. for a serial output
+ * @param text text
+ * @param s characters and '\0'
+ * @param size of s, the text is cut to size - 1 characters
+ * @return characters in s
+ *****************************************************************************/
+uint32_t FMT_chars(const FMT_text_t *text, char *s, uint32_t size)
+{
+	uint32_t n = 0;
+	if (0 == size) {
+		return 0;
+	}
+	while ((n < text->len) && (n < size - 1)) {
+		s[n] = (char)(text->glyph[n] + ' ');
+		n++;
+	}
+	s[n] = '\0';
+	return n;
+}
+
+
+/** ***************************************************************************
+ * @brief Append a glyph if there is room
+ * @param text text to build
+ * @param glyph glyph index
+ *****************************************************************************/
+static void FMT_put(FMT_text_t *text, uint8_t glyph)
+{
+	if (text->len < FMT_LEN) {
+		text->glyph[text->len++] = glyph;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Decimal digits of a value, least significant first
+ * @param value value
+ * @param min digits at least, with leading zeros
+ * @param digit glyphs of the digits
+ * @return number of digits
+ *
+ * The division by the constant 10 is a multiplication for the compiler.
+ *****************************************************************************/
+static uint32_t FMT_digits(uint32_t value, uint32_t min, uint8_t digit[FMT_DIGITS])
+{
+	uint32_t n = 0;
+	do {
+		digit[n++] = FMT_GLYPH('0' + value % 10U);
+		value /= 10U;
+	} while ((0U != value) || (n < min));
+	return n;
+}
+
+
+/** ***************************************************************************
+ * @brief Append a number right aligned
+ * @param text text to build
+ * @param minus a sign is put in front
+ * @param whole digits before the point
+ * @param decimals digits after the point, 0 = no point
+ * @param fraction value of these digits
+ * @param width glyphs of the number at least, padded with spaces
+ *****************************************************************************/
+static void FMT_number(FMT_text_t *text, bool minus, uint32_t whole,
+		uint32_t decimals, uint32_t fraction, uint32_t width)
+{
+	uint8_t integer[FMT_DIGITS];
+	uint8_t decimal[FMT_DIGITS];
+	uint32_t ni = FMT_digits(whole, 1, integer);
+	uint32_t nd = (decimals > 0) ? FMT_digits(fraction, decimals, decimal) : 0;
+	uint32_t len = (minus ? 1 : 0) + ni + ((decimals > 0) ? 1 + nd : 0);
+	for (; len < width; len++) {
+		FMT_put(text, FMT_GLYPH(' '));
+	}
+	if (minus) {
+		FMT_put(text, FMT_GLYPH('-'));
+	}
+	while (ni > 0) {
+		FMT_put(text, integer[--ni]);
+	}
+	if (decimals > 0) {
+		FMT_put(text, FMT_GLYPH('.'));
+		while (nd > 0) {
+			FMT_put(text, decimal[--nd]);
+		}
+	}
+}
@@ -0,0 +1,140 @@
+/** ***************************************************************************
+ * @file
+ * @brief Lock-free ring of acquired frames from the interrupt handlers to main
+ *
+ * ==============================================================
+ *
+ * The acquisition interrupt handler is the only producer,
+ * the main loop is the only consumer.
+ * Each side writes only its own index, so no locking is needed.
+ * @n FRAME_put() copies the samples into a slot of the ring,
+ * the DMA can then refill its buffer without tearing the frame.
+ * The slot belongs to the consumer from FRAME_peek() until FRAME_release().
+ *
+ * If the ring is full the new frame is dropped, never a queued one.
+ * The drop is counted in FRAME_overruns and in the overruns field
+ * of the next frame, and its sequence number is skipped.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include "stm32f4xx.h"
+
+#include "frames.h"
+#include "measuring.h"
+#include "events.h"
+#include "placement.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define FRAME_MASK			(FRAME_SLOTS-1)	///< Index wrap around
+#define FRAME_SAMPLES		(ADC_NUMS*INPUTS_NUMS)	///< Max. samples of a frame
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+volatile uint32_t FRAME_overruns = 0;	///< Frames dropped since reset
+
+static FRAME_t FRAME_ring[FRAME_SLOTS] PLACE_CCM;	///< Descriptors
+static uint32_t FRAME_data[FRAME_SLOTS][FRAME_SAMPLES] PLACE_CCM;	///< Samples per slot
+static volatile uint32_t FRAME_head = 0;	///< Frames put, written by ISR
+static volatile uint32_t FRAME_tail = 0;	///< Frames released, written by main
+static uint32_t FRAME_seq = 0;			///< Next sequence number
+static uint32_t FRAME_dropped = 0;		///< Drops not yet reported in a frame
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Discard all frames and restart the sequence numbers
+ *
+ * Call only while no acquisition is running.
+ *****************************************************************************/
+void FRAME_reset(void)
+{
+	FRAME_head = 0;
+	FRAME_tail = 0;
+	FRAME_seq = 0;
+	FRAME_dropped = 0;
+	FRAME_overruns = 0;
+}
+
+
+/** ***************************************************************************
+ * @brief Copy a frame into the ring, called by the acquisition ISR
+ * @param samples interleaved samples of all INPUTS_NUMS inputs
+ * @param count samples per input, max. ADC_NUMS
+ * @return false if the ring was full and the frame has been dropped
+ *****************************************************************************/
+PLACE_RAMFUNC bool FRAME_put(const uint32_t *samples, uint32_t count)
+{
+	uint32_t head = FRAME_head;
+	uint32_t seq = FRAME_seq++;
+	if (FRAME_SLOTS <= head - FRAME_tail) {	// Consumer is behind
+		FRAME_dropped++;
+		FRAME_overruns++;
+		return false;
+	}
+	FRAME_t *frame = &FRAME_ring[head & FRAME_MASK];
+	uint32_t *data = FRAME_data[head & FRAME_MASK];
+	for (uint32_t i = 0; i < count * INPUTS_NUMS; i++) {	// No memcpy() in flash
+		data[i] = samples[i];
+	}
+	frame->samples = FRAME_data[head & FRAME_MASK];
+	frame->count = count;
+	frame->seq = seq;
+	frame->time = EVT_timestamp();
+	frame->overruns = FRAME_dropped;
+	FRAME_dropped = 0;
+	__DMB();							// Frame complete before it is visible
+	FRAME_head = head + 1;
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Number of frames waiting in the ring
+ * @return frames put and not yet released
+ *****************************************************************************/
+uint32_t FRAME_count(void)
+{
+	return FRAME_head - FRAME_tail;
+}
+
+
+/** ***************************************************************************
+ * @brief Oldest frame in the ring, called by main
+ * @return the frame or NULL if the ring is empty
+ *
+ * The frame stays valid until FRAME_release() is called.
+ *****************************************************************************/
+const FRAME_t *FRAME_peek(void)
+{
+	uint32_t tail = FRAME_tail;
+	if (tail == FRAME_head) {
+		return NULL;
+	}
+	__DMB();							// Read the index before the frame
+	return &FRAME_ring[tail & FRAME_MASK];
+}
+
+
+/** ***************************************************************************
+ * @brief Give the slot of the oldest frame back to the producer
+ *****************************************************************************/
+void FRAME_release(void)
+{
+	__DMB();							// Done reading before the slot is reused
+	FRAME_tail = FRAME_tail + 1;
+}
@@ -0,0 +1,337 @@
+/** ***************************************************************************
+ * @file
+ * @brief Asynchronous command queue for the DMA2D graphics accelerator.
+ *
+ * ==============================================================
+ *
+ * Fills, copies, pixel format conversions and blends are put into a queue
+ * and executed back-to-back by the DMA2D.
+ * @n The next command is started from the DMA2D transfer complete interrupt,
+ * so the CPU does not wait for the transfer and can process samples
+ * in the meantime.
+ * @n Before the CPU reads or writes pixels in the framebuffer itself
+ * GFX_sync() or GFX_fence() has to be called.
+ * The BSP LCD driver does this in BSP_LCD_DrawPixel() and BSP_LCD_ReadPixel().
+ *
+ * GFX_mark() queues a marker instead of a transfer.
+ * When all commands before it have been executed its tag and the time
+ * are stored, so the main loop can find out without waiting
+ * when everything drawn for a frame is in the framebuffer.
+ *
+ * @note Source buffers of queued copies, conversions and blends
+ * must stay valid until the command has been executed.
+ * Call GFX_fence() before reusing them.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include "stm32f4xx.h"
+
+#include "graphics.h"
+#include "events.h"
+#include "placement.h"
+#include "probe.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define GFX_QUEUE_MASK		(GFX_QUEUE_SIZE-1)	///< Index wrap around
+#define GFX_MODE_M2M		0UL		///< Memory to memory
+#define GFX_MODE_M2M_PFC	1UL		///< Memory to memory with PFC
+#define GFX_MODE_M2M_BLEND	2UL		///< Memory to memory with blending
+#define GFX_MODE_R2M		3UL		///< Register to memory = fill
+#define GFX_AM_MULTIPLY		2UL		///< Alpha mode: multiply with ALPHA
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+volatile bool GFX_pending = false;		///< DMA2D has queued or running work
+volatile uint32_t GFX_mark_tag = 0;		///< Tag of the last passed GFX_mark()
+volatile uint32_t GFX_mark_time = 0;	///< EVT_timestamp() when it passed
+#ifdef GFX_STATS
+uint32_t GFX_cpu_pixels = 0;			///< Pixels read or written by the CPU
+#endif
+
+static GFX_cmd_t GFX_queue[GFX_QUEUE_SIZE];	///< Queued commands
+static volatile uint32_t GFX_head = 0;	///< Next free slot, written by main
+static volatile uint32_t GFX_tail = 0;	///< Next command, written by ISR
+static volatile bool GFX_running = false;	///< DMA2D transfer in progress
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static void GFX_enqueue(const GFX_cmd_t *cmd);
+static void GFX_start_next(void);
+
+
+/** ***************************************************************************
+ * @brief Initialize the DMA2D and enable its interrupt
+ *
+ * @note The DMA2D clock is enabled by BSP_LCD_Init().
+ *****************************************************************************/
+void GFX_init(void)
+{
+	__HAL_RCC_DMA2D_CLK_ENABLE();		// Enable Clock for DMA2D
+	DMA2D->IFCR = DMA2D_IFCR_CTCIF | DMA2D_IFCR_CTEIF;	// Clear flags
+	GFX_head = 0;
+	GFX_tail = 0;
+	GFX_running = false;
+	GFX_pending = false;
+	NVIC_ClearPendingIRQ(DMA2D_IRQn);	// Clear pending DMA2D interrupt
+	NVIC_EnableIRQ(DMA2D_IRQn);			// Enable DMA2D interrupt in the NVIC
+}
+
+
+/** ***************************************************************************
+ * @brief Queue a rectangle fill with a constant ARGB8888 color
+ * @param dst address of the first pixel
+ * @param width pixels per line
+ * @param height number of lines
+ * @param dst_offset pixels to skip at the end of each line
+ * @param color fill color
+ *****************************************************************************/
+void GFX_fill(uint32_t dst, uint32_t width, uint32_t height,
+		uint32_t dst_offset, uint32_t color)
+{
+	GFX_cmd_t cmd = {0};
+	cmd.op = GFX_FILL;
+	cmd.fg = color;
+	cmd.dst = dst;
+	cmd.width = width;
+	cmd.height = height;
+	cmd.dst_offset = dst_offset;
+	GFX_enqueue(&cmd);
+}
+
+
+/** ***************************************************************************
+ * @brief Queue an ARGB8888 copy of a rectangle
+ * @param src address of the first source pixel
+ * @param src_offset pixels to skip at the end of each source line
+ * @param dst address of the first destination pixel
+ * @param dst_offset pixels to skip at the end of each destination line
+ * @param width pixels per line
+ * @param height number of lines
+ *
+ * @note Source and destination may only overlap if dst is below src,
+ * e.g. for scrolling a region to the left or upwards.
+ *****************************************************************************/
+void GFX_copy(uint32_t src, uint32_t src_offset, uint32_t dst,
+		uint32_t dst_offset, uint32_t width, uint32_t height)
+{
+	GFX_cmd_t cmd = {0};
+	cmd.op = GFX_COPY;
+	cmd.fg = src;
+	cmd.fg_offset = src_offset;
+	cmd.dst = dst;
+	cmd.dst_offset = dst_offset;
+	cmd.width = width;
+	cmd.height = height;
+	GFX_enqueue(&cmd);
+}
+
+
+/** ***************************************************************************
+ * @brief Queue a conversion of a rectangle to ARGB8888
+ * @param src address of the first source pixel
+ * @param src_mode color mode of the source GFX_CM_*
+ * @param dst address of the first destination pixel
+ * @param width pixels per line
+ * @param height number of lines
+ * @param dst_offset pixels to skip at the end of each destination line
+ *****************************************************************************/
+void GFX_convert(uint32_t src, uint32_t src_mode, uint32_t dst,
+		uint32_t width, uint32_t height, uint32_t dst_offset)
+{
+	GFX_cmd_t cmd = {0};
+	cmd.op = GFX_CONVERT;
+	cmd.fg = src;
+	cmd.fg_mode = src_mode;
+	cmd.dst = dst;
+	cmd.dst_offset = dst_offset;
+	cmd.width = width;
+	cmd.height = height;
+	GFX_enqueue(&cmd);
+}
+
+
+/** ***************************************************************************
+ * @brief Queue a blend of a foreground onto an ARGB8888 background
+ * @param fg address of the first foreground pixel
+ * @param fg_offset pixels to skip at the end of each foreground line
+ * @param fg_mode color mode of the foreground GFX_CM_*
+ * @param fg_color color used with GFX_CM_A8 foregrounds
+ * @param alpha foreground alpha is multiplied with this value
+ * @param bg address of the first background pixel
+ * @param bg_offset pixels to skip at the end of each background line
+ * @param dst address of the first destination pixel
+ * @param dst_offset pixels to skip at the end of each destination line
+ * @param width pixels per line
+ * @param height number of lines
+ *****************************************************************************/
+void GFX_blend(uint32_t fg, uint32_t fg_offset, uint32_t fg_mode,
+		uint32_t fg_color, uint8_t alpha, uint32_t bg, uint32_t bg_offset,
+		uint32_t dst, uint32_t dst_offset, uint32_t width, uint32_t height)
+{
+	GFX_cmd_t cmd = {0};
+	cmd.op = GFX_BLEND;
+	cmd.fg = fg;
+	cmd.fg_offset = fg_offset;
+	cmd.fg_mode = fg_mode;
+	cmd.fg_color = fg_color;
+	cmd.fg_alpha = alpha;
+	cmd.bg = bg;
+	cmd.bg_offset = bg_offset;
+	cmd.dst = dst;
+	cmd.dst_offset = dst_offset;
+	cmd.width = width;
+	cmd.height = height;
+	GFX_enqueue(&cmd);
+}
+
+
+/** ***************************************************************************
+ * @brief Queue a marker behind the commands queued so far
+ * @param tag stored in GFX_mark_tag when the marker is reached
+ *****************************************************************************/
+void GFX_mark(uint32_t tag)
+{
+	GFX_cmd_t cmd = {0};
+	cmd.op = GFX_MARK;
+	cmd.fg = tag;
+	GFX_enqueue(&cmd);
+}
+
+
+/** ***************************************************************************
+ * @brief Wait until all queued DMA2D commands have been executed
+ *****************************************************************************/
+void GFX_fence(void)
+{
+	while (GFX_pending) { ; }			// Wait for the queue to drain
+}
+
+
+/** ***************************************************************************
+ * @brief Number of commands waiting in the queue
+ * @return queued commands, the one currently running is not counted
+ *****************************************************************************/
+uint32_t GFX_get_queued(void)
+{
+	return (GFX_head - GFX_tail) & GFX_QUEUE_MASK;
+}
+
+
+/** ***************************************************************************
+ * @brief Put a command into the queue and start the DMA2D if it is idle
+ * @param cmd command to be copied into the queue
+ *
+ * If the queue is full, waits until the interrupt has freed a slot.
+ *****************************************************************************/
+static void GFX_enqueue(const GFX_cmd_t *cmd)
+{
+	uint32_t head = GFX_head;
+	while (((head + 1) & GFX_QUEUE_MASK) == GFX_tail) { ; }	// Queue full
+	GFX_queue[head] = *cmd;
+	NVIC_DisableIRQ(DMA2D_IRQn);		// ISR must not start in between
+	GFX_pending = true;					// ISR cannot clear it before the head
+	GFX_head = (head + 1) & GFX_QUEUE_MASK;
+	if (!GFX_running) {
+		GFX_start_next();
+	}
+	NVIC_EnableIRQ(DMA2D_IRQn);
+}
+
+
+/** ***************************************************************************
+ * @brief Load the next command into the DMA2D registers and start it
+ *
+ * Called from main with the DMA2D interrupt disabled or from the ISR.
+ * @n Markers are passed without a transfer.
+ * @n Sets GFX_pending with every transfer, clears it when the queue is empty.
+ * @n In RAM like the ISR, which calls it after every transfer.
+ *****************************************************************************/
+PLACE_RAMFUNC static void GFX_start_next(void)
+{
+	uint32_t tail = GFX_tail;
+	while ((tail != GFX_head) && (GFX_MARK == GFX_queue[tail].op)) {
+		GFX_mark_time = EVT_timestamp();
+		GFX_mark_tag = GFX_queue[tail].fg;
+		tail = (tail + 1) & GFX_QUEUE_MASK;
+		GFX_tail = tail;
+	}
+	if (tail == GFX_head) {				// Nothing left to do
+		GFX_running = false;
+		GFX_pending = false;
+		return;
+	}
+	const GFX_cmd_t *cmd = &GFX_queue[tail];
+	uint32_t mode = GFX_MODE_R2M;
+	switch (cmd->op) {
+	case GFX_FILL:
+		DMA2D->OCOLR = cmd->fg;			// Fill color
+		break;
+	case GFX_COPY:
+		mode = GFX_MODE_M2M;
+		DMA2D->FGMAR = cmd->fg;
+		DMA2D->FGOR = cmd->fg_offset;
+		DMA2D->FGPFCCR = GFX_CM_ARGB8888;
+		break;
+	case GFX_CONVERT:
+		mode = GFX_MODE_M2M_PFC;
+		DMA2D->FGMAR = cmd->fg;
+		DMA2D->FGOR = cmd->fg_offset;
+		DMA2D->FGPFCCR = cmd->fg_mode;	// Alpha is not modified
+		break;
+	case GFX_BLEND:
+		mode = GFX_MODE_M2M_BLEND;
+		DMA2D->FGMAR = cmd->fg;
+		DMA2D->FGOR = cmd->fg_offset;
+		DMA2D->FGCOLR = cmd->fg_color & 0x00FFFFFF;
+		DMA2D->FGPFCCR = cmd->fg_mode
+				| (GFX_AM_MULTIPLY << DMA2D_FGPFCCR_AM_Pos)
+				| ((uint32_t)cmd->fg_alpha << DMA2D_FGPFCCR_ALPHA_Pos);
+		DMA2D->BGMAR = cmd->bg;
+		DMA2D->BGOR = cmd->bg_offset;
+		DMA2D->BGPFCCR = GFX_CM_ARGB8888;
+		break;
+	default:							// Should never occur
+		break;
+	}
+	DMA2D->OPFCCR = GFX_CM_ARGB8888;	// Output is always ARGB8888
+	DMA2D->OMAR = cmd->dst;
+	DMA2D->OOR = cmd->dst_offset;
+	DMA2D->NLR = ((uint32_t)cmd->width << DMA2D_NLR_PL_Pos) | cmd->height;
+	GFX_tail = (tail + 1) & GFX_QUEUE_MASK;	// Slot is free now
+	GFX_running = true;
+	GFX_pending = true;
+	__DSB();							// CPU writes done before DMA2D reads
+	DMA2D->CR = (mode << DMA2D_CR_MODE_Pos) | DMA2D_CR_TCIE | DMA2D_CR_TEIE
+			| DMA2D_CR_START;			// Start transfer
+}
+
+
+/** ***************************************************************************
+ * @brief Interrupt handler for the DMA2D
+ *
+ * Starts the next queued command as soon as the last one has completed.
+ * @n A transfer error drops the failed command and continues with the next.
+ *****************************************************************************/
+PLACE_RAMFUNC void DMA2D_IRQHandler(void)
+{
+	PROBE_BEGIN(PROBE_ISR_DMA2D);
+	if (DMA2D->ISR & (DMA2D_ISR_TCIF | DMA2D_ISR_TEIF)) {
+		DMA2D->IFCR = DMA2D_IFCR_CTCIF | DMA2D_IFCR_CTEIF;	// Clear flags
+		GFX_start_next();
+	}
+	PROBE_END(PROBE_ISR_DMA2D);
+}
@@ -29,11 +29,31 @@
 #include "measuring.h"
 #include "calculations.h"
 #include "displayingdata.h"
+#include "graphics.h"
+#include "plotting.h"
+#include "events.h"
+#include "frames.h"
+#include "pipeline.h"
+#include "scheduler.h"
+#include "touch.h"
+#include "probe.h"
+#include "capture.h"
+#include "record.h"
+#include "telemetry.h"
+#include "remote.h"
+#include "sequential.h"
+#include "statistics.h"
+#include "trigger.h"
 
 /******************************************************************************
  * Defines
  *****************************************************************************/
-
+#define MAIN_UI_PERIOD		TOUCH_POLL_PERIOD	///< ms between debounce steps
+#define MAIN_STATUS_PERIOD	200			///< ms between LED toggles
+#define MAIN_REPORT_PERIODS	5			///< Status periods per load report
+#define MAIN_TELEMETRY_PERIOD	1000		///< ms between profile packets
+#define MAIN_REMOTE_PERIOD	100			///< ms between command polls
+#define MAIN_TASK_COUNT		5			///< Entries of MAIN_tasks[]
 
 /******************************************************************************
  * Variables
@@ -42,33 +62,59 @@ bool MEAS_data_wire = false;			///< Allow for wire data displaying
 bool MEAS_data_cable = false;			///< Allow for cable data displaying
 bool MEAS_data_angle = false;			///< Allow for angle data displaying
 
+static CAP_t MAIN_capture;				///< All frames since reset, in SDRAM
+
 /******************************************************************************
  * Functions
  *****************************************************************************/
 static void SystemClock_Config(void);	///< System Clock Configuration
 static void gyro_disable(void);			///< Disable the onboard gyroscope
+static void MAIN_start_measurement(bool adaptive);	///< Start a measurement
+static void MAIN_start_acquisition(bool adaptive);	///< Measurement, no menu
+static void MAIN_ui_task(void);			///< Pushbutton and touchscreen menu
+static void MAIN_frame_task(void);		///< Compute and show one frame
+static void MAIN_remote_task(void);		///< Commands of a test rig
+static void MAIN_status_task(void);		///< LEDs and statistics
+static void MAIN_telemetry_task(void);	///< Profiling counters to the host
+static void MAIN_trigger_report(void);	///< Frozen trigger window to the host
+
+/** Tasks in order of priority, deadlines in us */
+static SCHED_task_t MAIN_tasks[MAIN_TASK_COUNT] = {
+		SCHED_TASK("ui", MAIN_ui_task, 0, EVT_BUTTON | EVT_TOUCH, MAIN_UI_PERIOD, 50000),
+		SCHED_TASK("frame", MAIN_frame_task, 1, EVT_FRAME, 0, 50000),
+		SCHED_TASK("remote", MAIN_remote_task, 2, EVT_REMOTE, MAIN_REMOTE_PERIOD, 20000),
+		SCHED_TASK("status", MAIN_status_task, 3, 0, MAIN_STATUS_PERIOD, 20000),
+		SCHED_TASK("telemetry", MAIN_telemetry_task, 4, 0, MAIN_TELEMETRY_PERIOD, 20000),
+};
 
 
 /** ***************************************************************************
  * @brief  Main function
  * @return not used because main ends in an infinite loop
  *
- * Initialization and infinite while loop
+ * Initialization, then the scheduler runs the tasks in MAIN_tasks[]
+ * and sleeps in EVT_wait() while there is nothing to do.
  *****************************************************************************/
 int main(void) {
 	HAL_Init();							// Initialize the system
 
 	SystemClock_Config();				// Configure system clocks
+	EVT_init();							// Cycle counter for timestamps
+	PIPE_reset();						// Statistics of the pipeline stages
 
 	BSP_LCD_Init();						// Initialize the LCD display
-	BSP_LCD_LayerDefaultInit(LCD_FOREGROUND_LAYER, LCD_FRAME_BUFFER);
-	BSP_LCD_SelectLayer(LCD_FOREGROUND_LAYER);
+	GFX_init();							// DMA2D command queue for drawing
+	DISP_layers_init();					// Static background, dynamic foreground
+	CAP_create(&MAIN_capture, (void *)CAP_SDRAM_ADDR, CAP_SDRAM_SIZE,
+			ADC_FS, CALC_CALIBRATION);	// Record behind the framebuffers
+	REC_init((void *)REC_SDRAM_ADDR, REC_SDRAM_SIZE);	// Ring behind the capture
+	REC_start();						// Keeps the last minutes of the live view
+	TEL_init();							// Packets to the virtual COM port
+	REM_init();							// Commands from the virtual COM port
 	BSP_LCD_DisplayOn();
-	BSP_LCD_Clear(LCD_COLOR_WHITE);
 
 	BSP_TS_Init(BSP_LCD_GetXSize(), BSP_LCD_GetYSize());	// Touchscreen
-	/* Uncomment next line to enable touchscreen interrupt */
-	 //BSP_TS_ITConfig();					// Enable Touchscreen interrupt
+	TOUCH_init();						// Enable touchscreen interrupt
 
 	PB_init();							// Initialize the user pushbutton
 	PB_enableIRQ();						// Enable interrupt on user pushbutton
@@ -85,85 +131,298 @@ int main(void) {
 	MEAS_timer_init();					// Configure the timer
 
 
-	/* Infinite while loop */
-	while (1) {							// Infinitely loop in main function
-		BSP_LED_Toggle(LED3);			// Visual feedback when running
-		BSP_LED_Toggle(LED4);
-
+	SCHED_run(MAIN_tasks, MAIN_TASK_COUNT);	// Never returns
+}
 
 
-		// Show data for wire
-		if ((MEAS_data_ready)&&(MEAS_data_wire)) {
-			MEAS_data_ready = false;
-			MEAS_sort_data();
-			DISP_show_data_wire();
-			MEAS_data_wire = false;
-		}
-		// Show data for cable
-		if ((MEAS_data_ready)&&(MEAS_data_cable)) {
-			MEAS_data_ready = false;
-			MEAS_sort_data();
-			DISP_show_data_cable();
-			MEAS_data_cable = false;
-		}
-		// Show data for angle
-		if ((MEAS_data_ready)&&(MEAS_data_angle)) {
-			MEAS_data_ready = false;
-			MEAS_sort_data();
-			DISP_show_data_angle();
-			MEAS_data_angle = false;
-		}
+/** ***************************************************************************
+ * @brief User interface task: pushbutton and touchscreen menu
+ *
+ * Released by the pushbutton, the touchscreen and every MAIN_UI_PERIOD ms.
+ * @n The touch controller is only read while the screen is touched.
+ *****************************************************************************/
+static void MAIN_ui_task(void)
+{
+	/* Pressing the blue pushbutton will turn off the device */
+	if (PB_pressed()) {					// Check if user pushbutton was pressed
+		MANUAL_shut_off();
+	}
 
+	TOUCH_update();						// Debounce, no I2C while not touched
+	MENU_check_transition();
 
-		/* Pressing the blue pushbutton will turn off the device */
-		if (PB_pressed()) {				// Check if user pushbutton was pressed
-				MANUAL_shut_off();
-			}
+	switch (MENU_get_transition()) {	// Handle user menu choice
+	case MENU_NONE:						// No transition => do nothing
+		break;
+	case MENU_ZERO:
 
+		// MEASUREMENT WIRE
+		MAIN_start_measurement(true);
+		MEAS_data_wire = true;
+		break;
 
+	case MENU_ONE:
 
+		// MEASUREMENT CABLE
+		MAIN_start_measurement(true);
+		MEAS_data_cable = true;
+		break;
 
+	case MENU_TWO:
 
+		// MEASUREMENT ANGLE
+		MAIN_start_measurement(false);
+		MEAS_data_angle = true;
+		break;
 
-		/* Comment next line if touchscreen interrupt is enabled */
-		MENU_check_transition();
+	case MENU_THREE:
 
-		switch (MENU_get_transition()) {	// Handle user menu choice
-		case MENU_NONE:					// No transition => do nothing
-			break;
-		case MENU_ZERO:
+		// LIVE VIEW, touch again to switch strip-chart / waterfall
+		if (PLOT_OFF == PLOT_view) {
+			PLOT_start(PLOT_STRIP);
+		} else if (PLOT_STRIP == PLOT_view) {
+			PLOT_set_view(PLOT_WATERFALL);
+		} else {
+			PLOT_set_view(PLOT_STRIP);
+		}
+		break;
+	case MENU_CONTENT:
+
+		// DEBUG PAGE with the probe statistics, long press above the menu bar,
+		// again to clear them
+#ifdef PROBE_ENABLE
+		PLOT_stop();
+		PROBE_show();
+#endif
+		break;
+	default:							// Should never occur
+		break;
+	}
+}
 
-			// MEASUREMENT WIRE
-			ADC3_scan_init();
-			ADC3_scan_start();
-			MEAS_data_wire = true;
-			break;
 
-		case MENU_ONE:
+/** ***************************************************************************
+ * @brief Acquisition processing task: one frame out of the frame ring
+ *
+ * The frame passes the compute and the display stage of the pipeline.
+ * The ring slot is released as soon as the samples are sorted,
+ * the calculated values are handed to the display stage in a local record.
+ * @n A single acquisition is shown on the requested result screen,
+ * a half of the continuous stream is added to the live view.
+ * @n During a sequential measurement the halves go to the estimator
+ * instead, its result is shown like a single acquisition.
+ * The DMA2D draws in the background while the next frame is computed.
+ * @n Only one frame is processed per run, so the user interface
+ * gets its turn in between. The task releases itself for the others.
+ *****************************************************************************/
+static void MAIN_frame_task(void)
+{
+	const FRAME_t *frame = FRAME_peek();
+	if (NULL == frame) {
+		return;
+	}
+	uint32_t start = PIPE_compute_begin(frame);
+	uint32_t acquired = frame->time;
+	uint32_t seq = frame->seq;
+	uint32_t count = frame->count;
+	bool stream = (ADC_STREAM_NUMS == count);
+	bool adaptive = stream && SEQ_running() && (PLOT_OFF == PLOT_view);
+	bool show = true;
+	PLOT_column_t column;
+	DISP_result_t result;
+	CAP_put(&MAIN_capture, frame);		// Until the SDRAM is full
+	TEL_frame(frame);					// Dropped if the serial port lags
+	PROBE_SCOPE(PROBE_SORT) {
+		MEAS_sort_data(frame);
+		if (stream) {
+			STAT_add(frame);			// Sliding windows of the live view
+		}
+	}
+	FRAME_release();					// The slot belongs to the ISR again
+	if (0U != FRAME_count()) {
+		EVT_post(EVT_FRAME);			// Run again for the next frame
+	}
+	if (adaptive) {
+		show = false;
+		PROBE_SCOPE(PROBE_CALC) {
+			CALC_kind_t kind = MEAS_data_cable ? CALC_CABLE : CALC_WIRE;
+			if (SEQ_add(kind, count)) {
+				SEQ_result_t estimate;
+				ADC3_scan_stop();		// Precise enough, later halves are dropped
+				SEQ_get(&estimate);
+				DISP_calc_sequential(&result, &estimate);
+				MEAS_data_wire = false;
+				MEAS_data_cable = false;
+				stream = false;			// Reported like a single acquisition
+				show = true;
+			}
+		}
+	} else if (stream) {
+		show = (PLOT_OFF != PLOT_view);
+		if (show) {
+			PROBE_SCOPE(PROBE_COLUMN) {
+				PLOT_compute(&column);
+			}
+		}
+	} else if (MEAS_data_wire) {		// Calculate data for wire, cable, angle
+		PROBE_SCOPE(PROBE_CALC) {
+			DISP_calc_wire(&result);
+		}
+		MEAS_data_wire = false;
+	} else if (MEAS_data_cable) {
+		PROBE_SCOPE(PROBE_CALC) {
+			DISP_calc_cable(&result);
+		}
+		MEAS_data_cable = false;
+	} else if (MEAS_data_angle) {
+		PROBE_SCOPE(PROBE_CALC) {
+			DISP_calc_angle(&result);
+		}
+		MEAS_data_angle = false;
+	} else {
+		show = false;
+	}
+	start = PIPE_compute_end(start);
+	if (show && stream && (PLOT_WATERFALL == column.view)) {
+		TEL_spectrum(seq, column.mag, PLOT_BINS);
+	} else if (show && !stream) {
+		TEL_result(&result);
+		REM_done();						// A test rig gets the next one
+		show = !REM_headless;			// Only the rig needs the values
+	}
+	if (show) {
+		if (stream) {
+			PROBE_SCOPE(PROBE_DRAW) {
+				PLOT_draw(&column);
+			}
+		} else {
+			PROBE_SCOPE(PROBE_SHOW) {
+				DISP_show(&result);
+			}
+		}
+		PIPE_display_end(start, acquired);
+	}
+	PIPE_poll();						// Frames the DMA2D has finished
+}
 
-			// MEASUREMENT CABLE
-			ADC3_scan_init();
-			ADC3_scan_start();
-			MEAS_data_cable = true;
-			break;
 
-		case MENU_TWO:
+/** ***************************************************************************
+ * @brief Remote task: commands of a test rig, see remote.c
+ *
+ * Released by received commands, by the result of a remote measurement
+ * and every MAIN_REMOTE_PERIOD ms.
+ * @n Starts the next measurement of a series, the selected calculation
+ * runs in MAIN_frame_task() like after a touch on the menu.
+ *****************************************************************************/
+static void MAIN_remote_task(void)
+{
+	REM_mode_t mode;
+	REM_poll();
+	if (REM_next(&mode)) {
+		MAIN_start_acquisition(REM_ANGLE != mode);
+		MEAS_data_wire = (REM_WIRE == mode);
+		MEAS_data_cable = (REM_CABLE == mode);
+		MEAS_data_angle = (REM_ANGLE == mode);
+	}
+	TRIG_config_t trigger;
+	if (REM_trigger(&trigger)) {
+		if (0 == trigger.post) {
+			TRIG_disarm();
+		} else {
+			if (PLOT_OFF == PLOT_view) {
+				PLOT_start(PLOT_STRIP);	// The trigger watches the live view
+			}
+			TRIG_arm(&trigger);
+		}
+	}
+}
 
-			// MEASUREMENT ANGLE
-			ADC3_scan_init();
-			ADC3_scan_start();
-			MEAS_data_angle = true;
-			break;
 
-		case MENU_THREE:
-			MANUAL_shut_off();
-			break;
-		default:						// Should never occur
-			break;
+/** ***************************************************************************
+ * @brief Status task: LEDs and statistics
+ *
+ * Runs every MAIN_STATUS_PERIOD ms.
+ * @n The statistics are updated every MAIN_REPORT_PERIODS runs.
+ *****************************************************************************/
+static void MAIN_status_task(void)
+{
+	static uint32_t reports = 0;
+	BSP_LED_Toggle(LED3);				// Visual feedback when running
+	BSP_LED_Toggle(LED4);
+	PIPE_poll();
+	MAIN_trigger_report();
+	if (MAIN_REPORT_PERIODS <= ++reports) {
+		reports = 0;
+		if (PIPE_report()) {			// Occupancy of the pipeline stages
+			PLOT_show_load();
 		}
+		PROBE_refresh();				// Debug page and export, if shown
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Send a frozen trigger window, see trigger.c
+ *
+ * Called by the status task. The window goes out in packets of ADC_NUMS
+ * samples, as fast as the telemetry ring takes them.
+ *****************************************************************************/
+static void MAIN_trigger_report(void)
+{
+	static uint32_t sent = 0;
+	static bool pending = false;
+	if (TRIG_poll()) {
+		sent = 0;
+		pending = (TRIG_count > 0);
+	}
+	while (pending && TEL_trigger(sent, ADC_NUMS)) {
+		sent += ADC_NUMS;
+		pending = (sent < TRIG_count);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Telemetry task: profiling counters
+ *
+ * Runs every MAIN_TELEMETRY_PERIOD ms, see telemetry.c.
+ *****************************************************************************/
+static void MAIN_telemetry_task(void)
+{
+	TEL_profile();
+}
+
+
+/** ***************************************************************************
+ * @brief Start a measurement of all inputs
+ * @param adaptive see MAIN_start_acquisition()
+ *
+ * Stops the live view and records the latency from the touch on the menu.
+ *****************************************************************************/
+static void MAIN_start_measurement(bool adaptive)
+{
+	MAIN_start_acquisition(adaptive);
+	EVT_latency_record(&EVT_touch_latency, MENU_get_touch_time());
+}
 
-		HAL_Delay(200);					// Wait or sleep
+
+/** ***************************************************************************
+ * @brief Stop the live view and start an acquisition of all inputs
+ * @param adaptive true = sequential measurement if SEQ_precision is set,
+ * the continuous mode runs until the frame task has a precise result
+ *
+ * Otherwise a single acquisition of ADC_NUMS samples.
+ *****************************************************************************/
+static void MAIN_start_acquisition(bool adaptive)
+{
+	PLOT_stop();
+	if (adaptive && (SEQ_precision > 0)) {
+		SEQ_begin();
+		ADC3_scan_continuous_init();
+	} else {
+		ADC3_scan_init();
 	}
+	ADC3_scan_start();
 }
 
 
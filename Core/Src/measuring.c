@@ -78,11 +78,18 @@
 #include "measuring.h"
 #include "displayingdata.h"
 #include "calculations.h"
+#include "events.h"
+#include "frames.h"
+#include "pipeline.h"
+#include "placement.h"
+#include "probe.h"
+#include "record.h"
+#include "statistics.h"
+#include "trigger.h"
 
 /******************************************************************************
  * Defines
  *****************************************************************************/
- #define ADC_FS          600 			///< Sampling freq. => 12 samples for a 50Hz period
  #define ADC_CLOCK       84000000    	///< APB2 peripheral clock frequency
  #define ADC_CLOCKS_PS   15          	///< Clocks/sample: 3 hold + 12 conversion
  #define TIM_CLOCK       84000000    	///< APB1 timer clock frequency
@@ -92,24 +99,28 @@
 /******************************************************************************
  * Variables
  *****************************************************************************/
-bool MEAS_data_ready = false;			///< New data is ready
+volatile bool MEAS_continuous = false;	///< Continuous acquisition running
 uint32_t MEAS_input_count = 1;			///< Number of input ports
 bool DAC_active = false;				///< DAC output active?
 
 static uint32_t ADC_sample_count = 0;  		///< Index for buffer
-uint32_t ADC_samples[ADC_NUMS*INPUTS_NUMS]; ///< ADC values of max. 4 input channels
+uint32_t ADC_samples[ADC_NUMS*INPUTS_NUMS] PLACE_DMA;	///< ADC values of max. 4 input channels
 static uint32_t DAC_sample = 0;         	///< DAC output value
 
-int32_t PAD1_samples[ADC_NUMS];				///< Array for the PAD1 samples for calculation and/or displaying
-int32_t PAD2_samples[ADC_NUMS];				///< Array for the PAD2 samples for calculation and/or displaying
-int32_t COIL1_samples[ADC_NUMS];			///< Array for the COIL1 samples for calculation and/or displaying
-int32_t COIL2_samples[ADC_NUMS];			///< Array for the COIL2 samples for calculation and/or displaying
+int32_t PAD1_samples[ADC_NUMS] PLACE_CCM;	///< Array for the PAD1 samples for calculation and/or displaying
+int32_t PAD2_samples[ADC_NUMS] PLACE_CCM;	///< Array for the PAD2 samples for calculation and/or displaying
+int32_t COIL1_samples[ADC_NUMS] PLACE_CCM;	///< Array for the COIL1 samples for calculation and/or displaying
+int32_t COIL2_samples[ADC_NUMS] PLACE_CCM;	///< Array for the COIL2 samples for calculation and/or displaying
+uint32_t MEAS_sorted_count = ADC_NUMS;	///< Samples per input of the last MEAS_sort_data()
 
 uint32_t ADC_buffer[INPUTS_NUMS*ADC_NUMS];	///< Buffer for ADC samples
 
 /******************************************************************************
  * Functions
  *****************************************************************************/
+static void MEAS_done(void);
+static void MEAS_stream_publish(uint32_t block);
+static void ADC3_scan_config(bool circular);
 
 /** ***************************************************************************
  * @brief Configure GPIOs in analog mode.
@@ -222,30 +233,75 @@ void TIM2_IRQHandler(void)
  *
  * Reads one sample from the ADC3 DataRegister and transfers it to a buffer.
  * @n Stops when ADC_NUMS samples have been read.
+ * @n The analog watchdog of ADC3 fires the trigger, see trigger.c.
  *****************************************************************************/
-void ADC_IRQHandler(void)
+PLACE_RAMFUNC void ADC_IRQHandler(void)
 {
-	if (ADC3->SR & ADC_SR_EOC) {		// Check if ADC3 end of conversion
+	if ((ADC3->CR1 & ADC_CR1_AWDIE) && (ADC3->SR & ADC_SR_AWD)) {
+		TRIG_awd();						// Level crossed in continuous mode
+	}
+	if ((ADC3->CR1 & ADC_CR1_EOCIE) && (ADC3->SR & ADC_SR_EOC)) {	// ADC3 EOC
 		ADC_samples[ADC_sample_count++] = ADC3->DR;	// Read input channel 1 only
 		if (ADC_sample_count >= ADC_NUMS) {		// Buffer full
 			TIM2->CR1 &= ~TIM_CR1_CEN;	// Disable timer
 			ADC3->CR2 &= ~ADC_CR2_ADON;	// Disable ADC3
 			ADC_reset();
-			MEAS_data_ready = true;
+			MEAS_done();
 		}
 
 	}
 }
 
 
+/** ***************************************************************************
+ * @brief Announce a completed single acquisition to the main loop
+ *****************************************************************************/
+PLACE_RAMFUNC static void MEAS_done(void)
+{
+	FRAME_put(ADC_samples, ADC_NUMS);
+	EVT_post(EVT_FRAME);
+}
+
+
+/** ***************************************************************************
+ * @brief Announce a filled half of ADC_samples in continuous mode
+ * @param block 0 = first half, 1 = second half
+ *
+ * The half is copied into the frame ring before the DMA refills it.
+ * If the ring is full the half is counted as overrun.
+ * @n The recorder copies it into the SDRAM ring by DMA meanwhile.
+ *****************************************************************************/
+PLACE_RAMFUNC static void MEAS_stream_publish(uint32_t block)
+{
+	REC_put(&ADC_samples[block*INPUTS_NUMS*ADC_STREAM_NUMS], ADC_STREAM_NUMS);
+	FRAME_put(&ADC_samples[block*INPUTS_NUMS*ADC_STREAM_NUMS], ADC_STREAM_NUMS);
+	EVT_post(EVT_FRAME);
+}
+
+
 /** ***************************************************************************
  * @brief Interrupt handler for DMA2 Stream1
  *
  * The samples from the ADC3 have been transfered to memory by the DMA2 Stream1
  * and are ready for processing.
+ * @n In continuous mode the half transfer and the transfer complete interrupt
+ * each announce one half of ADC_samples while the DMA fills the other half.
  *****************************************************************************/
-void DMA2_Stream1_IRQHandler(void)
+PLACE_RAMFUNC void DMA2_Stream1_IRQHandler(void)
 {
+	PROBE_BEGIN(PROBE_ISR_ADC);
+	if (MEAS_continuous) {				// Circular mode, keep running
+		if (DMA2->LISR & DMA_LISR_HTIF1) {	// First half is ready
+			DMA2->LIFCR |= DMA_LIFCR_CHTIF1;// Clear half transfer interrupt fl.
+			MEAS_stream_publish(0);
+		}
+		if (DMA2->LISR & DMA_LISR_TCIF1) {	// Second half is ready
+			DMA2->LIFCR |= DMA_LIFCR_CTCIF1;// Clear transfer complete int. fl.
+			MEAS_stream_publish(1);
+		}
+		PROBE_END(PROBE_ISR_ADC);
+		return;
+	}
 	if (DMA2->LISR & DMA_LISR_TCIF1) {	// Stream1 transfer compl. interrupt f.
 		NVIC_DisableIRQ(DMA2_Stream1_IRQn);	// Disable DMA interrupt in the NVIC
 		NVIC_ClearPendingIRQ(DMA2_Stream1_IRQn);// Clear pending DMA interrupt
@@ -256,8 +312,9 @@ void DMA2_Stream1_IRQHandler(void)
 		ADC3->CR2 &= ~ADC_CR2_ADON;		// Disable ADC3
 		ADC3->CR2 &= ~ADC_CR2_DMA;		// Disable DMA mode
 		ADC_reset();
-		MEAS_data_ready = true;
+		MEAS_done();
 	}
+	PROBE_END(PROBE_ISR_ADC);
 }
 
 
@@ -279,7 +336,7 @@ void DMA2_Stream3_IRQHandler(void)
 		ADC2->CR2 &= ~ADC_CR2_ADON;		// Disable ADC2
 		ADC2->CR2 &= ~ADC_CR2_DMA;		// Disable DMA mode
 		ADC_reset();
-		MEAS_data_ready = true;
+		MEAS_done();
 	}
 }
 
@@ -313,7 +370,7 @@ void DMA2_Stream4_IRQHandler(void)
 			ADC_samples[2*i]   = (ADC_samples[i] & 0xffff);
 		}
 		ADC_reset();
-		MEAS_data_ready = true;
+		MEAS_done();
 	}
 }
 
@@ -345,18 +402,71 @@ void MEAS_CLEAR_buffer_flags(void)
  * @n All 4 inputs are scanned and put into the ADC_samples array
  *****************************************************************************/
 void ADC3_scan_init(void)
+{
+	MEAS_continuous = false;
+	FRAME_reset();
+	ADC3_scan_config(false);
+}
+
+
+/** ***************************************************************************
+ * @brief Initialize ADC, timer and DMA for continuous scan mode
+ *
+ * Same as ADC3_scan_init() but the DMA runs in circular mode.
+ * @n The half transfer and transfer complete interrupts put a frame
+ * of ADC_STREAM_NUMS samples per input into the frame ring.
+ * @n The sliding windows (statistics.c) start empty.
+ * @n Call ADC3_scan_start() to start and ADC3_scan_stop() to stop.
+ *****************************************************************************/
+void ADC3_scan_continuous_init(void)
+{
+	MEAS_continuous = true;
+	FRAME_reset();
+	STAT_reset();
+	ADC3_scan_config(true);
+}
+
+
+/** ***************************************************************************
+ * @brief Stop a continuous acquisition
+ *****************************************************************************/
+void ADC3_scan_stop(void)
+{
+	NVIC_DisableIRQ(DMA2_Stream1_IRQn);	// Disable DMA interrupt in the NVIC
+	TIM2->CR1 &= ~TIM_CR1_CEN;			// Disable timer
+	DMA2_Stream1->CR &= ~DMA_SxCR_EN;	// Disable the DMA
+	while (DMA2_Stream1->CR & DMA_SxCR_EN) { ; }	// Wait for DMA to finish
+	DMA2->LIFCR |= DMA_LIFCR_CTCIF1 | DMA_LIFCR_CHTIF1;	// Clear flags
+	NVIC_ClearPendingIRQ(DMA2_Stream1_IRQn);// Clear pending DMA interrupt
+	ADC3->CR2 &= ~ADC_CR2_ADON;			// Disable ADC3
+	ADC3->CR2 &= ~ADC_CR2_DMA;			// Disable DMA mode
+	ADC_reset();
+	MEAS_continuous = false;
+}
+
+
+/** ***************************************************************************
+ * @brief Configure ADC3 and DMA2_Stream1 for scan mode
+ * @param circular true = DMA in circular mode with half transfer interrupt
+ *****************************************************************************/
+static void ADC3_scan_config(bool circular)
 {
 
 	__HAL_RCC_DMA2_CLK_ENABLE();		// Enable Clock for DMA2
 	DMA2_Stream1->CR &= ~DMA_SxCR_EN;	// Disable the DMA stream 1
 	while (DMA2_Stream1->CR & DMA_SxCR_EN) { ; }	// Wait for DMA to finish
-	DMA2->LIFCR |= DMA_LIFCR_CTCIF1;	// Clear transfer complete interrupt fl.
+	DMA2->LIFCR |= DMA_LIFCR_CTCIF1 | DMA_LIFCR_CHTIF1;	// Clear interrupt fl.
+	DMA2_Stream1->CR &= ~(DMA_SxCR_CIRC | DMA_SxCR_HTIE);	// Single shot
 	DMA2_Stream1->CR |= DMA_SxCR_CHSEL_1;	// Select channel 2
 	DMA2_Stream1->CR |= DMA_SxCR_PL_1;		// Priority high
 	DMA2_Stream1->CR |= DMA_SxCR_MSIZE_1;	// Memory data size = 32 bit
 	DMA2_Stream1->CR |= DMA_SxCR_PSIZE_1;	// Peripheral data size = 32 bit
 	DMA2_Stream1->CR |= DMA_SxCR_MINC;	// Increment memory address pointer
 	DMA2_Stream1->CR |= DMA_SxCR_TCIE;	// Transfer complete interrupt enable
+	if (circular) {
+		DMA2_Stream1->CR |= DMA_SxCR_CIRC;	// Restart at the end of the buffer
+		DMA2_Stream1->CR |= DMA_SxCR_HTIE;	// Half transfer interrupt enable
+	}
 	DMA2_Stream1->NDTR = INPUTS_NUMS*ADC_NUMS;		// Number of data items to transfer
 	DMA2_Stream1->PAR = (uint32_t)&ADC3->DR;	// Peripheral register address
 	DMA2_Stream1->M0AR = (uint32_t)ADC_samples;	// Buffer memory loc. address
@@ -384,6 +494,7 @@ void ADC3_scan_init(void)
  *****************************************************************************/
 void ADC3_scan_start(void)
 {
+	PIPE_acquire_start();
 	DMA2_Stream1->CR |= DMA_SxCR_EN;	// Enable DMA
 	NVIC_ClearPendingIRQ(DMA2_Stream1_IRQn);	// Clear pending DMA interrupt
 	NVIC_EnableIRQ(DMA2_Stream1_IRQn);	// Enable DMA interrupt in the NVIC
@@ -393,24 +504,28 @@ void ADC3_scan_start(void)
 
 
 /** ***************************************************************************
- * @brief Sorts the data from ADC_samples to a array for each input
- * @note	  The array has the same size as ADC_NUMS = 60
+ * @brief Sorts the samples of a frame to a array for each input
+ * @param frame single acquisition or half of the continuous stream
+ * @note	  The arrays have the size ADC_NUMS = 60,
+ * only the first frame->count entries are written, see MEAS_sorted_count
  *****************************************************************************/
 
 //float32_t sample_adc1_real[16];
 //float32_t sample_adc2_imag[16];
 
 
-void MEAS_sort_data(void){
-	for(int i=0;i<ADC_NUMS;i++){
+void MEAS_sort_data(const FRAME_t *frame){
+	const uint32_t *src = frame->samples;
+	MEAS_sorted_count = frame->count;
+	for(uint32_t i=0;i<frame->count;i++){
 
 //		sample_adc1_real =(float32_t)(adc_dual_mode_samples[n] & 0x0000FFFF);
 //		sample_adc2_imag = (float32_t)((adc_dual_mode_samples[n] >> 16) & 0x0000FFFF);
 
-		PAD1_samples[i]=ADC_samples[(4*i)];
-		PAD2_samples[i]=ADC_samples[1+((4*i))];
-		COIL1_samples[i]=ADC_samples[2+(4*i)];
-		COIL2_samples[i]=ADC_samples[3+(4*i)];
+		PAD1_samples[i]=src[(4*i)];
+		PAD2_samples[i]=src[1+((4*i))];
+		COIL1_samples[i]=src[2+(4*i)];
+		COIL2_samples[i]=src[3+(4*i)];
 	}
 }
 
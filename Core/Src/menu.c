@@ -3,13 +3,10 @@
  * @brief The menu
  *
  * Initializes and displays the menu.
- * @n Provides the function MENU_check_transition() for polling user actions.
- * The variable MENU_transition is set to the touched menu item.
+ * @n Provides the function MENU_check_transition() for user actions.
+ * It takes the debounced touch events of the touch module
+ * and sets the variable MENU_transition to the pressed menu item.
  * If no touch has occurred the variable MENU_transition is set to MENU_NONE
- * @n If the interrupt handler is enabled by calling BSP_TS_ITConfig();
- * the variable MENU_transition is set to the touched menu entry as above.
- * @n Either call once BSP_TS_ITConfig() to enable the interrupt
- * or MENU_check_transition() in the main while loop for polling.
  * @n The function MENU_get_transition() returns the new menu item.
  *
  * @author  Hanspeter Hochreutener, hhrt@zhaw.ch
@@ -29,14 +26,18 @@
 #include "main.h"
 
 #include "menu.h"
+#include "displayingdata.h"
+#include "events.h"
+#include "touch.h"
 
 
 /******************************************************************************
  * Defines
  *****************************************************************************/
-#define MENU_FONT				&Font16	///< Possible font sizes: 8 12 16 20 24
+#define MENU_FONT				&Font12	///< Possible font sizes: 8 12 16 20 24
 #define MENU_HEIGHT				40		///< Height of menu bar
 #define MENU_MARGIN				2		///< Margin around a menu entry
+#define MENU_HOLD_TIME			1000	///< ms a press above the bar is held for MENU_CONTENT
 /** Position of menu bar: 0 = top, (BSP_LCD_GetYSize()-MENU_HEIGHT) = bottom */
 #define MENU_Y					(BSP_LCD_GetYSize()-MENU_HEIGHT)
 
@@ -44,11 +45,15 @@
 /******************************************************************************
  * Variables
  *****************************************************************************/
-static MENU_item_t MENU_transition = MENU_NONE;	///< Transition to this menu
+static volatile MENU_item_t MENU_transition = MENU_NONE;	///< Transition to this menu
+static uint32_t MENU_touch_time = 0;	///< EVT_timestamp() of the first touch
+static bool MENU_content_held = false;	///< Press above the bar not yet released
+static uint32_t MENU_content_time = 0;	///< EVT_timestamp() of that press
 static MENU_entry_t MENU_entry[MENU_ENTRY_COUNT] = {
 		{"WIRE",	" ",		LCD_COLOR_BLACK,	LCD_COLOR_RED},
 		{"CABLE",	" ",		LCD_COLOR_BLACK,	LCD_COLOR_YELLOW},
 		{"Angle",	" ",		LCD_COLOR_BLACK,	LCD_COLOR_CYAN},
+		{"LIVE",	"Strip",	LCD_COLOR_BLACK,	LCD_COLOR_GREEN},
 };										///< All the menu entries
 
 
@@ -60,12 +65,14 @@ static MENU_entry_t MENU_entry[MENU_ENTRY_COUNT] = {
 /** ***************************************************************************
  * @brief Draw the menu onto the display.
  *
- * Each menu entry has two lines.
+ * The menu is drawn on the background layer.
+ * @n Each menu entry has two lines.
  * Text and background colors are applied.
  * @n These attributes are defined in the variable MENU_draw[].
  *****************************************************************************/
 void MENU_draw(void)
 {
+	BSP_LCD_SelectLayer(LCD_BACKGROUND_LAYER);	// Menu bar is static
 	BSP_LCD_SetFont(MENU_FONT);
 	uint32_t x, y, m, w, h;
 	y = MENU_Y;
@@ -83,6 +90,7 @@ void MENU_draw(void)
 		BSP_LCD_DisplayStringAt((x+3*m), y+h/2,
 				(uint8_t *)MENU_entry[i].line2, LEFT_MODE);
 	}
+	BSP_LCD_SelectLayer(LCD_FOREGROUND_LAYER);
 }
 
 
@@ -92,6 +100,7 @@ void MENU_draw(void)
  *****************************************************************************/
 void MENU_hint(void)
 {
+	DISP_static_begin(DISP_SCREEN_HINT);	// Hint is drawn on the background
 	BSP_LCD_SetBackColor(LCD_COLOR_WHITE);
 	BSP_LCD_SetTextColor(LCD_COLOR_BLUE);
 	BSP_LCD_FillCircle(10,124,8);
@@ -107,6 +116,7 @@ void MENU_hint(void)
 	BSP_LCD_DisplayStringAt(0, 190, (uint8_t *)"Version 30.03.2022", CENTER_MODE);
 	BSP_LCD_DisplayStringAt(0, 210, (uint8_t *)"ETPM4 Project | ET20a", CENTER_MODE);
 	BSP_LCD_DisplayStringAt(0, 230, (uint8_t *)"kneubste | schocnik", CENTER_MODE);
+	DISP_dynamic_begin();
 }
 
 
@@ -148,6 +158,8 @@ MENU_entry_t MENU_get_entry(const MENU_item_t item)
  * MENU_transition is used as a flag.
  * When the value is read by calling MENU_get_transition()
  * this flag is cleared, respectively set to MENU_NONE.
+ * @n Only main sets it, in MENU_check_transition(), the touchscreen
+ * interrupt handler just queues the touch events.
  *****************************************************************************/
 MENU_item_t MENU_get_transition(void)
 {
@@ -158,71 +170,58 @@ MENU_item_t MENU_get_transition(void)
 
 
 /** ***************************************************************************
- * @brief Check for selection/transition
+ * @brief Get the time of the touch which caused the last transition
  *
- * If the last transition has been consumed (MENU_NONE == MENU_transition)
- * and the touchscreen has been touched for a defined period
- * the variable MENU_transition is set to the touched item.
- * @note  Evalboard revision E (blue PCB) has an inverted y-axis
- * in the touch controller compared to the display.
- * Uncomment or comment the <b>\#define EVAL_REV_E</b> in main.h accordingly.
+ * @return EVT_timestamp() of the touchscreen interrupt
  *****************************************************************************/
-void MENU_check_transition(void)
+uint32_t MENU_get_touch_time(void)
 {
-	static MENU_item_t item_old = MENU_NONE;
-	static MENU_item_t item_new = MENU_NONE;
-	static TS_StateTypeDef  TS_State;	// State of the touch controller
-	BSP_TS_GetState(&TS_State);			// Get the state
-#ifdef EVAL_REV_E
-// Evalboard revision E (blue) has an inverted y-axis in the touch controller
-	TS_State.Y = BSP_LCD_GetYSize() - TS_State.Y;	// Invert the y-axis
-#endif
-	if (TS_State.TouchDetected) {		// If a touch was detected
-		/* Do only if last transition not pending anymore */
-		if (MENU_NONE == MENU_transition) {
-			item_old = item_new;		// Store old item
-			/* If touched within the menu bar? */
-			if ((MENU_Y < TS_State.Y) && (MENU_Y+MENU_HEIGHT > TS_State.Y)) {
-				item_new = TS_State.X	// Calculate new item
-						/ (BSP_LCD_GetXSize()/MENU_ENTRY_COUNT);
-				if ((0 > item_new) || (MENU_ENTRY_COUNT <= item_new)) {
-					item_new = MENU_NONE;	// Out of bounds
-				}
-				if (item_new == item_old) {	// 2 times the same menu item
-					item_new = MENU_NONE;
-					MENU_transition = item_old;
-				}
-			}
-		}
-	}
+	return MENU_touch_time;
 }
 
 
-
 /** ***************************************************************************
- * @brief Interrupt handler for the touchscreen
- *
- * @note BSP_TS_ITConfig(); must be called in the main function
- * to enable touchscreen interrupt.
- * @note There are timing issues when interrupt is enabled.
- * It seems that polling is the better choice with this evaluation board.
- * @n Call MENU_check_transition() from the while loop in main for polling.
+ * @brief Check for selection/transition
  *
- * The touchscreen interrupt is connected to PA15.
- * @n The interrupt handler for external line 15 to 10 is called.
+ * Takes the queued touch events of TOUCH_update().
+ * If the last transition has been consumed (MENU_NONE == MENU_transition)
+ * a press within the menu bar sets MENU_transition to the pressed item.
+ * @n A press above the bar only sets MENU_CONTENT if it is held for
+ * MENU_HOLD_TIME, so a stray touch of the content does nothing.
  *****************************************************************************/
-void EXTI15_10_IRQHandler(void)
+void MENU_check_transition(void)
 {
-	if (EXTI->PR & EXTI_PR_PR15) {		// Check if interrupt on touchscreen
-		EXTI->PR |= EXTI_PR_PR15;		// Clear pending interrupt on line 15
-		if (BSP_TS_ITGetStatus()) {		// Get interrupt status
-			BSP_TS_ITClear();				// Clear touchscreen controller int.
-			MENU_check_transition();
+	TOUCH_event_t event;
+	while (TOUCH_get(&event)) {
+		if (TOUCH_RELEASE == event.type) {
+			if (MENU_content_held && (MENU_NONE == MENU_transition)
+					&& (event.time - MENU_content_time
+							>= (SystemCoreClock / 1000U) * MENU_HOLD_TIME)) {
+				MENU_touch_time = event.time;	// Latency from the release
+				MENU_transition = MENU_CONTENT;
+			}
+			MENU_content_held = false;
+			continue;
+		}
+		if (MENU_NONE != MENU_transition) {
+			continue;					// Presses while pending
+		}
+		/* If touched within the menu bar? */
+		if ((MENU_Y < event.y) && (MENU_Y+MENU_HEIGHT > event.y)) {
+			MENU_item_t item = event.x	// Calculate the item
+					/ (BSP_LCD_GetXSize()/MENU_ENTRY_COUNT);
+			if ((0 <= item) && (MENU_ENTRY_COUNT > item)) {
+				MENU_touch_time = event.time;	// Start of the latency
+				MENU_transition = item;
+			}
+		} else if (MENU_Y >= event.y) {
+			MENU_content_held = true;	// Long press, see the release
+			MENU_content_time = event.time;
 		}
-		EXTI->PR |= EXTI_PR_PR15;		// Clear pending interrupt on line 15
 	}
 }
 
+
 /** ***************************************************************************
  * @brief Manual shut off of the device
  *
@@ -232,9 +231,8 @@ void EXTI15_10_IRQHandler(void)
  *****************************************************************************/
 void MANUAL_shut_off(void)
 {
-	/* Clear the display */
-	BSP_LCD_SetTextColor(LCD_COLOR_WHITE);
-	BSP_LCD_FillRect(0, 0, 240, 260+1);
+	/* Clear the display, both layers */
+	DISP_clear();
 	/* Write first 2 samples as numbers */
 	BSP_LCD_SetFont(&Font24);
 	BSP_LCD_SetBackColor(LCD_COLOR_WHITE);
@@ -0,0 +1,235 @@
+/** ***************************************************************************
+ * @file
+ * @brief Timing and occupancy of the acquire, compute and display stages
+ *
+ * ==============================================================
+ *
+ * A frame passes three stages, each one owning the frame's data in turn:
+ * - Acquire: the DMA fills ADC_samples, the ISR copies the frame into
+ *   a slot of the frame ring (frames.c).
+ * - Compute: main sorts the slot into the sample arrays and releases it
+ *   at once, then calculates the values to be shown.
+ * - Display: main queues the drawing, the DMA2D executes it.
+ *   The stage ends when the GFX_mark() queued behind the drawing passes.
+ *
+ * The stages work on different frames at the same time:
+ * the DMA acquires frame N+1 while the CPU computes frame N
+ * and the DMA2D still draws frame N-1.
+ * Nobody waits for the end of the display stage, it is collected later
+ * by PIPE_poll(). So the frame rate is limited by the slowest stage,
+ * not by the sum of all stages.
+ *
+ * For each stage PIPE_stats[] has the time per frame, the number of
+ * frames in the stage and the busy share of the last report period.
+ * The acquire stage is busy while the DMA fills a frame, the display stage
+ * from the start of drawing until the DMA2D has finished.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <string.h>
+#include "stm32f4xx.h"
+
+#include "pipeline.h"
+#include "events.h"
+#include "graphics.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define PIPE_FLIGHT_MASK	(PIPE_FLIGHT-1)	///< Index wrap around
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** A frame in the display stage */
+typedef struct {
+	uint32_t tag;						///< Tag of its GFX_mark()
+	uint32_t start;						///< EVT_timestamp() drawing started
+	uint32_t acquired;					///< EVT_timestamp() of the last sample
+} PIPE_flight_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+PIPE_stats_t PIPE_stats[PIPE_STAGES];	///< Statistics per stage
+
+static PIPE_flight_t PIPE_flight[PIPE_FLIGHT];	///< Frames being drawn
+static uint32_t PIPE_flight_head = 0;	///< Next free entry
+static uint32_t PIPE_flight_tail = 0;	///< Oldest frame being drawn
+static uint32_t PIPE_tag = 0;			///< Last tag, never reset
+static uint32_t PIPE_acquire_from = 0;	///< Start of the current acquisition
+static uint32_t PIPE_display_until = 0;	///< End of the last display stage
+static uint32_t PIPE_report_time = 0;	///< EVT_timestamp() of the last report
+static uint64_t PIPE_report_busy[PIPE_STAGES];	///< Busy at the last report
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static void PIPE_add(PIPE_stage_t stage, uint32_t time, uint32_t busy);
+
+
+/** ***************************************************************************
+ * @brief Clear all statistics
+ *
+ * Frames still being drawn are collected by the next PIPE_poll().
+ *****************************************************************************/
+void PIPE_reset(void)
+{
+	memset(PIPE_stats, 0, sizeof(PIPE_stats));
+	memset(PIPE_report_busy, 0, sizeof(PIPE_report_busy));
+	PIPE_stats[PIPE_DISPLAY].depth = PIPE_flight_head - PIPE_flight_tail;
+	PIPE_report_time = EVT_timestamp();
+}
+
+
+/** ***************************************************************************
+ * @brief An acquisition has been started, called by ADC3_scan_start()
+ *****************************************************************************/
+void PIPE_acquire_start(void)
+{
+	PIPE_acquire_from = EVT_timestamp();
+}
+
+
+/** ***************************************************************************
+ * @brief Main takes a frame out of the ring
+ * @param frame the frame
+ * @return EVT_timestamp() at the start of the compute stage
+ *
+ * Completes the acquire stage of the frame.
+ * In continuous mode the acquisition of the next frame started
+ * when the DMA finished this one.
+ *****************************************************************************/
+uint32_t PIPE_compute_begin(const FRAME_t *frame)
+{
+	uint32_t now = EVT_timestamp();
+	uint32_t busy = frame->time - PIPE_acquire_from;
+	if ((int32_t)busy < 0) {			// Acquisition started after the frame
+		busy = 0;
+	}
+	PIPE_acquire_from = frame->time;
+	PIPE_stats[PIPE_ACQUIRE].depth = FRAME_count();
+	PIPE_add(PIPE_ACQUIRE, busy, busy);
+	PIPE_stats[PIPE_COMPUTE].depth = 1;
+	return now;
+}
+
+
+/** ***************************************************************************
+ * @brief The values of the frame are calculated
+ * @param start return value of PIPE_compute_begin()
+ * @return EVT_timestamp() at the start of the display stage
+ *****************************************************************************/
+uint32_t PIPE_compute_end(uint32_t start)
+{
+	uint32_t now = EVT_timestamp();
+	PIPE_add(PIPE_COMPUTE, now - start, now - start);
+	PIPE_stats[PIPE_COMPUTE].depth = 0;
+	return now;
+}
+
+
+/** ***************************************************************************
+ * @brief The drawing of the frame is queued
+ * @param start return value of PIPE_compute_end()
+ * @param acquired EVT_timestamp() of the last sample of the frame
+ *
+ * Queues a marker behind the drawing.
+ * If too many frames are being drawn, waits for the DMA2D.
+ *****************************************************************************/
+void PIPE_display_end(uint32_t start, uint32_t acquired)
+{
+	if (PIPE_FLIGHT <= PIPE_flight_head - PIPE_flight_tail) {
+		GFX_fence();
+		PIPE_poll();
+	}
+	PIPE_flight_t *flight = &PIPE_flight[PIPE_flight_head & PIPE_FLIGHT_MASK];
+	flight->tag = ++PIPE_tag;
+	flight->start = start;
+	flight->acquired = acquired;
+	PIPE_flight_head++;
+	PIPE_stats[PIPE_DISPLAY].depth = PIPE_flight_head - PIPE_flight_tail;
+	GFX_mark(PIPE_tag);
+}
+
+
+/** ***************************************************************************
+ * @brief Collect the frames the DMA2D has finished drawing
+ *
+ * Records their display stage and their latency from the end
+ * of the acquisition until all of it is in the framebuffer.
+ *****************************************************************************/
+void PIPE_poll(void)
+{
+	uint32_t tag = GFX_mark_tag;
+	uint32_t done = GFX_mark_time;
+	while ((PIPE_flight_tail != PIPE_flight_head)
+			&& ((int32_t)(tag - PIPE_flight[PIPE_flight_tail
+					& PIPE_FLIGHT_MASK].tag) >= 0)) {
+		const PIPE_flight_t *flight =
+				&PIPE_flight[PIPE_flight_tail & PIPE_FLIGHT_MASK];
+		uint32_t from = flight->start;
+		if ((int32_t)(PIPE_display_until - from) > 0) {	// Overlapped
+			from = PIPE_display_until;
+		}
+		PIPE_add(PIPE_DISPLAY, done - flight->start, done - from);
+		EVT_latency_add(&EVT_display_latency, done - flight->acquired);
+		PIPE_display_until = done;
+		PIPE_flight_tail++;
+	}
+	PIPE_stats[PIPE_DISPLAY].depth = PIPE_flight_head - PIPE_flight_tail;
+}
+
+
+/** ***************************************************************************
+ * @brief Calculate the occupancy of all stages since the last report
+ * @return true if there is a new report, false if no time has passed
+ *****************************************************************************/
+bool PIPE_report(void)
+{
+	uint32_t now = EVT_timestamp();
+	uint32_t period = now - PIPE_report_time;
+	if (0U == period) {
+		return false;
+	}
+	for (uint32_t i = 0; i < PIPE_STAGES; i++) {
+		uint64_t busy = PIPE_stats[i].busy - PIPE_report_busy[i];
+		PIPE_stats[i].occupancy = (uint32_t)((busy * 100U) / period);
+		PIPE_report_busy[i] = PIPE_stats[i].busy;
+	}
+	PIPE_report_time = now;
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Add a frame to the statistics of a stage
+ * @param stage the stage
+ * @param time time of the frame in the stage in CPU clock cycles
+ * @param busy part of the time the stage was not yet busy with an older frame
+ *****************************************************************************/
+static void PIPE_add(PIPE_stage_t stage, uint32_t time, uint32_t busy)
+{
+	PIPE_stats_t *stats = &PIPE_stats[stage];
+	uint32_t us = time / (SystemCoreClock / 1000000U);
+	stats->frames++;
+	stats->last = us;
+	if (us > stats->max) {
+		stats->max = us;
+	}
+	if (stats->depth > stats->depth_max) {
+		stats->depth_max = stats->depth;
+	}
+	stats->busy += busy;
+}
@@ -0,0 +1,405 @@
+/** ***************************************************************************
+ * @file
+ * @brief Scrolling strip-chart and waterfall views for continuous monitoring.
+ *
+ * ==============================================================
+ *
+ * The ADC runs in continuous mode (ADC3_scan_continuous_init()).
+ * Every half buffer of ADC_STREAM_NUMS samples per input adds one column
+ * at the right edge of the plot, i.e. 20 columns per second.
+ *
+ * - Strip-chart: RMS of the pads and the coils and the distance over time,
+ *   from the sliding windows of statistics.c, with the distance and the
+ *   current of the last second as numbers
+ * - Waterfall: spectrum of the coils over time, low frequencies at the bottom
+ *
+ * The plot is not redrawn for a new column.
+ * The plot region on the foreground layer is shifted one pixel to the left
+ * by a DMA2D memory to memory copy, then the new column is filled.
+ * All of this is queued for the DMA2D, the CPU only calculates the values.
+ * @n Grid and labels are static and live on the background layer.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <string.h>
+#include "stm32f4xx.h"
+#include "stm32f429i_discovery.h"
+#include "stm32f429i_discovery_lcd.h"
+
+#include "plotting.h"
+#include "measuring.h"
+#include "calculations.h"
+#include "displayingdata.h"
+#include "graphics.h"
+#include "fft.h"
+#include "format.h"
+#include "menu.h"
+#include "pipeline.h"
+#include "statistics.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define PLOT_X_SIZE		240			///< Width of the display
+#define PLOT_Y0			60			///< First row of the plot region
+#define PLOT_H			200			///< Rows of the plot region
+#define PLOT_GRID		50			///< Rows between grid lines
+#define PLOT_RMS_SCALE	5			///< ADC counts per pixel for RMS traces
+#define PLOT_BIN_H		13			///< Rows per spectrum bin
+#define PLOT_MAG_MIN	4			///< Magnitude of the lowest color level
+#define PLOT_LEVELS		8			///< Number of color levels
+#define PLOT_CURRENT_MAX	9999		///< Largest current shown in cA, 99.99 A
+
+/** Address of a pixel on the foreground layer */
+#define PLOT_PIXEL(x, y)	(DISP_FG_BUFFER + 4*((y)*PLOT_X_SIZE + (x)))
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+PLOT_view_t PLOT_view = PLOT_OFF;		///< Active view, PLOT_OFF if stopped
+
+static int32_t PLOT_last[PLOT_TRACES];	///< Last row of each trace
+static bool PLOT_first = true;			///< No previous column yet
+
+/** Colors of the strip-chart traces: pads, coils, distance */
+static const uint32_t PLOT_trace_color[PLOT_TRACES] = {
+		LCD_COLOR_BLUE, LCD_COLOR_DARKCYAN, LCD_COLOR_RED
+};
+
+/** Color levels of the waterfall, level 0 is transparent */
+static const uint32_t PLOT_colormap[PLOT_LEVELS] = {
+		LCD_COLOR_WHITE, LCD_COLOR_LIGHTCYAN, LCD_COLOR_CYAN,
+		LCD_COLOR_LIGHTGREEN, LCD_COLOR_GREEN, LCD_COLOR_YELLOW,
+		LCD_COLOR_ORANGE, LCD_COLOR_RED
+};
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static void PLOT_draw_static(void);
+static void PLOT_scroll(void);
+static void PLOT_segment(int32_t from, int32_t to, uint32_t color);
+static void PLOT_strip_compute(PLOT_column_t *column);
+static void PLOT_strip_draw(const PLOT_column_t *column);
+static void PLOT_waterfall_compute(PLOT_column_t *column);
+static void PLOT_waterfall_draw(const PLOT_column_t *column);
+
+
+/** ***************************************************************************
+ * @brief Start the continuous acquisition and show a view
+ * @param view PLOT_STRIP or PLOT_WATERFALL
+ *
+ * The distance is calculated with the cable lookup table.
+ *****************************************************************************/
+void PLOT_start(PLOT_view_t view)
+{
+	MEAS_data_cable = true;
+	FFT_init(ADC_STREAM_NUMS);
+	PLOT_set_view(view);
+	ADC3_scan_continuous_init();
+	ADC3_scan_start();
+}
+
+
+/** ***************************************************************************
+ * @brief Switch the view without interrupting the acquisition
+ * @param view PLOT_STRIP or PLOT_WATERFALL
+ *****************************************************************************/
+void PLOT_set_view(PLOT_view_t view)
+{
+	MENU_entry_t entry = MENU_get_entry(MENU_THREE);
+	PLOT_view = view;
+	PLOT_first = true;
+	strncpy(entry.line2, (PLOT_STRIP == view) ? "Strip" : "Fall",
+			sizeof(entry.line2) - 1);
+	entry.line2[sizeof(entry.line2) - 1] = '\0';
+	MENU_set_entry(MENU_THREE, entry);
+	MENU_draw();
+	if (DISP_static_begin((PLOT_STRIP == view) ?
+			DISP_SCREEN_STRIP : DISP_SCREEN_WATERFALL)) {
+		PLOT_draw_static();
+	}
+	DISP_dynamic_begin();
+}
+
+
+/** ***************************************************************************
+ * @brief Stop the continuous acquisition
+ *
+ * Does nothing if no view is active.
+ *****************************************************************************/
+void PLOT_stop(void)
+{
+	if (PLOT_OFF == PLOT_view) {
+		return;
+	}
+	ADC3_scan_stop();
+	PLOT_view = PLOT_OFF;
+	MEAS_data_cable = false;
+}
+
+
+/** ***************************************************************************
+ * @brief Calculate the column of the active view
+ * @param column calculated values for PLOT_draw()
+ *
+ * MEAS_sort_data() must have been called with the frame.
+ *****************************************************************************/
+void PLOT_compute(PLOT_column_t *column)
+{
+	column->view = PLOT_view;
+	if (PLOT_STRIP == PLOT_view) {
+		PLOT_strip_compute(column);
+	} else if (PLOT_WATERFALL == PLOT_view) {
+		PLOT_waterfall_compute(column);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Scroll the view and add a calculated column
+ * @param column from PLOT_compute()
+ *
+ * A column calculated for the other view is dropped.
+ *****************************************************************************/
+void PLOT_draw(const PLOT_column_t *column)
+{
+	if (column->view != PLOT_view) {
+		return;
+	}
+	PLOT_scroll();
+	if (PLOT_STRIP == PLOT_view) {
+		PLOT_strip_draw(column);
+	} else if (PLOT_WATERFALL == PLOT_view) {
+		PLOT_waterfall_draw(column);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Add the column of a frame to the active view
+ * @param frame half of the continuous stream
+ *****************************************************************************/
+void PLOT_update(const FRAME_t *frame)
+{
+	PLOT_column_t column;
+	MEAS_sort_data(frame);
+	STAT_add(frame);
+	PLOT_compute(&column);
+	PLOT_draw(&column);
+}
+
+
+/** ***************************************************************************
+ * @brief Show the occupancy of the pipeline stages above the plot
+ *
+ * Call after PIPE_report(). Acquisition, computation and display
+ * in percent of the last report period.
+ *****************************************************************************/
+void PLOT_show_load(void)
+{
+	FMT_text_t text;
+	if (PLOT_OFF == PLOT_view) {
+		return;
+	}
+	FMT_clear(&text);
+	FMT_string(&text, "acq");
+	FMT_uint(&text, PIPE_stats[PIPE_ACQUIRE].occupancy, 3);
+	FMT_string(&text, " cmp");
+	FMT_uint(&text, PIPE_stats[PIPE_COMPUTE].occupancy, 3);
+	FMT_string(&text, " dsp");
+	FMT_uint(&text, PIPE_stats[PIPE_DISPLAY].occupancy, 3);
+	BSP_LCD_SetFont(&Font8);
+	BSP_LCD_SetBackColor(LCD_COLOR_WHITE);
+	BSP_LCD_SetTextColor(LCD_COLOR_DARKGRAY);
+	FMT_draw(&text, 135, 47, LEFT_MODE);	// Beside the legend, above the plot
+}
+
+
+/** ***************************************************************************
+ * @brief Draw title, legend and grid on the background layer
+ *****************************************************************************/
+static void PLOT_draw_static(void)
+{
+	BSP_LCD_SetBackColor(LCD_COLOR_WHITE);
+	BSP_LCD_SetTextColor(LCD_COLOR_BLACK);
+	if (PLOT_STRIP == PLOT_view) {
+		BSP_LCD_SetFont(&Font24);
+		BSP_LCD_DisplayStringAt(5, 10, (uint8_t *)"Live", LEFT_MODE);
+		BSP_LCD_SetFont(&Font12);
+		BSP_LCD_SetTextColor(PLOT_trace_color[0]);
+		BSP_LCD_DisplayStringAt(5, 45, (uint8_t *)"Pad", LEFT_MODE);
+		BSP_LCD_SetTextColor(PLOT_trace_color[1]);
+		BSP_LCD_DisplayStringAt(40, 45, (uint8_t *)"Coil", LEFT_MODE);
+		BSP_LCD_SetTextColor(PLOT_trace_color[2]);
+		BSP_LCD_DisplayStringAt(82, 45, (uint8_t *)"Dist", LEFT_MODE);
+		BSP_LCD_SetTextColor(LCD_COLOR_LIGHTGRAY);
+		for (uint32_t y = PLOT_Y0; y < PLOT_Y0 + PLOT_H; y += PLOT_GRID) {
+			BSP_LCD_DrawHLine(0, y, PLOT_X_SIZE);
+		}
+		BSP_LCD_DrawHLine(0, PLOT_Y0 + PLOT_H - 1, PLOT_X_SIZE);
+	} else {
+		BSP_LCD_SetFont(&Font24);
+		BSP_LCD_DisplayStringAt(5, 10, (uint8_t *)"Spectrum", LEFT_MODE);
+		BSP_LCD_SetFont(&Font12);
+		BSP_LCD_DisplayStringAt(5, 45, (uint8_t *)"Coils 20..300 Hz", LEFT_MODE);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Shift the plot region one pixel to the left
+ *
+ * DMA2D copy within the foreground framebuffer, the destination is below
+ * the source, so the overlapping copy is safe.
+ * The new column at the right edge is cleared (white = transparent).
+ *****************************************************************************/
+static void PLOT_scroll(void)
+{
+	GFX_copy(PLOT_PIXEL(1, PLOT_Y0), 1, PLOT_PIXEL(0, PLOT_Y0), 1,
+			PLOT_X_SIZE - 1, PLOT_H);
+	GFX_fill(PLOT_PIXEL(PLOT_X_SIZE - 1, PLOT_Y0), 1, PLOT_H,
+			PLOT_X_SIZE - 1, LCD_COLOR_WHITE);
+}
+
+
+/** ***************************************************************************
+ * @brief Fill a vertical segment of the new column
+ * @param from row relative to the bottom of the plot
+ * @param to row relative to the bottom of the plot
+ * @param color fill color
+ *****************************************************************************/
+static void PLOT_segment(int32_t from, int32_t to, uint32_t color)
+{
+	if (from > to) {
+		int32_t tmp = from;
+		from = to;
+		to = tmp;
+	}
+	if (from < 0) { from = 0; }			// Limit values, prevent crash
+	if (to > PLOT_H - 1) { to = PLOT_H - 1; }
+	if (from > to) {
+		return;
+	}
+	uint32_t y = PLOT_Y0 + PLOT_H - 1 - to;
+	GFX_fill(PLOT_PIXEL(PLOT_X_SIZE - 1, y), 1, to - from + 1,
+			PLOT_X_SIZE - 1, color);
+}
+
+
+/** ***************************************************************************
+ * @brief Strip-chart values: pad RMS, coil RMS, distance and current
+ * @param column calculated values
+ *
+ * The distance in mm is plotted with 1 pixel per mm,
+ * -1 (out of range) is shown at the top.
+ * @n The traces use the last STAT_ACCURATE samples, which reach back into
+ * the previous half, the numbers the last second. STAT_add() must have
+ * been called with the frame.
+ * @n The current is interpolated at the distance by
+ * CALC_estimate_current(), fixed point and without a division.
+ *****************************************************************************/
+static void PLOT_strip_compute(PLOT_column_t *column)
+{
+	int32_t pad = (STAT_deviation(0, STAT_ACCURATE)
+			+ STAT_deviation(1, STAT_ACCURATE)) / 2;
+	int32_t coil = (STAT_deviation(2, STAT_ACCURATE)
+			+ STAT_deviation(3, STAT_ACCURATE)) / 2;
+	int32_t second = (STAT_deviation(0, STAT_SECOND)
+			+ STAT_deviation(1, STAT_SECOND)) / 2;
+	int32_t field = (STAT_deviation(2, STAT_SECOND)
+			+ STAT_deviation(3, STAT_SECOND)) / 2;
+	column->dist = CALC_distance(CALC_CABLE, pad, &CALC_limits);
+	column->average = CALC_distance(CALC_CABLE, second, &CALC_limits);
+	column->current = CALC_estimate_current(column->average, -1, field, -1, NULL);
+	column->row[0] = pad / PLOT_RMS_SCALE;
+	column->row[1] = coil / PLOT_RMS_SCALE;
+	column->row[2] = (column->dist < 0) ? PLOT_H - 1 : column->dist;
+}
+
+
+/** ***************************************************************************
+ * @brief New strip-chart column
+ * @param column values from PLOT_strip_compute()
+ *****************************************************************************/
+static void PLOT_strip_draw(const PLOT_column_t *column)
+{
+	FMT_text_t text;
+	for (uint32_t i = 0; i < PLOT_TRACES; i++) {
+		PLOT_segment(PLOT_first ? column->row[i] : PLOT_last[i],
+				column->row[i], PLOT_trace_color[i]);
+		PLOT_last[i] = column->row[i];
+	}
+	PLOT_first = false;
+	/* Actual distance in mm and current in A as numbers, drawn by the CPU */
+	BSP_LCD_SetFont(&Font16);
+	BSP_LCD_SetBackColor(LCD_COLOR_WHITE);
+	BSP_LCD_SetTextColor(LCD_COLOR_BLACK);
+	FMT_clear(&text);
+	FMT_string(&text, "Dist: ");
+	FMT_int(&text, column->average, 4);
+	FMT_draw(&text, 120, 10, LEFT_MODE);
+	/* Font12 and a fixed width, the line ends at x = 120 + 11*7 */
+	BSP_LCD_SetFont(&Font12);
+	FMT_clear(&text);
+	FMT_string(&text, "Curr: ");
+	if (column->current < 0) {
+		FMT_string(&text, "   --");
+	} else {
+		int32_t centi = (column->current + 5) / 10;
+		FMT_fixed(&text, (centi > PLOT_CURRENT_MAX) ? PLOT_CURRENT_MAX : centi,
+				2, 5);
+	}
+	FMT_draw(&text, 120, 27, LEFT_MODE);
+}
+
+
+/** ***************************************************************************
+ * @brief Waterfall values: color levels of the spectrum of the coils
+ * @param column calculated values
+ *
+ * The color level is logarithmic: each level doubles the magnitude.
+ *****************************************************************************/
+static void PLOT_waterfall_compute(PLOT_column_t *column)
+{
+	int32_t coils[ADC_STREAM_NUMS];
+	uint32_t *mag = column->mag;
+	for (uint32_t i = 0; i < ADC_STREAM_NUMS; i++) {
+		coils[i] = COIL1_samples[i] + COIL2_samples[i];
+	}
+	FFT_spectrum(coils, mag, PLOT_BINS);
+	for (uint32_t b = 0; b < PLOT_BINS; b++) {
+		uint32_t level = 0;
+		while ((level < PLOT_LEVELS - 1)
+				&& (mag[b] >= ((uint32_t)PLOT_MAG_MIN << level))) {
+			level++;
+		}
+		column->level[b] = level;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief New waterfall column
+ * @param column values from PLOT_waterfall_compute()
+ *****************************************************************************/
+static void PLOT_waterfall_draw(const PLOT_column_t *column)
+{
+	for (uint32_t b = 1; b < PLOT_BINS; b++) {	// Skip DC
+		uint32_t level = column->level[b];
+		if (level > 0) {				// Level 0 stays transparent
+			int32_t from = (b - 1) * PLOT_BIN_H;
+			PLOT_segment(from, from + PLOT_BIN_H - 1, PLOT_colormap[level]);
+		}
+	}
+}
@@ -0,0 +1,274 @@
+/** ***************************************************************************
+ * @file
+ * @brief Cycle counter probes around the processing stages and handlers
+ *
+ * ==============================================================
+ *
+ * A probe times a block of code with the DWT cycle counter:
+ * @verbatim
+   PROBE_SCOPE(PROBE_SORT) {
+       MEAS_sort_data(frame);
+   }
+   @endverbatim
+ * or with PROBE_BEGIN(PROBE_RMS) and PROBE_END(PROBE_RMS) in one block.
+ * @n Every probe has count, min, max, mean and a histogram with one bin
+ * per octave of duration in the static table PROBE_stats[].
+ * Bin 0 counts runs shorter than 2^PROBE_BIN_SHIFT cycles,
+ * bin n the runs of 2^(n+PROBE_BIN_SHIFT-1) up to 2^(n+PROBE_BIN_SHIFT)
+ * cycles, the last bin all longer runs.
+ *
+ * The probes are only compiled with PROBE_ENABLE defined,
+ * which the debug build does.
+ * Otherwise the macros expand to nothing and this file is empty.
+ *
+ * PROBE_show() opens a debug page with the table, main() calls it for a
+ * long press above the menu bar (MENU_CONTENT). PROBE_refresh() updates
+ * it and writes the table as CSV over the ITM stimulus port 0 (SWO),
+ * which the ST-LINK passes on as a serial stream.
+ *
+ * @note A probe must only be recorded from one context (one handler or the
+ * main loop), the update is not atomic.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include "probe.h"
+
+#ifdef PROBE_ENABLE
+
+#include <string.h>
+#include "stm32f429i_discovery.h"
+#include "stm32f429i_discovery_lcd.h"
+
+#include "displayingdata.h"
+#include "format.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define PROBE_ROW_Y			58			///< First table row on the page
+#define PROBE_ROW_STEP		22			///< Rows between two probes
+#define PROBE_HIST_X		160			///< Left edge of the histograms
+#define PROBE_BAR_WIDTH		5			///< Pixels per histogram bin
+#define PROBE_BAR_HEIGHT	16			///< Pixels of the fullest bin
+#define PROBE_TEXT_LEN		12			///< ",value" of the export incl. '\0'
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+PROBE_LOCAL PROBE_stats_t PROBE_stats[PROBE_COUNT];	///< Statistics per probe
+
+/** Short names for the page and the export */
+static const char * const PROBE_name[PROBE_COUNT] = {
+		[PROBE_ISR_ADC] = "adc",
+		[PROBE_ISR_DMA2D] = "dma2d",
+		[PROBE_ISR_TOUCH] = "touch",
+		[PROBE_SORT] = "sort",
+		[PROBE_RMS] = "rms",
+		[PROBE_DISTANCE] = "dist",
+		[PROBE_CALC] = "calc",
+		[PROBE_SHOW] = "show",
+		[PROBE_COLUMN] = "col",
+		[PROBE_DRAW] = "draw",
+};
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static void PROBE_snapshot(PROBE_stats_t *copy, PROBE_id_t id);
+static void PROBE_print(const char *text);
+static void PROBE_print_value(uint32_t value);
+
+
+/** ***************************************************************************
+ * @brief Add one run to the statistics of a probe
+ * @param id the probe
+ * @param cycles duration in CPU clock cycles
+ *
+ * Called by the PROBE_* macros, also from interrupt handlers.
+ *****************************************************************************/
+void PROBE_record(PROBE_id_t id, uint32_t cycles)
+{
+	PROBE_stats_t *stats = &PROBE_stats[id];
+	uint32_t bin = 32U - __CLZ(cycles | 1U);	// Bits of the duration
+	bin = (bin > PROBE_BIN_SHIFT) ? bin - PROBE_BIN_SHIFT : 0U;
+	if (bin >= PROBE_BINS) {
+		bin = PROBE_BINS - 1U;
+	}
+	if ((0U == stats->count) || (cycles < stats->min)) {
+		stats->min = cycles;
+	}
+	if (cycles > stats->max) {
+		stats->max = cycles;
+	}
+	stats->sum += cycles;
+	stats->count++;
+	stats->hist[bin]++;
+}
+
+
+/** ***************************************************************************
+ * @brief Clear the statistics of all probes
+ *****************************************************************************/
+void PROBE_reset(void)
+{
+	__disable_irq();
+	memset(PROBE_stats, 0, sizeof(PROBE_stats));
+	__enable_irq();
+}
+
+
+/** ***************************************************************************
+ * @brief Open the debug page, or clear the statistics if it is open already
+ *****************************************************************************/
+void PROBE_show(void)
+{
+	if (DISP_static_begin(DISP_SCREEN_DEBUG)) {
+		BSP_LCD_SetBackColor(LCD_COLOR_WHITE);
+		BSP_LCD_SetTextColor(LCD_COLOR_BLACK);
+		BSP_LCD_SetFont(&Font24);
+		BSP_LCD_DisplayStringAt(5, 10, (uint8_t *)"Probes", LEFT_MODE);
+		BSP_LCD_SetFont(&Font8);
+		BSP_LCD_DisplayStringAt(5, 42,
+				(uint8_t *)"probe     n   min  mean   max us", LEFT_MODE);
+		for (uint32_t id = 0; id < PROBE_COUNT; id++) {	// Bin baselines
+			BSP_LCD_DrawHLine(PROBE_HIST_X,
+					PROBE_ROW_Y + id*PROBE_ROW_STEP + PROBE_BAR_HEIGHT,
+					PROBE_BINS*PROBE_BAR_WIDTH);
+		}
+	} else {
+		PROBE_reset();					// Held again: start over
+	}
+	PROBE_refresh();
+}
+
+
+/** ***************************************************************************
+ * @brief Redraw the values of the debug page and export them
+ *
+ * Does nothing if another screen is shown.
+ *****************************************************************************/
+void PROBE_refresh(void)
+{
+	if (DISP_SCREEN_DEBUG != DISP_get_screen()) {
+		return;
+	}
+	uint32_t us = SystemCoreClock / 1000000U;
+	FMT_text_t text;
+	DISP_dynamic_begin();
+	BSP_LCD_SetFont(&Font8);
+	BSP_LCD_SetBackColor(LCD_COLOR_WHITE);
+	for (uint32_t id = 0; id < PROBE_COUNT; id++) {
+		PROBE_stats_t stats;
+		PROBE_snapshot(&stats, id);
+		uint32_t y = PROBE_ROW_Y + id*PROBE_ROW_STEP;
+		uint32_t mean = (stats.count > 0U) ?
+				(uint32_t)(stats.sum / stats.count) : 0U;
+		FMT_clear(&text);
+		FMT_string(&text, PROBE_name[id]);
+		FMT_column(&text, 6);
+		FMT_uint(&text, (stats.count > 99999U) ? 99999U : stats.count, 5);
+		FMT_uint(&text, stats.min / us, 6);
+		FMT_uint(&text, mean / us, 6);
+		FMT_uint(&text, stats.max / us, 6);
+		BSP_LCD_SetTextColor(LCD_COLOR_DARKGRAY);
+		FMT_draw(&text, 5, y + 4, LEFT_MODE);
+		uint32_t full = 1;
+		for (uint32_t b = 0; b < PROBE_BINS; b++) {
+			if (stats.hist[b] > full) {
+				full = stats.hist[b];
+			}
+		}
+		BSP_LCD_SetTextColor(LCD_COLOR_BLUE);
+		for (uint32_t b = 0; b < PROBE_BINS; b++) {
+			uint32_t h = (stats.hist[b] * PROBE_BAR_HEIGHT + full - 1) / full;
+			if (h > 0) {
+				BSP_LCD_FillRect(PROBE_HIST_X + b*PROBE_BAR_WIDTH,
+						y + PROBE_BAR_HEIGHT - h, PROBE_BAR_WIDTH - 1, h);
+			}
+		}
+	}
+	PROBE_export();
+}
+
+
+/** ***************************************************************************
+ * @brief Write the statistics as CSV over the ITM stimulus port 0
+ *
+ * One line per probe: name, count, min, mean, max in CPU clock cycles,
+ * followed by the histogram bins.
+ * @n Returns at once if no debugger has enabled the ITM.
+ *****************************************************************************/
+void PROBE_export(void)
+{
+	PROBE_print("probe,count,min,mean,max,hist\r\n");
+	for (uint32_t id = 0; id < PROBE_COUNT; id++) {
+		PROBE_stats_t stats;
+		PROBE_snapshot(&stats, id);
+		uint32_t mean = (stats.count > 0U) ?
+				(uint32_t)(stats.sum / stats.count) : 0U;
+		PROBE_print(PROBE_name[id]);
+		PROBE_print_value(stats.count);
+		PROBE_print_value(stats.min);
+		PROBE_print_value(mean);
+		PROBE_print_value(stats.max);
+		for (uint32_t b = 0; b < PROBE_BINS; b++) {
+			PROBE_print_value(stats.hist[b]);
+		}
+		PROBE_print("\r\n");
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Consistent copy of the statistics of a probe
+ * @param copy destination
+ * @param id the probe
+ *
+ * The handlers may record while the main loop reads.
+ *****************************************************************************/
+static void PROBE_snapshot(PROBE_stats_t *copy, PROBE_id_t id)
+{
+	__disable_irq();
+	*copy = PROBE_stats[id];
+	__enable_irq();
+}
+
+
+/** ***************************************************************************
+ * @brief Write a string to the ITM stimulus port 0
+ * @param text zero terminated
+ *****************************************************************************/
+static void PROBE_print(const char *text)
+{
+	while ('\0' != *text) {
+		ITM_SendChar((uint8_t)*text++);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Write a comma and a value to the ITM stimulus port 0
+ * @param value unsigned decimal
+ *****************************************************************************/
+static void PROBE_print_value(uint32_t value)
+{
+	char text[PROBE_TEXT_LEN];
+	FMT_text_t glyphs;
+	FMT_clear(&glyphs);
+	FMT_string(&glyphs, ",");
+	FMT_uint(&glyphs, value, 0);
+	FMT_chars(&glyphs, text, sizeof(text));
+	PROBE_print(text);
+}
+
+#endif
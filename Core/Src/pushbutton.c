@@ -18,6 +18,7 @@
 #include "stm32f429i_discovery.h"
 
 #include "pushbutton.h"
+#include "events.h"
 
 
 /******************************************************************************
@@ -28,7 +29,7 @@
 /******************************************************************************
  * Variables
  *****************************************************************************/
-static bool PB_pressed_flag = false;	///< USER pushbutton pressed flag
+static volatile bool PB_pressed_flag = false;	///< USER pushbutton pressed flag
 
 
 /******************************************************************************
@@ -68,12 +69,13 @@ void PB_enableIRQ(void)
  * @brief Was the pushbutton pressed?
  *
  * @return true if pushbutton was pressed
+ *
+ * Reading and resetting the flag is one exclusive access,
+ * a press in between cannot get lost.
  *****************************************************************************/
 bool PB_pressed(void)
 {
-	bool pressed = PB_pressed_flag;		// Read/store value of flag
-	PB_pressed_flag = false;			// Reset flag
-	return pressed;
+	return __atomic_exchange_n(&PB_pressed_flag, false, __ATOMIC_RELAXED);
 }
 
 
@@ -88,6 +90,7 @@ void EXTI0_IRQHandler(void)
 	if (EXTI->PR & EXTI_PR_PR0) {		// Check if interrupt on line 0
 		EXTI->PR |= EXTI_PR_PR0;		// Clear pending interrupt on line 0
 		PB_pressed_flag = true;			// Set flag
+		EVT_post(EVT_BUTTON);			// Wake up the main loop
 	}
 }
 
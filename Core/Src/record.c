@@ -0,0 +1,316 @@
+/** ***************************************************************************
+ * @file
+ * @brief Long recordings of the continuous mode in an SDRAM ring
+ *
+ * ==============================================================
+ *
+ * The capture (capture.c) keeps the first frames after reset.
+ * The recorder keeps the last minutes of the continuous mode,
+ * e.g. to catch an intermittent fault on a cable.
+ *
+ * Every half buffer of ADC_samples becomes a block of the ring,
+ * REC_block_t, the oldest block is overwritten.
+ * The ADC interrupt handler calls REC_put(), which writes the header
+ * and starts BSP_SDRAM_WriteData_DMA() for the samples.
+ * The memory to memory DMA (DMA2_Stream0) copies them while the ADC fills
+ * the other half, the CPU does not wait for the SDRAM.
+ * A half which arrives while the DMA is still busy is not recorded and
+ * counted in REC_dropped and in the next block.
+ * @n With 496 bytes per 50 ms the 6.4 MByte behind the capture
+ * hold about 11 minutes, see REC_seconds().
+ *
+ * Readback by random access, from the main loop:
+ * - REC_range() gives the recorded samples still in the ring.
+ *   Samples are numbered from REC_start() on, dropped halves get no numbers.
+ * - REC_read() copies any samples of that range, e.g. a window for the
+ *   post-analysis or the display.
+ * - REC_frame() gives one block as frame, which can be fed to
+ *   MEAS_sort_data() and the views or written to a capture with CAP_put().
+ *
+ * A block is valid once its DMA is done, the header then has its
+ * sequence number and count.
+ * The readers check after copying that the block was not overwritten
+ * in the meantime.
+ *
+ * Export the ring with the debugger like the capture, see capture.c.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "stm32f429i_discovery_sdram.h"
+
+#include "record.h"
+#include "placement.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define REC_BLOCK_WORDS		(REC_BLOCK_SAMPLES*INPUTS_NUMS)	///< Per DMA
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+volatile uint32_t REC_dropped = 0;		///< Halves not recorded, DMA was busy
+
+static REC_block_t *REC_ring = NULL;	///< Blocks in the SDRAM
+static uint32_t REC_capacity = 0;		///< Blocks in the ring
+static volatile bool REC_running = false;	///< REC_put() records
+static volatile bool REC_busy = false;	///< DMA of the newest block active
+static volatile uint32_t REC_head = 0;	///< Blocks started since REC_start()
+static volatile uint32_t REC_done = 0;	///< Blocks finished by the DMA
+static uint32_t REC_lost = 0;			///< Halves dropped since REC_start()
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static bool REC_copy(uint32_t block, uint32_t offset, uint32_t count,
+		uint32_t *samples, REC_block_t *header);
+
+
+/** ***************************************************************************
+ * @brief Set up the ring, stopped
+ * @param base word aligned, REC_SDRAM_ADDR on the target
+ * @param size bytes, REC_SDRAM_SIZE on the target
+ *****************************************************************************/
+void REC_init(void *base, uint32_t size)
+{
+	REC_running = false;
+	REC_ring = (REC_block_t *)base;
+	REC_capacity = size / sizeof(REC_block_t);
+	REC_head = REC_done = 0;
+}
+
+
+/** ***************************************************************************
+ * @brief Discard the recording and record from now on
+ *
+ * Waits for the DMA of a block in progress, a few microseconds.
+ *****************************************************************************/
+void REC_start(void)
+{
+	REC_running = false;
+	while (REC_busy) { ; }				// The callback writes into the ring
+	REC_head = REC_done = 0;
+	REC_lost = 0;
+	REC_running = (REC_capacity > 0);
+}
+
+
+/** ***************************************************************************
+ * @brief Stop recording, the ring can still be read
+ *****************************************************************************/
+void REC_stop(void)
+{
+	REC_running = false;
+}
+
+
+/** ***************************************************************************
+ * @brief Record a half buffer of the continuous mode
+ * @param samples interleaved like ADC_samples, must stay unchanged until
+ * the DMA is done: the ADC fills the other half meanwhile
+ * @param count samples per input, other counts than REC_BLOCK_SAMPLES
+ * (single acquisitions) are not recorded
+ *
+ * Called by the ADC interrupt handler, does not wait.
+ *****************************************************************************/
+PLACE_RAMFUNC void REC_put(const uint32_t *samples, uint32_t count)
+{
+	if (!REC_running || (REC_BLOCK_SAMPLES != count)) {
+		return;
+	}
+	if (REC_busy) {						// Should not happen at 20 halves/s
+		REC_dropped++;
+		REC_lost++;
+		return;
+	}
+	uint32_t seq = REC_head;
+	REC_block_t *block = &REC_ring[seq % REC_capacity];
+	block->count = 0;					// Not valid until the DMA is done
+	block->seq = seq;
+	block->time = HAL_GetTick();
+	block->dropped = REC_lost;
+	REC_busy = true;					// Before the start, the host finishes at once
+	REC_head = seq + 1;
+	if (SDRAM_OK != BSP_SDRAM_WriteData_DMA((uint32_t)block->samples,
+			(uint32_t *)samples, REC_BLOCK_WORDS)) {
+		REC_done = seq + 1;				// Block stays invalid
+		REC_busy = false;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Recorded samples still in the ring
+ * @param first set to the number of the oldest sample per input
+ * @param end set to the number after the newest sample
+ *
+ * The oldest block is left out, it may be overwritten any moment.
+ *****************************************************************************/
+void REC_range(uint32_t *first, uint32_t *end)
+{
+	uint32_t done = REC_done;
+	uint32_t head = REC_head;
+	uint32_t oldest = (head + 1 > REC_capacity) ? head + 1 - REC_capacity : 0;
+	if (oldest > done) {
+		oldest = done;
+	}
+	*first = oldest * REC_BLOCK_SAMPLES;
+	*end = done * REC_BLOCK_SAMPLES;
+}
+
+
+/** ***************************************************************************
+ * @brief Copy recorded samples, random access
+ * @param first number of the first sample, see REC_range()
+ * @param count samples per input
+ * @param samples count*INPUTS_NUMS words, interleaved like ADC_samples
+ * @return samples per input copied, less than count where the range ends
+ * or the ring has overwritten the samples
+ *****************************************************************************/
+uint32_t REC_read(uint32_t first, uint32_t count, uint32_t *samples)
+{
+	uint32_t copied = 0;
+	while (copied < count) {
+		uint32_t block = (first + copied) / REC_BLOCK_SAMPLES;
+		uint32_t offset = (first + copied) % REC_BLOCK_SAMPLES;
+		uint32_t n = REC_BLOCK_SAMPLES - offset;
+		if (n > count - copied) {
+			n = count - copied;
+		}
+		if (!REC_copy(block, offset, n, &samples[copied*INPUTS_NUMS], NULL)) {
+			break;
+		}
+		copied += n;
+	}
+	return copied;
+}
+
+
+/** ***************************************************************************
+ * @brief Copy one block as frame
+ * @param block number, REC_range() / REC_BLOCK_SAMPLES
+ * @param frame set up like a frame of the frame ring, but the time is
+ * HAL_GetTick() and overruns are the halves dropped before the block
+ * @param samples REC_BLOCK_SAMPLES*INPUTS_NUMS words for the frame
+ * @return false if the block is not in the ring
+ *****************************************************************************/
+bool REC_frame(uint32_t block, FRAME_t *frame, uint32_t *samples)
+{
+	REC_block_t header;
+	if (!REC_copy(block, 0, REC_BLOCK_SAMPLES, samples, &header)) {
+		return false;
+	}
+	REC_block_t before;
+	uint32_t lost = 0;
+	if ((block > 0) && REC_copy(block - 1, 0, 0, NULL, &before)) {
+		lost = header.dropped - before.dropped;
+	}
+	frame->samples = samples;
+	frame->count = REC_BLOCK_SAMPLES;
+	frame->seq = header.seq;
+	frame->time = header.time;
+	frame->overruns = lost;
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Length of the ring
+ * @return seconds of the continuous mode the ring holds
+ *****************************************************************************/
+uint32_t REC_seconds(void)
+{
+	return REC_capacity * REC_BLOCK_SAMPLES / ADC_FS;
+}
+
+
+/** ***************************************************************************
+ * @brief Number of the first sample of the next block
+ * @return samples per input started since REC_start()
+ *
+ * Called by the ADC interrupt handlers to number a sample
+ * of the half being filled, see trigger.c.
+ *****************************************************************************/
+PLACE_RAMFUNC uint32_t REC_position(void)
+{
+	return REC_head * REC_BLOCK_SAMPLES;
+}
+
+
+/** ***************************************************************************
+ * @brief Copy samples of one block if it is valid
+ * @param block number since REC_start()
+ * @param offset first sample per input in the block
+ * @param count samples per input
+ * @param samples count*INPUTS_NUMS words
+ * @param header set to the header, may be NULL
+ * @return false if the block is not finished or overwritten
+ *****************************************************************************/
+static bool REC_copy(uint32_t block, uint32_t offset, uint32_t count,
+		uint32_t *samples, REC_block_t *header)
+{
+	if ((0 == REC_capacity) || (block >= REC_done)) {
+		return false;
+	}
+	const REC_block_t *slot = &REC_ring[block % REC_capacity];
+	if ((slot->seq != block) || (REC_BLOCK_SAMPLES != slot->count)) {
+		return false;
+	}
+	if (NULL != header) {
+		memcpy(header, slot, offsetof(REC_block_t, samples));
+	}
+	if (count > 0) {
+		memcpy(samples, &slot->samples[offset*INPUTS_NUMS],
+				count*INPUTS_NUMS*sizeof(samples[0]));
+	}
+	return REC_head - block <= REC_capacity;	// Not started to overwrite
+}
+
+
+/** ***************************************************************************
+ * @brief The DMA has copied the samples of the newest block
+ * @param hdma unused
+ *
+ * Called by HAL_DMA_IRQHandler(), overrides the weak HAL function.
+ *****************************************************************************/
+void HAL_SDRAM_DMA_XferCpltCallback(DMA_HandleTypeDef *hdma)
+{
+	(void)hdma;
+	REC_ring[REC_done % REC_capacity].count = REC_BLOCK_SAMPLES;
+	REC_done++;
+	REC_busy = false;
+}
+
+
+/** ***************************************************************************
+ * @brief The DMA failed, the newest block stays invalid
+ * @param hdma unused
+ *****************************************************************************/
+void HAL_SDRAM_DMA_XferErrorCallback(DMA_HandleTypeDef *hdma)
+{
+	(void)hdma;
+	REC_done++;
+	REC_busy = false;
+}
+
+
+/** ***************************************************************************
+ * @brief Interrupt handler of the SDRAM DMA, DMA2_Stream0
+ *****************************************************************************/
+void DMA2_Stream0_IRQHandler(void)
+{
+	BSP_SDRAM_DMA_IRQHandler();
+}
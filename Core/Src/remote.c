@@ -0,0 +1,341 @@
+/** ***************************************************************************
+ * @file
+ * @brief Remote control over USART1 for test rigs
+ *
+ * ==============================================================
+ *
+ * A test rig sends commands to the ST-LINK virtual COM port instead of
+ * touching the menu, the results come back as telemetry (telemetry.c).
+ * Host/build/teldec sends the commands, see there.
+ *
+ * A command is a packet like the telemetry packets: sync, type
+ * (REM_command_t), TEL_VERSION, sequence number, length, payload and CRC.
+ * Every valid command is answered by a TEL_REPLY packet with its type,
+ * status (REM_status_t) and sequence number.
+ * Packets with a wrong CRC are ignored, the rig repeats them after
+ * missing the reply.
+ *
+ * Commands, payloads little endian:
+ * | Type         | Payload | Effect                                       |
+ * |--------------|---------|----------------------------------------------|
+ * | REM_MODE     | u8      | REM_mode_t of the following measurements     |
+ * | REM_MEASURE  | u16     | Number of measurements, 0 stops              |
+ * | REM_WINDOW   | u16     | CALC_window, CALC_WINDOW_MIN .. ADC_NUMS     |
+ * | REM_STREAM   | u32     | TEL_mask, e.g. 1 << TEL_RESULT               |
+ * | REM_HEADLESS | u8      | 1 = results are not rendered, 0 = shown      |
+ * | REM_TRIGGER  | 10 B    | Arm the trigger, see below                   |
+ * | REM_PRECISION| u16     | SEQ_precision in mm, 0 = fixed window        |
+ *
+ * REM_TRIGGER payload: u8 input (TRIG_ALL_INPUTS = all), u8 0, u16 low,
+ * u16 high, u16 pre, u16 post, see TRIG_config_t. post = 0 disarms.
+ * The live view is started if needed, the frozen window is sent as
+ * TEL_TRIGGER packets.
+ *
+ * The measurements run back to back: main starts the next one when
+ * REM_done() announces the result of the last, so the rate is given
+ * by the acquisition.
+ * Wire and cable measurements stop as soon as the distance is known to
+ * REM_PRECISION mm, see sequential.c.
+ * With REM_HEADLESS the result screens are not drawn at all.
+ *
+ * Receiving: DMA2_Stream5 writes the bytes into a circular buffer,
+ * the idle line interrupt of the USART posts EVT_REMOTE.
+ * REM_poll() parses the new bytes in the main loop.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include "stm32f4xx.h"
+#include "stm32f4xx_hal.h"
+
+#include "remote.h"
+#include "calculations.h"
+#include "events.h"
+#include "measuring.h"
+#include "placement.h"
+#include "sequential.h"
+#include "telemetry.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define REM_PACKET_SIZE		(TEL_HEADER_SIZE + REM_MAX_PAYLOAD + TEL_CRC_SIZE)
+/** All interrupt flags of DMA2_Stream5 */
+#define REM_DMA_FLAGS		(DMA_HIFCR_CTCIF5 | DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTEIF5 \
+		| DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CFEIF5)
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+bool REM_headless = false;				///< Results are not rendered
+uint32_t REM_lost = 0;					///< Measurements given up, no result
+
+static uint8_t REM_rx[REM_RX_SIZE] PLACE_DMA;	///< Written by the DMA, circular
+static uint32_t REM_read = 0;			///< Next byte of REM_rx to parse
+static uint8_t REM_packet[REM_PACKET_SIZE];	///< Command being received
+static uint32_t REM_fill = 0;			///< Bytes in REM_packet
+static REM_mode_t REM_mode = REM_WIRE;	///< Mode of the next measurements
+static uint32_t REM_count = 0;			///< Measurements still to start
+static bool REM_busy = false;			///< A measurement is running
+static uint32_t REM_started = 0;		///< HAL_GetTick() of its start
+static TRIG_config_t REM_trigger_config;	///< Setup of the last REM_TRIGGER
+static bool REM_trigger_request = false;	///< REM_TRIGGER not yet executed
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static bool REM_feed(uint8_t byte);
+static REM_status_t REM_execute(uint32_t type, const uint8_t *p, uint32_t n);
+
+
+/** ***************************************************************************
+ * @brief Enable the receiver of USART1 with its DMA
+ *
+ * TEL_init() must have configured the USART and the pins.
+ *****************************************************************************/
+void REM_init(void)
+{
+	REM_read = REM_fill = 0;
+	REM_count = 0;
+	REM_busy = false;
+	DMA2_Stream5->CR &= ~DMA_SxCR_EN;	// Disable the DMA stream 5
+	while (DMA2_Stream5->CR & DMA_SxCR_EN) { ; }	// Wait for DMA to finish
+	DMA2->HIFCR = REM_DMA_FLAGS;		// Clear interrupt flags
+	DMA2_Stream5->CR = DMA_SxCR_CHSEL_2	// Channel 4 = USART1_RX
+			| DMA_SxCR_MINC				// Increment memory address pointer
+			| DMA_SxCR_CIRC;			// Restart at the end of the buffer
+	DMA2_Stream5->NDTR = REM_RX_SIZE;
+	DMA2_Stream5->PAR = (uint32_t)&USART1->DR;
+	DMA2_Stream5->M0AR = (uint32_t)REM_rx;
+	DMA2_Stream5->CR |= DMA_SxCR_EN;	// Enable DMA
+
+	USART1->CR3 |= USART_CR3_DMAR;		// Receive by DMA
+	USART1->CR1 |= USART_CR1_RE | USART_CR1_IDLEIE;	// Interrupt after a burst
+	NVIC_ClearPendingIRQ(USART1_IRQn);
+	NVIC_EnableIRQ(USART1_IRQn);
+}
+
+
+/** ***************************************************************************
+ * @brief Execute the commands received since the last call
+ * @return true if a command was executed
+ *
+ * Called by the remote task in main, released by EVT_REMOTE.
+ *****************************************************************************/
+bool REM_poll(void)
+{
+	bool executed = false;
+	uint32_t write = (REM_RX_SIZE - DMA2_Stream5->NDTR) % REM_RX_SIZE;
+	while (REM_read != write) {
+		executed = REM_feed(REM_rx[REM_read]) || executed;
+		REM_read = (REM_read + 1) % REM_RX_SIZE;
+	}
+	return executed;
+}
+
+
+/** ***************************************************************************
+ * @brief Next measurement to start
+ * @param mode set to the selected measurement
+ * @return true if main shall start a single acquisition now
+ *
+ * A measurement without result after REM_TIMEOUT ms, e.g. stopped from the
+ * menu, is counted in REM_lost and the next one is started.
+ *****************************************************************************/
+bool REM_next(REM_mode_t *mode)
+{
+	if (REM_busy && (HAL_GetTick() - REM_started > REM_TIMEOUT)) {
+		REM_busy = false;
+		REM_lost++;
+	}
+	if (REM_busy || (0 == REM_count)) {
+		return false;
+	}
+	REM_count--;
+	REM_busy = true;
+	REM_started = HAL_GetTick();
+	*mode = REM_mode;
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief A single acquisition has been evaluated
+ *
+ * Releases the remote task for the next measurement.
+ * Results of measurements from the menu are ignored.
+ *****************************************************************************/
+void REM_done(void)
+{
+	if (REM_busy) {
+		REM_busy = false;
+		if (REM_count > 0) {
+			EVT_post(EVT_REMOTE);
+		}
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Trigger setup received by REM_TRIGGER
+ * @param config set to the setup, post = 0 means disarm
+ * @return true once per received command
+ *****************************************************************************/
+bool REM_trigger(TRIG_config_t *config)
+{
+	if (!REM_trigger_request) {
+		return false;
+	}
+	REM_trigger_request = false;
+	*config = REM_trigger_config;
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Measurements not yet finished
+ * @return remaining measurements including the running one
+ *****************************************************************************/
+uint32_t REM_pending(void)
+{
+	return REM_count + (REM_busy ? 1 : 0);
+}
+
+
+/** ***************************************************************************
+ * @brief Interrupt handler of USART1: the line went idle after bytes
+ *
+ * Reading SR and then DR clears the idle flag, the DMA has taken the data.
+ *****************************************************************************/
+void USART1_IRQHandler(void)
+{
+	if (USART1->SR & USART_SR_IDLE) {
+		(void)USART1->DR;
+		EVT_post(EVT_REMOTE);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Add a received byte to the command being received
+ * @param byte received
+ * @return true if a command was executed
+ *
+ * Executes and answers a complete command with a valid CRC.
+ * Bytes which cannot start a command are skipped.
+ *****************************************************************************/
+static bool REM_feed(uint8_t byte)
+{
+	REM_packet[REM_fill++] = byte;
+	while (REM_fill > 0) {
+		uint8_t *p = REM_packet;
+		uint32_t n = (REM_fill >= TEL_HEADER_SIZE) ? (p[6] | (p[7] << 8)) : 0;
+		bool bad = (TEL_SYNC0 != p[0])
+				|| ((REM_fill > 1) && (TEL_SYNC1 != p[1]))
+				|| ((REM_fill > 3) && (TEL_VERSION != p[3]))
+				|| (n > REM_MAX_PAYLOAD);
+		if (!bad && (REM_fill >= TEL_HEADER_SIZE)) {
+			uint32_t size = TEL_HEADER_SIZE + n + TEL_CRC_SIZE;
+			if (REM_fill < size) {
+				return false;
+			}
+			uint16_t crc = TEL_crc(0xFFFF, &p[2], TEL_HEADER_SIZE - 2 + n);
+			if (crc == (p[size-2] | (p[size-1] << 8))) {
+				uint8_t reply[4] = { p[2], 0, p[4], p[5] };
+				reply[1] = REM_execute(p[2], &p[TEL_HEADER_SIZE], n);
+				TEL_send(TEL_REPLY, reply, sizeof(reply));
+				REM_fill = 0;
+				return true;
+			}
+			bad = true;
+		}
+		if (!bad) {
+			return false;
+		}
+		REM_fill--;						// Resync one byte later
+		for (uint32_t i = 0; i < REM_fill; i++) {
+			p[i] = p[i+1];
+		}
+	}
+	return false;
+}
+
+
+/** ***************************************************************************
+ * @brief Execute a command
+ * @param type REM_command_t
+ * @param p payload
+ * @param n payload length
+ * @return status for the reply
+ *****************************************************************************/
+static REM_status_t REM_execute(uint32_t type, const uint8_t *p, uint32_t n)
+{
+	static const uint8_t length[REM_COMMANDS] = {
+			[REM_MODE] = 1, [REM_MEASURE] = 2, [REM_WINDOW] = 2,
+			[REM_STREAM] = 4, [REM_HEADLESS] = 1, [REM_TRIGGER] = 10,
+			[REM_PRECISION] = 2
+	};
+	if (type >= REM_COMMANDS) {
+		return REM_BAD_COMMAND;
+	}
+	if (n != length[type]) {
+		return REM_BAD_LENGTH;
+	}
+	uint32_t value = p[0];
+	for (uint32_t i = 1; (i < n) && (i < 4); i++) {
+		value |= (uint32_t)p[i] << (8*i);
+	}
+	switch (type) {
+	case REM_MODE:
+		if (value >= REM_MODES) {
+			return REM_BAD_VALUE;
+		}
+		REM_mode = (REM_mode_t)value;
+		break;
+	case REM_MEASURE:
+		REM_count = value;
+		EVT_post(EVT_REMOTE);			// Start at once
+		break;
+	case REM_WINDOW:
+		if ((value < CALC_WINDOW_MIN) || (value > ADC_NUMS)) {
+			return REM_BAD_VALUE;
+		}
+		CALC_window = value;
+		break;
+	case REM_STREAM:
+		TEL_mask = value;
+		break;
+	case REM_HEADLESS:
+		REM_headless = (0 != value);
+		break;
+	case REM_TRIGGER: {
+		TRIG_config_t config = {
+				.input = p[0], .low = p[2] | (p[3] << 8),
+				.high = p[4] | (p[5] << 8), .pre = p[6] | (p[7] << 8),
+				.post = p[8] | (p[9] << 8)
+		};
+		if ((config.post > 0) && !TRIG_check(&config)) {
+			return REM_BAD_VALUE;
+		}
+		REM_trigger_config = config;
+		REM_trigger_request = true;
+		EVT_post(EVT_REMOTE);
+		break;
+	}
+	case REM_PRECISION:
+		SEQ_precision = value;
+		break;
+	default:
+		break;
+	}
+	return REM_OK;
+}
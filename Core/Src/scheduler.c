@@ -0,0 +1,152 @@
+/** ***************************************************************************
+ * @file
+ * @brief Cooperative run-to-completion task scheduler
+ *
+ * ==============================================================
+ *
+ * All work outside of the interrupt handlers runs in tasks.
+ * A task is released by the events posted with EVT_post()
+ * and/or periodically, then it runs once to its end.
+ * @n Of all released tasks the one with the highest priority runs next,
+ * tasks of equal priority in the order of the task table.
+ * After each run the events are checked again, so a newly released task
+ * of higher priority runs before waiting tasks of lower priority.
+ * Tasks are never interrupted by other tasks, only by interrupt handlers.
+ * A long job has to be split into several runs to keep the others
+ * responsive, e.g. one frame per run.
+ * @n When no task is released the CPU sleeps in EVT_wait().
+ *
+ * Periods are multiples of EVT_TICK_PERIOD ms, SysTick posts EVT_TICK.
+ * @n For each task the DWT cycle counter gives the run time
+ * and the time from the release to the end of the run.
+ * If this is longer than the deadline, the run is counted as overrun.
+ * A release while the task is still waiting to run is counted as skipped.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include "stm32f4xx.h"
+
+#include "scheduler.h"
+#include "events.h"
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+SCHED_task_t *SCHED_tasks = NULL;		///< Task table of SCHED_run()
+uint32_t SCHED_task_count = 0;			///< Entries in the task table
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static void SCHED_release(SCHED_task_t *task, uint32_t now);
+static bool SCHED_check(uint32_t events);
+static void SCHED_execute(SCHED_task_t *task);
+
+
+/** ***************************************************************************
+ * @brief Run the tasks, never returns
+ * @param tasks task table
+ * @param count number of tasks
+ *****************************************************************************/
+void SCHED_run(SCHED_task_t *tasks, uint32_t count)
+{
+	uint32_t now = HAL_GetTick();
+	SCHED_tasks = tasks;
+	SCHED_task_count = count;
+	for (uint32_t i = 0; i < count; i++) {
+		tasks[i].due = now + tasks[i].period;
+	}
+	bool ready = false;
+	while (1) {
+		uint32_t events = ready ? EVT_poll() : EVT_wait();
+		ready = SCHED_check(events);
+		SCHED_task_t *next = NULL;
+		for (uint32_t i = 0; i < count; i++) {
+			if (tasks[i].ready
+					&& ((NULL == next) || (tasks[i].priority < next->priority))) {
+				next = &tasks[i];
+			}
+		}
+		if (NULL != next) {
+			SCHED_execute(next);
+			ready = true;				// Check the others without sleeping
+		}
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Release a task
+ * @param task the task
+ * @param now EVT_timestamp()
+ *****************************************************************************/
+static void SCHED_release(SCHED_task_t *task, uint32_t now)
+{
+	if (task->ready) {
+		task->skipped++;				// Previous release not yet served
+	} else {
+		task->ready = true;
+		task->release = now;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Release the tasks waiting for the events or their period
+ * @param events EVT_* bits taken from the event flags
+ * @return true if any task is ready
+ *****************************************************************************/
+static bool SCHED_check(uint32_t events)
+{
+	uint32_t now = EVT_timestamp();
+	uint32_t tick = HAL_GetTick();
+	bool ready = false;
+	for (uint32_t i = 0; i < SCHED_task_count; i++) {
+		SCHED_task_t *task = &SCHED_tasks[i];
+		if (events & task->events) {
+			SCHED_release(task, now);
+		}
+		if ((0U != task->period) && ((int32_t)(tick - task->due) >= 0)) {
+			SCHED_release(task, now);
+			task->due += task->period;
+			if ((int32_t)(tick - task->due) >= 0) {	// Fell behind, resync
+				task->due = tick + task->period;
+			}
+		}
+		ready |= task->ready;
+	}
+	return ready;
+}
+
+
+/** ***************************************************************************
+ * @brief Run a task once and update its statistics
+ * @param task the task
+ *****************************************************************************/
+static void SCHED_execute(SCHED_task_t *task)
+{
+	uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+	task->ready = false;
+	uint32_t start = EVT_timestamp();
+	task->run();
+	uint32_t end = EVT_timestamp();
+	uint32_t response = (end - task->release) / cycles_per_us;
+	task->runs++;
+	task->busy += end - start;
+	task->last = (end - start) / cycles_per_us;
+	if (response > task->max) {
+		task->max = response;
+	}
+	if (response > task->deadline) {
+		task->overruns++;
+	}
+}
@@ -0,0 +1,229 @@
+/** ***************************************************************************
+ * @file
+ * @brief Sequential measurement: acquire until the estimate is precise
+ *
+ * ==============================================================
+ *
+ * A single acquisition always takes ADC_NUMS samples and evaluates a fixed
+ * number of them, whether the field is strong and clean or weak and noisy.
+ * The sequential measurement runs the continuous mode instead and stops
+ * it as soon as the distance is known to SEQ_precision mm.
+ *
+ * SEQ_add() takes each half of the continuous mode after MEAS_sort_data().
+ * Every mains period (SEQ_PERIOD samples) gives one RMS value per input,
+ * periods run across the halves. The running mean and variance of these
+ * values are added to integer sums per input, nothing is stored.
+ * The RMS values have SEQ_FRACTION fraction bits, the whole estimate is
+ * integer arithmetic and the same on the host and the target.
+ * @n From the second period on the 95 % confidence interval of the mean
+ * (Student t) is mapped through the lookup table:
+ * - distance: CALC_distance_half() at both ends of the pad interval,
+ *   the half width in mm is the precision achieved
+ * - current: CALC_estimate_current() from the distance and the coil
+ *   interval, within SEQ_CURRENT_PRECISION
+ *
+ * The two pads and the two coils see the same conductor, so the half widths
+ * of the two inputs are averaged, not combined as if they were independent.
+ * @n The measurement ends when both are precise or after SEQ_MAX_PERIODS,
+ * the result tells which. A strong field is done after one half, 50 ms,
+ * instead of the 100 ms of a single acquisition.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <string.h>
+
+#include "sequential.h"
+#include "placement.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define SEQ_T_COUNT			20			///< Entries of SEQ_t95
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+uint32_t SEQ_precision = SEQ_PRECISION;	///< Requested half width in mm, 0 = off
+
+static bool SEQ_active = false;			///< A measurement is running
+static SEQ_stat_t SEQ_stat[INPUTS_NUMS] PLACE_CCM;	///< RMS values of the periods
+static uint32_t SEQ_sum[INPUTS_NUMS] PLACE_CCM;	///< Samples of the current period
+static uint32_t SEQ_squares[INPUTS_NUMS] PLACE_CCM;	///< Their squares
+static uint32_t SEQ_fill = 0;			///< Samples in the current period
+static SEQ_result_t SEQ_result;			///< Estimate after the last period
+
+/** Sorted samples of the inputs, see MEAS_sort_data() */
+static const int32_t *const SEQ_inputs[INPUTS_NUMS] = {
+		PAD1_samples, PAD2_samples, COIL1_samples, COIL2_samples
+};
+
+/** Student t times 100, 95 % two-sided, for 1 .. SEQ_T_COUNT degrees of freedom */
+static const uint32_t SEQ_t95[SEQ_T_COUNT] = {
+		1271, 430, 318, 278, 257, 245, 236, 231, 226, 223,
+		220, 218, 216, 214, 213, 212, 211, 210, 209, 209
+};
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static void SEQ_update(SEQ_stat_t *stat, uint32_t value);
+static uint32_t SEQ_half(const SEQ_stat_t *stat);
+static bool SEQ_evaluate(CALC_kind_t kind);
+
+
+/** ***************************************************************************
+ * @brief Start a new measurement, the last result is discarded
+ *
+ * The continuous mode must be started by the caller.
+ *****************************************************************************/
+void SEQ_begin(void)
+{
+	memset(SEQ_stat, 0, sizeof(SEQ_stat));
+	memset(SEQ_sum, 0, sizeof(SEQ_sum));
+	memset(SEQ_squares, 0, sizeof(SEQ_squares));
+	memset(&SEQ_result, 0, sizeof(SEQ_result));
+	SEQ_result.distance_half = -1;
+	SEQ_result.current_half = -1;
+	SEQ_fill = 0;
+	SEQ_active = true;
+}
+
+
+/** ***************************************************************************
+ * @brief A measurement is waiting for halves
+ * @return true between SEQ_begin() and the end of the measurement
+ *****************************************************************************/
+bool SEQ_running(void)
+{
+	return SEQ_active;
+}
+
+
+/** ***************************************************************************
+ * @brief Add the samples of a half
+ * @param kind wire or cable, selects the thresholds
+ * @param count samples per input in PAD1_samples ... COIL2_samples
+ * @return true when the measurement has ended, see SEQ_get()
+ *
+ * Samples after the end of the measurement are ignored.
+ *****************************************************************************/
+bool SEQ_add(CALC_kind_t kind, uint32_t count)
+{
+	if (!SEQ_active) {
+		return false;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		for (uint32_t in = 0; in < INPUTS_NUMS; in++) {
+			uint32_t value = (uint32_t)SEQ_inputs[in][i];
+			SEQ_sum[in] += value;
+			SEQ_squares[in] += value * value;
+		}
+		SEQ_result.samples++;
+		if (++SEQ_fill < SEQ_PERIOD) {
+			continue;
+		}
+		SEQ_fill = 0;					// One period: RMS without the offset
+		for (uint32_t in = 0; in < INPUTS_NUMS; in++) {
+			uint64_t var = (uint64_t)SEQ_PERIOD * SEQ_squares[in]
+					- (uint64_t)SEQ_sum[in] * SEQ_sum[in];
+			SEQ_update(&SEQ_stat[in],
+					CALC_sqrt64(var << (2 * SEQ_FRACTION)) / SEQ_PERIOD);
+			SEQ_sum[in] = SEQ_squares[in] = 0;
+		}
+		if (SEQ_evaluate(kind)) {
+			SEQ_active = false;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/** ***************************************************************************
+ * @brief Estimate of the running or the last measurement
+ * @param result set to the estimate after the last complete period
+ *****************************************************************************/
+void SEQ_get(SEQ_result_t *result)
+{
+	*result = SEQ_result;
+}
+
+
+/** ***************************************************************************
+ * @brief Add a value to the sums of an input
+ * @param stat statistics of one input
+ * @param value RMS value of a period, SEQ_FRACTION fraction bits
+ *****************************************************************************/
+static void SEQ_update(SEQ_stat_t *stat, uint32_t value)
+{
+	stat->n++;
+	stat->sum += value;
+	stat->squares += (uint64_t)value * value;
+}
+
+
+/** ***************************************************************************
+ * @brief Half width of the confidence interval of the mean
+ * @param stat statistics of one input
+ * @return 95 % half width, SEQ_FRACTION fraction bits, 0 below two values
+ *
+ * The variance of the mean is (n*sum(x^2) - sum(x)^2) / (n^2 * (n-1)),
+ * the numerator is exact.
+ *****************************************************************************/
+static uint32_t SEQ_half(const SEQ_stat_t *stat)
+{
+	if (stat->n < 2) {
+		return 0;
+	}
+	uint32_t df = (stat->n - 1 < SEQ_T_COUNT) ? stat->n - 1 : SEQ_T_COUNT;
+	uint64_t var = stat->n * stat->squares - (uint64_t)stat->sum * stat->sum;
+	var /= (uint64_t)stat->n * stat->n * (stat->n - 1);
+	return (SEQ_t95[df - 1] * CALC_sqrt64(var) + 50) / 100;
+}
+
+
+/** ***************************************************************************
+ * @brief Update the estimate after a period
+ * @param kind wire or cable
+ * @return true if the measurement ends
+ *****************************************************************************/
+static bool SEQ_evaluate(CALC_kind_t kind)
+{
+	uint32_t n = SEQ_stat[0].n;
+	int32_t e_val = (int32_t)(((SEQ_stat[0].sum + SEQ_stat[1].sum) / (2 * n))
+			>> SEQ_FRACTION);
+	int32_t b_val = (int32_t)(((SEQ_stat[2].sum + SEQ_stat[3].sum) / (2 * n))
+			>> SEQ_FRACTION);
+	SEQ_result_t *r = &SEQ_result;
+	r->kind = kind;
+	r->distance = CALC_distance(kind, e_val, &CALC_limits);
+	if (n < SEQ_MIN_PERIODS) {
+		r->current = CALC_estimate_current(r->distance, -1, b_val, -1, NULL);
+		r->first_distance = r->distance;
+		r->first_current = r->current;
+		return false;
+	}
+	/* Half widths rounded up to whole ADC counts */
+	const uint32_t up = (1U << SEQ_FRACTION) - 1;
+	int32_t e_half = (int32_t)(((SEQ_half(&SEQ_stat[0]) + SEQ_half(&SEQ_stat[1])) / 2
+			+ up) >> SEQ_FRACTION);
+	int32_t b_half = (int32_t)(((SEQ_half(&SEQ_stat[2]) + SEQ_half(&SEQ_stat[3])) / 2
+			+ up) >> SEQ_FRACTION);
+	r->distance_half = CALC_distance_half(kind, e_val, e_half);
+	r->current = CALC_estimate_current(r->distance, r->distance_half,
+			b_val, b_half, &r->current_half);
+	r->converged = (r->distance_half >= 0)
+			&& ((uint32_t)r->distance_half <= SEQ_precision)
+			&& (r->current_half >= 0) && (r->current_half <= SEQ_CURRENT_PRECISION);
+	return r->converged || (n >= SEQ_MAX_PERIODS);
+}
@@ -0,0 +1,204 @@
+/** ***************************************************************************
+ * @file
+ * @brief Sliding window statistics of the continuous mode
+ *
+ * ==============================================================
+ *
+ * Mean and standard deviation (the RMS value without the offset, like
+ * RMS()) of the last samples of every input, over several windows at once:
+ * STAT_SINGLE, STAT_ACCURATE and STAT_SECOND.
+ *
+ * The last STAT_HISTORY samples are kept in a ring.
+ * Every window has a running sum and sum of squares per input.
+ * A new sample is added to them and the sample which leaves the window
+ * is taken off, so an update costs the same for every window length.
+ * The queries only divide and take an integer square root.
+ *
+ * The sums are integers, so adding and taking off is exact and does not
+ * drift like floating point sums would. Every STAT_RESYNC samples the sums
+ * are still recalculated from the ring, which bounds the effect of
+ * anything that went wrong in between, e.g. a sample added while the
+ * ring was being reset. Differences are counted in STAT_mismatches.
+ * This costs STAT_WINDOWS additions per sample on average.
+ *
+ * Fed from main with the halves of the continuous mode, a half with
+ * overruns before it leaves a gap in the windows.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <string.h>
+
+#include "statistics.h"
+#include "calculations.h"
+#include "placement.h"
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+uint32_t STAT_mismatches = 0;			///< Running sums found wrong
+
+static uint16_t STAT_ring[STAT_HISTORY][INPUTS_NUMS] PLACE_CCM;	///< Last samples
+static uint32_t STAT_head = 0;			///< Next slot of STAT_ring
+static uint32_t STAT_filled = 0;		///< Samples in STAT_ring
+static uint32_t STAT_until_resync = STAT_RESYNC;	///< Samples to the next
+static uint32_t STAT_sum[STAT_WINDOWS][INPUTS_NUMS] PLACE_CCM;	///< Sums of the windows
+static uint64_t STAT_squares[STAT_WINDOWS][INPUTS_NUMS] PLACE_CCM;	///< Sums of squares
+
+/** Samples per window */
+static const uint32_t STAT_length[STAT_WINDOWS] = {
+		[STAT_SINGLE] = 10, [STAT_ACCURATE] = CALC_WINDOW,
+		[STAT_SECOND] = STAT_HISTORY
+};
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static void STAT_push(const uint32_t *samples);
+static void STAT_resync(void);
+
+
+/** ***************************************************************************
+ * @brief Empty all windows, e.g. when the continuous mode starts
+ *****************************************************************************/
+void STAT_reset(void)
+{
+	memset(STAT_sum, 0, sizeof(STAT_sum));
+	memset(STAT_squares, 0, sizeof(STAT_squares));
+	STAT_head = 0;
+	STAT_filled = 0;
+	STAT_until_resync = STAT_RESYNC;
+}
+
+
+/** ***************************************************************************
+ * @brief Add the samples of a frame to all windows
+ * @param frame half of the continuous stream, interleaved samples
+ *****************************************************************************/
+void STAT_add(const FRAME_t *frame)
+{
+	for (uint32_t i = 0; i < frame->count; i++) {
+		STAT_push(&frame->samples[i*INPUTS_NUMS]);
+		if (0 == --STAT_until_resync) {
+			STAT_until_resync = STAT_RESYNC;
+			STAT_resync();
+		}
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Samples in a window
+ * @param window STAT_SINGLE ...
+ * @return window length, less until enough samples have arrived
+ *****************************************************************************/
+uint32_t STAT_count(STAT_window_t window)
+{
+	return (STAT_filled < STAT_length[window]) ? STAT_filled : STAT_length[window];
+}
+
+
+/** ***************************************************************************
+ * @brief Mean of a window
+ * @param input 0 = PAD1 ... 3 = COIL2
+ * @param window STAT_SINGLE ...
+ * @return mean in ADC counts, 0 if empty
+ *****************************************************************************/
+int32_t STAT_mean(uint32_t input, STAT_window_t window)
+{
+	uint32_t n = STAT_count(window);
+	return (0 == n) ? 0 : (int32_t)(STAT_sum[window][input] / n);
+}
+
+
+/** ***************************************************************************
+ * @brief Standard deviation of a window, the RMS value without the offset
+ * @param input 0 = PAD1 ... 3 = COIL2
+ * @param window STAT_SINGLE ...
+ * @return standard deviation in ADC counts, 0 if empty
+ *
+ * n*sum(x^2) - sum(x)^2 is exact in 64 bits for 12 bit samples.
+ *****************************************************************************/
+int32_t STAT_deviation(uint32_t input, STAT_window_t window)
+{
+	uint32_t n = STAT_count(window);
+	if (0 == n) {
+		return 0;
+	}
+	uint64_t sum = STAT_sum[window][input];
+	uint64_t var = n * STAT_squares[window][input] - sum * sum;
+	return (int32_t)(CALC_sqrt64(var) / n);
+}
+
+
+/** ***************************************************************************
+ * @brief Add one sample of every input
+ * @param samples INPUTS_NUMS samples
+ *
+ * The sample leaving a window is read before the ring slot is overwritten,
+ * the longest window leaves at the slot itself.
+ *****************************************************************************/
+static void STAT_push(const uint32_t *samples)
+{
+	for (uint32_t w = 0; w < STAT_WINDOWS; w++) {
+		const uint16_t *leave = NULL;
+		if (STAT_filled >= STAT_length[w]) {
+			leave = STAT_ring[(STAT_head + STAT_HISTORY - STAT_length[w]) % STAT_HISTORY];
+		}
+		for (uint32_t in = 0; in < INPUTS_NUMS; in++) {
+			uint32_t value = samples[in];
+			STAT_sum[w][in] += value;
+			STAT_squares[w][in] += value * value;
+			if (NULL != leave) {
+				STAT_sum[w][in] -= leave[in];
+				STAT_squares[w][in] -= (uint32_t)leave[in] * leave[in];
+			}
+		}
+	}
+	for (uint32_t in = 0; in < INPUTS_NUMS; in++) {
+		STAT_ring[STAT_head][in] = (uint16_t)samples[in];
+	}
+	STAT_head = (STAT_head + 1) % STAT_HISTORY;
+	if (STAT_filled < STAT_HISTORY) {
+		STAT_filled++;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Recalculate the sums of all windows from the ring
+ *
+ * The longest window covers the ring, the shorter ones are its end,
+ * so one pass over the ring gives all sums.
+ *****************************************************************************/
+static void STAT_resync(void)
+{
+	uint32_t sum[STAT_WINDOWS][INPUTS_NUMS] = { { 0 } };
+	uint64_t squares[STAT_WINDOWS][INPUTS_NUMS] = { { 0 } };
+	for (uint32_t age = 1; age <= STAT_filled; age++) {
+		const uint16_t *s = STAT_ring[(STAT_head + STAT_HISTORY - age) % STAT_HISTORY];
+		for (uint32_t w = 0; w < STAT_WINDOWS; w++) {
+			if (age > STAT_length[w]) {
+				continue;
+			}
+			for (uint32_t in = 0; in < INPUTS_NUMS; in++) {
+				sum[w][in] += s[in];
+				squares[w][in] += (uint32_t)s[in] * s[in];
+			}
+		}
+	}
+	if ((0 != memcmp(sum, STAT_sum, sizeof(sum)))
+			|| (0 != memcmp(squares, STAT_squares, sizeof(squares)))) {
+		STAT_mismatches++;
+	}
+	memcpy(STAT_sum, sum, sizeof(sum));
+	memcpy(STAT_squares, squares, sizeof(squares));
+}
@@ -28,6 +28,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f4xx_it.h"
 #include "stm32f4xx_hal.h"
+#include "events.h"
 
 
 /* Private typedef -----------------------------------------------------------*/
@@ -138,6 +139,7 @@ void PendSV_Handler(void)
 void SysTick_Handler(void)
 {
 	HAL_IncTick();
+	EVT_tick();
 }
 
 
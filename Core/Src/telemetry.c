@@ -0,0 +1,476 @@
+/** ***************************************************************************
+ * @file
+ * @brief Framed binary telemetry over USART1 with DMA
+ *
+ * ==============================================================
+ *
+ * Sends results, raw frames, spectra and profiling counters as packets
+ * to the ST-LINK virtual COM port (USART1, PA9 = TX, TEL_BAUD 8N1).
+ * Host/build/teldec decodes them.
+ *
+ * Packet, all fields little endian:
+ * | Offset | Size | Content                                          |
+ * |--------|------|--------------------------------------------------|
+ * | 0      | 2    | TEL_SYNC0, TEL_SYNC1                             |
+ * | 2      | 1    | Type, TEL_type_t                                 |
+ * | 3      | 1    | TEL_VERSION                                      |
+ * | 4      | 2    | Sequence number per type, counts dropped packets |
+ * | 6      | 2    | Payload length n, max. TEL_MAX_PAYLOAD           |
+ * | 8      | n    | Payload                                          |
+ * | 8+n    | 2    | CRC-16/CCITT-FALSE of the bytes 2 .. 7+n         |
+ *
+ * Payloads, u = unsigned, i = signed, number = bits:
+ * - TEL_RESULT: u8 DISP_screen_t, 3 x u8 0, u32 state,
+ *   DISP_VALUES x i32 values
+ * - TEL_FRAME: u32 seq, u32 time, u16 count, u16 overruns,
+ *   count x INPUTS_NUMS x u16 samples interleaved like ADC_samples
+ * - TEL_SPECTRUM: u32 frame seq, u16 bins, u16 0, bins x u32 magnitude
+ * - TEL_PROFILE: u32 HAL_GetTick(), u32 FRAME_overruns, u32 REC_dropped,
+ *   TEL_TYPES x u32 TEL_dropped,
+ *   PIPE_STAGES x (u32 occupancy %, u32 max us),
+ *   u32 tasks, tasks x (u32 runs, u32 overruns, u32 max us),
+ *   u32 probes (0 without PROBE_ENABLE),
+ *   probes x (u32 count, u32 min, u32 max, u32 mean) in cycles
+ * - TEL_REPLY: u8 command type, u8 REM_status_t, u16 command sequence number
+ * - TEL_TRIGGER: u32 trigger sample, u32 trigger time, u16 samples before
+ *   the trigger, u16 samples of the window, u16 offset, u16 count,
+ *   count x INPUTS_NUMS x u16 samples of the window from offset on
+ *
+ * The packets are queued in a ring of TEL_BUFFER_SIZE bytes.
+ * The DMA (DMA2_Stream7) sends the ring up to its end or the newest
+ * packet, the transfer complete interrupt starts the rest.
+ * @n Nothing ever waits for the serial port.
+ * When the ring is too full a packet is dropped, counted in TEL_dropped
+ * and its sequence number skipped, so the host sees the gap.
+ * Frames and spectra must leave TEL_RESERVE bytes free,
+ * results and profiles still get through when the port is saturated.
+ * @n Types cleared in TEL_mask are not sent at all, e.g. only results
+ * for a test rig (see remote.c). Replies are always sent.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <string.h>
+#include "stm32f4xx.h"
+#include "stm32f4xx_hal.h"
+
+#include "telemetry.h"
+#include "measuring.h"
+#include "pipeline.h"
+#include "placement.h"
+#include "probe.h"
+#include "record.h"
+#include "scheduler.h"
+#include "trigger.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define TEL_MASK			(TEL_BUFFER_SIZE-1)	///< Index wrap around
+#define TEL_PCLK			(SystemCoreClock/2)	///< APB2, see SystemClock_Config()
+/** All interrupt flags of DMA2_Stream7 */
+#define TEL_DMA_FLAGS		(DMA_HIFCR_CTCIF7 | DMA_HIFCR_CHTIF7 | DMA_HIFCR_CTEIF7 \
+		| DMA_HIFCR_CDMEIF7 | DMA_HIFCR_CFEIF7)
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+uint32_t TEL_sent[TEL_TYPES];			///< Packets queued per type
+uint32_t TEL_dropped[TEL_TYPES];		///< Packets dropped per type, ring full
+uint32_t TEL_mask = TEL_MASK_ALL;		///< Bit 1 << type set = type is sent
+
+static uint8_t TEL_buffer[TEL_BUFFER_SIZE] PLACE_DMA;	///< Transmit ring
+static volatile uint32_t TEL_head = 0;	///< Bytes queued, written by main
+static volatile uint32_t TEL_tail = 0;	///< Bytes sent, written by the ISR
+static volatile uint32_t TEL_chunk = 0;	///< Bytes of the running DMA, 0 = idle
+static uint16_t TEL_seq[TEL_TYPES];		///< Next sequence number per type
+
+/** CRC-16/CCITT-FALSE, polynomial 0x1021, one entry per nibble */
+static const uint16_t TEL_crc_table[16] = {
+		0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+		0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static uint32_t TEL_write(uint32_t position, const uint8_t *data,
+		uint32_t length);
+static void TEL_start_next(void);
+static bool TEL_room(TEL_type_t type, uint32_t length);
+static uint8_t *TEL_put16(uint8_t *p, uint32_t value);
+static uint8_t *TEL_put32(uint8_t *p, uint32_t value);
+
+
+/** ***************************************************************************
+ * @brief Configure USART1 and its transmit DMA
+ *****************************************************************************/
+void TEL_init(void)
+{
+	GPIO_InitTypeDef gpio = {0};
+	__HAL_RCC_GPIOA_CLK_ENABLE();
+	__HAL_RCC_USART1_CLK_ENABLE();
+	__HAL_RCC_DMA2_CLK_ENABLE();
+	gpio.Pin = GPIO_PIN_9 | GPIO_PIN_10;	// TX, RX for a later command port
+	gpio.Mode = GPIO_MODE_AF_PP;
+	gpio.Pull = GPIO_PULLUP;
+	gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+	gpio.Alternate = GPIO_AF7_USART1;
+	HAL_GPIO_Init(GPIOA, &gpio);
+
+	TEL_head = TEL_tail = TEL_chunk = 0;
+	memset(TEL_sent, 0, sizeof(TEL_sent));
+	memset(TEL_dropped, 0, sizeof(TEL_dropped));
+	memset(TEL_seq, 0, sizeof(TEL_seq));
+	TEL_mask = TEL_MASK_ALL;
+
+	USART1->CR1 = 0;
+	USART1->BRR = (TEL_PCLK + TEL_BAUD/2) / TEL_BAUD;	// Oversampling by 16
+	USART1->CR3 = USART_CR3_DMAT;		// Transmit by DMA
+	USART1->CR1 = USART_CR1_UE | USART_CR1_TE;
+
+	DMA2_Stream7->CR &= ~DMA_SxCR_EN;	// Disable the DMA stream 7
+	while (DMA2_Stream7->CR & DMA_SxCR_EN) { ; }	// Wait for DMA to finish
+	DMA2->HIFCR = TEL_DMA_FLAGS;		// Clear interrupt flags
+	DMA2_Stream7->CR = DMA_SxCR_CHSEL_2	// Channel 4 = USART1_TX
+			| DMA_SxCR_DIR_0			// Memory to peripheral
+			| DMA_SxCR_MINC				// Increment memory address pointer
+			| DMA_SxCR_TCIE | DMA_SxCR_TEIE;	// Interrupt when done or failed
+	DMA2_Stream7->PAR = (uint32_t)&USART1->DR;
+	NVIC_ClearPendingIRQ(DMA2_Stream7_IRQn);
+	NVIC_EnableIRQ(DMA2_Stream7_IRQn);
+}
+
+
+/** ***************************************************************************
+ * @brief Queue a packet and start the DMA if it is idle
+ * @param type of the packet
+ * @param payload bytes
+ * @param length bytes of the payload, max. TEL_MAX_PAYLOAD
+ * @return false if dropped because the ring is too full or masked
+ *
+ * Called from main only, never waits.
+ *****************************************************************************/
+bool TEL_send(TEL_type_t type, const uint8_t *payload, uint32_t length)
+{
+	uint8_t header[TEL_HEADER_SIZE];
+	uint8_t crc[TEL_CRC_SIZE];
+	uint32_t size = TEL_HEADER_SIZE + length + TEL_CRC_SIZE;
+	if ((TEL_REPLY != type) && !(TEL_mask & (1UL << type))) {
+		return false;					// Not wanted, no sequence number
+	}
+	uint32_t seq = TEL_seq[type]++;		// Also counts dropped packets
+	if (!TEL_room(type, length)) {
+		TEL_dropped[type]++;
+		return false;
+	}
+	header[0] = TEL_SYNC0;
+	header[1] = TEL_SYNC1;
+	header[2] = (uint8_t)type;
+	header[3] = TEL_VERSION;
+	TEL_put16(&header[4], seq);
+	TEL_put16(&header[6], length);
+	uint16_t c = TEL_crc(0xFFFF, &header[2], TEL_HEADER_SIZE - 2);
+	TEL_put16(crc, TEL_crc(c, payload, length));
+	uint32_t position = TEL_head;
+	position = TEL_write(position, header, sizeof(header));
+	position = TEL_write(position, payload, length);
+	TEL_write(position, crc, sizeof(crc));
+	TEL_head += size;					// Visible to the ISR when complete
+	TEL_sent[type]++;
+
+	NVIC_DisableIRQ(DMA2_Stream7_IRQn);	// ISR must not start in between
+	if (0 == TEL_chunk) {
+		TEL_start_next();
+	}
+	NVIC_EnableIRQ(DMA2_Stream7_IRQn);
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Send the values of a result screen
+ * @param result from DISP_calc_wire() / cable() / angle()
+ * @return false if dropped
+ *****************************************************************************/
+bool TEL_result(const DISP_result_t *result)
+{
+	uint8_t payload[8 + 4*DISP_VALUES];
+	uint8_t *p = payload;
+	*p++ = (uint8_t)result->layout->screen;
+	*p++ = 0;
+	*p++ = 0;
+	*p++ = 0;
+	p = TEL_put32(p, result->state);
+	for (uint32_t i = 0; i < DISP_VALUES; i++) {
+		p = TEL_put32(p, (uint32_t)result->values[i]);
+	}
+	return TEL_send(TEL_RESULT, payload, p - payload);
+}
+
+
+/** ***************************************************************************
+ * @brief Send the raw samples of a frame
+ * @param frame single acquisition or half of the continuous stream
+ * @return false if dropped
+ *****************************************************************************/
+bool TEL_frame(const FRAME_t *frame)
+{
+	uint8_t payload[12 + 2*ADC_NUMS*INPUTS_NUMS];
+	uint32_t count = (frame->count > ADC_NUMS) ? ADC_NUMS : frame->count;
+	uint8_t *p = payload;
+	p = TEL_put32(p, frame->seq);
+	p = TEL_put32(p, frame->time);
+	p = TEL_put16(p, count);
+	p = TEL_put16(p, (frame->overruns > 0xFFFF) ? 0xFFFF : frame->overruns);
+	for (uint32_t i = 0; i < count*INPUTS_NUMS; i++) {
+		p = TEL_put16(p, frame->samples[i]);
+	}
+	return TEL_send(TEL_FRAME, payload, p - payload);
+}
+
+
+/** ***************************************************************************
+ * @brief Send a spectrum
+ * @param seq sequence number of the frame
+ * @param mag magnitudes, DC first
+ * @param bins number of magnitudes
+ * @return false if dropped
+ *****************************************************************************/
+bool TEL_spectrum(uint32_t seq, const uint32_t *mag, uint32_t bins)
+{
+	uint8_t payload[TEL_MAX_PAYLOAD];
+	uint8_t *p = payload;
+	if (bins > (TEL_MAX_PAYLOAD - 8) / 4) {
+		bins = (TEL_MAX_PAYLOAD - 8) / 4;
+	}
+	p = TEL_put32(p, seq);
+	p = TEL_put16(p, bins);
+	p = TEL_put16(p, 0);
+	for (uint32_t i = 0; i < bins; i++) {
+		p = TEL_put32(p, mag[i]);
+	}
+	return TEL_send(TEL_SPECTRUM, payload, p - payload);
+}
+
+
+/** ***************************************************************************
+ * @brief Send the profiling counters
+ * @return false if dropped
+ *****************************************************************************/
+bool TEL_profile(void)
+{
+	uint8_t payload[TEL_MAX_PAYLOAD];
+	uint8_t *p = payload;
+	p = TEL_put32(p, HAL_GetTick());
+	p = TEL_put32(p, FRAME_overruns);
+	p = TEL_put32(p, REC_dropped);
+	for (uint32_t t = 0; t < TEL_TYPES; t++) {
+		p = TEL_put32(p, TEL_dropped[t]);
+	}
+	for (uint32_t s = 0; s < PIPE_STAGES; s++) {
+		p = TEL_put32(p, PIPE_stats[s].occupancy);
+		p = TEL_put32(p, PIPE_stats[s].max);
+	}
+	uint32_t tasks = SCHED_task_count;
+	if (tasks > (TEL_MAX_PAYLOAD - 200) / 12) {
+		tasks = (TEL_MAX_PAYLOAD - 200) / 12;
+	}
+	p = TEL_put32(p, tasks);
+	for (uint32_t t = 0; t < tasks; t++) {
+		p = TEL_put32(p, SCHED_tasks[t].runs);
+		p = TEL_put32(p, SCHED_tasks[t].overruns);
+		p = TEL_put32(p, SCHED_tasks[t].max);
+	}
+#ifdef PROBE_ENABLE
+	p = TEL_put32(p, PROBE_COUNT);
+	for (uint32_t i = 0; i < PROBE_COUNT; i++) {
+		const PROBE_stats_t *st = &PROBE_stats[i];	// Torn values are harmless
+		p = TEL_put32(p, st->count);
+		p = TEL_put32(p, st->min);
+		p = TEL_put32(p, st->max);
+		p = TEL_put32(p, (0 == st->count) ? 0 : (uint32_t)(st->sum / st->count));
+	}
+#else
+	p = TEL_put32(p, 0);
+#endif
+	return TEL_send(TEL_PROFILE, payload, p - payload);
+}
+
+
+/** ***************************************************************************
+ * @brief Send a part of the frozen trigger window
+ * @param offset first sample per input
+ * @param count samples per input, max. ADC_NUMS
+ * @return false if there is no room, nothing is dropped: send it later
+ *
+ * See trigger.c, the window must be TRIG_DONE.
+ *****************************************************************************/
+bool TEL_trigger(uint32_t offset, uint32_t count)
+{
+	uint8_t payload[16 + 2*ADC_NUMS*INPUTS_NUMS];
+	uint8_t *p = payload;
+	if (!(TEL_mask & (1UL << TEL_TRIGGER))) {
+		return true;					// Not wanted
+	}
+	if (count > ADC_NUMS) {
+		count = ADC_NUMS;
+	}
+	if ((offset > TRIG_count) || (count > TRIG_count - offset)) {
+		count = (offset > TRIG_count) ? 0 : TRIG_count - offset;
+	}
+	if (!TEL_room(TEL_TRIGGER, 16 + 2*count*INPUTS_NUMS)) {
+		return false;
+	}
+	p = TEL_put32(p, TRIG_sample);
+	p = TEL_put32(p, TRIG_time);
+	p = TEL_put16(p, TRIG_pre);
+	p = TEL_put16(p, TRIG_count);
+	p = TEL_put16(p, offset);
+	p = TEL_put16(p, count);
+	for (uint32_t i = offset*INPUTS_NUMS; i < (offset + count)*INPUTS_NUMS; i++) {
+		p = TEL_put16(p, TRIG_samples[i]);
+	}
+	return TEL_send(TEL_TRIGGER, payload, p - payload);
+}
+
+
+/** ***************************************************************************
+ * @brief Bytes waiting in the ring, the running DMA included
+ * @return queued bytes
+ *****************************************************************************/
+uint32_t TEL_queued(void)
+{
+	return TEL_head - TEL_tail;
+}
+
+
+/** ***************************************************************************
+ * @brief Update a CRC-16/CCITT-FALSE
+ * @param crc 0xFFFF for the first bytes, else the result of the last call
+ * @param data bytes
+ * @param length number of bytes
+ * @return updated CRC
+ *****************************************************************************/
+uint16_t TEL_crc(uint16_t crc, const uint8_t *data, uint32_t length)
+{
+	for (uint32_t i = 0; i < length; i++) {
+		crc = (crc << 4) ^ TEL_crc_table[(crc >> 12) ^ (data[i] >> 4)];
+		crc = (crc << 4) ^ TEL_crc_table[(crc >> 12) ^ (data[i] & 0x0F)];
+	}
+	return crc;
+}
+
+
+/** ***************************************************************************
+ * @brief Interrupt handler of the USART1 transmit DMA, DMA2_Stream7
+ *
+ * Frees the sent bytes and starts the DMA for the next ones.
+ * @n A transfer error drops the rest of the chunk, the host resyncs
+ * on the next packet.
+ *****************************************************************************/
+PLACE_RAMFUNC void DMA2_Stream7_IRQHandler(void)
+{
+	if (DMA2->HISR & (DMA_HISR_TCIF7 | DMA_HISR_TEIF7)) {
+		DMA2->HIFCR = TEL_DMA_FLAGS;
+		TEL_tail += TEL_chunk;
+		TEL_chunk = 0;
+		TEL_start_next();
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Check if a packet fits into the ring
+ * @param type of the packet, frames and spectra leave TEL_RESERVE free
+ * @param length bytes of the payload
+ * @return true if it fits
+ *****************************************************************************/
+static bool TEL_room(TEL_type_t type, uint32_t length)
+{
+	uint32_t size = TEL_HEADER_SIZE + length + TEL_CRC_SIZE;
+	uint32_t reserve = ((TEL_FRAME == type) || (TEL_SPECTRUM == type))
+			? TEL_RESERVE : 0;
+	return (length <= TEL_MAX_PAYLOAD)
+			&& (TEL_queued() + size + reserve <= TEL_BUFFER_SIZE);
+}
+
+
+/** ***************************************************************************
+ * @brief Copy bytes into the ring
+ * @param position in bytes since TEL_init(), not yet sent
+ * @param data bytes
+ * @param length number of bytes, there must be room for them
+ * @return position behind the bytes
+ *****************************************************************************/
+static uint32_t TEL_write(uint32_t position, const uint8_t *data,
+		uint32_t length)
+{
+	uint32_t index = position & TEL_MASK;
+	uint32_t first = TEL_BUFFER_SIZE - index;
+	if (first > length) {
+		first = length;
+	}
+	memcpy(&TEL_buffer[index], data, first);
+	memcpy(TEL_buffer, &data[first], length - first);
+	return position + length;
+}
+
+
+/** ***************************************************************************
+ * @brief Start the DMA for the queued bytes up to the end of the ring
+ *
+ * Called from main with the DMA interrupt disabled or from the ISR.
+ * @n In RAM like the ISR, which calls it after every chunk.
+ *****************************************************************************/
+PLACE_RAMFUNC static void TEL_start_next(void)
+{
+	uint32_t tail = TEL_tail;
+	uint32_t queued = TEL_head - tail;
+	if (0 == queued) {
+		return;
+	}
+	uint32_t index = tail & TEL_MASK;
+	uint32_t chunk = TEL_BUFFER_SIZE - index;	// Up to the end of the ring
+	if (chunk > queued) {
+		chunk = queued;
+	}
+	TEL_chunk = chunk;
+	DMA2_Stream7->M0AR = (uint32_t)&TEL_buffer[index];
+	DMA2_Stream7->NDTR = chunk;
+	DMA2->HIFCR = TEL_DMA_FLAGS;
+	USART1->SR &= ~USART_SR_TC;
+	DMA2_Stream7->CR |= DMA_SxCR_EN;	// Enable DMA
+}
+
+
+/** ***************************************************************************
+ * @brief Store little endian values
+ * @param p destination
+ * @param value to store
+ * @return p behind the value
+ *****************************************************************************/
+static uint8_t *TEL_put16(uint8_t *p, uint32_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+	return p + 2;
+}
+
+static uint8_t *TEL_put32(uint8_t *p, uint32_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+	p[2] = (uint8_t)(value >> 16);
+	p[3] = (uint8_t)(value >> 24);
+	return p + 4;
+}
@@ -0,0 +1,235 @@
+/** ***************************************************************************
+ * @file
+ * @brief Interrupt-driven touchscreen with debouncing and an event queue
+ *
+ * ==============================================================
+ *
+ * The STMPE811 touch controller pulls its interrupt line (PA15)
+ * when a touch starts or ends.
+ * The interrupt handler only takes a timestamp and posts EVT_TOUCH,
+ * the controller is read over I2C by TOUCH_update() in the user
+ * interface task.
+ * @n While the screen is not touched there is no I2C traffic at all.
+ * While it is touched TOUCH_update() reads the controller
+ * every TOUCH_POLL_PERIOD ms, so a lost release interrupt does no harm.
+ *
+ * Debouncing state machine:
+ * @verbatim
+   IDLE --touch--> PRESSING --stable TOUCH_DEBOUNCE ms--> PRESSED (event)
+                      '--no touch--> IDLE
+   PRESSED --no touch--> RELEASING --stable TOUCH_DEBOUNCE ms--> IDLE (event)
+                            '--touch--> PRESSED
+   @endverbatim
+ * The debounced presses and releases are put into a queue,
+ * which is emptied by TOUCH_get().
+ *
+ * @note Evalboard revision E (blue PCB) has an inverted y-axis
+ * in the touch controller compared to the display.
+ * Uncomment or comment the <b>\#define EVAL_REV_E</b> in main.h accordingly.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include "stm32f4xx.h"
+#include "stm32f429i_discovery.h"
+#include "stm32f429i_discovery_lcd.h"
+#include "stm32f429i_discovery_ts.h"
+
+#include "main.h"
+
+#include "touch.h"
+#include "events.h"
+#include "probe.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define TOUCH_QUEUE_MASK	(TOUCH_QUEUE_SIZE-1)	///< Index wrap around
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** States of the debouncing */
+typedef enum {
+	TOUCH_IDLE = 0, TOUCH_PRESSING, TOUCH_PRESSED, TOUCH_RELEASING
+} TOUCH_state_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+uint32_t TOUCH_reads = 0;				///< Reads of the touch controller
+uint32_t TOUCH_dropped = 0;				///< Events lost with a full queue
+
+static volatile bool TOUCH_irq = false;	///< Interrupt not yet handled
+static volatile uint32_t TOUCH_irq_time = 0;	///< EVT_timestamp() of it
+static TOUCH_state_t TOUCH_state = TOUCH_IDLE;	///< Debouncing state
+static uint32_t TOUCH_since = 0;		///< HAL_GetTick() of the last change
+static uint32_t TOUCH_last_read = 0;	///< HAL_GetTick() of the last read
+static uint32_t TOUCH_press_time = 0;	///< EVT_timestamp() of the touch
+static uint16_t TOUCH_x = 0;			///< Last touched column
+static uint16_t TOUCH_y = 0;			///< Last touched row
+static TOUCH_event_t TOUCH_queue[TOUCH_QUEUE_SIZE];	///< Debounced events
+static uint32_t TOUCH_head = 0;			///< Events put
+static uint32_t TOUCH_tail = 0;			///< Events taken
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static void TOUCH_put(TOUCH_type_t type, uint32_t time);
+
+
+/** ***************************************************************************
+ * @brief Enable the touch interrupt of the controller and of PA15
+ *
+ * Only touch detection raises the interrupt,
+ * the FIFO interrupts would fire continuously during a touch.
+ * @note BSP_TS_Init() must have been called.
+ *****************************************************************************/
+void TOUCH_init(void)
+{
+	BSP_TS_ITConfig();					// EXTI on PA15, controller interrupts
+	stmpe811_DisableITSource(TS_I2C_ADDRESS,
+			STMPE811_TS_IT & ~STMPE811_GIT_TOUCH);
+	BSP_TS_ITClear();
+	TOUCH_state = TOUCH_IDLE;
+	TOUCH_head = 0;
+	TOUCH_tail = 0;
+}
+
+
+/** ***************************************************************************
+ * @brief Read the controller if needed and run the debouncing
+ *
+ * Call on EVT_TOUCH and every TOUCH_POLL_PERIOD ms.
+ * Returns at once without I2C traffic while the screen is not touched.
+ *****************************************************************************/
+void TOUCH_update(void)
+{
+	static TS_StateTypeDef TS_State;	// State of the touch controller
+	uint32_t now = HAL_GetTick();
+	bool irq = TOUCH_irq;
+	if (!irq) {
+		if (TOUCH_IDLE == TOUCH_state) {
+			return;						// Not touched, nothing to read
+		}
+		if ((now - TOUCH_last_read) < TOUCH_POLL_PERIOD) {
+			return;
+		}
+	}
+	TOUCH_irq = false;
+	if (irq) {
+		BSP_TS_ITClear();				// Release the interrupt line
+	}
+	BSP_TS_GetState(&TS_State);			// Get the state
+	TOUCH_reads++;
+	TOUCH_last_read = now;
+	if (TS_State.TouchDetected) {
+		TOUCH_x = TS_State.X;
+#ifdef EVAL_REV_E
+// Evalboard revision E (blue) has an inverted y-axis in the touch controller
+		TOUCH_y = BSP_LCD_GetYSize() - TS_State.Y;	// Invert the y-axis
+#else
+		TOUCH_y = TS_State.Y;
+#endif
+	}
+	switch (TOUCH_state) {
+	case TOUCH_IDLE:
+		if (TS_State.TouchDetected) {
+			TOUCH_state = TOUCH_PRESSING;
+			TOUCH_since = now;
+			TOUCH_press_time = irq ? TOUCH_irq_time : EVT_timestamp();
+		}
+		break;
+	case TOUCH_PRESSING:
+		if (!TS_State.TouchDetected) {	// Bounce
+			TOUCH_state = TOUCH_IDLE;
+		} else if ((now - TOUCH_since) >= TOUCH_DEBOUNCE) {
+			TOUCH_state = TOUCH_PRESSED;
+			TOUCH_put(TOUCH_PRESS, TOUCH_press_time);
+		}
+		break;
+	case TOUCH_PRESSED:
+		if (!TS_State.TouchDetected) {
+			TOUCH_state = TOUCH_RELEASING;
+			TOUCH_since = now;
+		}
+		break;
+	case TOUCH_RELEASING:
+		if (TS_State.TouchDetected) {	// Bounce
+			TOUCH_state = TOUCH_PRESSED;
+		} else if ((now - TOUCH_since) >= TOUCH_DEBOUNCE) {
+			TOUCH_state = TOUCH_IDLE;
+			TOUCH_put(TOUCH_RELEASE, EVT_timestamp());
+		}
+		break;
+	default:							// Should never occur
+		TOUCH_state = TOUCH_IDLE;
+		break;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Take the oldest touch event out of the queue
+ * @param event the event
+ * @return false if the queue is empty
+ *****************************************************************************/
+bool TOUCH_get(TOUCH_event_t *event)
+{
+	if (TOUCH_tail == TOUCH_head) {
+		return false;
+	}
+	*event = TOUCH_queue[TOUCH_tail & TOUCH_QUEUE_MASK];
+	TOUCH_tail++;
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Put an event with the last position into the queue
+ * @param type press or release
+ * @param time EVT_timestamp() of the touch
+ *****************************************************************************/
+static void TOUCH_put(TOUCH_type_t type, uint32_t time)
+{
+	if (TOUCH_QUEUE_SIZE <= TOUCH_head - TOUCH_tail) {
+		TOUCH_dropped++;
+		return;
+	}
+	TOUCH_event_t *event = &TOUCH_queue[TOUCH_head & TOUCH_QUEUE_MASK];
+	event->type = type;
+	event->x = TOUCH_x;
+	event->y = TOUCH_y;
+	event->time = time;
+	TOUCH_head++;
+}
+
+
+/** ***************************************************************************
+ * @brief Interrupt handler for the touchscreen
+ *
+ * The touchscreen interrupt is connected to PA15.
+ * @n The interrupt handler for external line 15 to 10 is called.
+ * No I2C transfer here, the controller is read by TOUCH_update().
+ *****************************************************************************/
+void EXTI15_10_IRQHandler(void)
+{
+	PROBE_BEGIN(PROBE_ISR_TOUCH);
+	if (EXTI->PR & EXTI_PR_PR15) {		// Check if interrupt on touchscreen
+		EXTI->PR = EXTI_PR_PR15;		// Clear pending interrupt on line 15
+		TOUCH_irq_time = EVT_timestamp();
+		TOUCH_irq = true;
+		EVT_post(EVT_TOUCH);			// Wake up the user interface task
+	}
+	PROBE_END(PROBE_ISR_TOUCH);
+}
@@ -0,0 +1,187 @@
+/** ***************************************************************************
+ * @file
+ * @brief Event triggered capture with pre-trigger, by the ADC analog watchdog
+ *
+ * ==============================================================
+ *
+ * Catches a transient, e.g. a load switched on a cable, like the normal
+ * trigger mode of an oscilloscope.
+ *
+ * The continuous mode runs, the recorder (record.c) keeps the samples
+ * in the SDRAM ring. The analog watchdog of ADC3 compares every
+ * conversion with a low and a high threshold, on one input or on all.
+ * The CPU does not look at the samples while armed.
+ * @n The first conversion outside the thresholds raises the ADC interrupt:
+ * TRIG_awd() disables the watchdog and numbers the trigger sample like
+ * the recorder, from the position of the DMA in ADC_samples.
+ * TRIG_poll() waits until the post-trigger samples are recorded and copies
+ * the window around the trigger out of the ring into TRIG_samples.
+ * The window then stays frozen until the trigger is armed again.
+ *
+ * The pre-trigger part is limited by what the ring holds, e.g. right after
+ * the start of the continuous mode. Stopping the continuous mode resets
+ * the ADC: an armed trigger is disarmed, a fired one freezes the samples
+ * recorded up to then.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include "stm32f4xx.h"
+#include "stm32f4xx_hal.h"
+
+#include "trigger.h"
+#include "record.h"
+#include "placement.h"
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+volatile TRIG_state_t TRIG_state = TRIG_IDLE;	///< Written by the ISR and main
+uint32_t TRIG_sample = 0;				///< Number of the trigger sample, see REC
+uint32_t TRIG_time = 0;					///< HAL_GetTick() of the trigger
+uint32_t TRIG_pre = 0;					///< Samples before the trigger in the window
+uint32_t TRIG_count = 0;				///< Samples per input in the window
+uint32_t TRIG_samples[TRIG_MAX_SAMPLES*INPUTS_NUMS] PLACE_CCM;	///< The window
+
+static TRIG_config_t TRIG_config;		///< Setup of the armed trigger
+
+/** ADC3 channels of the inputs in the order of the scan, see measuring.c */
+static const uint32_t TRIG_channel[INPUTS_NUMS] = { 4, 13, 6, 11 };
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Check a trigger setup
+ * @param config setup
+ * @return true if it can be armed
+ *****************************************************************************/
+bool TRIG_check(const TRIG_config_t *config)
+{
+	return (config->input <= TRIG_ALL_INPUTS)
+			&& (config->low < config->high)
+			&& (config->high < (1UL << ADC_DAC_RES))
+			&& (config->post > 0)
+			&& (config->pre + config->post <= TRIG_MAX_SAMPLES);
+}
+
+
+/** ***************************************************************************
+ * @brief Arm the trigger
+ * @param config setup, see TRIG_check()
+ * @return false if the setup is wrong or the continuous mode is not running
+ *
+ * A frozen window is discarded.
+ *****************************************************************************/
+bool TRIG_arm(const TRIG_config_t *config)
+{
+	if (!TRIG_check(config) || !MEAS_continuous) {
+		return false;
+	}
+	TRIG_disarm();
+	TRIG_config = *config;
+	TRIG_count = 0;
+	ADC3->CR1 &= ~(ADC_CR1_AWDCH | ADC_CR1_AWDSGL);
+	ADC3->LTR = config->low;			// Low threshold
+	ADC3->HTR = config->high;			// High threshold
+	if (config->input < INPUTS_NUMS) {	// Else all regular channels
+		ADC3->CR1 |= ADC_CR1_AWDSGL
+				| (TRIG_channel[config->input] << ADC_CR1_AWDCH_Pos);
+	}
+	ADC3->SR &= ~ADC_SR_AWD;			// Clear a former event
+	TRIG_state = TRIG_ARMED;
+	ADC3->CR1 |= ADC_CR1_AWDEN | ADC_CR1_AWDIE;	// Watch regular channels
+	NVIC_ClearPendingIRQ(ADC_IRQn);
+	NVIC_EnableIRQ(ADC_IRQn);
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Disarm the trigger, a frozen window is kept
+ *****************************************************************************/
+void TRIG_disarm(void)
+{
+	ADC3->CR1 &= ~(ADC_CR1_AWDIE | ADC_CR1_AWDEN);
+	if (TRIG_DONE != TRIG_state) {
+		TRIG_state = TRIG_IDLE;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief The analog watchdog has fired
+ *
+ * Called by ADC_IRQHandler(). Disables the watchdog, so the interrupt
+ * comes once per arming.
+ * @n The DMA position gives the sample in the half being filled.
+ * A half with a pending DMA interrupt is not yet recorded,
+ * the recorder will give it the next block number.
+ *****************************************************************************/
+PLACE_RAMFUNC void TRIG_awd(void)
+{
+	ADC3->CR1 &= ~(ADC_CR1_AWDIE | ADC_CR1_AWDEN);	// One shot
+	ADC3->SR &= ~ADC_SR_AWD;			// Clear flag
+	if (TRIG_ARMED != TRIG_state) {
+		return;
+	}
+	uint32_t written = (INPUTS_NUMS*ADC_NUMS - DMA2_Stream1->NDTR) / INPUTS_NUMS;
+	uint32_t position = REC_position();
+	if (DMA2->LISR & (DMA_LISR_HTIF1 | DMA_LISR_TCIF1)) {
+		position += REC_BLOCK_SAMPLES;
+	}
+	TRIG_sample = position + written % ADC_STREAM_NUMS;
+	TRIG_time = HAL_GetTick();
+	TRIG_state = TRIG_FIRED;
+}
+
+
+/** ***************************************************************************
+ * @brief Freeze the window once the post-trigger samples are recorded
+ * @return true when the window has just been frozen
+ *
+ * Called periodically from main, copies at most TRIG_MAX_SAMPLES samples.
+ *****************************************************************************/
+bool TRIG_poll(void)
+{
+	if ((TRIG_ARMED == TRIG_state) && !MEAS_continuous) {
+		TRIG_state = TRIG_IDLE;			// Stopped, the ADC has been reset
+		return false;
+	}
+	if (TRIG_FIRED != TRIG_state) {
+		return false;
+	}
+	uint32_t first, end;
+	REC_range(&first, &end);
+	uint32_t last = TRIG_sample + TRIG_config.post;
+	if (end < last) {
+		if (MEAS_continuous) {
+			return false;				// Still recording
+		}
+		last = end;
+	}
+	uint32_t start = (TRIG_sample > TRIG_config.pre)
+			? TRIG_sample - TRIG_config.pre : 0;
+	if (start < first) {
+		start = first;					// Ring holds less
+	}
+	if (last < start) {
+		last = start;
+	}
+	TRIG_count = REC_read(start, last - start, TRIG_samples);
+	TRIG_pre = (TRIG_sample > start) ? TRIG_sample - start : 0;
+	if (TRIG_pre > TRIG_count) {
+		TRIG_pre = TRIG_count;
+	}
+	TRIG_state = TRIG_DONE;
+	return true;
+}
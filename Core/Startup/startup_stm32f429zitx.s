@@ -88,6 +88,28 @@ LoopFillZerobss:
   ldr  r3, = _ebss
   cmp  r2, r3
   bcc  FillZerobss
+  ldr  r2, =_sdma
+  b  LoopFillZerodma
+/* Zero fill the DMA buffers in SRAM2, see placement.h */
+FillZerodma:
+  movs  r3, #0
+  str  r3, [r2], #4
+
+LoopFillZerodma:
+  ldr  r3, = _edma
+  cmp  r2, r3
+  bcc  FillZerodma
+  ldr  r2, =_sccmram
+  b  LoopFillZeroccm
+/* Zero fill the CPU only buffers in the CCM RAM, see placement.h */
+FillZeroccm:
+  movs  r3, #0
+  str  r3, [r2], #4
+
+LoopFillZeroccm:
+  ldr  r3, = _eccmram
+  cmp  r2, r3
+  bcc  FillZeroccm
 
 /* Call the clock system intitialization function.*/
   bl  SystemInit   
@@ -73,6 +73,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f429i_discovery_lcd.h"
+#include "graphics.h"
 #include "../../../Utilities/Fonts/fonts.h"
 #include "../../../Utilities/Fonts/font24.c"
 #include "../../../Utilities/Fonts/font20.c"
@@ -121,7 +122,6 @@
   * @{
   */ 
 LTDC_HandleTypeDef  LtdcHandler;
-static DMA2D_HandleTypeDef Dma2dHandler;
 static RCC_PeriphCLKInitTypeDef  PeriphClkInitStruct;
 
 /* Default LCD configuration with LCD Layer 1 */
@@ -533,6 +533,9 @@ sFONT *BSP_LCD_GetFont(void)
 uint32_t BSP_LCD_ReadPixel(uint16_t Xpos, uint16_t Ypos)
 {
   uint32_t ret = 0;
+
+  /* Queued DMA2D commands have to be finished first */
+  GFX_sync();
   
   if(LtdcHandler.LayerCfg[ActiveLayer].PixelFormat == LTDC_PIXEL_FORMAT_ARGB8888)
   {
@@ -658,6 +661,41 @@ void BSP_LCD_DisplayStringAt(uint16_t X, uint16_t Y, uint8_t *pText, Text_AlignM
   }  
 }
 
+/**
+  * @brief  Displays glyphs of the actual font, e.g. text formatted by format.c.
+  * @param  X: pointer to x position (in pixel)
+  * @param  Y: pointer to y position (in pixel)
+  * @param  pGlyph: glyph indexes into the font table, character - ' '
+  * @param  Count: number of glyphs
+  * @param  mode: The display mode, see BSP_LCD_DisplayStringAt()
+  * @note   Draws the same pixels as BSP_LCD_DisplayStringAt() with the text,
+  *         without scanning the text for its end and its characters.
+  */
+void BSP_LCD_DisplayGlyphs(uint16_t X, uint16_t Y, const uint8_t *pGlyph, uint32_t Count, Text_AlignModeTypdef mode)
+{
+  sFONT *font = DrawProp[ActiveLayer].pFont;
+  uint32_t bytes = font->Height * ((font->Width + 7) / 8);
+  uint32_t xsize = BSP_LCD_GetXSize() / font->Width;
+  uint16_t refcolumn = X;
+  uint32_t i = 0;
+
+  if (mode == CENTER_MODE)
+  {
+    refcolumn = X + ((xsize - Count) * font->Width) / 2;
+  }
+  else if (mode == RIGHT_MODE)
+  {
+    refcolumn = X + ((xsize - Count) * font->Width);
+  }
+
+  /* Same limit as BSP_LCD_DisplayStringAt(): glyphs which fit the width */
+  for (i = 0; (i < Count) && (i < xsize); i++)
+  {
+    DrawChar(refcolumn, Y, &font->table[pGlyph[i] * bytes]);
+    refcolumn += font->Width;
+  }
+}
+
 /**
   * @brief  Displays a maximum of 20 char on the LCD.
   * @param  Line: the Line where to display the character shape
@@ -1307,6 +1345,9 @@ __weak void BSP_LCD_MspInit(void)
   */
 void BSP_LCD_DrawPixel(uint16_t Xpos, uint16_t Ypos, uint32_t RGB_Code)
 {
+  /* Queued DMA2D commands have to be finished first */
+  GFX_sync();
+
   /* Write data value to all SDRAM memory */
   *(__IO uint32_t*) (LtdcHandler.LayerCfg[ActiveLayer].FBStartAdress + (4*(Ypos*BSP_LCD_GetXSize() + Xpos))) = RGB_Code;
 }
@@ -1376,26 +1417,8 @@ static void DrawChar(uint16_t Xpos, uint16_t Ypos, const uint8_t *c)
   */
 static void FillBuffer(uint32_t LayerIndex, void * pDst, uint32_t xSize, uint32_t ySize, uint32_t OffLine, uint32_t ColorIndex) 
 {
-  
-  /* Register to memory mode with ARGB8888 as color Mode */ 
-  Dma2dHandler.Init.Mode         = DMA2D_R2M;
-  Dma2dHandler.Init.ColorMode    = DMA2D_ARGB8888;
-  Dma2dHandler.Init.OutputOffset = OffLine;      
-  
-  Dma2dHandler.Instance = DMA2D; 
-  
-  /* DMA2D Initialization */
-  if(HAL_DMA2D_Init(&Dma2dHandler) == HAL_OK) 
-  {
-    if(HAL_DMA2D_ConfigLayer(&Dma2dHandler, LayerIndex) == HAL_OK) 
-    {
-      if (HAL_DMA2D_Start(&Dma2dHandler, ColorIndex, (uint32_t)pDst, xSize, ySize) == HAL_OK)
-      {
-        /* Polling For DMA transfer */  
-        HAL_DMA2D_PollForTransfer(&Dma2dHandler, 10);
-      }
-    }
-  } 
+  /* Register to memory mode with ARGB8888 as color Mode, queued for the DMA2D */
+  GFX_fill((uint32_t)pDst, xSize, ySize, OffLine, ColorIndex);
 }
 
 /**
@@ -1407,31 +1430,8 @@ static void FillBuffer(uint32_t LayerIndex, void * pDst, uint32_t xSize, uint32_
   */
 static void ConvertLineToARGB8888(void * pSrc, void * pDst, uint32_t xSize, uint32_t ColorMode)
 {    
-  /* Configure the DMA2D Mode, Color Mode and output offset */
-  Dma2dHandler.Init.Mode         = DMA2D_M2M_PFC;
-  Dma2dHandler.Init.ColorMode    = DMA2D_ARGB8888;
-  Dma2dHandler.Init.OutputOffset = 0;     
-  
-  /* Foreground Configuration */
-  Dma2dHandler.LayerCfg[1].AlphaMode = DMA2D_NO_MODIF_ALPHA;
-  Dma2dHandler.LayerCfg[1].InputAlpha = 0xFF;
-  Dma2dHandler.LayerCfg[1].InputColorMode = ColorMode;
-  Dma2dHandler.LayerCfg[1].InputOffset = 0;
-  
-  Dma2dHandler.Instance = DMA2D; 
-  
-  /* DMA2D Initialization */
-  if(HAL_DMA2D_Init(&Dma2dHandler) == HAL_OK) 
-  {
-    if(HAL_DMA2D_ConfigLayer(&Dma2dHandler, 1) == HAL_OK) 
-    {
-      if (HAL_DMA2D_Start(&Dma2dHandler, (uint32_t)pSrc, (uint32_t)pDst, xSize, 1) == HAL_OK)
-      {
-        /* Polling For DMA transfer */  
-        HAL_DMA2D_PollForTransfer(&Dma2dHandler, 10);
-      }
-    }
-  } 
+  /* Memory to memory with pixel format conversion, queued for the DMA2D */
+  GFX_convert((uint32_t)pSrc, ColorMode, (uint32_t)pDst, xSize, 1, 0);
 }
 
 /**
@@ -0,0 +1,282 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host stand-in for the CMSIS Cortex-M4 core header
+ *
+ * Replaces Drivers/CMSIS/Include/core_cm4.h in the host build.
+ * @n The core peripherals (NVIC, SCB, SysTick, DWT, CoreDebug) are plain
+ * structs in host memory, the intrinsics are no-ops or portable C.
+ * @n Enabling or pending an interrupt calls HOST_step(), which runs the
+ * peripheral models and the handlers of pending and enabled interrupts.
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef HOST_CORE_CM4_H_
+#define HOST_CORE_CM4_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdint.h>
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define __CORTEX_M				(4U)
+
+#define __I						volatile const
+#define __O						volatile
+#define __IO					volatile
+#define __IM					volatile const
+#define __OM					volatile
+#define __IOM					volatile
+
+#ifndef __ASM
+#define __ASM					__asm
+#endif
+#ifndef __INLINE
+#define __INLINE				inline
+#endif
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE			static inline
+#endif
+#ifndef __STATIC_FORCEINLINE
+#define __STATIC_FORCEINLINE	static inline __attribute__((always_inline))
+#endif
+#ifndef __NO_RETURN
+#define __NO_RETURN				__attribute__((__noreturn__))
+#endif
+#ifndef __USED
+#define __USED					__attribute__((used))
+#endif
+#ifndef __WEAK
+#define __WEAK					__attribute__((weak))
+#endif
+#ifndef __PACKED
+#define __PACKED				__attribute__((packed, aligned(1)))
+#endif
+#ifndef __ALIGNED
+#define __ALIGNED(x)			__attribute__((aligned(x)))
+#endif
+
+#define HOST_IRQ_COUNT			(96U)	///< Device interrupts of the F429
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Nested vectored interrupt controller, only the used registers */
+typedef struct {
+	__IOM uint32_t ISER[8U];			///< Interrupt set enable
+	__IOM uint32_t ICER[8U];			///< Interrupt clear enable
+	__IOM uint32_t ISPR[8U];			///< Interrupt set pending
+	__IOM uint32_t ICPR[8U];			///< Interrupt clear pending
+	__IOM uint32_t IABR[8U];			///< Interrupt active bit
+	__IOM uint8_t  IP[240U];			///< Interrupt priority
+} NVIC_Type;
+
+/** System control block, only the used registers */
+typedef struct {
+	__IM  uint32_t CPUID;
+	__IOM uint32_t ICSR;
+	__IOM uint32_t VTOR;
+	__IOM uint32_t AIRCR;
+	__IOM uint32_t SCR;
+	__IOM uint32_t CCR;
+	__IOM uint32_t CPACR;
+} SCB_Type;
+
+/** System timer */
+typedef struct {
+	__IOM uint32_t CTRL;
+	__IOM uint32_t LOAD;
+	__IOM uint32_t VAL;
+	__IM  uint32_t CALIB;
+} SysTick_Type;
+
+/** Data watchpoint and trace unit, only the counters */
+typedef struct {
+	__IOM uint32_t CTRL;
+	__IOM uint32_t CYCCNT;
+	__IOM uint32_t CPICNT;
+	__IOM uint32_t EXCCNT;
+	__IOM uint32_t SLEEPCNT;
+	__IOM uint32_t LSUCNT;
+	__IOM uint32_t FOLDCNT;
+} DWT_Type;
+
+/** Core debug, only the exception and monitor control register */
+typedef struct {
+	__IOM uint32_t DHCSR;
+	__OM  uint32_t DCRSR;
+	__IOM uint32_t DCRDR;
+	__IOM uint32_t DEMCR;
+} CoreDebug_Type;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern NVIC_Type HOST_nvic;				///< Host memory of the NVIC
+extern SCB_Type HOST_scb;				///< Host memory of the SCB
+extern SysTick_Type HOST_systick;		///< Host memory of the SysTick
+extern DWT_Type HOST_dwt;				///< Host memory of the DWT
+extern CoreDebug_Type HOST_coredebug;	///< Host memory of the CoreDebug
+extern uint32_t HOST_primask;			///< Interrupts masked if not 0
+
+#define NVIC					(&HOST_nvic)
+#define SCB						(&HOST_scb)
+#define SysTick					(&HOST_systick)
+#define DWT						(&HOST_dwt)
+#define CoreDebug				(&HOST_coredebug)
+
+#define SCB_SCR_SLEEPONEXIT_Msk		(1UL << 1U)
+#define SCB_SCR_SLEEPDEEP_Msk		(1UL << 2U)
+#define SysTick_CTRL_ENABLE_Msk		(1UL << 0U)
+#define SysTick_CTRL_TICKINT_Msk	(1UL << 1U)
+#define SysTick_CTRL_CLKSOURCE_Msk	(1UL << 2U)
+#define SysTick_LOAD_RELOAD_Msk		(0xFFFFFFUL)
+#define DWT_CTRL_CYCCNTENA_Msk		(1UL << 0U)
+#define CoreDebug_DEMCR_TRCENA_Msk	(1UL << 24U)
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void HOST_step(void);
+
+
+/******************************************************************************
+ * Intrinsics
+ *****************************************************************************/
+__STATIC_INLINE void __NOP(void) { }
+__STATIC_INLINE void __DSB(void) { __sync_synchronize(); }
+__STATIC_INLINE void __DMB(void) { __sync_synchronize(); }
+__STATIC_INLINE void __ISB(void) { __sync_synchronize(); }
+__STATIC_INLINE void __WFI(void) { HOST_step(); }
+__STATIC_INLINE void __WFE(void) { HOST_step(); }
+__STATIC_INLINE void __SEV(void) { }
+
+__STATIC_INLINE void __disable_irq(void) { HOST_primask = 1U; }
+__STATIC_INLINE void __enable_irq(void) { HOST_primask = 0U; HOST_step(); }
+__STATIC_INLINE uint32_t __get_PRIMASK(void) { return HOST_primask; }
+__STATIC_INLINE void __set_PRIMASK(uint32_t priMask)
+{
+	HOST_primask = priMask;
+	if (0U == priMask) {
+		HOST_step();
+	}
+}
+
+__STATIC_INLINE uint8_t __CLZ(uint32_t value)
+{
+	return (0U == value) ? 32U : (uint8_t)__builtin_clz(value);
+}
+
+__STATIC_INLINE uint32_t __REV(uint32_t value)
+{
+	return __builtin_bswap32(value);
+}
+
+__STATIC_INLINE int32_t __SSAT(int32_t val, uint32_t sat)
+{
+	const int32_t max = (int32_t)((1U << (sat - 1U)) - 1U);
+	const int32_t min = -1 - max;
+	return (val > max) ? max : ((val < min) ? min : val);
+}
+
+__STATIC_INLINE uint32_t __USAT(int32_t val, uint32_t sat)
+{
+	const uint32_t max = (1U << sat) - 1U;
+	return (val < 0) ? 0U : (((uint32_t)val > max) ? max : (uint32_t)val);
+}
+
+
+/******************************************************************************
+ * NVIC
+ *****************************************************************************/
+__STATIC_INLINE void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+	if ((int32_t)IRQn >= 0) {
+		NVIC->ISER[(uint32_t)IRQn >> 5U] |= 1UL << ((uint32_t)IRQn & 0x1FU);
+		HOST_step();
+	}
+}
+
+__STATIC_INLINE uint32_t NVIC_GetEnableIRQ(IRQn_Type IRQn)
+{
+	if ((int32_t)IRQn < 0) {
+		return 0U;
+	}
+	return (NVIC->ISER[(uint32_t)IRQn >> 5U] >> ((uint32_t)IRQn & 0x1FU)) & 1UL;
+}
+
+__STATIC_INLINE void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+	if ((int32_t)IRQn >= 0) {
+		NVIC->ISER[(uint32_t)IRQn >> 5U] &= ~(1UL << ((uint32_t)IRQn & 0x1FU));
+	}
+}
+
+__STATIC_INLINE uint32_t NVIC_GetPendingIRQ(IRQn_Type IRQn)
+{
+	if ((int32_t)IRQn < 0) {
+		return 0U;
+	}
+	return (NVIC->ISPR[(uint32_t)IRQn >> 5U] >> ((uint32_t)IRQn & 0x1FU)) & 1UL;
+}
+
+__STATIC_INLINE void NVIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+	if ((int32_t)IRQn >= 0) {
+		NVIC->ISPR[(uint32_t)IRQn >> 5U] |= 1UL << ((uint32_t)IRQn & 0x1FU);
+		HOST_step();
+	}
+}
+
+__STATIC_INLINE void NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+	if ((int32_t)IRQn >= 0) {
+		NVIC->ISPR[(uint32_t)IRQn >> 5U] &= ~(1UL << ((uint32_t)IRQn & 0x1FU));
+	}
+}
+
+__STATIC_INLINE void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+	if ((int32_t)IRQn >= 0) {
+		NVIC->IP[(uint32_t)IRQn] = (uint8_t)(priority << (8U - __NVIC_PRIO_BITS));
+	}
+}
+
+__STATIC_INLINE uint32_t NVIC_GetPriority(IRQn_Type IRQn)
+{
+	if ((int32_t)IRQn < 0) {
+		return 0U;
+	}
+	return (uint32_t)NVIC->IP[(uint32_t)IRQn] >> (8U - __NVIC_PRIO_BITS);
+}
+
+__STATIC_INLINE uint32_t SysTick_Config(uint32_t ticks)
+{
+	SysTick->LOAD = (ticks - 1UL) & SysTick_LOAD_RELOAD_Msk;
+	SysTick->VAL = 0UL;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk
+			| SysTick_CTRL_ENABLE_Msk;
+	return 0UL;
+}
+
+
+/******************************************************************************
+ * ITM
+ *****************************************************************************/
+/** No debugger is attached on the host, the character is dropped */
+__STATIC_INLINE uint32_t ITM_SendChar(uint32_t ch)
+{
+	return ch;
+}
+
+
+#endif
@@ -0,0 +1,71 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host simulation of the board, see host_*.c
+ *
+ * Prefix HOST
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef HOST_H_
+#define HOST_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "stm32f4xx.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define HOST_LCD_MAX_PIXELS	(240*320)	///< Size of a composed screen
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Work done by the DMA2D model */
+typedef struct {
+	uint32_t transfers[4];				///< Started transfers per mode
+	uint64_t pixels;					///< Output pixels
+	uint64_t bytes_read;				///< Bytes read from memory
+	uint64_t bytes_written;				///< Bytes written to memory
+	uint32_t errors;					///< Transfers with unsupported setup
+} HOST_dma2d_stats_t;
+
+/** Visible screen composed from the LTDC layers, ARGB8888 */
+typedef struct {
+	uint32_t width;						///< Active width in pixels
+	uint32_t height;					///< Active height in pixels
+	uint32_t pixel[HOST_LCD_MAX_PIXELS];	///< Pixels row by row
+} HOST_screen_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+extern HOST_dma2d_stats_t HOST_dma2d_stats;
+extern volatile uint32_t HOST_tick;		///< Value of HAL_GetTick()
+extern int HOST_uart_fd;				///< Receives USART1, -1 = discard
+extern uint64_t HOST_uart_bytes;		///< Bytes sent by USART1
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void HOST_reset(void);
+void HOST_dma2d_run(void);
+void HOST_uart_run(void);
+void HOST_ltdc_compose(HOST_screen_t *screen);
+bool HOST_write_image(const char *path, const HOST_screen_t *screen);
+bool HOST_read_ppm(const char *path, HOST_screen_t *screen);
+uint8_t *HOST_load(const char *path, uint32_t *size);
+uint32_t HOST_compare(const HOST_screen_t *a, const HOST_screen_t *b);
+
+
+#endif
@@ -0,0 +1,25 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host stand-in for the placement of buffers and code
+ *
+ * Replaces Core/Inc/placement.h in the host build.
+ * @n The host has a single memory, the buffers and functions stay in the
+ * default sections.
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef HOST_PLACE_H_
+#define HOST_PLACE_H_
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define PLACE_CCM						///< Default section
+#define PLACE_DMA						///< Default section
+#define PLACE_RAMFUNC					///< Default section
+
+
+#endif
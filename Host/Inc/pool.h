@@ -0,0 +1,43 @@
+/** ***************************************************************************
+ * @file
+ * @brief See pool.c
+ *
+ * Prefix POOL
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef POOL_H_
+#define POOL_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdint.h>
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define POOL_MAX_WORKERS	256			///< Upper limit of the threads
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Work on the items [begin, end), worker is 0 .. workers - 1 */
+typedef void (*POOL_work_t)(void *context, uint32_t begin, uint32_t end,
+		uint32_t worker);
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+uint32_t POOL_cpus(void);
+void POOL_run(uint32_t workers, uint32_t count, uint32_t grain,
+		POOL_work_t work, void *context);
+
+
+#endif
@@ -0,0 +1,35 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host stand-in for the BSP LCD header
+ *
+ * Includes the real BSP header and moves the framebuffers into host memory.
+ * @n The BSP LCD driver itself is compiled unchanged, it only gets the
+ * framebuffer addresses through BSP_LCD_LayerDefaultInit().
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef HOST_STM32F429I_DISCOVERY_LCD_H_
+#define HOST_STM32F429I_DISCOVERY_LCD_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdint.h>
+#include "../../Drivers/BSP/STM32F429I-Discovery/stm32f429i_discovery_lcd.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define HOST_SDRAM_SIZE		0x00800000UL	///< 8 MByte external SDRAM
+
+extern uint8_t HOST_sdram[HOST_SDRAM_SIZE];	///< Host memory of the SDRAM
+
+#undef LCD_FRAME_BUFFER
+#define LCD_FRAME_BUFFER	((uint32_t)(uintptr_t)HOST_sdram)
+
+
+#endif
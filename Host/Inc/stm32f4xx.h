@@ -0,0 +1,41 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host stand-in for the STM32F4xx device header
+ *
+ * Includes the real device header and moves the peripheral address space
+ * into host memory:
+ * @n All peripheral base addresses derive from PERIPH_BASE, so redefining it
+ * before the HAL headers are parsed redirects every peripheral macro
+ * (ADC3, DMA2_Stream1, LTDC, DMA2D, ...) to HOST_periph.
+ * The offsets between the peripherals are kept, which the HAL relies on
+ * e.g. for the LTDC layers.
+ *
+ * @note The host build must be linked with -no-pie, the firmware casts
+ * pointers to uint32_t and back.
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef HOST_STM32F4XX_H_
+#define HOST_STM32F4XX_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdint.h>
+
+#define HOST_PERIPH_SIZE	0x00080000UL	///< APB1, APB2 and AHB1 peripherals
+
+extern uint8_t HOST_periph[HOST_PERIPH_SIZE];	///< Host memory of the peripherals
+
+#include "../../Drivers/CMSIS/Device/ST/STM32F4xx/Include/stm32f429xx.h"
+
+#undef PERIPH_BASE
+#define PERIPH_BASE			((uintptr_t)HOST_periph)
+
+#include "../../Drivers/CMSIS/Device/ST/STM32F4xx/Include/stm32f4xx.h"
+
+
+#endif
@@ -0,0 +1,78 @@
+/** ***************************************************************************
+ * @file
+ * @brief See synth.c
+ *
+ * Prefix SYN
+ *
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+#ifndef SYN_H_
+#define SYN_H_
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "measuring.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define SYN_RATE			600			///< Sample rate of the firmware in Hz
+#define SYN_OFFSET			2048		///< Virtual ground in ADC counts
+#define SYN_HARMONICS		2			///< Modelled harmonics: 3rd and 5th
+#define SYN_MAX_PERIOD		1200		///< Max. samples of one mains period
+#define SYN_NOISE_SIZE		4096		///< Entries of the noise table (2^n)
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Kind of conductor, selects the pad lookup table */
+typedef enum {
+	SYN_WIRE = 0, SYN_CABLE
+} SYN_kind_t;
+
+/** Field situation and signal chain to be synthesized */
+typedef struct {
+	SYN_kind_t kind;					///< Single wire or cable
+	uint32_t mains;						///< Mains frequency in Hz, 50 or 60
+	uint32_t rate;						///< Sample rate in Hz
+	float distance;						///< Distance to the conductor in mm
+	float current;						///< Current in the conductor in A
+	float angle;						///< Angle in degrees, positive = left
+	float harmonic[SYN_HARMONICS];		///< 3rd and 5th relative to the 50 Hz
+	float coil_phase;					///< Phase of the coils to the pads in rad
+	float offset;						///< Virtual ground in ADC counts
+	float noise;						///< RMS noise in ADC counts
+	uint32_t seed;						///< Start of the noise sequence, not 0
+} SYN_config_t;
+
+/** Generator state, precomputed from a SYN_config_t */
+typedef struct {
+	SYN_config_t config;				///< Situation of the tables
+	uint32_t period;					///< Samples until the signal repeats
+	uint32_t phase;						///< Index of the next sample
+	uint32_t rng;						///< State of the noise generator
+	int32_t noise[SYN_NOISE_SIZE];		///< Gaussian noise in 1/256 counts
+	int32_t wave[SYN_MAX_PERIOD][INPUTS_NUMS];	///< Signal in 1/256 counts
+	uint16_t quantized[SYN_MAX_PERIOD][INPUTS_NUMS];	///< Noiseless samples
+} SYN_t;
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+void SYN_default(SYN_config_t *config);
+bool SYN_init(SYN_t *syn, const SYN_config_t *config);
+void SYN_frame(SYN_t *syn, uint32_t *samples, uint32_t count);
+float SYN_pad_rms(SYN_kind_t kind, float distance);
+float SYN_coil_rms(float distance, float current);
+
+
+#endif
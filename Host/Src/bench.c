@@ -0,0 +1,373 @@
+/** ***************************************************************************
+ * @file
+ * @brief Time the calculations and the drawing of the firmware on the host
+ *
+ * ==============================================================
+ *
+ * Boots the display like main(), fills ADC_samples with the synthetic
+ * signal of a wire at 20 mm (see synth.c) and calls each benchmarked
+ * function of the firmware many times.
+ * @n The signal generator itself is timed too, with and without noise.
+ * @n The result of every call is compared with the one of the first call,
+ * a function which does not give the same result for the same input
+ * fails the run.
+ *
+ * Usage: bench [-n calls] [-r rounds] [name ...]
+ * - -n calls per round (default 10000)
+ * - -r rounds, the fastest is reported (default 5)
+ * - name only run the benchmarks of these names, e.g. for perf record
+ *
+ * Build with "make SAN=1" to run the firmware code under the address
+ * and undefined behaviour sanitizers.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "stm32f4xx.h"
+#include "stm32f429i_discovery_lcd.h"
+
+#include "host.h"
+#include "graphics.h"
+#include "calculations.h"
+#include "displayingdata.h"
+#include "format.h"
+#include "frames.h"
+#include "measuring.h"
+#include "menu.h"
+#include "plotting.h"
+#include "record.h"
+#include "statistics.h"
+#include "synth.h"
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** One benchmark: how to set it up and one call of the measured code */
+typedef struct {
+	const char *name;					///< Name for the report and selection
+	void (*setup)(void);				///< Called once before the rounds
+	int32_t (*run)(void);				///< Measured call, returns its result
+} BENCH_case_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+bool MEAS_data_wire = false;			///< Defined by main.c on the target
+bool MEAS_data_cable = false;			///< Defined by main.c on the target
+bool MEAS_data_angle = false;			///< Defined by main.c on the target
+
+static uint32_t BENCH_samples[ADC_NUMS*INPUTS_NUMS];	///< Generated input
+static const FRAME_t BENCH_frame = { ADC_samples, ADC_NUMS, 0, 0, 0 };
+static const FRAME_t BENCH_stream = { ADC_samples, ADC_STREAM_NUMS, 0, 0, 0 };
+static DISP_result_t BENCH_result;		///< Input of the show benchmark
+static SYN_t BENCH_syn;					///< Signal generator
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Generate a single acquisition and sort it into the input arrays
+ *
+ * The calculations clear ADC_samples, so the samples are kept in
+ * BENCH_samples and copied back with BENCH_load().
+ *****************************************************************************/
+static void BENCH_generate(void)
+{
+	SYN_config_t config;
+	SYN_default(&config);
+	SYN_init(&BENCH_syn, &config);
+	SYN_frame(&BENCH_syn, BENCH_samples, ADC_NUMS);
+}
+
+
+/** ***************************************************************************
+ * @brief Copy the generated samples into ADC_samples and sort them
+ *****************************************************************************/
+static void BENCH_load(void)
+{
+	memcpy(ADC_samples, BENCH_samples, sizeof(BENCH_samples));
+	MEAS_sort_data(&BENCH_frame);
+}
+
+
+/** Generating a frame of a wire, with and without noise */
+static void BENCH_synth_setup(void)
+{
+	SYN_config_t config;
+	SYN_default(&config);
+	SYN_init(&BENCH_syn, &config);
+}
+static void BENCH_clean_setup(void)
+{
+	SYN_config_t config;
+	SYN_default(&config);
+	config.noise = 0;
+	SYN_init(&BENCH_syn, &config);
+}
+static int32_t BENCH_synth_run(void)
+{
+	SYN_frame(&BENCH_syn, ADC_samples, ADC_NUMS);
+	return 0;
+}
+
+/** Sorting a frame into the input arrays */
+static void BENCH_sort_setup(void) { BENCH_load(); }
+static int32_t BENCH_sort_run(void)
+{
+	MEAS_sort_data(&BENCH_frame);
+	return PAD1_samples[ADC_NUMS/4] + COIL2_samples[ADC_NUMS-1];
+}
+
+/** RMS of the accurate measurement */
+static void BENCH_wire_setup(void)
+{
+	MEAS_data_cable = false;
+	MEAS_data_angle = false;
+	MEAS_data_wire = true;
+	BENCH_load();
+}
+static int32_t BENCH_rms_run(void) { return RMS(50, PAD1_samples); }
+
+/** The same from the sliding windows: a single acquisition more and all
+ * windows of the pad, filled before, the acquisition is 5 periods */
+static void BENCH_sliding_setup(void)
+{
+	BENCH_load();
+	STAT_reset();
+	for (uint32_t i = 0; i < STAT_HISTORY / ADC_NUMS; i++) {
+		STAT_add(&BENCH_frame);
+	}
+}
+static int32_t BENCH_sliding_run(void)
+{
+	STAT_add(&BENCH_frame);
+	return STAT_deviation(0, STAT_SINGLE) + STAT_deviation(0, STAT_ACCURATE)
+			+ STAT_deviation(0, STAT_SECOND);
+}
+
+/** Single calculations of the wire screen */
+static int32_t BENCH_distance_run(void) { return distance_to_cable(0); }
+static int32_t BENCH_current_run(void) { return current(0); }
+static int32_t BENCH_angle_run(void) { return angle_to_cable(); }
+
+/** The current of a strip-chart column, from the values of a wire at 20 mm */
+static int32_t BENCH_estimate_run(void)
+{
+	int32_t half;
+	return CALC_estimate_current(20, 1, 248, 2, &half) + half;
+}
+
+/** All values of the wire screen */
+static int32_t BENCH_calc_run(void)
+{
+	DISP_result_t result;
+	DISP_calc_wire(&result);
+	return result.values[DISP_DIST_ACCU] + result.values[DISP_CURRENT_ACCU];
+}
+
+/** Formatting the fields of the wire screen, without drawing */
+static int32_t BENCH_format_run(void)
+{
+	FMT_text_t text;
+	int32_t sum = 0;
+	for (int32_t i = 0; i < 4; i++) {
+		FMT_clear(&text);
+		FMT_string(&text, "Distance: ");
+		FMT_unit(&text, 20 + i, 4, NULL);
+		sum += text.glyph[text.len - 1];
+	}
+	return sum;
+}
+
+/** Drawing the wire screen, the DMA2D model included */
+static void BENCH_show_setup(void)
+{
+	BENCH_wire_setup();
+	DISP_calc_wire(&BENCH_result);
+	DISP_show(&BENCH_result);
+	GFX_fence();
+}
+static int32_t BENCH_show_run(void)
+{
+	DISP_show(&BENCH_result);
+	GFX_fence();
+	return 0;
+}
+
+/** One half buffer of the strip chart: sort, compute and draw */
+static void BENCH_strip_setup(void)
+{
+	memcpy(ADC_samples, BENCH_samples, sizeof(BENCH_samples));
+	PLOT_start(PLOT_STRIP);
+	GFX_fence();
+}
+static int32_t BENCH_strip_run(void)
+{
+	PLOT_update(&BENCH_stream);
+	GFX_fence();
+	return 0;
+}
+
+
+/** Recording a half buffer into the SDRAM ring and reading a window back,
+ * which spans two blocks */
+static void BENCH_record_setup(void)
+{
+	REC_init((void *)REC_SDRAM_ADDR, REC_SDRAM_SIZE);
+	REC_start();
+	REC_put(BENCH_samples, REC_BLOCK_SAMPLES);
+	REC_put(BENCH_samples, REC_BLOCK_SAMPLES);
+}
+static int32_t BENCH_record_run(void)
+{
+	uint32_t window[REC_BLOCK_SAMPLES*INPUTS_NUMS];
+	uint32_t first, end;
+	int32_t sum = 0;
+	REC_put(BENCH_samples, REC_BLOCK_SAMPLES);
+	REC_range(&first, &end);
+	uint32_t n = REC_read(end - REC_BLOCK_SAMPLES*3/2, REC_BLOCK_SAMPLES, window);
+	for (uint32_t i = 0; i < n*INPUTS_NUMS; i++) {
+		sum += window[i];
+	}
+	return sum;
+}
+
+
+/** Benchmarks in the order they are run */
+static const BENCH_case_t BENCH_cases[] = {
+		{ "synth", BENCH_synth_setup, BENCH_synth_run },
+		{ "clean", BENCH_clean_setup, BENCH_synth_run },
+		{ "sort", BENCH_sort_setup, BENCH_sort_run },
+		{ "rms", BENCH_wire_setup, BENCH_rms_run },
+		{ "sliding", BENCH_sliding_setup, BENCH_sliding_run },
+		{ "distance", BENCH_wire_setup, BENCH_distance_run },
+		{ "current", BENCH_wire_setup, BENCH_current_run },
+		{ "estimate", BENCH_wire_setup, BENCH_estimate_run },
+		{ "angle", BENCH_wire_setup, BENCH_angle_run },
+		{ "calc", BENCH_wire_setup, BENCH_calc_run },
+		{ "format", BENCH_wire_setup, BENCH_format_run },
+		{ "show", BENCH_show_setup, BENCH_show_run },
+		{ "strip", BENCH_strip_setup, BENCH_strip_run },
+		{ "record", BENCH_record_setup, BENCH_record_run },
+};
+
+
+/** ***************************************************************************
+ * @brief Host time in nanoseconds
+ * @return monotonic time
+ *****************************************************************************/
+static double BENCH_ns(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+
+/** ***************************************************************************
+ * @brief Is a benchmark selected on the command line?
+ * @param name of the benchmark
+ * @param argc number of names
+ * @param argv names
+ * @return true if selected or no names given
+ *****************************************************************************/
+static bool BENCH_selected(const char *name, int argc, char *argv[])
+{
+	if (0 == argc) {
+		return true;
+	}
+	for (int i = 0; i < argc; i++) {
+		if (0 == strcmp(name, argv[i])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/** ***************************************************************************
+ * @brief Boot the display, run and time all selected benchmarks
+ * @param argc number of arguments
+ * @param argv arguments, see file description
+ * @return 0 if every benchmark gave the same result in every call
+ *****************************************************************************/
+int main(int argc, char *argv[])
+{
+	uint32_t calls = 10000;
+	uint32_t rounds = 5;
+	int result = 0;
+	int opt;
+	while (-1 != (opt = getopt(argc, argv, "n:r:"))) {
+		switch (opt) {
+		case 'n': calls = strtoul(optarg, NULL, 0); break;
+		case 'r': rounds = strtoul(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-n calls] [-r rounds] [name ...]\n",
+					argv[0]);
+			return 2;
+		}
+	}
+	if ((0 == calls) || (0 == rounds)) {
+		calls = rounds = 1;
+	}
+
+	HOST_reset();						// Same sequence as main()
+	BSP_LCD_Init();
+	GFX_init();
+	DISP_layers_init();
+	BSP_LCD_DisplayOn();
+	MENU_draw();
+	BENCH_generate();
+
+	printf("%-10s %12s %12s %12s\n", "benchmark", "ns/call", "calls", "result");
+	for (uint32_t b = 0; b < sizeof(BENCH_cases)/sizeof(BENCH_cases[0]); b++) {
+		const BENCH_case_t *bench = &BENCH_cases[b];
+		if (!BENCH_selected(bench->name, argc - optind, &argv[optind])) {
+			continue;
+		}
+		bench->setup();
+		int32_t first = bench->run();
+		uint32_t differ = 0;
+		double best = 0;
+		for (uint32_t r = 0; r < rounds; r++) {
+			double t0 = BENCH_ns();
+			for (uint32_t n = 0; n < calls; n++) {
+				if (bench->run() != first) {
+					differ++;
+				}
+			}
+			double t = (BENCH_ns() - t0) / calls;
+			if ((0 == r) || (t < best)) {
+				best = t;
+			}
+		}
+		printf("%-10s %12.1f %12u %12d\n", bench->name, best,
+				(unsigned)(calls * rounds), (int)first);
+		if (differ > 0) {
+			fprintf(stderr, "%s: %u calls with a different result\n",
+					bench->name, (unsigned)differ);
+			result = 1;
+		}
+	}
+	if (HOST_dma2d_stats.errors > 0) {
+		fprintf(stderr, "%u DMA2D transfers with unsupported setup\n",
+				(unsigned)HOST_dma2d_stats.errors);
+		result = 1;
+	}
+	return result;
+}
@@ -0,0 +1,137 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host memory of the core and device peripherals, interrupt dispatch
+ *
+ * ==============================================================
+ *
+ * The firmware accesses the peripherals through the macros of the device
+ * header, which the host headers redirect to the arrays and structs here.
+ * @n Writing a register has no side effect by itself.
+ * The peripheral models run in HOST_step(), which is called whenever the
+ * firmware enables or pends an interrupt, unmasks interrupts or waits
+ * for one (__WFI()).
+ * HOST_step() then calls the handlers of all enabled and pending interrupts
+ * until nothing is left to do, like the NVIC would after the instruction.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <string.h>
+#include "stm32f4xx.h"
+#include "stm32f429i_discovery_lcd.h"
+
+#include "host.h"
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+uint8_t HOST_periph[HOST_PERIPH_SIZE] __attribute__((aligned(1024)));
+uint8_t HOST_sdram[HOST_SDRAM_SIZE] __attribute__((aligned(1024)));
+
+NVIC_Type HOST_nvic;
+SCB_Type HOST_scb;
+SysTick_Type HOST_systick;
+DWT_Type HOST_dwt;
+CoreDebug_Type HOST_coredebug;
+uint32_t HOST_primask = 0;
+uint32_t SystemCoreClock = 168000000;	///< Like the board after clock setup
+
+/** Interrupt handlers of the firmware, undefined ones are NULL */
+extern void EXTI0_IRQHandler(void) __attribute__((weak));
+extern void ADC_IRQHandler(void) __attribute__((weak));
+extern void TIM2_IRQHandler(void) __attribute__((weak));
+extern void USART1_IRQHandler(void) __attribute__((weak));
+extern void EXTI15_10_IRQHandler(void) __attribute__((weak));
+extern void DMA2_Stream0_IRQHandler(void) __attribute__((weak));
+extern void DMA2_Stream1_IRQHandler(void) __attribute__((weak));
+extern void DMA2_Stream3_IRQHandler(void) __attribute__((weak));
+extern void DMA2_Stream4_IRQHandler(void) __attribute__((weak));
+extern void DMA2_Stream7_IRQHandler(void) __attribute__((weak));
+extern void DMA2D_IRQHandler(void) __attribute__((weak));
+
+/** Vector table of the device interrupts */
+static void (* const HOST_vector[HOST_IRQ_COUNT])(void) = {
+		[EXTI0_IRQn] = EXTI0_IRQHandler,
+		[ADC_IRQn] = ADC_IRQHandler,
+		[TIM2_IRQn] = TIM2_IRQHandler,
+		[USART1_IRQn] = USART1_IRQHandler,
+		[EXTI15_10_IRQn] = EXTI15_10_IRQHandler,
+		[DMA2_Stream0_IRQn] = DMA2_Stream0_IRQHandler,
+		[DMA2_Stream1_IRQn] = DMA2_Stream1_IRQHandler,
+		[DMA2_Stream3_IRQn] = DMA2_Stream3_IRQHandler,
+		[DMA2_Stream4_IRQn] = DMA2_Stream4_IRQHandler,
+		[DMA2_Stream7_IRQn] = DMA2_Stream7_IRQHandler,
+		[DMA2D_IRQn] = DMA2D_IRQHandler,
+};
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Power on reset of all simulated registers and counters
+ *
+ * The SDRAM keeps its content like on the board.
+ *****************************************************************************/
+void HOST_reset(void)
+{
+	memset(HOST_periph, 0, sizeof(HOST_periph));
+	memset(&HOST_nvic, 0, sizeof(HOST_nvic));
+	memset(&HOST_scb, 0, sizeof(HOST_scb));
+	memset(&HOST_systick, 0, sizeof(HOST_systick));
+	memset(&HOST_dwt, 0, sizeof(HOST_dwt));
+	memset(&HOST_coredebug, 0, sizeof(HOST_coredebug));
+	memset(&HOST_dma2d_stats, 0, sizeof(HOST_dma2d_stats));
+	HOST_primask = 0;
+	HOST_tick = 0;
+}
+
+
+/** ***************************************************************************
+ * @brief Run the peripheral models and the pending interrupt handlers
+ *
+ * A call from inside a handler returns immediately,
+ * the outermost call continues until no work is left.
+ *****************************************************************************/
+void HOST_step(void)
+{
+	static bool active = false;
+	bool again;
+	if (active) {						// Handlers do not nest
+		return;
+	}
+	active = true;
+	do {
+		again = false;
+		DMA2->LISR &= ~DMA2->LIFCR;		// Write 1 to clear
+		DMA2->HISR &= ~DMA2->HIFCR;
+		DMA2->LIFCR = 0;
+		DMA2->HIFCR = 0;
+		HOST_dma2d_run();
+		HOST_uart_run();
+		if (0U != HOST_primask) {
+			break;
+		}
+		for (uint32_t irq = 0; irq < HOST_IRQ_COUNT; irq++) {
+			uint32_t mask = 1UL << (irq & 0x1FU);
+			uint32_t word = irq >> 5U;
+			if ((HOST_nvic.ISER[word] & HOST_nvic.ISPR[word] & mask)
+					&& (NULL != HOST_vector[irq])) {
+				HOST_nvic.ISPR[word] &= ~mask;
+				HOST_nvic.IABR[word] |= mask;
+				HOST_vector[irq]();
+				HOST_nvic.IABR[word] &= ~mask;
+				again = true;
+			}
+		}
+	} while (again);
+	active = false;
+}
@@ -0,0 +1,260 @@
+/** ***************************************************************************
+ * @file
+ * @brief Software model of the DMA2D graphics accelerator
+ *
+ * ==============================================================
+ *
+ * Executes a started transfer when HOST_step() runs, i.e. before the
+ * firmware can observe the result, and raises the transfer complete
+ * interrupt if it is enabled.
+ * @n Supported are all four modes with ARGB8888 output and the input color
+ * modes ARGB8888, RGB888, RGB565, ARGB1555, ARGB4444 and A8.
+ * Other setups set the transfer error flag.
+ *
+ * The pixels and bytes of every transfer are counted in HOST_dma2d_stats,
+ * which gives the memory traffic caused by the rendering.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <string.h>
+#include "stm32f4xx.h"
+
+#include "host.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define DMA2D_CM_ARGB8888	0U			///< Color mode ARGB8888
+#define DMA2D_CM_RGB888		1U			///< Color mode RGB888
+#define DMA2D_CM_RGB565		2U			///< Color mode RGB565
+#define DMA2D_CM_ARGB1555	3U			///< Color mode ARGB1555
+#define DMA2D_CM_ARGB4444	4U			///< Color mode ARGB4444
+#define DMA2D_CM_A8			9U			///< Color mode A8
+
+#define DMA2D_MODE_M2M		0U			///< Memory to memory
+#define DMA2D_MODE_PFC		1U			///< Memory to memory with PFC
+#define DMA2D_MODE_BLEND	2U			///< Memory to memory with blending
+#define DMA2D_MODE_R2M		3U			///< Register to memory
+
+/** Address in host memory of a 32 bit DMA2D address register value */
+#define HOST_ADDR(a)		((uint8_t *)(uintptr_t)(a))
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+HOST_dma2d_stats_t HOST_dma2d_stats;	///< Work done since HOST_reset()
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static uint32_t DMA2D_bytes(uint32_t cm);
+static uint32_t DMA2D_read(const uint8_t *p, uint32_t cm, uint32_t color);
+static uint32_t DMA2D_alpha(uint32_t argb, uint32_t pfccr);
+static uint32_t DMA2D_blend(uint32_t fg, uint32_t bg);
+static bool DMA2D_transfer(void);
+
+
+/** ***************************************************************************
+ * @brief Execute a started transfer and raise its interrupt
+ *
+ * Called by HOST_step().
+ *****************************************************************************/
+void HOST_dma2d_run(void)
+{
+	DMA2D->ISR &= ~DMA2D->IFCR;			// Write 1 to clear
+	DMA2D->IFCR = 0;
+	if (0U == (DMA2D->CR & DMA2D_CR_START)) {
+		return;
+	}
+	bool ok = DMA2D_transfer();
+	DMA2D->CR &= ~DMA2D_CR_START;
+	DMA2D->ISR |= ok ? DMA2D_ISR_TCIF : DMA2D_ISR_TEIF;
+	if ((ok && (DMA2D->CR & DMA2D_CR_TCIE))
+			|| (!ok && (DMA2D->CR & DMA2D_CR_TEIE))) {
+		NVIC->ISPR[DMA2D_IRQn >> 5U] |= 1UL << (DMA2D_IRQn & 0x1FU);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Bytes per pixel of a color mode
+ * @param cm color mode
+ * @return bytes or 0 if not supported
+ *****************************************************************************/
+static uint32_t DMA2D_bytes(uint32_t cm)
+{
+	switch (cm) {
+	case DMA2D_CM_ARGB8888:	return 4;
+	case DMA2D_CM_RGB888:	return 3;
+	case DMA2D_CM_RGB565:
+	case DMA2D_CM_ARGB1555:
+	case DMA2D_CM_ARGB4444:	return 2;
+	case DMA2D_CM_A8:		return 1;
+	default:				return 0;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Read a pixel and convert it to ARGB8888
+ * @param p address of the pixel
+ * @param cm color mode of the pixel
+ * @param color RGB used for A8 pixels
+ * @return ARGB8888 value
+ *****************************************************************************/
+static uint32_t DMA2D_read(const uint8_t *p, uint32_t cm, uint32_t color)
+{
+	uint32_t v, a, r, g, b;
+	switch (cm) {
+	case DMA2D_CM_ARGB8888:
+		memcpy(&v, p, 4);
+		return v;
+	case DMA2D_CM_RGB888:
+		return 0xFF000000UL | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0];
+	case DMA2D_CM_RGB565:
+		v = p[0] | ((uint32_t)p[1] << 8);
+		r = (v >> 11) & 0x1F;
+		g = (v >> 5) & 0x3F;
+		b = v & 0x1F;
+		return 0xFF000000UL | (((r << 3) | (r >> 2)) << 16)
+				| (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+	case DMA2D_CM_ARGB1555:
+		v = p[0] | ((uint32_t)p[1] << 8);
+		a = (v & 0x8000) ? 0xFF : 0x00;
+		r = (v >> 10) & 0x1F;
+		g = (v >> 5) & 0x1F;
+		b = v & 0x1F;
+		return (a << 24) | (((r << 3) | (r >> 2)) << 16)
+				| (((g << 3) | (g >> 2)) << 8) | ((b << 3) | (b >> 2));
+	case DMA2D_CM_ARGB4444:
+		v = p[0] | ((uint32_t)p[1] << 8);
+		return (((v >> 12) & 0xF) * 0x11UL << 24) | (((v >> 8) & 0xF) * 0x11UL << 16)
+				| (((v >> 4) & 0xF) * 0x11UL << 8) | ((v & 0xF) * 0x11UL);
+	case DMA2D_CM_A8:
+		return ((uint32_t)p[0] << 24) | (color & 0x00FFFFFF);
+	default:
+		return 0;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Apply the alpha mode of a PFC control register
+ * @param argb pixel
+ * @param pfccr FGPFCCR or BGPFCCR
+ * @return pixel with modified alpha
+ *****************************************************************************/
+static uint32_t DMA2D_alpha(uint32_t argb, uint32_t pfccr)
+{
+	uint32_t alpha = (pfccr & DMA2D_FGPFCCR_ALPHA) >> DMA2D_FGPFCCR_ALPHA_Pos;
+	uint32_t a = argb >> 24;
+	switch ((pfccr & DMA2D_FGPFCCR_AM) >> DMA2D_FGPFCCR_AM_Pos) {
+	case 1: a = alpha; break;			// Replace
+	case 2: a = a * alpha / 255; break;	// Multiply
+	default: break;						// Unchanged
+	}
+	return (a << 24) | (argb & 0x00FFFFFF);
+}
+
+
+/** ***************************************************************************
+ * @brief Blend two ARGB8888 pixels like the DMA2D
+ * @param fg foreground
+ * @param bg background
+ * @return blended pixel
+ *****************************************************************************/
+static uint32_t DMA2D_blend(uint32_t fg, uint32_t bg)
+{
+	uint32_t af = fg >> 24;
+	uint32_t ab = bg >> 24;
+	uint32_t am = af * ab / 255;
+	uint32_t ao = af + ab - am;
+	uint32_t out = ao << 24;
+	if (0U == ao) {
+		return 0;
+	}
+	for (uint32_t shift = 0; shift < 24; shift += 8) {
+		uint32_t cf = (fg >> shift) & 0xFF;
+		uint32_t cb = (bg >> shift) & 0xFF;
+		out |= ((cf * af + cb * ab - cb * am) / ao) << shift;
+	}
+	return out;
+}
+
+
+/** ***************************************************************************
+ * @brief Execute the transfer set up in the registers
+ * @return false if the setup is not supported
+ *****************************************************************************/
+static bool DMA2D_transfer(void)
+{
+	uint32_t mode = (DMA2D->CR & DMA2D_CR_MODE) >> DMA2D_CR_MODE_Pos;
+	uint32_t width = (DMA2D->NLR & DMA2D_NLR_PL) >> DMA2D_NLR_PL_Pos;
+	uint32_t height = DMA2D->NLR & DMA2D_NLR_NL;
+	uint32_t fg_cm = DMA2D->FGPFCCR & DMA2D_FGPFCCR_CM;
+	uint32_t bg_cm = DMA2D->BGPFCCR & DMA2D_BGPFCCR_CM;
+	uint32_t fg_bytes = DMA2D_bytes(fg_cm);
+	uint32_t bg_bytes = DMA2D_bytes(bg_cm);
+	uint8_t *out = HOST_ADDR(DMA2D->OMAR);
+	const uint8_t *fg = HOST_ADDR(DMA2D->FGMAR);
+	const uint8_t *bg = HOST_ADDR(DMA2D->BGMAR);
+	HOST_dma2d_stats.transfers[mode]++;
+	if ((DMA2D_CM_ARGB8888 != (DMA2D->OPFCCR & DMA2D_OPFCCR_CM))
+			|| ((DMA2D_MODE_R2M != mode) && (0U == fg_bytes))
+			|| ((DMA2D_MODE_BLEND == mode) && (0U == bg_bytes))) {
+		HOST_dma2d_stats.errors++;
+		return false;
+	}
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			uint32_t argb;
+			switch (mode) {
+			case DMA2D_MODE_M2M:		// Raw copy in the input format
+				memmove(out, fg, fg_bytes);
+				out += fg_bytes;
+				fg += fg_bytes;
+				HOST_dma2d_stats.bytes_read += fg_bytes;
+				HOST_dma2d_stats.bytes_written += fg_bytes;
+				continue;
+			case DMA2D_MODE_PFC:
+				argb = DMA2D_alpha(DMA2D_read(fg, fg_cm, DMA2D->FGCOLR),
+						DMA2D->FGPFCCR);
+				fg += fg_bytes;
+				HOST_dma2d_stats.bytes_read += fg_bytes;
+				break;
+			case DMA2D_MODE_BLEND:
+				argb = DMA2D_blend(
+						DMA2D_alpha(DMA2D_read(fg, fg_cm, DMA2D->FGCOLR),
+								DMA2D->FGPFCCR),
+						DMA2D_alpha(DMA2D_read(bg, bg_cm, DMA2D->BGCOLR),
+								DMA2D->BGPFCCR));
+				fg += fg_bytes;
+				bg += bg_bytes;
+				HOST_dma2d_stats.bytes_read += fg_bytes + bg_bytes;
+				break;
+			default:					// Register to memory
+				argb = DMA2D->OCOLR;
+				break;
+			}
+			memcpy(out, &argb, 4);
+			out += 4;
+			HOST_dma2d_stats.bytes_written += 4;
+		}
+		uint32_t out_bytes = (DMA2D_MODE_M2M == mode) ? fg_bytes : 4;
+		out += (DMA2D->OOR & DMA2D_OOR_LO) * out_bytes;
+		fg += (DMA2D->FGOR & DMA2D_FGOR_LO) * fg_bytes;
+		bg += (DMA2D->BGOR & DMA2D_BGOR_LO) * bg_bytes;
+	}
+	HOST_dma2d_stats.pixels += (uint64_t)width * height;
+	return true;
+}
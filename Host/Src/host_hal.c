@@ -0,0 +1,216 @@
+/** ***************************************************************************
+ * @file
+ * @brief Stand-ins for the HAL and BSP functions without a register model
+ *
+ * ==============================================================
+ *
+ * The LTDC and GPIO HAL drivers, the BSP LCD driver and the ILI9341 driver
+ * are compiled unchanged for the host.
+ * The functions here replace the parts which talk to hardware that is not
+ * modelled: clock tree, SDRAM controller and its DMA, SPI to the display controller,
+ * touch controller and LEDs.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <string.h>
+#include "stm32f4xx.h"
+#include "stm32f429i_discovery.h"
+#include "stm32f429i_discovery_lcd.h"
+#include "stm32f429i_discovery_sdram.h"
+#include "stm32f429i_discovery_ts.h"
+
+#include "host.h"
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+volatile uint32_t HOST_tick = 0;		///< Milliseconds since HOST_reset()
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief HAL initialization, nothing to do on the host
+ * @return HAL_OK
+ *****************************************************************************/
+HAL_StatusTypeDef HAL_Init(void)
+{
+	return HAL_OK;
+}
+
+
+/** ***************************************************************************
+ * @brief Milliseconds since the start
+ * @return HOST_tick
+ *****************************************************************************/
+uint32_t HAL_GetTick(void)
+{
+	return HOST_tick;
+}
+
+
+/** ***************************************************************************
+ * @brief Advance the simulated time without waiting
+ * @param Delay milliseconds
+ *****************************************************************************/
+void HAL_Delay(uint32_t Delay)
+{
+	HOST_tick += Delay;
+	HOST_step();
+}
+
+
+/** ***************************************************************************
+ * @brief Clock configuration, the PLLSAI is always ready on the host
+ * @param PeriphClkInit unused
+ * @return HAL_OK
+ *****************************************************************************/
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit)
+{
+	(void)PeriphClkInit;
+	return HAL_OK;
+}
+
+
+/** ***************************************************************************
+ * @brief SDRAM initialization, the SDRAM is the array HOST_sdram
+ * @return SDRAM_OK
+ *
+ * Enables the interrupt of the SDRAM DMA like the BSP.
+ *****************************************************************************/
+uint8_t BSP_SDRAM_Init(void)
+{
+	NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+	return SDRAM_OK;
+}
+
+
+/** ***************************************************************************
+ * @brief Write to the SDRAM by DMA, copies at once
+ * @param uwStartAddress destination
+ * @param pData source
+ * @param uwDataSize words
+ * @return SDRAM_OK
+ *
+ * The transfer complete interrupt is pended, its handler runs
+ * like on the target when the firmware allows it.
+ *****************************************************************************/
+uint8_t BSP_SDRAM_WriteData_DMA(uint32_t uwStartAddress, uint32_t *pData,
+		uint32_t uwDataSize)
+{
+	memcpy((void *)(uintptr_t)uwStartAddress, pData, uwDataSize * sizeof(uint32_t));
+	NVIC_SetPendingIRQ(DMA2_Stream0_IRQn);
+	return SDRAM_OK;
+}
+
+
+/** ***************************************************************************
+ * @brief Interrupt of the SDRAM DMA, the transfer is always complete
+ *****************************************************************************/
+void BSP_SDRAM_DMA_IRQHandler(void)
+{
+	HAL_SDRAM_DMA_XferCpltCallback(NULL);
+}
+
+
+/** ***************************************************************************
+ * @brief SPI interface of the ILI9341, commands are ignored
+ *****************************************************************************/
+void LCD_IO_Init(void)
+{
+}
+
+void LCD_IO_WriteData(uint16_t RegValue)
+{
+	(void)RegValue;
+}
+
+void LCD_IO_WriteReg(uint8_t Reg)
+{
+	(void)Reg;
+}
+
+uint32_t LCD_IO_ReadData(uint16_t RegValue, uint8_t ReadSize)
+{
+	(void)RegValue;
+	(void)ReadSize;
+	return 0;
+}
+
+void LCD_Delay(uint32_t Delay)
+{
+	HAL_Delay(Delay);
+}
+
+
+/** ***************************************************************************
+ * @brief Touchscreen, never touched on the host
+ *****************************************************************************/
+uint8_t BSP_TS_Init(uint16_t XSize, uint16_t YSize)
+{
+	(void)XSize;
+	(void)YSize;
+	return TS_OK;
+}
+
+void BSP_TS_GetState(TS_StateTypeDef *TsState)
+{
+	TsState->TouchDetected = 0;
+	TsState->X = 0;
+	TsState->Y = 0;
+	TsState->Z = 0;
+}
+
+uint8_t BSP_TS_ITGetStatus(void)
+{
+	return 0;
+}
+
+void BSP_TS_ITClear(void)
+{
+}
+
+uint8_t BSP_TS_ITConfig(void)
+{
+	return TS_OK;
+}
+
+void stmpe811_DisableITSource(uint16_t DeviceAddr, uint8_t Source)
+{
+	(void)DeviceAddr;
+	(void)Source;
+}
+
+
+/** ***************************************************************************
+ * @brief LEDs, ignored on the host
+ *****************************************************************************/
+void BSP_LED_Init(Led_TypeDef Led)
+{
+	(void)Led;
+}
+
+void BSP_LED_On(Led_TypeDef Led)
+{
+	(void)Led;
+}
+
+void BSP_LED_Off(Led_TypeDef Led)
+{
+	(void)Led;
+}
+
+void BSP_LED_Toggle(Led_TypeDef Led)
+{
+	(void)Led;
+}
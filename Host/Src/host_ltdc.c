@@ -0,0 +1,353 @@
+/** ***************************************************************************
+ * @file
+ * @brief Visible screen composed from the LTDC registers, image files
+ *
+ * ==============================================================
+ *
+ * HOST_ltdc_compose() does what the LTDC does for one frame:
+ * Both layers are read from their framebuffers at the configured address,
+ * window and pitch, color keyed and blended onto the background color
+ * with the configured blending factors and constant alpha.
+ * @n Only the ARGB8888 pixel format is supported, other layers show their
+ * default color.
+ *
+ * The result can be written as binary PPM (P6) or as PNG.
+ * The PNG uses uncompressed deflate blocks, so no zlib is needed.
+ * @n HOST_load() reads other files of the host tools, e.g. captures.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f4xx.h"
+
+#include "host.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define LTDC_BF1_CA			4U			///< Blending factor constant alpha
+#define LTDC_BF1_PAxCA		6U			///< Blending factor pixel x constant
+#define PNG_BLOCK			65535U		///< Max. size of a stored deflate block
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static void LTDC_layer(HOST_screen_t *screen, LTDC_Layer_TypeDef *layer,
+		uint32_t ahbp, uint32_t avbp);
+static uint32_t PNG_crc(uint32_t crc, const uint8_t *data, size_t len);
+static void PNG_chunk(FILE *f, const char *type, const uint8_t *data,
+		uint32_t len);
+static void PNG_put32(uint8_t *p, uint32_t v);
+
+
+/** ***************************************************************************
+ * @brief Compose the visible screen from the LTDC layers
+ * @param screen result
+ *****************************************************************************/
+void HOST_ltdc_compose(HOST_screen_t *screen)
+{
+	uint32_t ahbp = (LTDC->BPCR & LTDC_BPCR_AHBP) >> LTDC_BPCR_AHBP_Pos;
+	uint32_t avbp = LTDC->BPCR & LTDC_BPCR_AVBP;
+	uint32_t aaw = (LTDC->AWCR & LTDC_AWCR_AAW) >> LTDC_AWCR_AAW_Pos;
+	uint32_t aah = LTDC->AWCR & LTDC_AWCR_AAH;
+	screen->width = (aaw > ahbp) ? aaw - ahbp : 0;
+	screen->height = (aah > avbp) ? aah - avbp : 0;
+	if (screen->width * screen->height > HOST_LCD_MAX_PIXELS) {
+		screen->width = 0;
+		screen->height = 0;
+	}
+	for (uint32_t i = 0; i < screen->width * screen->height; i++) {
+		screen->pixel[i] = 0xFF000000UL | (LTDC->BCCR & 0x00FFFFFF);
+	}
+	LTDC_layer(screen, LTDC_Layer1, ahbp, avbp);
+	LTDC_layer(screen, LTDC_Layer2, ahbp, avbp);
+}
+
+
+/** ***************************************************************************
+ * @brief Blend one layer onto the screen
+ * @param screen screen with the layers below
+ * @param layer registers of the layer
+ * @param ahbp accumulated horizontal back porch
+ * @param avbp accumulated vertical back porch
+ *****************************************************************************/
+static void LTDC_layer(HOST_screen_t *screen, LTDC_Layer_TypeDef *layer,
+		uint32_t ahbp, uint32_t avbp)
+{
+	if (0U == (layer->CR & LTDC_LxCR_LEN)) {
+		return;
+	}
+	int32_t x0 = (int32_t)(layer->WHPCR & LTDC_LxWHPCR_WHSTPOS) - (int32_t)ahbp - 1;
+	int32_t x1 = (int32_t)((layer->WHPCR & LTDC_LxWHPCR_WHSPPOS) >> 16) - (int32_t)ahbp;
+	int32_t y0 = (int32_t)(layer->WVPCR & LTDC_LxWVPCR_WVSTPOS) - (int32_t)avbp - 1;
+	int32_t y1 = (int32_t)((layer->WVPCR & LTDC_LxWVPCR_WVSPPOS) >> 16) - (int32_t)avbp;
+	uint32_t pitch = (layer->CFBLR & LTDC_LxCFBLR_CFBP) >> LTDC_LxCFBLR_CFBP_Pos;
+	uint32_t bf1 = (layer->BFCR & LTDC_LxBFCR_BF1) >> 8;
+	uint32_t ca = layer->CACR & LTDC_LxCACR_CONSTA;
+	bool keying = (0U != (layer->CR & LTDC_LxCR_COLKEN));
+	bool argb = (0U == (layer->PFCR & LTDC_LxPFCR_PF));
+	const uint8_t *fb = (const uint8_t *)(uintptr_t)layer->CFBAR;
+	for (int32_t y = y0; y < y1; y++) {
+		if ((y < 0) || (y >= (int32_t)screen->height)) {
+			continue;
+		}
+		for (int32_t x = x0; x < x1; x++) {
+			if ((x < 0) || (x >= (int32_t)screen->width)) {
+				continue;
+			}
+			uint32_t px = layer->DCCR;
+			if (argb) {
+				memcpy(&px, fb + (y - y0) * pitch + (x - x0) * 4, 4);
+			}
+			if (keying && ((px & 0x00FFFFFF) == (layer->CKCR & 0x00FFFFFF))) {
+				px = 0;					// Keyed pixels are fully transparent
+			}
+			uint32_t a = (LTDC_BF1_PAxCA == bf1) ? (px >> 24) * ca / 255 : ca;
+			uint32_t *dst = &screen->pixel[y * screen->width + x];
+			uint32_t out = 0xFF000000UL;
+			for (uint32_t shift = 0; shift < 24; shift += 8) {
+				uint32_t c = (px >> shift) & 0xFF;
+				uint32_t b = (*dst >> shift) & 0xFF;
+				out |= ((c * a + b * (255 - a)) / 255) << shift;
+			}
+			*dst = out;
+		}
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Write a screen as image file
+ * @param path file name, ending .png writes PNG, everything else PPM
+ * @param screen composed screen
+ * @return false if the file could not be written
+ *****************************************************************************/
+bool HOST_write_image(const char *path, const HOST_screen_t *screen)
+{
+	size_t len = strlen(path);
+	bool png = (len > 4) && (0 == strcmp(path + len - 4, ".png"));
+	uint32_t w = screen->width;
+	uint32_t h = screen->height;
+	FILE *f = fopen(path, "wb");
+	if (NULL == f) {
+		return false;
+	}
+	if (!png) {
+		fprintf(f, "P6\n%u %u\n255\n", (unsigned)w, (unsigned)h);
+		for (uint32_t i = 0; i < w * h; i++) {
+			uint32_t px = screen->pixel[i];
+			uint8_t rgb[3] = { px >> 16, px >> 8, px };
+			fwrite(rgb, 1, 3, f);
+		}
+		return 0 == fclose(f);
+	}
+	/* Raw image: filter byte 0 and RGB per row */
+	size_t raw_len = (size_t)h * (1 + 3 * w);
+	size_t blocks = (raw_len + PNG_BLOCK - 1) / PNG_BLOCK;
+	size_t z_len = 2 + raw_len + 5 * blocks + 4;
+	uint8_t *raw = malloc(raw_len);
+	uint8_t *z = malloc(z_len);
+	if ((NULL == raw) || (NULL == z)) {
+		free(raw);
+		free(z);
+		fclose(f);
+		return false;
+	}
+	uint8_t *p = raw;
+	for (uint32_t y = 0; y < h; y++) {
+		*p++ = 0;
+		for (uint32_t x = 0; x < w; x++) {
+			uint32_t px = screen->pixel[y * w + x];
+			*p++ = px >> 16;
+			*p++ = px >> 8;
+			*p++ = px;
+		}
+	}
+	/* zlib stream with stored deflate blocks and Adler-32 */
+	uint32_t s1 = 1, s2 = 0;
+	for (size_t i = 0; i < raw_len; i++) {
+		s1 = (s1 + raw[i]) % 65521;
+		s2 = (s2 + s1) % 65521;
+	}
+	p = z;
+	*p++ = 0x78;
+	*p++ = 0x01;
+	for (size_t pos = 0; pos < raw_len; pos += PNG_BLOCK) {
+		uint32_t n = (raw_len - pos > PNG_BLOCK) ? PNG_BLOCK : raw_len - pos;
+		*p++ = (pos + n == raw_len) ? 1 : 0;	// Final block flag
+		*p++ = n;
+		*p++ = n >> 8;
+		*p++ = ~n;
+		*p++ = ~n >> 8;
+		memcpy(p, raw + pos, n);
+		p += n;
+	}
+	PNG_put32(p, (s2 << 16) | s1);
+	uint8_t ihdr[13];
+	PNG_put32(ihdr, w);
+	PNG_put32(ihdr + 4, h);
+	ihdr[8] = 8;						// Bit depth
+	ihdr[9] = 2;						// Truecolor
+	ihdr[10] = ihdr[11] = ihdr[12] = 0;	// Deflate, no filter, no interlace
+	fwrite("\x89PNG\r\n\x1a\n", 1, 8, f);
+	PNG_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+	PNG_chunk(f, "IDAT", z, z_len);
+	PNG_chunk(f, "IEND", NULL, 0);
+	free(raw);
+	free(z);
+	return 0 == fclose(f);
+}
+
+
+/** ***************************************************************************
+ * @brief Read a binary PPM written by HOST_write_image()
+ * @param path file name
+ * @param screen result
+ * @return false if the file is missing or not a matching PPM
+ *****************************************************************************/
+bool HOST_read_ppm(const char *path, HOST_screen_t *screen)
+{
+	unsigned w, h, max;
+	FILE *f = fopen(path, "rb");
+	if (NULL == f) {
+		return false;
+	}
+	if ((3 != fscanf(f, "P6 %u %u %u", &w, &h, &max)) || (255 != max)
+			|| (w * h > HOST_LCD_MAX_PIXELS) || ('\n' != fgetc(f))) {
+		fclose(f);
+		return false;
+	}
+	screen->width = w;
+	screen->height = h;
+	for (uint32_t i = 0; i < w * h; i++) {
+		uint8_t rgb[3];
+		if (3 != fread(rgb, 1, 3, f)) {
+			fclose(f);
+			return false;
+		}
+		screen->pixel[i] = 0xFF000000UL | ((uint32_t)rgb[0] << 16)
+				| ((uint32_t)rgb[1] << 8) | rgb[2];
+	}
+	fclose(f);
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Read a whole file into memory
+ * @param path file name
+ * @param size set to the bytes read
+ * @return buffer to be freed, NULL on error
+ *****************************************************************************/
+uint8_t *HOST_load(const char *path, uint32_t *size)
+{
+	FILE *file = fopen(path, "rb");
+	uint8_t *buffer = NULL;
+	long length = -1;
+	if ((NULL != file) && (0 == fseek(file, 0, SEEK_END))) {
+		length = ftell(file);
+		rewind(file);
+	}
+	if ((length > 0) && (length <= UINT32_MAX)) {
+		buffer = malloc(length);
+		if ((NULL != buffer) && (fread(buffer, 1, length, file) != (size_t)length)) {
+			free(buffer);
+			buffer = NULL;
+		}
+	}
+	if (NULL != file) {
+		fclose(file);
+	}
+	*size = (NULL != buffer) ? (uint32_t)length : 0;
+	return buffer;
+}
+
+
+/** ***************************************************************************
+ * @brief Compare two screens
+ * @param a first screen
+ * @param b second screen
+ * @return number of different pixels, all pixels if the sizes differ
+ *****************************************************************************/
+uint32_t HOST_compare(const HOST_screen_t *a, const HOST_screen_t *b)
+{
+	if ((a->width != b->width) || (a->height != b->height)) {
+		return HOST_LCD_MAX_PIXELS;
+	}
+	uint32_t diff = 0;
+	for (uint32_t i = 0; i < a->width * a->height; i++) {
+		if ((a->pixel[i] ^ b->pixel[i]) & 0x00FFFFFF) {
+			diff++;
+		}
+	}
+	return diff;
+}
+
+
+/** ***************************************************************************
+ * @brief CRC-32 as used by PNG
+ * @param crc CRC of the previous data, 0 at the start
+ * @param data bytes
+ * @param len number of bytes
+ * @return updated CRC
+ *****************************************************************************/
+static uint32_t PNG_crc(uint32_t crc, const uint8_t *data, size_t len)
+{
+	crc = ~crc;
+	for (size_t i = 0; i < len; i++) {
+		crc ^= data[i];
+		for (uint32_t k = 0; k < 8; k++) {
+			crc = (crc >> 1) ^ (0xEDB88320UL & (0U - (crc & 1U)));
+		}
+	}
+	return ~crc;
+}
+
+
+/** ***************************************************************************
+ * @brief Write a PNG chunk with length and CRC
+ * @param f file
+ * @param type four character chunk type
+ * @param data chunk data
+ * @param len bytes of chunk data
+ *****************************************************************************/
+static void PNG_chunk(FILE *f, const char *type, const uint8_t *data,
+		uint32_t len)
+{
+	uint8_t word[4];
+	PNG_put32(word, len);
+	fwrite(word, 1, 4, f);
+	fwrite(type, 1, 4, f);
+	uint32_t crc = PNG_crc(0, (const uint8_t *)type, 4);
+	if (len > 0) {
+		fwrite(data, 1, len, f);
+		crc = PNG_crc(crc, data, len);
+	}
+	PNG_put32(word, crc);
+	fwrite(word, 1, 4, f);
+}
+
+
+/** ***************************************************************************
+ * @brief Store a 32 bit value big endian
+ * @param p destination
+ * @param v value
+ *****************************************************************************/
+static void PNG_put32(uint8_t *p, uint32_t v)
+{
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >> 8;
+	p[3] = v;
+}
@@ -0,0 +1,123 @@
+/** ***************************************************************************
+ * @file
+ * @brief Model of USART1 with its DMA streams, DMA2_Stream7 and 5
+ *
+ * ==============================================================
+ *
+ * A transfer started by the firmware is written to the file descriptor
+ * HOST_uart_fd when HOST_step() runs, e.g. the master of a pseudo-terminal
+ * (see teldec.c) in place of the ST-LINK virtual COM port.
+ * Without a descriptor the bytes are discarded like on an open line.
+ *
+ * A non-blocking descriptor which takes only a part of the bytes leaves
+ * the rest of the transfer running, like a slow line:
+ * the transfer complete interrupt comes after the last byte.
+ * The baud rate is not modelled.
+ *
+ * Bytes readable from HOST_uart_fd are received by the circular DMA
+ * of the receiver (DMA2_Stream5), followed by the idle line interrupt.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <unistd.h>
+#include "stm32f4xx.h"
+
+#include "host.h"
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+int HOST_uart_fd = -1;					///< Receives the bytes, -1 = discard
+uint64_t HOST_uart_bytes = 0;			///< Bytes sent since start
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Receive the bytes available on HOST_uart_fd
+ *****************************************************************************/
+static void HOST_uart_receive(void)
+{
+	static uint32_t reload = 0;			// Size of the circular transfer
+	if (!(DMA2_Stream5->CR & DMA_SxCR_EN)) {
+		reload = 0;
+		return;
+	}
+	if (!(USART1->CR1 & USART_CR1_UE) || !(USART1->CR1 & USART_CR1_RE)
+			|| !(USART1->CR3 & USART_CR3_DMAR) || (HOST_uart_fd < 0)) {
+		return;
+	}
+	if (0 == reload) {
+		reload = DMA2_Stream5->NDTR;
+	}
+	bool received = false;
+	for (;;) {
+		uint32_t count = DMA2_Stream5->NDTR;
+		uint8_t *data = (uint8_t *)DMA2_Stream5->M0AR + (reload - count);
+		ssize_t n = read(HOST_uart_fd, data, count);
+		if (n <= 0) {
+			break;
+		}
+		received = true;
+		DMA2_Stream5->NDTR -= (uint32_t)n;
+		if (0 == DMA2_Stream5->NDTR) {
+			if (!(DMA2_Stream5->CR & DMA_SxCR_CIRC)) {
+				DMA2_Stream5->CR &= ~DMA_SxCR_EN;
+				break;
+			}
+			DMA2_Stream5->NDTR = reload;
+		}
+	}
+	if (received) {
+		USART1->SR |= USART_SR_IDLE;
+		if (USART1->CR1 & USART_CR1_IDLEIE) {
+			NVIC->ISPR[USART1_IRQn >> 5U] |= 1UL << (USART1_IRQn & 0x1FU);
+		}
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Receive and send the bytes of the running transfers
+ *
+ * Called by HOST_step().
+ *****************************************************************************/
+void HOST_uart_run(void)
+{
+	HOST_uart_receive();
+	if (!(DMA2_Stream7->CR & DMA_SxCR_EN)
+			|| !(USART1->CR1 & USART_CR1_UE) || !(USART1->CR1 & USART_CR1_TE)
+			|| !(USART1->CR3 & USART_CR3_DMAT)) {
+		return;
+	}
+	uint32_t count = DMA2_Stream7->NDTR;
+	const uint8_t *data = (const uint8_t *)DMA2_Stream7->M0AR;
+	if (count > 0 && HOST_uart_fd >= 0) {
+		ssize_t written = write(HOST_uart_fd, data, count);
+		if (written <= 0) {
+			return;						// Line busy, try again next step
+		}
+		count = (uint32_t)written;
+	}
+	HOST_uart_bytes += count;
+	DMA2_Stream7->M0AR += count;
+	DMA2_Stream7->NDTR -= count;
+	if (0 == DMA2_Stream7->NDTR) {
+		DMA2_Stream7->CR &= ~DMA_SxCR_EN;
+		DMA2->HISR |= DMA_HISR_TCIF7;
+		USART1->SR |= USART_SR_TC | USART_SR_TXE;
+		if (DMA2_Stream7->CR & DMA_SxCR_TCIE) {
+			NVIC->ISPR[DMA2_Stream7_IRQn >> 5U] |= 1UL << (DMA2_Stream7_IRQn & 0x1FU);
+		}
+	}
+}
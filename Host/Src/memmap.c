@@ -0,0 +1,481 @@
+/** ***************************************************************************
+ * @file
+ * @brief Report of the memory placement from the map file of the firmware
+ *
+ * ==============================================================
+ *
+ * Reads the map file the GNU linker writes for the target build
+ * (-Wl,-Map=demo_code.map, see Debug/makefile) and prints the use of the
+ * memory regions of the linker script and every input section placed
+ * with placement.h: CPU only buffers (.ccmram), DMA buffers (.dma)
+ * and code in RAM (.RamFunc), with the global symbols in them.
+ * @n Usage: memmap [-v] file.map
+ * - -v also list the output sections with their region
+ *
+ * Fails if a section is in a memory it does not work in:
+ * - .ccmram outside of the CCMRAM region
+ * - .dma in the CCMRAM, no DMA reaches it, or in the flash
+ * - .RamFunc in the CCMRAM, the core fetches no instructions from it,
+ *   or still in the flash
+ * - nothing placed at all, e.g. a map of a build before placement.h
+ *
+ * Sizes are virtual addresses: the initial values of .data are counted
+ * once more in the region they are loaded from, sections of only
+ * uninitialised data are not.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define MAP_LINE			1024		///< Longest line of the map file
+#define MAP_NAME			64			///< Longest kept name
+#define MAP_REGIONS			16			///< Memory regions of the linker script
+#define MAP_PLACED			64			///< Placed input sections
+#define MAP_SYMBOLS			8			///< Symbols listed per placed section
+#define MAP_CCM				"CCMRAM"	///< Region of the core coupled memory
+#define MAP_FLASH			"FLASH"		///< Region of the flash
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Kind of a placed input section, see placement.h */
+typedef enum {
+	MAP_KIND_CCM = 0,					///< .ccmram, CPU only buffer
+	MAP_KIND_DMA,						///< .dma, DMA buffer
+	MAP_KIND_RAMFUNC,					///< .RamFunc, code in RAM
+	MAP_KINDS
+} MAP_kind_t;
+
+/** Memory region from the memory configuration */
+typedef struct {
+	char name[MAP_NAME];
+	uint64_t origin;
+	uint64_t length;
+	uint64_t used;						///< Sum of the output sections
+} MAP_region_t;
+
+/** Placed input section */
+typedef struct {
+	MAP_kind_t kind;
+	uint64_t address;
+	uint64_t size;
+	char object[MAP_NAME];				///< Object file without the path
+	char symbols[MAP_SYMBOLS][MAP_NAME];	///< Global symbols inside
+	uint32_t symbol_count;
+} MAP_placed_t;
+
+/** Output section being read */
+typedef struct {
+	char name[MAP_NAME];
+	uint64_t address;
+	uint64_t size;
+	uint64_t load;						///< Load address, 0 = none
+	bool bits;							///< Has contents to load
+} MAP_output_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+static MAP_region_t MAP_region[MAP_REGIONS];	///< Regions of the script
+static uint32_t MAP_region_count = 0;
+static MAP_placed_t MAP_placed[MAP_PLACED];	///< Placed input sections
+static uint32_t MAP_placed_count = 0;
+static bool MAP_verbose = false;		///< List the output sections
+
+/** Input section names of the kinds, as in placement.h */
+static const char *const MAP_prefix[MAP_KINDS] = {
+	".ccmram", ".dma", ".RamFunc"
+};
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+/** ***************************************************************************
+ * @brief Region containing an address
+ * @return NULL if in none, e.g. the debug sections at 0
+ *****************************************************************************/
+static MAP_region_t *MAP_find(uint64_t address)
+{
+	for (uint32_t i = 0; i < MAP_region_count; i++) {
+		MAP_region_t *r = &MAP_region[i];
+		if ((address >= r->origin) && (address - r->origin < r->length)) {
+			return r;
+		}
+	}
+	return NULL;
+}
+
+
+/** ***************************************************************************
+ * @brief Name of the region of an address, "-" if in none
+ *****************************************************************************/
+static const char *MAP_region_name(uint64_t address)
+{
+	const MAP_region_t *r = MAP_find(address);
+	return (NULL == r) ? "-" : r->name;
+}
+
+
+/** ***************************************************************************
+ * @brief Kind of a placed input section
+ * @return MAP_KINDS if the section is not placed
+ *****************************************************************************/
+static MAP_kind_t MAP_kind(const char *section)
+{
+	for (MAP_kind_t k = 0; k < MAP_KINDS; k++) {
+		size_t n = strlen(MAP_prefix[k]);
+		if ((0 == strncmp(section, MAP_prefix[k], n))
+				&& (('\0' == section[n]) || ('.' == section[n]))) {
+			return k;
+		}
+	}
+	return MAP_KINDS;
+}
+
+
+/** ***************************************************************************
+ * @brief Copy a name, cut to MAP_NAME
+ *****************************************************************************/
+static void MAP_copy(char *dst, const char *src)
+{
+	size_t n = strnlen(src, MAP_NAME - 1);
+	memcpy(dst, src, n);
+	dst[n] = '\0';
+}
+
+
+/** ***************************************************************************
+ * @brief Read a region line of the memory configuration
+ *
+ * "RAM 0x0000000020000000 0x0000000000030000 xrw"
+ *****************************************************************************/
+static void MAP_read_region(const char *line)
+{
+	char name[MAP_NAME];
+	unsigned long long origin, length;
+	if ((3 != sscanf(line, "%63s %llx %llx", name, &origin, &length))
+			|| ('*' == name[0]) || (MAP_region_count >= MAP_REGIONS)) {
+		return;							// *default* or the header
+	}
+	MAP_region_t *r = &MAP_region[MAP_region_count++];
+	MAP_copy(r->name, name);
+	r->origin = origin;
+	r->length = length;
+	r->used = 0;
+}
+
+
+/** ***************************************************************************
+ * @brief Account a finished output section to its regions
+ *****************************************************************************/
+static void MAP_close(MAP_output_t *out)
+{
+	if ('\0' == out->name[0]) {
+		return;
+	}
+	MAP_region_t *r = MAP_find(out->address);
+	if ((NULL != r) && (out->size > 0)) {
+		r->used += out->size;
+		if (MAP_verbose) {
+			printf("%-20s 0x%08llx %8llu %s\n", out->name,
+					(unsigned long long)out->address,
+					(unsigned long long)out->size, r->name);
+		}
+	}
+	MAP_region_t *l = MAP_find(out->load);
+	if ((0 != out->load) && (NULL != l) && (l != r) && out->bits) {
+		l->used += out->size;			// Initial values of .data
+	}
+	out->name[0] = '\0';
+}
+
+
+/** ***************************************************************************
+ * @brief Start an output section
+ * @param rest "load address 0x..." if loaded from elsewhere
+ *****************************************************************************/
+static void MAP_open(MAP_output_t *out, const char *name, uint64_t address,
+		uint64_t size, const char *rest)
+{
+	unsigned long long load = 0;
+	sscanf(rest, "load address %llx", &load);
+	MAP_copy(out->name, name);
+	out->address = address;
+	out->size = size;
+	out->load = load;
+	out->bits = false;
+}
+
+
+/** ***************************************************************************
+ * @brief Read the address and size of a section
+ * @param text after the name, "0x... 0x... rest"
+ * @param rest set to the rest, the object or "load address 0x..."
+ * @return false if the text has no address and size
+ *****************************************************************************/
+static bool MAP_read_span(const char *text, uint64_t *address,
+		uint64_t *size, const char **rest)
+{
+	char *end;
+	while (' ' == *text) {
+		text++;
+	}
+	if (0 != strncmp(text, "0x", 2)) {
+		return false;
+	}
+	*address = strtoull(text, &end, 16);
+	while (' ' == *end) {
+		end++;
+	}
+	if (0 != strncmp(end, "0x", 2)) {
+		return false;					// A symbol, not a section
+	}
+	*size = strtoull(end, &end, 16);
+	while (' ' == *end) {
+		end++;
+	}
+	*rest = end;
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Note an input section, keep it if placed
+ *****************************************************************************/
+static void MAP_input(MAP_output_t *out, const char *section,
+		uint64_t address, uint64_t size, const char *object)
+{
+	MAP_kind_t kind = MAP_kind(section);
+	if ((size > 0) && (0 != strncmp(section, ".bss", 4))
+			&& (0 != strcmp(section, "COMMON"))
+			&& ((MAP_KINDS == kind) || (MAP_KIND_RAMFUNC == kind))) {
+		out->bits = true;				// Loaded, not only zeroed
+	}
+	if ((MAP_KINDS == kind) || (0 == size) || (MAP_placed_count >= MAP_PLACED)) {
+		return;
+	}
+	MAP_placed_t *p = &MAP_placed[MAP_placed_count++];
+	p->kind = kind;
+	p->address = address;
+	p->size = size;
+	const char *slash = strrchr(object, '/');
+	MAP_copy(p->object, (NULL == slash) ? object : slash + 1);
+	p->symbol_count = 0;
+}
+
+
+/** ***************************************************************************
+ * @brief Attach a symbol line to the last placed section it lies in
+ *****************************************************************************/
+static void MAP_symbol(uint64_t address, const char *name, const char *line)
+{
+	if ((0 == MAP_placed_count) || (NULL != strchr(line, '='))) {
+		return;							// Assignment of the script
+	}
+	MAP_placed_t *p = &MAP_placed[MAP_placed_count - 1];
+	if ((address >= p->address) && (address - p->address < p->size)
+			&& (p->symbol_count < MAP_SYMBOLS)) {
+		MAP_copy(p->symbols[p->symbol_count++], name);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Read the map file
+ * @return false if it has no memory configuration
+ *****************************************************************************/
+static bool MAP_read(FILE *file)
+{
+	enum { DISCARDED, MEMORY, SCRIPT } part = DISCARDED;
+	char line[MAP_LINE];
+	char pending[MAP_NAME] = "";		// Name alone on its line
+	bool pending_output = false;
+	MAP_output_t out = { .name = "" };
+	while (NULL != fgets(line, sizeof(line), file)) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (0 == strncmp(line, "Memory Configuration", 20)) {
+			part = MEMORY;
+			continue;
+		}
+		if (0 == strncmp(line, "Linker script and memory map", 28)) {
+			part = SCRIPT;
+			continue;
+		}
+		if (MEMORY == part) {
+			MAP_read_region(line);
+			continue;
+		}
+		if (SCRIPT != part) {
+			continue;					// Discarded input sections
+		}
+		uint64_t address, size;
+		const char *rest;
+		char name[MAP_NAME];
+		if ('.' == line[0]) {			// Output section
+			MAP_close(&out);
+			pending[0] = '\0';
+			if (1 != sscanf(line, "%63s", name)) {
+				continue;
+			}
+			const char *text = line + strlen(name);
+			if (!MAP_read_span(text, &address, &size, &rest)) {
+				MAP_copy(pending, name);	// Address on the next line
+				pending_output = true;
+				continue;
+			}
+			MAP_open(&out, name, address, size, rest);
+		} else if ((' ' == line[0]) && (('.' == line[1]) || ('C' == line[1]))
+				&& (1 == sscanf(line, "%63s", name))) {	// Input section
+			const char *text = line + 1 + strlen(name);
+			if (!MAP_read_span(text, &address, &size, &rest)) {
+				MAP_copy(pending, name);
+				pending_output = false;
+				continue;
+			}
+			MAP_input(&out, name, address, size, rest);
+		} else if (' ' == line[0]) {	// Continuation or symbol
+			if (MAP_read_span(line, &address, &size, &rest)) {
+				if ('\0' == pending[0]) {
+					continue;
+				}
+				if (pending_output) {
+					MAP_open(&out, pending, address, size, rest);
+				} else {
+					MAP_input(&out, pending, address, size, rest);
+				}
+				pending[0] = '\0';
+			} else {
+				unsigned long long value;
+				if (2 == sscanf(line, " %llx %63s", &value, name)) {
+					MAP_symbol(value, name, line);
+				}
+			}
+		}
+	}
+	MAP_close(&out);
+	return MAP_region_count > 0;
+}
+
+
+/** ***************************************************************************
+ * @brief Check the region of a placed section
+ * @return reason it is in the wrong memory, NULL if fine
+ *****************************************************************************/
+static const char *MAP_check(const MAP_placed_t *p)
+{
+	const char *region = MAP_region_name(p->address);
+	switch (p->kind) {
+	case MAP_KIND_CCM:
+		return (0 != strcmp(region, MAP_CCM)) ? "not in the CCM" : NULL;
+	case MAP_KIND_DMA:
+		if (0 == strcmp(region, MAP_CCM)) {
+			return "the DMA does not reach the CCM";
+		}
+		return (0 == strcmp(region, MAP_FLASH)) ? "in the flash" : NULL;
+	default:
+		if (0 == strcmp(region, MAP_CCM)) {
+			return "no instructions from the CCM";
+		}
+		return (0 == strcmp(region, MAP_FLASH)) ? "still in the flash" : NULL;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Print the report
+ * @return number of sections in the wrong memory
+ *****************************************************************************/
+static uint32_t MAP_report(void)
+{
+	printf("%-10s %10s %10s %5s\n", "region", "used", "size", "use");
+	for (uint32_t i = 0; i < MAP_region_count; i++) {
+		const MAP_region_t *r = &MAP_region[i];
+		printf("%-10s %10llu %10llu %4llu%%\n", r->name,
+				(unsigned long long)r->used, (unsigned long long)r->length,
+				(unsigned long long)((0 == r->length) ? 0 : 100 * r->used / r->length));
+	}
+	uint32_t errors = 0;
+	uint64_t total[MAP_KINDS] = { 0 };
+	printf("\n%-9s %-10s %-10s %6s %-16s %s\n", "section", "region",
+			"address", "bytes", "object", "symbols");
+	for (uint32_t i = 0; i < MAP_placed_count; i++) {
+		const MAP_placed_t *p = &MAP_placed[i];
+		const char *reason = MAP_check(p);
+		total[p->kind] += p->size;
+		printf("%-9s %-10s 0x%08llx %6llu %-16s", MAP_prefix[p->kind],
+				MAP_region_name(p->address), (unsigned long long)p->address,
+				(unsigned long long)p->size, p->object);
+		for (uint32_t s = 0; s < p->symbol_count; s++) {
+			printf(" %s", p->symbols[s]);
+		}
+		printf("%s%s\n", (NULL == reason) ? "" : "  <- ",
+				(NULL == reason) ? "" : reason);
+		errors += (NULL != reason);
+	}
+	printf("\n%llu bytes CPU only in the CCM, %llu bytes of DMA buffers, "
+			"%llu bytes of code in RAM: %s\n",
+			(unsigned long long)total[MAP_KIND_CCM],
+			(unsigned long long)total[MAP_KIND_DMA],
+			(unsigned long long)total[MAP_KIND_RAMFUNC],
+			((0 == errors) && (MAP_placed_count > 0)) ? "pass" : "fail");
+	return errors;
+}
+
+
+/** ***************************************************************************
+ * @brief Main function of the placement report
+ *****************************************************************************/
+int main(int argc, char *argv[])
+{
+	int opt;
+	while (-1 != (opt = getopt(argc, argv, "v"))) {
+		switch (opt) {
+		case 'v': MAP_verbose = true; break;
+		default:
+			fprintf(stderr, "usage: %s [-v] file.map\n", argv[0]);
+			return 2;
+		}
+	}
+	if (optind >= argc) {
+		fprintf(stderr, "%s: no map file given\n", argv[0]);
+		return 2;
+	}
+	FILE *file = fopen(argv[optind], "r");
+	if (NULL == file) {
+		fprintf(stderr, "%s: cannot open\n", argv[optind]);
+		return 2;
+	}
+	bool ok = MAP_read(file);
+	fclose(file);
+	if (!ok) {
+		fprintf(stderr, "%s: no memory configuration, not a map file\n",
+				argv[optind]);
+		return 2;
+	}
+	uint32_t errors = MAP_report();
+	if (0 == MAP_placed_count) {
+		fprintf(stderr, "%s: nothing placed, built without placement.h?\n",
+				argv[optind]);
+		return 1;
+	}
+	return (0 == errors) ? 0 : 1;
+}
@@ -0,0 +1,259 @@
+/** ***************************************************************************
+ * @file
+ * @brief Work-stealing thread pool of the host tools
+ *
+ * ==============================================================
+ *
+ * POOL_run() processes the items 0 .. count - 1 on several threads,
+ * the calling thread is worker 0.
+ *
+ * Every worker owns a deque of item ranges, at the start each one gets
+ * an equal share.
+ * A worker takes the newest range from the bottom of its own deque.
+ * It pushes the upper half back until the range is not larger than
+ * the grain and then works on it.
+ * A worker with an empty deque steals the oldest, so the largest,
+ * range from the top of another deque.
+ * @n Workers which finish early thereby take over the rest of the slow
+ * ones, e.g. when some items take longer or a core is busy otherwise.
+ *
+ * The deques are protected by a mutex each, a range is only locked
+ * once per grain, which is small against the work of a grain.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pool.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+/** Ranges per deque: the initial one plus one per halving */
+#define POOL_DEQUE_SIZE		64
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Items [begin, end) */
+typedef struct {
+	uint32_t begin;
+	uint32_t end;
+} POOL_range_t;
+
+/** Ranges of one worker, top is the oldest */
+typedef struct {
+	pthread_mutex_t lock;
+	uint32_t top;						///< Index of the oldest range
+	uint32_t bottom;					///< Index after the newest range
+	POOL_range_t range[POOL_DEQUE_SIZE];
+} POOL_deque_t;
+
+/** State of one POOL_run() */
+typedef struct {
+	POOL_work_t work;					///< Called per grain
+	void *context;						///< Passed to work
+	uint32_t grain;						///< Largest range given to work
+	uint32_t workers;					///< Threads including the caller
+	atomic_uint remaining;				///< Items not yet done
+	POOL_deque_t deque[POOL_MAX_WORKERS];
+} POOL_t;
+
+/** Argument of a worker thread */
+typedef struct {
+	POOL_t *pool;
+	uint32_t id;
+} POOL_worker_t;
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static void POOL_push(POOL_deque_t *deque, POOL_range_t range);
+static bool POOL_pop(POOL_deque_t *deque, POOL_range_t *range);
+static bool POOL_steal(POOL_deque_t *deque, POOL_range_t *range);
+static void *POOL_worker(void *arg);
+
+
+/** ***************************************************************************
+ * @brief Number of online CPUs
+ * @return at least 1
+ *****************************************************************************/
+uint32_t POOL_cpus(void)
+{
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cpus < 1) {
+		return 1;
+	}
+	return (cpus > POOL_MAX_WORKERS) ? POOL_MAX_WORKERS : (uint32_t)cpus;
+}
+
+
+/** ***************************************************************************
+ * @brief Process all items on several threads, see file description
+ * @param workers threads including the caller, 0 for POOL_cpus()
+ * @param count items
+ * @param grain largest number of items per call of work, at least 1
+ * @param work called for disjoint ranges which cover all items
+ * @param context passed to work
+ *
+ * Returns when all items are done.
+ * If a thread cannot be started, the others steal its share.
+ *****************************************************************************/
+void POOL_run(uint32_t workers, uint32_t count, uint32_t grain,
+		POOL_work_t work, void *context)
+{
+	static POOL_t pool;					// Too large for the stack
+	pthread_t thread[POOL_MAX_WORKERS];
+	POOL_worker_t arg[POOL_MAX_WORKERS];
+	bool started[POOL_MAX_WORKERS] = { false };
+
+	if (0 == workers) {
+		workers = POOL_cpus();
+	}
+	if (workers > POOL_MAX_WORKERS) {
+		workers = POOL_MAX_WORKERS;
+	}
+	if (workers > count) {
+		workers = (0 == count) ? 1 : count;
+	}
+	pool.work = work;
+	pool.context = context;
+	pool.grain = (0 == grain) ? 1 : grain;
+	pool.workers = workers;
+	atomic_init(&pool.remaining, count);
+	for (uint32_t w = 0; w < workers; w++) {
+		POOL_deque_t *deque = &pool.deque[w];
+		pthread_mutex_init(&deque->lock, NULL);
+		deque->top = deque->bottom = 0;
+		POOL_range_t share = {
+				(uint32_t)((uint64_t)count * w / workers),
+				(uint32_t)((uint64_t)count * (w + 1) / workers) };
+		if (share.end > share.begin) {
+			POOL_push(deque, share);
+		}
+	}
+
+	for (uint32_t w = 1; w < workers; w++) {
+		arg[w].pool = &pool;
+		arg[w].id = w;
+		started[w] = (0 == pthread_create(&thread[w], NULL, POOL_worker, &arg[w]));
+	}
+	arg[0].pool = &pool;
+	arg[0].id = 0;
+	POOL_worker(&arg[0]);
+	for (uint32_t w = 1; w < workers; w++) {
+		if (started[w]) {
+			pthread_join(thread[w], NULL);
+		}
+	}
+	for (uint32_t w = 0; w < workers; w++) {
+		pthread_mutex_destroy(&pool.deque[w].lock);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Work on own and stolen ranges until all items are done
+ * @param arg POOL_worker_t
+ * @return NULL
+ *****************************************************************************/
+static void *POOL_worker(void *arg)
+{
+	POOL_t *pool = ((POOL_worker_t *)arg)->pool;
+	uint32_t id = ((POOL_worker_t *)arg)->id;
+	POOL_deque_t *own = &pool->deque[id];
+
+	while (atomic_load(&pool->remaining) > 0) {
+		POOL_range_t range;
+		bool found = POOL_pop(own, &range);
+		for (uint32_t v = 1; !found && (v < pool->workers); v++) {
+			found = POOL_steal(&pool->deque[(id + v) % pool->workers], &range);
+		}
+		if (!found) {
+			sched_yield();				// The rest is in progress elsewhere
+			continue;
+		}
+		while (range.end - range.begin > pool->grain) {
+			uint32_t middle = range.begin + (range.end - range.begin) / 2;
+			POOL_push(own, (POOL_range_t){ middle, range.end });
+			range.end = middle;
+		}
+		pool->work(pool->context, range.begin, range.end, id);
+		atomic_fetch_sub(&pool->remaining, range.end - range.begin);
+	}
+	return NULL;
+}
+
+
+/** ***************************************************************************
+ * @brief Add the newest range at the bottom
+ * @param deque own deque
+ * @param range not empty
+ *****************************************************************************/
+static void POOL_push(POOL_deque_t *deque, POOL_range_t range)
+{
+	pthread_mutex_lock(&deque->lock);
+	if ((deque->bottom == POOL_DEQUE_SIZE) && (deque->top > 0)) {
+		memmove(&deque->range[0], &deque->range[deque->top],
+				(deque->bottom - deque->top) * sizeof(deque->range[0]));
+		deque->bottom -= deque->top;	// Reuse the space of stolen ranges
+		deque->top = 0;
+	}
+	assert(deque->bottom < POOL_DEQUE_SIZE);
+	deque->range[deque->bottom++] = range;
+	pthread_mutex_unlock(&deque->lock);
+}
+
+
+/** ***************************************************************************
+ * @brief Take the newest range from the bottom
+ * @param deque own deque
+ * @param range set to the range
+ * @return false if empty
+ *****************************************************************************/
+static bool POOL_pop(POOL_deque_t *deque, POOL_range_t *range)
+{
+	bool found = false;
+	pthread_mutex_lock(&deque->lock);
+	if (deque->bottom > deque->top) {
+		*range = deque->range[--deque->bottom];
+		found = true;
+	}
+	pthread_mutex_unlock(&deque->lock);
+	return found;
+}
+
+
+/** ***************************************************************************
+ * @brief Take the oldest range from the top
+ * @param deque deque of another worker
+ * @param range set to the range
+ * @return false if empty
+ *****************************************************************************/
+static bool POOL_steal(POOL_deque_t *deque, POOL_range_t *range)
+{
+	bool found = false;
+	pthread_mutex_lock(&deque->lock);
+	if (deque->bottom > deque->top) {
+		*range = deque->range[deque->top++];
+		found = true;
+	}
+	pthread_mutex_unlock(&deque->lock);
+	return found;
+}
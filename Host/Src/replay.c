@@ -0,0 +1,283 @@
+/** ***************************************************************************
+ * @file
+ * @brief Record synthetic captures and replay captures through the firmware
+ *
+ * ==============================================================
+ *
+ * Record: writes a capture of synthetic frames, see synth.c.
+ * @n Usage: replay -o file [-n frames] [-k wire|cable] [-d mm] [-i A]
+ * [-a deg] [-s noise]
+ *
+ * Replay: reads a capture recorded on the target or the host and feeds
+ * every frame through MEAS_sort_data().
+ * A single acquisition (ADC_NUMS samples) is also evaluated like the
+ * wire or cable screen: distance_to_cable(), current() and
+ * angle_to_cable(), single and accurate.
+ * The frames of the continuous mode are only sorted.
+ * @n Usage: replay [-k wire|cable] [-v] [-r rounds] [-p mm] file
+ * - -k conductor, selects the calculations (default wire)
+ * - -v one CSV line with the results per evaluated frame, to be compared
+ *   with the output of an earlier version
+ * - -r replay the capture this many times for the throughput
+ * - -p run back to back sequential measurements (sequential.c) to this
+ *   precision over the samples instead, cut into halves like the
+ *   continuous mode, and print how many samples they took
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host.h"
+#include "calculations.h"
+#include "capture.h"
+#include "measuring.h"
+#include "sequential.h"
+#include "synth.h"
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+bool MEAS_data_wire = false;			///< Defined by main.c on the target
+bool MEAS_data_cable = false;			///< Defined by main.c on the target
+bool MEAS_data_angle = false;			///< Defined by main.c on the target
+
+static SYN_t REP_syn;					///< Signal generator for recording
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Host time in seconds
+ * @return monotonic time
+ *****************************************************************************/
+static double REP_s(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+
+/** ***************************************************************************
+ * @brief Write a capture of synthetic single acquisitions
+ * @param path file name
+ * @param frames number of frames
+ * @param config situation
+ * @return 0 if written
+ *****************************************************************************/
+static int REP_record(const char *path, uint32_t frames,
+		const SYN_config_t *config)
+{
+	uint32_t size = CAP_HEADER_SIZE + frames * CAP_FRAME_SIZE(ADC_NUMS);
+	uint8_t *buffer = malloc(size);
+	CAP_t cap;
+	if ((NULL == buffer) || !SYN_init(&REP_syn, config)
+			|| !CAP_create(&cap, buffer, size, config->rate, CALC_CALIBRATION)) {
+		fprintf(stderr, "%s: cannot create capture\n", path);
+		free(buffer);
+		return 1;
+	}
+	for (uint32_t n = 0; n < frames; n++) {
+		FRAME_t frame = { ADC_samples, ADC_NUMS, n, 0, 0 };
+		SYN_frame(&REP_syn, ADC_samples, ADC_NUMS);
+		CAP_put(&cap, &frame);
+	}
+	FILE *file = fopen(path, "wb");
+	int result = ((NULL == file)
+			|| (fwrite(buffer, 1, cap.used, file) != cap.used)) ? 1 : 0;
+	if ((NULL != file) && (0 != fclose(file))) {
+		result = 1;
+	}
+	if (0 != result) {
+		fprintf(stderr, "%s: cannot write\n", path);
+	}
+	free(buffer);
+	return result;
+}
+
+
+/** ***************************************************************************
+ * @brief Feed all frames of a capture through the processing chain
+ * @param cap capture from CAP_open()
+ * @param verbose print the results of every evaluated frame
+ * @param sum set to the sum of all results, a cheap fingerprint
+ * @return number of evaluated single acquisitions
+ *****************************************************************************/
+static uint32_t REP_run(CAP_t *cap, bool verbose, int64_t *sum)
+{
+	FRAME_t frame;
+	uint32_t evaluated = 0;
+	CAP_rewind(cap);
+	while (CAP_next(cap, &frame, ADC_samples, ADC_NUMS)) {
+		MEAS_sort_data(&frame);
+		if (ADC_NUMS != frame.count) {
+			continue;					// Continuous mode, only sorted
+		}
+		int32_t r[5];
+		r[0] = distance_to_cable(1);
+		r[1] = distance_to_cable(0);
+		r[2] = current(1);
+		r[3] = current(0);
+		r[4] = angle_to_cable();
+		CALC_degree_left = false;
+		CALC_degree_right = false;
+		for (uint32_t i = 0; i < 5; i++) {
+			*sum += r[i];
+		}
+		if (verbose) {
+			printf("%u,%d,%d,%d,%d,%d\n", (unsigned)frame.seq,
+					(int)r[0], (int)r[1], (int)r[2], (int)r[3], (int)r[4]);
+		}
+		evaluated++;
+	}
+	return evaluated;
+}
+
+
+/** ***************************************************************************
+ * @brief Sequential measurements over all samples of a capture
+ * @param cap capture from CAP_open()
+ * @param kind wire or cable
+ *
+ * The frames are cut into halves of ADC_STREAM_NUMS samples,
+ * a new measurement starts with the half after the end of the last.
+ *****************************************************************************/
+static void REP_sequential(CAP_t *cap, CALC_kind_t kind)
+{
+	FRAME_t frame;
+	SEQ_result_t r;
+	uint32_t measurements = 0;
+	uint32_t converged = 0;
+	uint64_t samples = 0;
+	int64_t distance = 0;
+	CAP_rewind(cap);
+	SEQ_begin();
+	while (CAP_next(cap, &frame, ADC_samples, ADC_NUMS)) {
+		for (uint32_t first = 0; first < frame.count; first += ADC_STREAM_NUMS) {
+			FRAME_t half = frame;
+			half.samples = &ADC_samples[first*INPUTS_NUMS];
+			half.count = (frame.count - first < ADC_STREAM_NUMS)
+					? frame.count - first : ADC_STREAM_NUMS;
+			MEAS_sort_data(&half);
+			if (!SEQ_add(kind, half.count)) {
+				continue;
+			}
+			SEQ_get(&r);
+			measurements++;
+			converged += r.converged ? 1 : 0;
+			samples += r.samples;
+			distance += r.distance;
+			SEQ_begin();
+		}
+	}
+	if (0 == measurements) {
+		fprintf(stderr, "no sequential measurement ended\n");
+		return;
+	}
+	printf("%u measurements to +/-%u mm, %u converged, "
+			"%.1f samples (%.0f ms), distance %.1f mm on average\n",
+			(unsigned)measurements, (unsigned)SEQ_precision, (unsigned)converged,
+			(double)samples / measurements,
+			1000.0 * samples / measurements / cap->rate,
+			(double)distance / measurements);
+}
+
+
+/** ***************************************************************************
+ * @brief Record or replay, see file description
+ * @param argc number of arguments
+ * @param argv arguments
+ * @return 0 on success
+ *****************************************************************************/
+int main(int argc, char *argv[])
+{
+	const char *out = NULL;
+	uint32_t frames = 1000;
+	uint32_t rounds = 1;
+	bool verbose = false;
+	bool sequential = false;
+	SYN_config_t config;
+	int opt;
+	SYN_default(&config);
+	while (-1 != (opt = getopt(argc, argv, "o:n:k:d:i:a:s:vr:p:"))) {
+		switch (opt) {
+		case 'o': out = optarg; break;
+		case 'n': frames = strtoul(optarg, NULL, 0); break;
+		case 'k': config.kind = (0 == strcmp(optarg, "cable")) ? SYN_CABLE : SYN_WIRE; break;
+		case 'd': config.distance = strtof(optarg, NULL); break;
+		case 'i': config.current = strtof(optarg, NULL); break;
+		case 'a': config.angle = strtof(optarg, NULL); break;
+		case 's': config.noise = strtof(optarg, NULL); break;
+		case 'v': verbose = true; break;
+		case 'r': rounds = strtoul(optarg, NULL, 0); break;
+		case 'p':
+			SEQ_precision = strtoul(optarg, NULL, 0);
+			sequential = true;
+			break;
+		default:
+			fprintf(stderr, "usage: %s -o file [-n frames] [-k wire|cable] "
+					"[-d mm] [-i A] [-a deg] [-s noise]\n"
+					"       %s [-k wire|cable] [-v] [-r rounds] [-p mm] file\n",
+					argv[0], argv[0]);
+			return 2;
+		}
+	}
+	if (NULL != out) {
+		return REP_record(out, frames, &config);
+	}
+	if (optind >= argc) {
+		fprintf(stderr, "%s: no capture given\n", argv[0]);
+		return 2;
+	}
+
+	uint32_t size;
+	uint8_t *buffer = HOST_load(argv[optind], &size);
+	CAP_t cap;
+	if ((NULL == buffer) || !CAP_open(&cap, buffer, size)) {
+		fprintf(stderr, "%s: no capture\n", argv[optind]);
+		free(buffer);
+		return 1;
+	}
+	if (CALC_CALIBRATION != cap.calibration) {
+		fprintf(stderr, "%s: recorded with calibration %u, this is %u\n",
+				argv[optind], (unsigned)cap.calibration, CALC_CALIBRATION);
+	}
+	MEAS_data_wire = (SYN_WIRE == config.kind);
+	MEAS_data_cable = (SYN_CABLE == config.kind);
+	if (sequential) {
+		REP_sequential(&cap, (SYN_CABLE == config.kind) ? CALC_CABLE : CALC_WIRE);
+		free(buffer);
+		return 0;
+	}
+
+	int64_t sum = 0;
+	uint32_t evaluated = REP_run(&cap, verbose, &sum);
+	double t0 = REP_s();
+	for (uint32_t r = 1; r < rounds; r++) {
+		int64_t again = 0;
+		REP_run(&cap, false, &again);
+	}
+	double t = REP_s() - t0;
+	fprintf(stderr, "%u frames at %u Hz, %u evaluated, fingerprint %lld\n",
+			(unsigned)cap.frames, (unsigned)cap.rate, (unsigned)evaluated,
+			(long long)sum);
+	if ((rounds > 1) && (t > 0)) {
+		fprintf(stderr, "%.0f frames/s\n", (rounds - 1) * cap.frames / t);
+	}
+	free(buffer);
+	return 0;
+}
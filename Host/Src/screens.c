@@ -0,0 +1,380 @@
+/** ***************************************************************************
+ * @file
+ * @brief Render every screen on the host, write images, report the work
+ *
+ * ==============================================================
+ *
+ * Boots the display like main() and draws each screen of the firmware
+ * with synthetic samples, using the unchanged display code and BSP driver.
+ *
+ * For each screen:
+ * - The first frame includes the static content on the background layer.
+ *   The visible screen after it is composed from the LTDC layers and written
+ *   as image, see HOST_write_image().
+ * - Further frames only redraw the dynamic content, their average work is
+ *   reported: DMA2D transfers, pixels and bytes moved by the DMA2D,
+ *   pixels drawn by the CPU and the host time per frame.
+ *
+ * Usage: screens [-o dir] [-f ppm|png] [-c dir] [-n frames]
+ * - -o directory for the images (default .)
+ * - -f image format (default ppm)
+ * - -c directory with reference PPM images of the same names.
+ *   Every screen is compared, the exit code is 1 if any pixel differs.
+ * - -n frames per screen for the averages (default 100)
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "stm32f4xx.h"
+#include "stm32f429i_discovery_lcd.h"
+
+#include "host.h"
+#include "graphics.h"
+#include "displayingdata.h"
+#include "frames.h"
+#include "measuring.h"
+#include "menu.h"
+#include "plotting.h"
+#include "probe.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define SCR_OFFSET			2048		///< ADC counts at 0 V input
+#define SCR_PERIOD			12			///< Samples per 50 Hz period at 600 Hz
+#define SCR_PATH_LEN		256			///< Max. length of a file name
+#define PI					3.14159265358979f
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** One screen: how to set it up and how to draw a frame */
+typedef struct {
+	const char *name;					///< Name of the image file
+	void (*setup)(void);				///< Called once before the frames
+	void (*frame)(uint32_t n);			///< Draw frame number n
+} SCR_screen_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+bool MEAS_data_wire = false;			///< Defined by main.c on the target
+bool MEAS_data_cable = false;			///< Defined by main.c on the target
+bool MEAS_data_angle = false;			///< Defined by main.c on the target
+
+static HOST_screen_t SCR_screen;		///< Composed screen
+static HOST_screen_t SCR_golden;		///< Reference image
+static uint32_t SCR_phase = 0;			///< Sample index of the signal
+static uint32_t SCR_block = 0;			///< Next half buffer in continuous mode
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Write 50 Hz sine waves of the given amplitudes into ADC_samples
+ * @param first first sample per input
+ * @param count samples per input
+ * @param amp amplitudes in ADC counts of pad1, pad2, coil1, coil2
+ * @param harmonic amplitude of the 3rd harmonic relative to the fundamental
+ *****************************************************************************/
+static void SCR_signal(uint32_t first, uint32_t count, const float amp[INPUTS_NUMS],
+		float harmonic)
+{
+	for (uint32_t i = first; i < first + count; i++) {
+		float w = 2 * PI * (float)(SCR_phase++ % SCR_PERIOD) / SCR_PERIOD;
+		float s = sinf(w) + harmonic * sinf(3 * w);
+		for (uint32_t ch = 0; ch < INPUTS_NUMS; ch++) {
+			ADC_samples[INPUTS_NUMS*i + ch] = (uint32_t)(SCR_OFFSET + amp[ch] * s);
+		}
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief One complete measurement as delivered by the single shot DMA
+ * @param p1 amplitude of pad1
+ * @param p2 amplitude of pad2
+ * @param c1 amplitude of coil1
+ * @param c2 amplitude of coil2
+ *****************************************************************************/
+static void SCR_measurement(float p1, float p2, float c1, float c2)
+{
+	const float amp[INPUTS_NUMS] = { p1, p2, c1, c2 };
+	SCR_phase = 0;
+	const FRAME_t frame = { ADC_samples, ADC_NUMS, 0, 0, 0 };
+	SCR_signal(0, ADC_NUMS, amp, 0.0f);
+	MEAS_sort_data(&frame);
+}
+
+
+/** ***************************************************************************
+ * @brief Deliver one half buffer in continuous mode through the DMA interrupt
+ * @param amp amplitudes of pad1, pad2, coil1, coil2
+ * @param harmonic amplitude of the 3rd harmonic
+ *****************************************************************************/
+static void SCR_stream(const float amp[INPUTS_NUMS], float harmonic)
+{
+	SCR_signal(SCR_block * ADC_STREAM_NUMS, ADC_STREAM_NUMS, amp, harmonic);
+	*(volatile uint32_t *)&DMA2->LISR |=
+			(0 == SCR_block) ? DMA_LISR_HTIF1 : DMA_LISR_TCIF1;
+	NVIC_SetPendingIRQ(DMA2_Stream1_IRQn);	// Runs DMA2_Stream1_IRQHandler()
+	SCR_block ^= 1;
+	const FRAME_t *frame = FRAME_peek();
+	if (NULL != frame) {
+		PLOT_update(frame);
+		FRAME_release();
+	}
+}
+
+
+/** Hint shown at startup */
+static void SCR_hint_setup(void) { }
+static void SCR_hint_frame(uint32_t n) { (void)n; MENU_hint(); }
+
+/** Wire in range */
+static void SCR_wire_setup(void) { MEAS_data_wire = true; }
+static void SCR_wire_frame(uint32_t n)
+{
+	SCR_measurement(425 + (n % 8), 425, 850, 850);
+	DISP_show_data_wire();
+}
+
+/** Wire out of range */
+static void SCR_wire_out_frame(uint32_t n)
+{
+	SCR_measurement(100, 100 + (n % 8), 200, 200);
+	DISP_show_data_wire();
+}
+
+/** Wire after a sequential measurement, traces of the last half only */
+static void SCR_wire_seq_frame(uint32_t n)
+{
+	const float amp[INPUTS_NUMS] = { 425 + (n % 8), 425, 850, 850 };
+	const FRAME_t frame = { ADC_samples, ADC_STREAM_NUMS, 0, 0, 0 };
+	SEQ_result_t seq = { CALC_WIRE, 52, 4, 2500, 120, 55, 2400,
+			(n + 1) * ADC_STREAM_NUMS, (0 != (n % 2)) };	// Image: not converged
+	DISP_result_t result;
+	SCR_phase = 0;
+	SCR_signal(0, ADC_STREAM_NUMS, amp, 0.0f);
+	MEAS_sort_data(&frame);
+	DISP_calc_sequential(&result, &seq);
+	DISP_show(&result);
+}
+
+/** Cable in range */
+static void SCR_cable_setup(void) { MEAS_data_wire = false; MEAS_data_cable = true; }
+static void SCR_cable_frame(uint32_t n)
+{
+	SCR_measurement(400, 400 + (n % 8), 450, 450);
+	DISP_show_data_cable();
+}
+
+/** Angle, left pad stronger */
+static void SCR_angle_setup(void) { MEAS_data_cable = false; MEAS_data_angle = true; }
+static void SCR_angle_frame(uint32_t n)
+{
+	SCR_measurement(500 + (n % 8), 300, 450, 450);
+	DISP_show_data_angle();
+}
+
+/** Strip-chart, cable approaching and leaving */
+static void SCR_strip_setup(void)
+{
+	MEAS_data_angle = false;
+	SCR_phase = 0;
+	SCR_block = 0;
+	PLOT_start(PLOT_STRIP);
+	for (uint32_t n = 0; n < 2 * 240; n++) {	// Fill the whole plot
+		float a = 150 + 300 * sinf(2 * PI * n / 240);
+		const float amp[INPUTS_NUMS] = { a + 200, a + 200, a + 250, a + 250 };
+		SCR_stream(amp, 0.0f);
+	}
+}
+static void SCR_strip_frame(uint32_t n)
+{
+	const float amp[INPUTS_NUMS] = { 400, 400, 450 + (n % 8), 450 };
+	SCR_stream(amp, 0.0f);
+	PLOT_show_load();					// Like main() after PIPE_report()
+}
+
+/** Waterfall with a 3rd harmonic */
+static void SCR_waterfall_setup(void)
+{
+	SCR_phase = 0;
+	SCR_block = 0;
+	PLOT_set_view(PLOT_WATERFALL);
+	for (uint32_t n = 0; n < 2 * 240; n++) {
+		float a = 200 + 150 * sinf(2 * PI * n / 120);
+		const float amp[INPUTS_NUMS] = { 300, 300, a, a };
+		SCR_stream(amp, 0.3f);
+	}
+}
+static void SCR_waterfall_frame(uint32_t n)
+{
+	const float amp[INPUTS_NUMS] = { 300, 300, 300 + (n % 8), 300 };
+	SCR_stream(amp, 0.3f);
+}
+
+/** Debug page after a few wire calculations */
+static void SCR_probes_setup(void)
+{
+	DISP_result_t result;
+	PLOT_stop();
+	PROBE_reset();
+	MEAS_data_wire = true;
+	for (uint32_t n = 0; n < 4; n++) {
+		SCR_measurement(425, 425, 850, 850);
+		DISP_calc_wire(&result);
+	}
+	MEAS_data_wire = false;
+}
+static void SCR_probes_frame(uint32_t n)
+{
+	if (0 == n) {
+		PROBE_show();
+	} else {
+		PROBE_refresh();
+	}
+}
+
+
+/** Screens in the order they are drawn */
+static const SCR_screen_t SCR_screens[] = {
+		{ "hint", SCR_hint_setup, SCR_hint_frame },
+		{ "wire", SCR_wire_setup, SCR_wire_frame },
+		{ "wire_out", SCR_wire_setup, SCR_wire_out_frame },
+		{ "wire_seq", SCR_wire_setup, SCR_wire_seq_frame },
+		{ "cable", SCR_cable_setup, SCR_cable_frame },
+		{ "angle", SCR_angle_setup, SCR_angle_frame },
+		{ "strip", SCR_strip_setup, SCR_strip_frame },
+		{ "waterfall", SCR_waterfall_setup, SCR_waterfall_frame },
+		{ "probes", SCR_probes_setup, SCR_probes_frame },
+};
+
+
+/** ***************************************************************************
+ * @brief Host time in microseconds
+ * @return monotonic time
+ *****************************************************************************/
+static double SCR_us(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+
+/** ***************************************************************************
+ * @brief Boot the display, draw all screens, write and compare the images
+ * @param argc number of arguments
+ * @param argv arguments, see file description
+ * @return 0 if all images match the references or no references are given
+ *****************************************************************************/
+int main(int argc, char *argv[])
+{
+	const char *out_dir = ".";
+	const char *golden_dir = NULL;
+	const char *format = "ppm";
+	uint32_t frames = 100;
+	int result = 0;
+	int opt;
+	while (-1 != (opt = getopt(argc, argv, "o:c:f:n:"))) {
+		switch (opt) {
+		case 'o': out_dir = optarg; break;
+		case 'c': golden_dir = optarg; break;
+		case 'f': format = optarg; break;
+		case 'n': frames = strtoul(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-o dir] [-f ppm|png] [-c dir] [-n frames]\n",
+					argv[0]);
+			return 2;
+		}
+	}
+
+	HOST_reset();						// Same sequence as main()
+	BSP_LCD_Init();
+	GFX_init();
+	DISP_layers_init();
+	BSP_LCD_DisplayOn();
+	MENU_draw();
+
+	printf("%-10s %9s %9s %9s %11s %11s %9s %9s\n", "screen", "first px",
+			"dma2d/fr", "px/fr", "read B/fr", "write B/fr", "cpu px/fr", "us/fr");
+	for (uint32_t s = 0; s < sizeof(SCR_screens)/sizeof(SCR_screens[0]); s++) {
+		const SCR_screen_t *scr = &SCR_screens[s];
+		char path[SCR_PATH_LEN];
+
+		/* First frame with the static content, this is the image */
+		scr->setup();
+		HOST_dma2d_stats_t first = HOST_dma2d_stats;
+		uint32_t first_cpu = GFX_cpu_pixels;
+		scr->frame(0);
+		GFX_fence();
+		uint64_t first_px = (HOST_dma2d_stats.pixels - first.pixels)
+				+ (GFX_cpu_pixels - first_cpu);
+		HOST_ltdc_compose(&SCR_screen);
+		snprintf(path, sizeof(path), "%s/%s.%s", out_dir, scr->name, format);
+		if (!HOST_write_image(path, &SCR_screen)) {
+			fprintf(stderr, "%s: cannot write\n", path);
+			result = 1;
+		}
+		if (NULL != golden_dir) {
+			snprintf(path, sizeof(path), "%s/%s.ppm", golden_dir, scr->name);
+			if (!HOST_read_ppm(path, &SCR_golden)) {
+				fprintf(stderr, "%s: missing reference\n", path);
+				result = 1;
+			} else {
+				uint32_t diff = HOST_compare(&SCR_screen, &SCR_golden);
+				if (diff > 0) {
+					fprintf(stderr, "%s: %u pixels differ\n", scr->name,
+							(unsigned)diff);
+					result = 1;
+				}
+			}
+		}
+
+		/* Steady state, only the dynamic content */
+		HOST_dma2d_stats_t start = HOST_dma2d_stats;
+		uint32_t start_cpu = GFX_cpu_pixels;
+		double t0 = SCR_us();
+		for (uint32_t n = 1; n <= frames; n++) {
+			scr->frame(n);
+		}
+		GFX_fence();
+		double t1 = SCR_us();
+		uint32_t transfers = 0;
+		for (uint32_t m = 0; m < 4; m++) {
+			transfers += HOST_dma2d_stats.transfers[m] - start.transfers[m];
+		}
+		double k = (frames > 0) ? 1.0 / frames : 0.0;
+		printf("%-10s %9llu %9.1f %9.0f %11.0f %11.0f %9.0f %9.1f\n",
+				scr->name, (unsigned long long)first_px, k * transfers,
+				k * (HOST_dma2d_stats.pixels - start.pixels),
+				k * (HOST_dma2d_stats.bytes_read - start.bytes_read),
+				k * (HOST_dma2d_stats.bytes_written - start.bytes_written),
+				k * (GFX_cpu_pixels - start_cpu), k * (t1 - t0));
+	}
+	if (HOST_dma2d_stats.errors > 0) {
+		fprintf(stderr, "%u DMA2D transfers with unsupported setup\n",
+				(unsigned)HOST_dma2d_stats.errors);
+		result = 1;
+	}
+	return result;
+}
@@ -0,0 +1,653 @@
+/** ***************************************************************************
+ * @file
+ * @brief Sweep the thresholds of the calculations over many captures
+ *
+ * ==============================================================
+ *
+ * Evaluates grids of CALC_limits_t over a set of single acquisitions
+ * with known distance and current and reports the errors per grid point.
+ *
+ * The acquisitions are synthetic (see synth.c): for each conductor,
+ * every distance of -d and 1.2 A and 5 A, -f frames with noise.
+ * Captures recorded on the target or with replay are added as
+ * kind:mm:A:file, e.g. wire:30:1.2:wire30.cap.
+ *
+ * Two phases run on a work-stealing pool (pool.c) on all CPUs:
+ * -# Features: the mean RMS values of the pads and coils of every frame,
+ *    for the single (10 samples) and the accurate (CALC_WINDOW samples)
+ *    measurement,
+ *    with RMS() like distance_to_cable() and current().
+ *    They do not depend on the thresholds and are computed once.
+ * -# Sweep: every grid point evaluates all features with CALC_distance()
+ *    and CALC_current() of the firmware.
+ *    current() estimates the current without the coil thresholds
+ *    (CALC_estimate_current()), they only matter for the classification.
+ *
+ * The results do not depend on the number of threads.
+ *
+ * Usage: sweep [-j threads] [-f frames] [-d from:to:step] [-s noise]
+ * [-k wire|cable] [-p name=from:to:step ...] [-t top] [-o csv] [captures]
+ * - -j threads, 0 for all CPUs (default)
+ * - -f synthetic frames per situation (default 20), 0 for none
+ * - -d synthetic distances in mm (default 5:250:5), beyond 200 mm
+ *   the correct answer is "out of range"
+ * - -s noise in ADC counts RMS (default 2)
+ * - -k only synthetic frames of this conductor
+ * - -p swept threshold, name as in CALC_limits, e.g. wire.zero=800:1000:25
+ *   for pad[CALC_WIRE].zero, the others keep their value
+ * - -t number of best grid points listed (default 10)
+ * - -o all grid points as CSV
+ *
+ * Columns per measurement (single, accurate):
+ * - mae: mean absolute distance error in mm of the frames in range
+ *   which got a distance
+ * - miss: % of the frames in range reported out of range
+ * - phan: % of the frames out of range which got a distance
+ * - score: mean error with a miss or phantom counted as SWP_RANGE mm,
+ *   the list is sorted by the score of the accurate measurement
+ * - cur: % of the frames with a wrong current
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host.h"
+#include "calculations.h"
+#include "capture.h"
+#include "measuring.h"
+#include "pool.h"
+#include "synth.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define SWP_MODES			2			///< Single and accurate measurement
+#define SWP_RANGE			200			///< Measuring range in mm
+#define SWP_MAX_AXES		10			///< Max. swept thresholds
+#define SWP_MAX_SETS		(1UL << 24)	///< Max. grid points
+#define SWP_MAX_SITUATIONS	4096		///< Max. synthetic situations and captures
+#define SWP_WORK			20000		///< Evaluations per grain of the sweep
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Features and truth of one single acquisition */
+typedef struct {
+	CALC_kind_t kind;					///< Conductor
+	int32_t distance;					///< True distance in mm, -1 out of range
+	int32_t current;					///< True current in mA
+	int32_t e_val[SWP_MODES];			///< Mean pad RMS, single and accurate
+	int32_t b_val[SWP_MODES];			///< Mean coil RMS, single and accurate
+} SWP_frame_t;
+
+/** Frames of one known situation */
+typedef struct {
+	CALC_kind_t kind;					///< Conductor
+	float distance;						///< mm
+	float current;						///< A
+	const char *path;					///< Capture, NULL for synthetic
+	CAP_t cap;							///< Opened capture
+	uint32_t first;						///< Index of the first frame
+	uint32_t frames;					///< Number of frames
+} SWP_situation_t;
+
+/** One swept threshold */
+typedef struct {
+	size_t offset;						///< Of the value in CALC_limits_t
+	const char *name;					///< As given with -p
+	int32_t from;						///< First value
+	int32_t step;						///< Increment, not 0
+	uint32_t count;						///< Number of values
+} SWP_axis_t;
+
+/** Errors of one measurement at one grid point */
+typedef struct {
+	uint32_t hits;						///< In range and a distance
+	uint32_t missed;					///< In range but out of range
+	uint32_t inside;					///< Frames in range
+	uint32_t phantom;					///< Out of range but a distance
+	uint32_t outside;					///< Frames out of range
+	uint32_t wrong;						///< Wrong current
+	uint64_t error;						///< Sum of |distance error| of the hits
+} SWP_stats_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+bool MEAS_data_wire = false;			///< Defined by main.c on the target
+bool MEAS_data_cable = false;			///< Defined by main.c on the target
+bool MEAS_data_angle = false;			///< Defined by main.c on the target
+
+/** Samples per measurement, like distance_to_cable() and current() */
+static const int32_t SWP_samples[SWP_MODES] = { 10, CALC_WINDOW };
+
+/** Thresholds which can be swept */
+static const struct {
+	const char *name;
+	size_t offset;
+} SWP_param[] = {
+		{ "wire.zero", offsetof(CALC_limits_t, pad[CALC_WIRE].zero) },
+		{ "wire.out", offsetof(CALC_limits_t, pad[CALC_WIRE].out) },
+		{ "wire.low_min", offsetof(CALC_limits_t, coil[CALC_WIRE].low_min) },
+		{ "wire.low_max", offsetof(CALC_limits_t, coil[CALC_WIRE].low_max) },
+		{ "wire.high_min", offsetof(CALC_limits_t, coil[CALC_WIRE].high_min) },
+		{ "cable.zero", offsetof(CALC_limits_t, pad[CALC_CABLE].zero) },
+		{ "cable.out", offsetof(CALC_limits_t, pad[CALC_CABLE].out) },
+		{ "cable.low_min", offsetof(CALC_limits_t, coil[CALC_CABLE].low_min) },
+		{ "cable.low_max", offsetof(CALC_limits_t, coil[CALC_CABLE].low_max) },
+		{ "cable.high_min", offsetof(CALC_limits_t, coil[CALC_CABLE].high_min) },
+};
+
+static SWP_situation_t SWP_situation[SWP_MAX_SITUATIONS];
+static uint32_t SWP_situations = 0;
+static SWP_frame_t *SWP_frame;			///< All frames of all situations
+static uint32_t SWP_frames = 0;
+static SWP_axis_t SWP_axis[SWP_MAX_AXES];
+static uint32_t SWP_axes = 0;
+static uint32_t SWP_sets = 1;			///< Grid points
+static SWP_stats_t (*SWP_stats)[SWP_MODES];	///< Per grid point
+static float SWP_noise = 2;				///< Of the synthetic frames
+static SYN_t *SWP_syn;					///< One generator per worker
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Host time in seconds
+ * @return monotonic time
+ *****************************************************************************/
+static double SWP_s(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+
+/** ***************************************************************************
+ * @brief Compute the features of a single acquisition
+ * @param samples ADC_NUMS samples per input, interleaved like ADC_samples
+ * @param frame features set, the truth is not touched
+ *
+ * Sorts like MEAS_sort_data(), but into local arrays.
+ *****************************************************************************/
+static void SWP_features(const uint32_t *samples, SWP_frame_t *frame)
+{
+	int32_t input[INPUTS_NUMS][ADC_NUMS];
+	for (uint32_t i = 0; i < ADC_NUMS; i++) {
+		for (uint32_t ch = 0; ch < INPUTS_NUMS; ch++) {
+			input[ch][i] = samples[INPUTS_NUMS * i + ch];
+		}
+	}
+	for (uint32_t m = 0; m < SWP_MODES; m++) {
+		int32_t n = SWP_samples[m];
+		frame->e_val[m] = (RMS(n, input[CAP_PAD1]) + RMS(n, input[CAP_PAD2])) / 2;
+		frame->b_val[m] = (RMS(n, input[CAP_COIL1]) + RMS(n, input[CAP_COIL2])) / 2;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Pool work: generate or decode the frames of situations
+ * @param context unused
+ * @param begin first situation
+ * @param end after the last situation
+ * @param worker selects the signal generator
+ *****************************************************************************/
+static void SWP_extract(void *context, uint32_t begin, uint32_t end,
+		uint32_t worker)
+{
+	uint32_t samples[ADC_NUMS * INPUTS_NUMS];
+	(void)context;
+	for (uint32_t s = begin; s < end; s++) {
+		SWP_situation_t *sit = &SWP_situation[s];
+		int32_t distance = (int32_t)lrintf(sit->distance);
+		SYN_config_t config;
+		if (NULL == sit->path) {
+			SYN_default(&config);
+			config.kind = (CALC_CABLE == sit->kind) ? SYN_CABLE : SYN_WIRE;
+			config.distance = sit->distance;
+			config.current = sit->current;
+			config.noise = SWP_noise;
+			config.seed = s + 1;		// Same frames for any thread count
+			SYN_init(&SWP_syn[worker], &config);
+		} else {
+			CAP_rewind(&sit->cap);
+		}
+		for (uint32_t n = 0; n < sit->frames; n++) {
+			SWP_frame_t *frame = &SWP_frame[sit->first + n];
+			if (NULL == sit->path) {
+				SYN_frame(&SWP_syn[worker], samples, ADC_NUMS);
+			} else {
+				FRAME_t f;
+				while (CAP_next(&sit->cap, &f, samples, ADC_NUMS)
+						&& (ADC_NUMS != f.count)) {
+					;					// Skip the continuous mode
+				}
+			}
+			frame->kind = sit->kind;
+			frame->distance = (distance > SWP_RANGE) ? -1 : distance;
+			frame->current = (int32_t)lrintf(sit->current * 1000);
+			SWP_features(samples, frame);
+		}
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Thresholds of a grid point
+ * @param set index of the grid point, the last axis changes fastest
+ * @param limits set to CALC_limits with the swept values replaced
+ *****************************************************************************/
+static void SWP_limits(uint32_t set, CALC_limits_t *limits)
+{
+	*limits = CALC_limits;
+	for (uint32_t a = SWP_axes; a-- > 0;) {
+		const SWP_axis_t *axis = &SWP_axis[a];
+		int32_t *value = (int32_t *)((uint8_t *)limits + axis->offset);
+		*value = axis->from + (int32_t)(set % axis->count) * axis->step;
+		set /= axis->count;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Evaluate all frames with some thresholds
+ * @param limits thresholds
+ * @param stats errors, single and accurate
+ *****************************************************************************/
+static void SWP_evaluate(const CALC_limits_t *limits,
+		SWP_stats_t stats[SWP_MODES])
+{
+	memset(stats, 0, SWP_MODES * sizeof(stats[0]));
+	for (uint32_t i = 0; i < SWP_frames; i++) {
+		const SWP_frame_t *frame = &SWP_frame[i];
+		for (uint32_t m = 0; m < SWP_MODES; m++) {
+			SWP_stats_t *st = &stats[m];
+			int32_t d = CALC_distance(frame->kind, frame->e_val[m], limits);
+			if (frame->distance < 0) {
+				st->outside++;
+				st->phantom += (d >= 0);
+			} else {
+				st->inside++;
+				if (d < 0) {
+					st->missed++;
+				} else {
+					st->hits++;
+					st->error += abs(d - frame->distance);
+				}
+			}
+			if (CALC_current(frame->kind, frame->b_val[m], limits)
+					!= frame->current) {
+				st->wrong++;
+			}
+		}
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Pool work: evaluate grid points
+ * @param context unused
+ * @param begin first grid point
+ * @param end after the last grid point
+ * @param worker unused
+ *****************************************************************************/
+static void SWP_sweep(void *context, uint32_t begin, uint32_t end,
+		uint32_t worker)
+{
+	(void)context;
+	(void)worker;
+	for (uint32_t set = begin; set < end; set++) {
+		CALC_limits_t limits;
+		SWP_limits(set, &limits);
+		SWP_evaluate(&limits, SWP_stats[set]);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Error score, see file description
+ * @param st errors of one measurement
+ * @return mean error in mm, lower is better
+ *****************************************************************************/
+static double SWP_score(const SWP_stats_t *st)
+{
+	uint32_t frames = st->inside + st->outside;
+	if (0 == frames) {
+		return 0;
+	}
+	return ((double)st->error
+			+ (double)(st->missed + st->phantom) * SWP_RANGE) / frames;
+}
+
+
+/** ***************************************************************************
+ * @brief Order of the grid points: accurate score, wrong currents, index
+ *****************************************************************************/
+static int SWP_compare(const void *a, const void *b)
+{
+	uint32_t i = *(const uint32_t *)a;
+	uint32_t j = *(const uint32_t *)b;
+	double si = SWP_score(&SWP_stats[i][SWP_MODES - 1]);
+	double sj = SWP_score(&SWP_stats[j][SWP_MODES - 1]);
+	if (si != sj) {
+		return (si < sj) ? -1 : 1;
+	}
+	uint32_t wi = SWP_stats[i][SWP_MODES - 1].wrong;
+	uint32_t wj = SWP_stats[j][SWP_MODES - 1].wrong;
+	if (wi != wj) {
+		return (wi < wj) ? -1 : 1;
+	}
+	return (i < j) ? -1 : (i > j);
+}
+
+
+/** ***************************************************************************
+ * @brief Percentage
+ * @return 100 * part / whole, 0 if whole is 0
+ *****************************************************************************/
+static double SWP_percent(uint32_t part, uint32_t whole)
+{
+	return (0 == whole) ? 0 : 100.0 * part / whole;
+}
+
+
+/** ***************************************************************************
+ * @brief Print the errors of one grid point
+ * @param file output
+ * @param limits thresholds of the grid point
+ * @param stats errors, single and accurate
+ * @param csv comma separated instead of aligned
+ *****************************************************************************/
+static void SWP_print(FILE *file, const CALC_limits_t *limits,
+		const SWP_stats_t stats[SWP_MODES], bool csv)
+{
+	for (uint32_t a = 0; a < SWP_axes; a++) {
+		int32_t value = *(const int32_t *)((const uint8_t *)limits
+				+ SWP_axis[a].offset);
+		fprintf(file, csv ? "%d," : "%14d", (int)value);
+	}
+	for (uint32_t m = 0; m < SWP_MODES; m++) {
+		const SWP_stats_t *st = &stats[m];
+		double mae = (0 == st->hits) ? 0 : (double)st->error / st->hits;
+		fprintf(file, csv ? "%.2f,%.2f,%.2f,%.2f,%.2f" : "%7.1f%6.1f%6.1f%7.1f%6.1f",
+				mae, SWP_percent(st->missed, st->inside),
+				SWP_percent(st->phantom, st->outside), SWP_score(st),
+				SWP_percent(st->wrong, st->inside + st->outside));
+		fputs((m + 1 < SWP_MODES) ? (csv ? "," : "  ") : "\n", file);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Print the column names
+ * @param file output
+ * @param csv comma separated instead of aligned
+ *****************************************************************************/
+static void SWP_header(FILE *file, bool csv)
+{
+	static const char * const mode[SWP_MODES] = { "single", "accu" };
+	for (uint32_t a = 0; a < SWP_axes; a++) {
+		fprintf(file, csv ? "%s," : "%14s", SWP_axis[a].name);
+	}
+	for (uint32_t m = 0; m < SWP_MODES; m++) {
+		if (csv) {
+			fprintf(file, "%s_mae,%s_miss,%s_phan,%s_score,%s_cur",
+					mode[m], mode[m], mode[m], mode[m], mode[m]);
+		} else {
+			fprintf(file, "%7s%6s%6s%7s%6s", "mae", "miss", "phan", "score", "cur");
+		}
+		fputs((m + 1 < SWP_MODES) ? (csv ? "," : "  ") : "\n", file);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Parse from:to:step
+ * @param text argument
+ * @param from first value
+ * @param step increment, positive
+ * @param count number of values
+ * @return false if not valid
+ *****************************************************************************/
+static bool SWP_range(const char *text, int32_t *from, int32_t *step,
+		uint32_t *count)
+{
+	int f, t, s = 1;
+	int n = sscanf(text, "%d:%d:%d", &f, &t, &s);
+	if (1 == n) {
+		t = f;
+	}
+	if ((n < 1) || (t < f) || (s <= 0)) {
+		return false;
+	}
+	*from = f;
+	*step = s;
+	*count = (uint32_t)((t - f) / s) + 1;
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Add a swept threshold given as name=from:to:step
+ * @param text argument of -p
+ * @return false if not valid
+ *****************************************************************************/
+static bool SWP_add_axis(const char *text)
+{
+	const char *equal = strchr(text, '=');
+	if ((NULL == equal) || (SWP_axes >= SWP_MAX_AXES)) {
+		return false;
+	}
+	for (uint32_t p = 0; p < sizeof(SWP_param)/sizeof(SWP_param[0]); p++) {
+		if ((strlen(SWP_param[p].name) == (size_t)(equal - text))
+				&& (0 == strncmp(SWP_param[p].name, text, equal - text))) {
+			SWP_axis_t *axis = &SWP_axis[SWP_axes];
+			axis->offset = SWP_param[p].offset;
+			axis->name = SWP_param[p].name;
+			if (!SWP_range(equal + 1, &axis->from, &axis->step, &axis->count)
+					|| ((uint64_t)SWP_sets * axis->count > SWP_MAX_SETS)) {
+				return false;
+			}
+			SWP_sets *= axis->count;
+			SWP_axes++;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/** ***************************************************************************
+ * @brief Add a capture with known distance and current
+ * @param text kind:mm:A:file
+ * @return false if not valid or not readable
+ *****************************************************************************/
+static bool SWP_add_capture(const char *text)
+{
+	char kind[8];
+	float distance, current;
+	int length = 0;
+	if ((SWP_situations >= SWP_MAX_SITUATIONS)
+			|| (3 != sscanf(text, "%7[a-z]:%f:%f:%n", kind, &distance, &current,
+					&length)) || (0 == length)
+			|| ((0 != strcmp(kind, "wire")) && (0 != strcmp(kind, "cable")))) {
+		return false;
+	}
+	SWP_situation_t *sit = &SWP_situation[SWP_situations];
+	uint32_t size;
+	uint8_t *buffer = HOST_load(text + length, &size);
+	if ((NULL == buffer) || !CAP_open(&sit->cap, buffer, size)) {
+		free(buffer);
+		return false;
+	}
+	if (CALC_CALIBRATION != sit->cap.calibration) {
+		fprintf(stderr, "%s: recorded with calibration %u, this is %u\n",
+				text + length, (unsigned)sit->cap.calibration, CALC_CALIBRATION);
+	}
+	sit->kind = (0 == strcmp(kind, "cable")) ? CALC_CABLE : CALC_WIRE;
+	sit->distance = distance;
+	sit->current = current;
+	sit->path = text + length;
+	sit->frames = 0;
+	FRAME_t frame;
+	uint32_t samples[ADC_NUMS * INPUTS_NUMS];
+	while (CAP_next(&sit->cap, &frame, samples, ADC_NUMS)) {
+		sit->frames += (ADC_NUMS == frame.count);
+	}
+	SWP_situations++;
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Build the frames, sweep the grid and report, see file description
+ * @param argc number of arguments
+ * @param argv arguments
+ * @return 0 on success
+ *****************************************************************************/
+int main(int argc, char *argv[])
+{
+	uint32_t workers = 0;
+	uint32_t frames = 20;
+	uint32_t top = 10;
+	int32_t from = 5, step = 5;
+	uint32_t distances = 50;
+	int kinds = 3;						// Bit 0 wire, bit 1 cable
+	const char *csv = NULL;
+	int opt;
+	while (-1 != (opt = getopt(argc, argv, "j:f:d:s:k:p:t:o:"))) {
+		bool ok = true;
+		switch (opt) {
+		case 'j': workers = strtoul(optarg, NULL, 0); break;
+		case 'f': frames = strtoul(optarg, NULL, 0); break;
+		case 'd': ok = SWP_range(optarg, &from, &step, &distances); break;
+		case 's': SWP_noise = strtof(optarg, NULL); break;
+		case 'k': kinds = (0 == strcmp(optarg, "cable")) ? 2 : 1; break;
+		case 'p': ok = SWP_add_axis(optarg); break;
+		case 't': top = strtoul(optarg, NULL, 0); break;
+		case 'o': csv = optarg; break;
+		default: ok = false; break;
+		}
+		if (!ok) {
+			fprintf(stderr, "usage: %s [-j threads] [-f frames] [-d from:to:step] "
+					"[-s noise] [-k wire|cable]\n"
+					"       [-p name=from:to:step ...] [-t top] [-o csv] "
+					"[kind:mm:A:capture ...]\n", argv[0]);
+			return 2;
+		}
+	}
+	for (int i = optind; i < argc; i++) {
+		if (!SWP_add_capture(argv[i])) {
+			fprintf(stderr, "%s: no capture\n", argv[i]);
+			return 1;
+		}
+	}
+	static const float current[] = { 1.2f, 5.0f };
+	for (int k = 0; (k < CALC_KINDS) && (frames > 0); k++) {
+		for (uint32_t d = 0; (kinds & (1 << k)) && (d < distances); d++) {
+			for (uint32_t c = 0; c < sizeof(current)/sizeof(current[0]); c++) {
+				if (SWP_situations >= SWP_MAX_SITUATIONS) {
+					fprintf(stderr, "more than %u situations\n", SWP_MAX_SITUATIONS);
+					return 2;
+				}
+				SWP_situation_t *sit = &SWP_situation[SWP_situations++];
+				sit->kind = (CALC_kind_t)k;
+				sit->distance = from + (int32_t)d * step;
+				sit->current = current[c];
+				sit->path = NULL;
+				sit->frames = frames;
+			}
+		}
+	}
+	for (uint32_t s = 0; s < SWP_situations; s++) {
+		SWP_situation[s].first = SWP_frames;
+		SWP_frames += SWP_situation[s].frames;
+	}
+	if (0 == workers) {
+		workers = POOL_cpus();
+	}
+	SWP_frame = calloc(SWP_frames + 1, sizeof(SWP_frame[0]));
+	SWP_stats = calloc(SWP_sets, sizeof(SWP_stats[0]));
+	SWP_syn = calloc(workers, sizeof(SWP_syn[0]));
+	if ((NULL == SWP_frame) || (NULL == SWP_stats) || (NULL == SWP_syn)) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	double t0 = SWP_s();
+	POOL_run(workers, SWP_situations, 1, SWP_extract, NULL);
+	double t1 = SWP_s();
+	uint32_t grain = 1 + SWP_WORK / (SWP_frames + 1);
+	POOL_run(workers, SWP_sets, grain, SWP_sweep, NULL);
+	double t2 = SWP_s();
+	fprintf(stderr, "%u frames of %u situations, %u grid points, %u threads\n"
+			"features %.3f s, sweep %.3f s (%.0f evaluations/s)\n",
+			(unsigned)SWP_frames, (unsigned)SWP_situations, (unsigned)SWP_sets,
+			(unsigned)workers, t1 - t0, t2 - t1,
+			(t2 > t1) ? (double)SWP_sets * SWP_frames * SWP_MODES / (t2 - t1) : 0);
+
+	/* Current thresholds of the firmware first, then the best grid points */
+	SWP_stats_t stats[SWP_MODES];
+	SWP_evaluate(&CALC_limits, stats);
+	printf("%*s%-34s  %s\n", (int)(14 * SWP_axes), "", "single", "accurate");
+	SWP_header(stdout, false);
+	SWP_print(stdout, &CALC_limits, stats, false);
+	uint32_t *order = malloc(SWP_sets * sizeof(order[0]));
+	if (NULL == order) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	for (uint32_t i = 0; i < SWP_sets; i++) {
+		order[i] = i;
+	}
+	qsort(order, SWP_sets, sizeof(order[0]), SWP_compare);
+	printf("best of the grid:\n");
+	for (uint32_t i = 0; (i < top) && (i < SWP_sets); i++) {
+		CALC_limits_t limits;
+		SWP_limits(order[i], &limits);
+		SWP_print(stdout, &limits, SWP_stats[order[i]], false);
+	}
+
+	if (NULL != csv) {
+		FILE *file = fopen(csv, "w");
+		if (NULL == file) {
+			fprintf(stderr, "%s: cannot write\n", csv);
+			return 1;
+		}
+		SWP_header(file, true);
+		for (uint32_t i = 0; i < SWP_sets; i++) {
+			CALC_limits_t limits;
+			SWP_limits(i, &limits);
+			SWP_print(file, &limits, SWP_stats[i], true);
+		}
+		if (0 != fclose(file)) {
+			fprintf(stderr, "%s: cannot write\n", csv);
+			return 1;
+		}
+	}
+	free(order);
+	free(SWP_syn);
+	free(SWP_stats);
+	free(SWP_frame);
+	return 0;
+}
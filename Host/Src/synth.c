@@ -0,0 +1,292 @@
+/** ***************************************************************************
+ * @file
+ * @brief Synthetic field signals of the pads and coils in ADC_samples format
+ *
+ * ==============================================================
+ *
+ * Generates what the four inputs pad1, pad2, coil1 and coil2 see
+ * near a conductor, interleaved like ADC_samples.
+ *
+ * Model of one situation (SYN_config_t):
+ * - Mains fundamental (50 or 60 Hz) with 3rd and 5th harmonic.
+ * - The pads see the electric field: the RMS value for a distance is
+ *   interpolated in the pad lookup table of the firmware (wire or cable,
+ *   one entry per mm).
+ * - The coils see the magnetic field: the RMS value is interpolated
+ *   in the coil lookup tables for 1.2 A and 5 A (one entry per 20 mm)
+ *   and linearly in the current between the two tables.
+ * - The angle makes the pads unequal the way angle_to_cable() expects:
+ *   pad1 - pad2 = angle / 45 * 232 (left) or * 222 (right).
+ * - The coils have their own phase to the pads.
+ * - Virtual ground offset, Gaussian noise, rounding to 12 bit and
+ *   clipping like the ADC.
+ *
+ * SYN_init() precomputes one period of the signal and a noise table,
+ * so SYN_frame() only adds, rounds and clips.
+ * Without noise the precomputed samples are copied.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <math.h>
+#include <string.h>
+
+#include "synth.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define SYN_PAD_STEP		1.0f		///< mm between pad table entries
+#define SYN_COIL_STEP		20.0f		///< mm between coil table entries
+#define SYN_CURRENT_LOW		1.2f		///< A of lut_coil_1_2
+#define SYN_CURRENT_HIGH	5.0f		///< A of lut_coil_5
+#define SYN_LEFT_SPAN		232.0f		///< pad1 - pad2 at 45 deg left
+#define SYN_RIGHT_SPAN		222.0f		///< pad2 - pad1 at 45 deg right
+#define SYN_SCALE			256.0f		///< Fixed point of the tables
+#define SYN_ADC_MAX			((1 << ADC_DAC_RES) - 1)	///< Largest ADC value
+#define SYN_LENGTH(a)		(sizeof(a)/sizeof((a)[0]))	///< Table entries
+#define PI					3.14159265358979f
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+/** The lookup tables of the firmware, see calculations.c */
+static const int32_t SYN_lut_pad_wire[] = {
+		#include "lut_pad_wire.csv"
+};
+static const int32_t SYN_lut_pad_cable[] = {
+		#include "lut_pad_cable.csv"
+};
+static const int32_t SYN_lut_coil_1_2[] = {
+		#include "lut_coil_1_2.csv"
+};
+static const int32_t SYN_lut_coil_5[] = {
+		#include "lut_coil_5.csv"
+};
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+static float SYN_lookup(const int32_t *lut, uint32_t length, float step,
+		float distance);
+static uint32_t SYN_random(uint32_t *state);
+
+
+/** ***************************************************************************
+ * @brief Typical situation: wire at 20 mm with 1.2 A, straight ahead
+ * @param config filled with the defaults
+ *****************************************************************************/
+void SYN_default(SYN_config_t *config)
+{
+	memset(config, 0, sizeof(*config));
+	config->kind = SYN_WIRE;
+	config->mains = 50;
+	config->rate = SYN_RATE;
+	config->distance = 20;
+	config->current = 1.2f;
+	config->harmonic[0] = 0.05f;
+	config->harmonic[1] = 0.02f;
+	config->offset = SYN_OFFSET;
+	config->noise = 2;
+	config->seed = 1;
+}
+
+
+/** ***************************************************************************
+ * @brief Precompute the signal period and the noise of a situation
+ * @param syn generator to set up
+ * @param config situation
+ * @return false if a mains period does not fit into SYN_MAX_PERIOD samples
+ *****************************************************************************/
+bool SYN_init(SYN_t *syn, const SYN_config_t *config)
+{
+	uint32_t a = config->rate;
+	uint32_t b = config->mains;
+	while (0 != b) {					// Greatest common divisor
+		uint32_t t = a % b;
+		a = b;
+		b = t;
+	}
+	if ((0 == config->mains) || (0 == a)
+			|| (config->rate / a > SYN_MAX_PERIOD)) {
+		return false;
+	}
+	syn->config = *config;
+	syn->period = config->rate / a;		// Whole number of mains periods
+	syn->phase = 0;
+	syn->rng = (0 != config->seed) ? config->seed : 1;
+
+	/* Amplitudes of the fundamental from the RMS values of the tables */
+	float rms = 1.0f;
+	for (uint32_t h = 0; h < SYN_HARMONICS; h++) {
+		rms += config->harmonic[h] * config->harmonic[h];
+	}
+	rms = sqrtf(rms / 2);				// RMS of the waveform with amplitude 1
+	float pad = SYN_pad_rms(config->kind, config->distance);
+	float span = (config->angle > 0) ? SYN_LEFT_SPAN : SYN_RIGHT_SPAN;
+	float diff = config->angle / 45 * span;
+	float amp[INPUTS_NUMS];
+	amp[0] = (pad + diff / 2) / rms;
+	amp[1] = (pad - diff / 2) / rms;
+	amp[2] = amp[3] = SYN_coil_rms(config->distance, config->current) / rms;
+
+	for (uint32_t i = 0; i < syn->period; i++) {
+		float w = 2 * PI * (float)config->mains * i / config->rate;
+		for (uint32_t ch = 0; ch < INPUTS_NUMS; ch++) {
+			float x = (ch < 2) ? w : w + config->coil_phase;
+			float s = sinf(x) + config->harmonic[0] * sinf(3 * x)
+					+ config->harmonic[1] * sinf(5 * x);
+			float v = config->offset + amp[ch] * s;
+			syn->wave[i][ch] = (int32_t)lrintf(v * SYN_SCALE);
+			long q = lrintf(v);
+			syn->quantized[i][ch] = (q < 0) ? 0
+					: ((q > SYN_ADC_MAX) ? SYN_ADC_MAX : (uint16_t)q);
+		}
+	}
+
+	/* Gaussian noise by Box-Muller, in pairs */
+	uint32_t rng = syn->rng;
+	for (uint32_t i = 0; i < SYN_NOISE_SIZE; i += 2) {
+		float u1 = (SYN_random(&rng) + 1.0f) / 4294967296.0f;
+		float u2 = SYN_random(&rng) / 4294967296.0f;
+		float r = config->noise * SYN_SCALE * sqrtf(-2 * logf(u1));
+		syn->noise[i] = (int32_t)lrintf(r * cosf(2 * PI * u2));
+		syn->noise[i + 1] = (int32_t)lrintf(r * sinf(2 * PI * u2));
+	}
+	syn->rng = rng;
+	return true;
+}
+
+
+/** ***************************************************************************
+ * @brief Generate the next samples of all inputs
+ * @param syn generator from SYN_init()
+ * @param samples interleaved like ADC_samples: pad1, pad2, coil1, coil2
+ * @param count samples per input
+ *
+ * Consecutive calls continue the signal without a phase jump.
+ *****************************************************************************/
+void SYN_frame(SYN_t *syn, uint32_t *samples, uint32_t count)
+{
+	uint32_t phase = syn->phase;
+	if (0 == syn->config.noise) {
+		for (uint32_t i = 0; i < count; i++) {
+			const uint16_t *q = syn->quantized[phase];
+			samples[0] = q[0];
+			samples[1] = q[1];
+			samples[2] = q[2];
+			samples[3] = q[3];
+			samples += INPUTS_NUMS;
+			if (++phase >= syn->period) {
+				phase = 0;
+			}
+		}
+		syn->phase = phase;
+		return;
+	}
+	uint32_t rng = syn->rng;
+	for (uint32_t i = 0; i < count; i++) {
+		const int32_t *w = syn->wave[phase];
+		uint32_t r = 0;
+		for (uint32_t ch = 0; ch < INPUTS_NUMS; ch++) {
+			if (0 == (ch & 1)) {		// Two noise indexes per random number
+				r = SYN_random(&rng);
+			} else {
+				r >>= 16;
+			}
+			int32_t v = (w[ch] + syn->noise[r & (SYN_NOISE_SIZE - 1)]
+					+ (int32_t)SYN_SCALE/2) >> 8;
+			samples[ch] = (v < 0) ? 0 : ((v > SYN_ADC_MAX) ? SYN_ADC_MAX : v);
+		}
+		samples += INPUTS_NUMS;
+		if (++phase >= syn->period) {
+			phase = 0;
+		}
+	}
+	syn->rng = rng;
+	syn->phase = phase;
+}
+
+
+/** ***************************************************************************
+ * @brief RMS value of the pads at a distance
+ * @param kind wire or cable
+ * @param distance in mm, clamped to the table
+ * @return ADC counts
+ *****************************************************************************/
+float SYN_pad_rms(SYN_kind_t kind, float distance)
+{
+	if (SYN_CABLE == kind) {
+		return SYN_lookup(SYN_lut_pad_cable, SYN_LENGTH(SYN_lut_pad_cable),
+				SYN_PAD_STEP, distance);
+	}
+	return SYN_lookup(SYN_lut_pad_wire, SYN_LENGTH(SYN_lut_pad_wire),
+			SYN_PAD_STEP, distance);
+}
+
+
+/** ***************************************************************************
+ * @brief RMS value of the coils at a distance and current
+ * @param distance in mm, clamped to the table
+ * @param current in A, interpolated between the 1.2 A and 5 A tables
+ * @return ADC counts, not negative
+ *****************************************************************************/
+float SYN_coil_rms(float distance, float current)
+{
+	float low = SYN_lookup(SYN_lut_coil_1_2, SYN_LENGTH(SYN_lut_coil_1_2),
+			SYN_COIL_STEP, distance);
+	float high = SYN_lookup(SYN_lut_coil_5, SYN_LENGTH(SYN_lut_coil_5),
+			SYN_COIL_STEP, distance);
+	float b = low + (current - SYN_CURRENT_LOW)
+			/ (SYN_CURRENT_HIGH - SYN_CURRENT_LOW) * (high - low);
+	return (b > 0) ? b : 0;
+}
+
+
+/** ***************************************************************************
+ * @brief Linear interpolation in a lookup table
+ * @param lut table
+ * @param length entries
+ * @param step mm between entries
+ * @param distance in mm
+ * @return interpolated value, the first or last entry outside the table
+ *****************************************************************************/
+static float SYN_lookup(const int32_t *lut, uint32_t length, float step,
+		float distance)
+{
+	float x = distance / step;
+	if (x <= 0) {
+		return lut[0];
+	}
+	if (x >= length - 1) {
+		return lut[length - 1];
+	}
+	uint32_t i = (uint32_t)x;
+	float f = x - i;
+	return lut[i] + f * (lut[i + 1] - lut[i]);
+}
+
+
+/** ***************************************************************************
+ * @brief Next value of the xorshift32 generator
+ * @param state not 0
+ * @return pseudo random number
+ *****************************************************************************/
+static uint32_t SYN_random(uint32_t *state)
+{
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
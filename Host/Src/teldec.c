@@ -0,0 +1,794 @@
+/** ***************************************************************************
+ * @file
+ * @brief Decoder of the telemetry stream, see telemetry.c
+ *
+ * ==============================================================
+ *
+ * Device: reads the virtual COM port of the board and prints one line
+ * per packet. Commands given as options are sent first, see remote.c.
+ * @n Usage: teldec [-b baud] [-n packets] [-m wire|cable|angle] [-w samples]
+ * [-s mask] [-H 0|1] [-a mm] [-t input:low:high:pre:post] [-c measurements]
+ * device
+ * - -b baud rate (default TEL_BAUD)
+ * - -n stop after this many packets
+ * - -m mode of the measurements
+ * - -w samples of an accurate value
+ * - -s telemetry types to send, bit 1 << TEL_type_t, e.g. 1 = results only
+ * - -H 1 = do not draw the results on the display
+ * - -a precision of the distance in mm, 0 = fixed window, see sequential.c
+ * - -t arm the trigger, see trigger.c, input 4 = all, post 0 disarms
+ * - -c run this many measurements and stop after their results
+ *
+ * Self-test: a pseudo-terminal stands in for the serial port.
+ * The firmware telemetry.c sends synthetic frames with their results,
+ * spectra and profiles through the USART model (host_uart.c) into the
+ * master side, the decoder reads the slave side.
+ * The reader only drains the port every few frames, so the ring of the
+ * sender fills up and packets are dropped.
+ * @n Passes if all packets have a valid CRC, the sequence gaps per type
+ * are the packets counted in TEL_dropped and all received frames have
+ * the samples that were sent.
+ * Then commands are written into the port, with a damaged and invalid
+ * ones, and the replies and the settings of remote.c are checked.
+ * Last the trigger (trigger.c) fires in the middle of recorded halves,
+ * its window must be the samples around the trigger, also in the packets.
+ * @n Usage: teldec -p [-n frames] [-r frames] [-v]
+ * - -n frames to send (default 2000)
+ * - -r frames between reads of the port (default 32, 1 = no drops)
+ * - -v print the packets
+ *
+ * A packet with a wrong CRC or an unknown header is skipped byte by byte
+ * until the next sync, like after a line glitch.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#define _GNU_SOURCE						// posix_openpt(), cfmakeraw()
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "host.h"
+#include "stm32f429i_discovery_sdram.h"
+#include "calculations.h"
+#include "displayingdata.h"
+#include "fft.h"
+#include "measuring.h"
+#include "plotting.h"
+#include "record.h"
+#include "remote.h"
+#include "sequential.h"
+#include "synth.h"
+#include "telemetry.h"
+#include "trigger.h"
+#include <termios.h>						// Last, defines CR2, CR3 ...
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define DEC_PACKET_MAX	(TEL_HEADER_SIZE + TEL_MAX_PAYLOAD + TEL_CRC_SIZE)
+#define DEC_FRAME_WORDS	(ADC_NUMS*INPUTS_NUMS)	///< Samples of a sent frame
+#define DEC_SPECTRUM	4				///< Frames per spectrum
+#define DEC_PROFILE		50				///< Frames per profile
+#define DEC_REPLIES		32				///< Commands per run, by sequence number
+#define DEC_COMMANDS	8				///< Commands given as options
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** Stream decoder */
+typedef struct {
+	uint8_t packet[DEC_PACKET_MAX];		///< Packet being received
+	uint32_t fill;						///< Bytes in packet
+	uint32_t received[TEL_TYPES];		///< Valid packets per type
+	uint32_t gaps[TEL_TYPES];			///< Missing sequence numbers per type
+	uint16_t next[TEL_TYPES];			///< Expected sequence number per type
+	bool seen[TEL_TYPES];				///< A packet of the type was received
+	uint32_t crc_errors;				///< Packets with a wrong CRC
+	uint32_t skipped;					///< Bytes skipped to find a sync
+	uint32_t mismatches;				///< Frames not as sent (self-test)
+	int32_t reply[DEC_REPLIES];			///< Status per command seq., -1 = none
+	bool verbose;						///< Print every packet
+} DEC_t;
+
+/** Command to send */
+typedef struct {
+	REM_command_t type;					///< Command
+	uint32_t value[5];					///< Payload, REM_TRIGGER: TRIG_config_t
+} DEC_command_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+bool MEAS_data_wire = false;			///< Defined by main.c on the target
+bool MEAS_data_cable = false;			///< Defined by main.c on the target
+bool MEAS_data_angle = false;			///< Defined by main.c on the target
+
+static const char *DEC_names[TEL_TYPES] = {
+		"result", "frame", "spectrum", "profile", "reply", "trigger"
+};
+/** Payload lengths of the commands */
+static const uint32_t DEC_command_length[REM_COMMANDS] = {
+		[REM_MODE] = 1, [REM_MEASURE] = 2, [REM_WINDOW] = 2,
+		[REM_STREAM] = 4, [REM_HEADLESS] = 1, [REM_TRIGGER] = 10,
+		[REM_PRECISION] = 2
+};
+static uint32_t (*DEC_sent)[DEC_FRAME_WORDS] = NULL;	///< Self-test frames
+static uint32_t DEC_sent_count = 0;		///< Entries of DEC_sent
+static const uint32_t *DEC_window = NULL;	///< Self-test trigger window
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Read little endian values
+ * @param p source
+ * @return value
+ *****************************************************************************/
+static uint32_t DEC_get16(const uint8_t *p)
+{
+	return p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t DEC_get32(const uint8_t *p)
+{
+	return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16)
+			| ((uint32_t)p[3] << 24);
+}
+
+
+/** ***************************************************************************
+ * @brief Print a packet
+ * @param type TEL_type_t
+ * @param seq sequence number
+ * @param p payload
+ * @param n payload length
+ *****************************************************************************/
+static void DEC_print(uint32_t type, uint32_t seq, const uint8_t *p, uint32_t n)
+{
+	printf("%-8s %5u %4u ", DEC_names[type], (unsigned)seq, (unsigned)n);
+	switch (type) {
+	case TEL_RESULT:
+		printf("screen %u state 0x%x values", p[0], (unsigned)DEC_get32(&p[4]));
+		for (uint32_t i = 8; i + 4 <= n; i += 4) {
+			printf(" %d", (int)DEC_get32(&p[i]));
+		}
+		break;
+	case TEL_FRAME:
+		printf("seq %u time %u count %u overruns %u",
+				(unsigned)DEC_get32(&p[0]), (unsigned)DEC_get32(&p[4]),
+				(unsigned)DEC_get16(&p[8]), (unsigned)DEC_get16(&p[10]));
+		break;
+	case TEL_SPECTRUM:
+		printf("seq %u mag", (unsigned)DEC_get32(&p[0]));
+		for (uint32_t i = 8; i + 4 <= n; i += 4) {
+			printf(" %u", (unsigned)DEC_get32(&p[i]));
+		}
+		break;
+	case TEL_PROFILE:
+		printf("tick %u overruns %u rec %u dropped",
+				(unsigned)DEC_get32(&p[0]), (unsigned)DEC_get32(&p[4]),
+				(unsigned)DEC_get32(&p[8]));
+		for (uint32_t t = 0; t < TEL_TYPES; t++) {
+			printf(" %u", (unsigned)DEC_get32(&p[12 + 4*t]));
+		}
+		break;
+	case TEL_REPLY:
+		printf("command %u status %u seq %u", p[0], p[1],
+				(unsigned)DEC_get16(&p[2]));
+		break;
+	case TEL_TRIGGER:
+		printf("sample %u time %u pre %u window %u offset %u count %u",
+				(unsigned)DEC_get32(&p[0]), (unsigned)DEC_get32(&p[4]),
+				(unsigned)DEC_get16(&p[8]), (unsigned)DEC_get16(&p[10]),
+				(unsigned)DEC_get16(&p[12]), (unsigned)DEC_get16(&p[14]));
+		break;
+	default:
+		break;
+	}
+	printf("\n");
+}
+
+
+/** ***************************************************************************
+ * @brief Check a received frame against the sent one (self-test)
+ * @param dec decoder
+ * @param p payload
+ * @param n payload length
+ *****************************************************************************/
+static void DEC_verify_frame(DEC_t *dec, const uint8_t *p, uint32_t n)
+{
+	uint32_t seq = DEC_get32(&p[0]);
+	uint32_t count = DEC_get16(&p[8]);
+	if ((seq >= DEC_sent_count) || (n != 12 + 2*count*INPUTS_NUMS)) {
+		dec->mismatches++;
+		return;
+	}
+	for (uint32_t i = 0; i < count*INPUTS_NUMS; i++) {
+		if (DEC_get16(&p[12 + 2*i]) != DEC_sent[seq][i]) {
+			dec->mismatches++;
+			return;
+		}
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Handle a complete packet with a valid CRC
+ * @param dec decoder
+ *****************************************************************************/
+static void DEC_packet(DEC_t *dec)
+{
+	uint32_t type = dec->packet[2];
+	uint32_t seq = DEC_get16(&dec->packet[4]);
+	uint32_t n = DEC_get16(&dec->packet[6]);
+	const uint8_t *payload = &dec->packet[TEL_HEADER_SIZE];
+	if (dec->seen[type]) {
+		dec->gaps[type] += (uint16_t)(seq - dec->next[type]);
+	} else {
+		dec->gaps[type] += seq;			// Dropped before the first one
+	}
+	dec->seen[type] = true;
+	dec->next[type] = seq + 1;
+	dec->received[type]++;
+	if ((TEL_FRAME == type) && (NULL != DEC_sent)) {
+		DEC_verify_frame(dec, payload, n);
+	}
+	if ((TEL_TRIGGER == type) && (NULL != DEC_window)) {
+		uint32_t offset = DEC_get16(&payload[12]);
+		for (uint32_t i = 0; i < DEC_get16(&payload[14])*INPUTS_NUMS; i++) {
+			if (DEC_get16(&payload[16 + 2*i]) != DEC_window[offset*INPUTS_NUMS + i]) {
+				dec->mismatches++;
+				break;
+			}
+		}
+	}
+	if ((TEL_REPLY == type) && (4 == n)
+			&& (DEC_get16(&payload[2]) < DEC_REPLIES)) {
+		dec->reply[DEC_get16(&payload[2])] = payload[1];
+	}
+	if (dec->verbose) {
+		DEC_print(type, seq, payload, n);
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Feed received bytes into the decoder
+ * @param dec decoder
+ * @param data bytes
+ * @param length number of bytes
+ * @return packets completed
+ *****************************************************************************/
+static uint32_t DEC_feed(DEC_t *dec, const uint8_t *data, uint32_t length)
+{
+	uint32_t packets = 0;
+	for (uint32_t i = 0; i < length; i++) {
+		dec->packet[dec->fill++] = data[i];
+		while (dec->fill > 0) {			// Until the bytes can start a packet
+			uint8_t *p = dec->packet;
+			bool bad = (TEL_SYNC0 != p[0])
+					|| ((dec->fill > 1) && (TEL_SYNC1 != p[1]))
+					|| ((dec->fill > 2) && (p[2] >= TEL_TYPES))
+					|| ((dec->fill > 3) && (TEL_VERSION != p[3]))
+					|| ((dec->fill >= TEL_HEADER_SIZE)
+							&& (DEC_get16(&p[6]) > TEL_MAX_PAYLOAD));
+			if (!bad && (dec->fill >= TEL_HEADER_SIZE)) {
+				uint32_t size = TEL_HEADER_SIZE + DEC_get16(&p[6]) + TEL_CRC_SIZE;
+				if (dec->fill < size) {
+					break;
+				}
+				uint16_t crc = TEL_crc(0xFFFF, &p[2], size - 2 - TEL_CRC_SIZE);
+				if (crc == DEC_get16(&p[size - TEL_CRC_SIZE])) {
+					DEC_packet(dec);
+					packets++;
+					dec->fill = 0;
+					break;
+				}
+				dec->crc_errors++;
+				bad = true;
+			}
+			if (!bad) {
+				break;
+			}
+			dec->skipped++;				// Resync one byte later
+			memmove(p, &p[1], --dec->fill);
+		}
+	}
+	return packets;
+}
+
+
+/** ***************************************************************************
+ * @brief Read all bytes available without waiting
+ * @param dec decoder
+ * @param fd non-blocking descriptor
+ * @return bytes read
+ *****************************************************************************/
+static uint32_t DEC_drain(DEC_t *dec, int fd)
+{
+	uint8_t buffer[4096];
+	uint32_t total = 0;
+	ssize_t n;
+	while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+		DEC_feed(dec, buffer, (uint32_t)n);
+		total += (uint32_t)n;
+	}
+	return total;
+}
+
+
+/** ***************************************************************************
+ * @brief Send a command packet
+ * @param fd serial port
+ * @param type REM_command_t, also invalid ones for the self-test
+ * @param seq sequence number
+ * @param payload bytes
+ * @param n payload length
+ * @return true if written
+ *****************************************************************************/
+static bool DEC_command(int fd, uint32_t type, uint32_t seq,
+		const uint8_t *payload, uint32_t n)
+{
+	uint8_t packet[TEL_HEADER_SIZE + REM_MAX_PAYLOAD + TEL_CRC_SIZE];
+	packet[0] = TEL_SYNC0;
+	packet[1] = TEL_SYNC1;
+	packet[2] = (uint8_t)type;
+	packet[3] = TEL_VERSION;
+	packet[4] = (uint8_t)seq;
+	packet[5] = (uint8_t)(seq >> 8);
+	packet[6] = (uint8_t)n;
+	packet[7] = 0;
+	memcpy(&packet[TEL_HEADER_SIZE], payload, n);
+	uint16_t crc = TEL_crc(0xFFFF, &packet[2], TEL_HEADER_SIZE - 2 + n);
+	packet[TEL_HEADER_SIZE + n] = (uint8_t)crc;
+	packet[TEL_HEADER_SIZE + n + 1] = (uint8_t)(crc >> 8);
+	uint32_t size = TEL_HEADER_SIZE + n + TEL_CRC_SIZE;
+	return write(fd, packet, size) == (ssize_t)size;
+}
+
+
+/** ***************************************************************************
+ * @brief Send a command with a value in its payload
+ * @param fd serial port
+ * @param command type and value
+ * @param seq sequence number
+ * @return true if written
+ *****************************************************************************/
+static bool DEC_send(int fd, const DEC_command_t *command, uint32_t seq)
+{
+	uint8_t payload[REM_MAX_PAYLOAD];
+	for (uint32_t i = 0; i < 4; i++) {
+		payload[i] = (uint8_t)(command->value[0] >> (8*i));
+	}
+	if (REM_TRIGGER == command->type) {	// u8 input, u8 0, u16 ...
+		payload[1] = 0;
+		for (uint32_t i = 1; i < 5; i++) {
+			payload[2*i] = (uint8_t)command->value[i];
+			payload[2*i + 1] = (uint8_t)(command->value[i] >> 8);
+		}
+	}
+	return DEC_command(fd, command->type, seq, payload,
+			DEC_command_length[command->type]);
+}
+
+
+/** ***************************************************************************
+ * @brief Remote control part of the self-test
+ * @param dec decoder of the slave side
+ * @param slave rig side of the pseudo-terminal
+ * @return true if passed
+ *****************************************************************************/
+static bool DEC_remote_test(DEC_t *dec, int slave)
+{
+	static const DEC_command_t commands[] = {
+			{ REM_MODE, { REM_CABLE } }, { REM_WINDOW, { 24 } },
+			{ REM_WINDOW, { 5 } }, { REM_STREAM, { 1UL << TEL_RESULT } },
+			{ REM_HEADLESS, { 1 } }, { REM_TRIGGER, { 1, 100, 4000, 120, 60 } },
+			{ REM_TRIGGER, { 7, 100, 4000, 120, 60 } }, { REM_PRECISION, { 3 } },
+			{ REM_MEASURE, { 3 } },
+	};
+	static const int32_t expected[] = {
+			REM_OK, REM_OK, REM_BAD_VALUE, REM_OK, REM_OK, REM_OK,
+			REM_BAD_VALUE, REM_OK, REM_OK, REM_BAD_COMMAND, REM_BAD_LENGTH, -1
+	};
+	const uint32_t count = sizeof(commands) / sizeof(commands[0]);
+	uint8_t junk[3] = { 0x00, TEL_SYNC0, 0x17 };
+	for (uint32_t i = 0; i < DEC_REPLIES; i++) {
+		dec->reply[i] = -1;
+	}
+	REM_init();
+	for (uint32_t i = 0; i < count; i++) {
+		DEC_send(slave, &commands[i], i);
+		if (1 == i) {
+			(void)!write(slave, junk, sizeof(junk));	// Line noise
+		}
+	}
+	DEC_command(slave, REM_COMMANDS + 3, count, junk, 1);
+	DEC_command(slave, REM_MODE, count + 1, junk, 2);
+	uint8_t damaged[TEL_HEADER_SIZE + 2 + TEL_CRC_SIZE] = {
+			TEL_SYNC0, TEL_SYNC1, REM_MEASURE, TEL_VERSION, count + 2, 0, 2, 0,
+			100, 0, 0x12, 0x34			// Wrong CRC
+	};
+	(void)!write(slave, damaged, sizeof(damaged));
+	for (uint32_t round = 0; round < 10; round++) {
+		HOST_step();					// Receiver and idle interrupt
+		REM_poll();
+		HOST_step();					// Replies
+		usleep(1000);
+		DEC_drain(dec, slave);
+	}
+
+	bool pass = (24 == CALC_window) && ((1UL << TEL_RESULT) == TEL_mask)
+			&& REM_headless && (3 == SEQ_precision) && (3 == REM_pending());
+	for (uint32_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+		pass = pass && (expected[i] == dec->reply[i]);
+	}
+	TRIG_config_t trigger;
+	pass = pass && REM_trigger(&trigger) && !REM_trigger(&trigger)
+			&& (1 == trigger.input) && (100 == trigger.low)
+			&& (4000 == trigger.high) && (120 == trigger.pre)
+			&& (60 == trigger.post);
+	REM_mode_t mode;
+	for (uint32_t i = 0; i < 3; i++) {
+		pass = pass && REM_next(&mode) && (REM_CABLE == mode)
+				&& !REM_next(&mode);	// Only one at a time
+		REM_done();
+	}
+	pass = pass && !REM_next(&mode) && (0 == REM_pending());
+	printf("remote: window %u, mask 0x%x, headless %u, replies",
+			(unsigned)CALC_window, (unsigned)TEL_mask, (unsigned)REM_headless);
+	for (uint32_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+		printf(" %d", (int)dec->reply[i]);
+	}
+	printf(": %s\n", pass ? "pass" : "FAIL");
+	CALC_window = CALC_WINDOW;
+	REM_headless = false;
+	TEL_mask = TEL_MASK_ALL;
+	return pass;
+}
+
+
+/** ***************************************************************************
+ * @brief Trigger part of the self-test
+ * @param dec decoder of the slave side
+ * @param slave rig side of the pseudo-terminal
+ * @param syn signal generator
+ * @return true if passed
+ *
+ * Feeds halves of the continuous mode into the recorder, fires the
+ * analog watchdog in the middle of a half and checks the frozen window
+ * and its TEL_TRIGGER packets.
+ *****************************************************************************/
+static bool DEC_trigger_test(DEC_t *dec, int slave, SYN_t *syn)
+{
+	enum { HALVES = 40, FIRE = 21, AT = 7 };
+	static uint32_t all[HALVES*ADC_STREAM_NUMS*INPUTS_NUMS];
+	const TRIG_config_t config = {
+			.input = 2, .low = 100, .high = 4000, .pre = 75, .post = 100
+	};
+	SYN_frame(syn, all, HALVES*ADC_STREAM_NUMS);
+	BSP_SDRAM_Init();
+	REC_init((void *)REC_SDRAM_ADDR, REC_SDRAM_SIZE);
+	REC_start();
+	MEAS_continuous = true;
+	bool pass = TRIG_arm(&config) && (TRIG_ARMED == TRIG_state);
+	bool frozen = false;
+	for (uint32_t h = 0; h < HALVES; h++) {
+		if (FIRE == h) {				// Level crossed at sample AT of the half
+			DMA2_Stream1->NDTR = INPUTS_NUMS*(ADC_NUMS - (h % 2)*ADC_STREAM_NUMS - AT);
+			ADC3->SR |= ADC_SR_AWD;
+			NVIC_SetPendingIRQ(ADC_IRQn);	// Runs ADC_IRQHandler()
+		}
+		REC_put(&all[h*ADC_STREAM_NUMS*INPUTS_NUMS], ADC_STREAM_NUMS);
+		HOST_step();					// SDRAM DMA done
+		frozen = TRIG_poll() || frozen;
+	}
+	uint32_t sample = FIRE*ADC_STREAM_NUMS + AT;
+	pass = pass && frozen && (TRIG_DONE == TRIG_state) && (sample == TRIG_sample)
+			&& (config.pre == TRIG_pre) && (config.pre + config.post == TRIG_count)
+			&& (0 == memcmp(TRIG_samples, &all[(sample - config.pre)*INPUTS_NUMS],
+					TRIG_count*INPUTS_NUMS*sizeof(uint32_t)));
+	MEAS_continuous = false;
+
+	uint32_t received = dec->received[TEL_TRIGGER];
+	uint32_t mismatches = dec->mismatches;
+	DEC_window = TRIG_samples;
+	for (uint32_t offset = 0; offset < TRIG_count; ) {
+		if (TEL_trigger(offset, ADC_NUMS)) {
+			offset += ADC_NUMS;
+		}
+		HOST_step();
+		DEC_drain(dec, slave);
+	}
+	for (uint32_t round = 0; round < 10; round++) {
+		HOST_step();
+		usleep(1000);
+		DEC_drain(dec, slave);
+	}
+	DEC_window = NULL;
+	uint32_t packets = (TRIG_count + ADC_NUMS - 1) / ADC_NUMS;
+	pass = pass && (dec->received[TEL_TRIGGER] - received == packets)
+			&& (dec->mismatches == mismatches);
+	printf("trigger: sample %u, window %u with %u before, %u packets: %s\n",
+			(unsigned)TRIG_sample, (unsigned)TRIG_count, (unsigned)TRIG_pre,
+			(unsigned)(dec->received[TEL_TRIGGER] - received),
+			pass ? "pass" : "FAIL");
+	return pass;
+}
+
+
+/** ***************************************************************************
+ * @brief Pseudo-terminal self-test, see file description
+ * @param frames number of frames to send
+ * @param interval frames between reads of the port
+ * @param verbose print the packets
+ * @return 0 if passed
+ *****************************************************************************/
+static int DEC_selftest(uint32_t frames, uint32_t interval, bool verbose)
+{
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	if ((master < 0) || (0 != grantpt(master)) || (0 != unlockpt(master))) {
+		perror("posix_openpt");
+		return 1;
+	}
+	int slave = open(ptsname(master), O_RDWR | O_NOCTTY | O_NONBLOCK);
+	struct termios tio;
+	if ((slave < 0) || (0 != tcgetattr(slave, &tio))) {
+		perror("pty slave");
+		return 1;
+	}
+	cfmakeraw(&tio);					// Binary, no echo or translation
+	tcsetattr(slave, TCSANOW, &tio);
+	fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+	static SYN_t syn;
+	SYN_config_t config;
+	SYN_default(&config);
+	SYN_init(&syn, &config);
+	DEC_sent = calloc(frames, sizeof(*DEC_sent));
+	DEC_sent_count = frames;
+	static DEC_t dec;
+	dec.verbose = verbose;
+
+	HOST_reset();
+	HOST_uart_fd = master;
+	TEL_init();
+	FFT_init(ADC_STREAM_NUMS);
+	for (uint32_t f = 0; f < frames; f++) {
+		FRAME_t frame = {
+				.samples = DEC_sent[f], .count = ADC_NUMS, .seq = f,
+				.time = HOST_tick, .overruns = 0
+		};
+		SYN_frame(&syn, DEC_sent[f], ADC_NUMS);
+		TEL_frame(&frame);
+		MEAS_sort_data(&frame);
+		DISP_result_t result;
+		DISP_calc_wire(&result);
+		TEL_result(&result);
+		if (0 == f % DEC_SPECTRUM) {
+			int32_t coils[ADC_STREAM_NUMS];
+			uint32_t mag[PLOT_BINS];
+			for (uint32_t i = 0; i < ADC_STREAM_NUMS; i++) {
+				coils[i] = COIL1_samples[i] + COIL2_samples[i];
+			}
+			FFT_spectrum(coils, mag, PLOT_BINS);
+			TEL_spectrum(f, mag, PLOT_BINS);
+		}
+		if (0 == f % DEC_PROFILE) {
+			TEL_profile();
+		}
+		HOST_tick += 100;				// Single acquisitions at 10 Hz
+		HOST_step();					// USART and its interrupt
+		if (0 == (f + 1) % interval) {
+			DEC_drain(&dec, slave);
+		}
+	}
+	for (uint32_t idle = 0; idle < 100; ) {	// Until sent and read
+		HOST_step();
+		if ((0 == DEC_drain(&dec, slave)) && (0 == TEL_queued())) {
+			idle++;
+			usleep(1000);
+		} else {
+			idle = 0;
+		}
+	}
+	bool pass = (0 == dec.crc_errors) && (0 == dec.mismatches)
+			&& (0 == dec.fill);
+	printf("type      sent dropped received gaps\n");
+	for (uint32_t t = 0; t < TEL_TYPES; t++) {
+		uint32_t numbered = TEL_sent[t] + TEL_dropped[t];
+		uint32_t tail = dec.seen[t]		// Dropped after the last received
+				? (uint16_t)(numbered - dec.next[t]) : numbered;
+		printf("%-8s %6u %7u %8u %4u\n", DEC_names[t], (unsigned)TEL_sent[t],
+				(unsigned)TEL_dropped[t], (unsigned)dec.received[t],
+				(unsigned)(dec.gaps[t] + tail));
+		pass = pass && (dec.received[t] == TEL_sent[t])
+				&& (dec.gaps[t] + tail == TEL_dropped[t]);
+	}
+	printf("%llu bytes, %u CRC errors, %u bytes skipped, %u frames wrong: %s\n",
+			(unsigned long long)HOST_uart_bytes, (unsigned)dec.crc_errors,
+			(unsigned)dec.skipped, (unsigned)dec.mismatches,
+			pass ? "pass" : "FAIL");
+	pass = DEC_remote_test(&dec, slave) && pass;
+	pass = DEC_trigger_test(&dec, slave, &syn) && pass;
+	HOST_uart_fd = -1;
+	close(slave);
+	close(master);
+	free(DEC_sent);
+	DEC_sent = NULL;
+	return pass ? 0 : 1;
+}
+
+
+/** ***************************************************************************
+ * @brief Baud rate constant of termios
+ * @param baud rate in bit/s
+ * @return speed_t, B0 if not supported
+ *****************************************************************************/
+static speed_t DEC_speed(uint32_t baud)
+{
+	switch (baud) {
+	case 115200: return B115200;
+	case 230400: return B230400;
+	case 460800: return B460800;
+	case 921600: return B921600;
+	default: return B0;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Decode the stream of a serial device, see file description
+ * @param path device, e.g. /dev/ttyACM0
+ * @param baud rate in bit/s
+ * @param packets stop after this many packets, 0 = never
+ * @param commands sent first
+ * @param count number of commands
+ * @return 0 on success
+ *
+ * Stops after the results of the measurements started by REM_MEASURE.
+ *****************************************************************************/
+static int DEC_device(const char *path, uint32_t baud, uint32_t packets,
+		const DEC_command_t *commands, uint32_t count)
+{
+	int fd = open(path, O_RDWR | O_NOCTTY);
+	struct termios tio;
+	if ((fd < 0) || (0 != tcgetattr(fd, &tio))) {
+		perror(path);
+		return 1;
+	}
+	if (B0 == DEC_speed(baud)) {
+		fprintf(stderr, "%s: baud rate %u not supported\n", path, (unsigned)baud);
+		return 2;
+	}
+	cfmakeraw(&tio);
+	cfsetispeed(&tio, DEC_speed(baud));
+	cfsetospeed(&tio, DEC_speed(baud));
+	tio.c_cc[VMIN] = 1;					// Block until a byte arrives
+	tio.c_cc[VTIME] = 0;
+	tcsetattr(fd, TCSANOW, &tio);
+
+	static DEC_t dec;
+	uint32_t total = 0;
+	uint32_t results = 0;				// Results to wait for, 0 = none
+	uint8_t buffer[4096];
+	dec.verbose = true;
+	for (uint32_t i = 0; i < count; i++) {
+		if (!DEC_send(fd, &commands[i], i)) {
+			perror(path);
+		}
+		if (REM_MEASURE == commands[i].type) {
+			results = commands[i].value[0];
+		}
+	}
+	while (((0 == packets) || (total < packets))
+			&& ((0 == results) || (dec.received[TEL_RESULT] < results))) {
+		ssize_t n = read(fd, buffer, sizeof(buffer));
+		if ((n < 0) && (EINTR != errno)) {
+			perror(path);
+			break;
+		}
+		if (n > 0) {
+			total += DEC_feed(&dec, buffer, (uint32_t)n);
+			fflush(stdout);
+		}
+	}
+	close(fd);
+	fprintf(stderr, "%u packets, %u CRC errors, gaps", (unsigned)total,
+			(unsigned)dec.crc_errors);
+	for (uint32_t t = 0; t < TEL_TYPES; t++) {
+		fprintf(stderr, " %s %u", DEC_names[t], (unsigned)dec.gaps[t]);
+	}
+	fprintf(stderr, "\n");
+	return 0;
+}
+
+
+/** ***************************************************************************
+ * @brief Decode a device or run the self-test, see file description
+ * @param argc number of arguments
+ * @param argv arguments
+ * @return 0 on success
+ *****************************************************************************/
+int main(int argc, char *argv[])
+{
+	bool selftest = false;
+	bool verbose = false;
+	uint32_t count = 0;
+	uint32_t interval = 32;
+	uint32_t baud = TEL_BAUD;
+	DEC_command_t commands[DEC_COMMANDS];
+	uint32_t commanded = 0;
+	int32_t measurements = -1;
+	int opt;
+	while (-1 != (opt = getopt(argc, argv, "pn:r:vb:m:w:s:H:a:t:c:"))) {
+		DEC_command_t *c = &commands[commanded];
+		switch (opt) {
+		case 'p': selftest = true; break;
+		case 'n': count = strtoul(optarg, NULL, 0); break;
+		case 'r': interval = strtoul(optarg, NULL, 0); break;
+		case 'v': verbose = true; break;
+		case 'b': baud = strtoul(optarg, NULL, 0); break;
+		case 'm':
+			c->type = REM_MODE;
+			c->value[0] = (0 == strcmp(optarg, "cable")) ? REM_CABLE
+					: (0 == strcmp(optarg, "angle")) ? REM_ANGLE : REM_WIRE;
+			commanded++;
+			break;
+		case 'w': c->type = REM_WINDOW; c->value[0] = strtoul(optarg, NULL, 0); commanded++; break;
+		case 's': c->type = REM_STREAM; c->value[0] = strtoul(optarg, NULL, 0); commanded++; break;
+		case 'H': c->type = REM_HEADLESS; c->value[0] = strtoul(optarg, NULL, 0); commanded++; break;
+		case 'a': c->type = REM_PRECISION; c->value[0] = strtoul(optarg, NULL, 0); commanded++; break;
+		case 't':
+			c->type = REM_TRIGGER;
+			if (5 != sscanf(optarg, "%u:%u:%u:%u:%u", &c->value[0], &c->value[1],
+					&c->value[2], &c->value[3], &c->value[4])) {
+				fprintf(stderr, "%s: -t input:low:high:pre:post\n", argv[0]);
+				return 2;
+			}
+			commanded++;
+			break;
+		case 'c': measurements = strtol(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-b baud] [-n packets] [-m wire|cable|angle] "
+					"[-w samples] [-s mask] [-H 0|1] [-a mm]\n"
+					"       [-t input:low:high:pre:post] [-c measurements] device\n"
+					"       %s -p [-n frames] [-r frames] [-v]\n",
+					argv[0], argv[0]);
+			return 2;
+		}
+		if (commanded >= DEC_COMMANDS - 1) {
+			fprintf(stderr, "%s: too many commands\n", argv[0]);
+			return 2;
+		}
+	}
+	if (measurements >= 0) {			// Last, after the settings
+		commands[commanded].type = REM_MEASURE;
+		commands[commanded].value[0] = (uint32_t)measurements;
+		commanded++;
+	}
+	if (selftest) {
+		return DEC_selftest((0 == count) ? 2000 : count,
+				(0 == interval) ? 1 : interval, verbose);
+	}
+	if (optind >= argc) {
+		fprintf(stderr, "%s: no device given\n", argv[0]);
+		return 2;
+	}
+	return DEC_device(argv[optind], baud, count, commands, commanded);
+}
@@ -0,0 +1,718 @@
+/** ***************************************************************************
+ * @file
+ * @brief Check the results of the firmware modules on the host
+ *
+ * ==============================================================
+ *
+ * Every test compares the firmware code with values found independently:
+ * the lookup tables themselves, the C library (sqrt(), snprintf()),
+ * a recalculation from all samples, the BSP string drawing or the data
+ * put in. Unlike bench, which only checks that a function gives
+ * the same result on every call, a wrong result fails here.
+ * @n A test prints its first TEST_REPORT failures and a pass or FAIL line,
+ * the exit code is 1 if any test failed.
+ *
+ * Usage: test [name ...]
+ * - name only run the tests of these names
+ *
+ * "make test" runs it, with "make SAN=1 test" under the address and
+ * undefined behaviour sanitizers.
+ *
+ * ----------------------------------------------------------------------------
+ * @author Stefan Kneubühl, kneubste@students.zhaw.ch
+ * @date 18.10.2026
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f4xx.h"
+
+#include "stm32f429i_discovery_lcd.h"
+
+#include "host.h"
+#include "graphics.h"
+#include "calculations.h"
+#include "capture.h"
+#include "displayingdata.h"
+#include "format.h"
+#include "frames.h"
+#include "measuring.h"
+#include "statistics.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define TEST_REPORT			5			///< Failures printed per test
+#define TEST_FRAMES			8			///< Frames of the capture round trip
+/** Samples fed to the statistics, past the third recalculation */
+#define TEST_STAT_SAMPLES	(3*STAT_RESYNC + ADC_NUMS)
+#define TEST_RMS_ARRAYS		10000		///< Random arrays of the RMS test
+
+
+/******************************************************************************
+ * Types
+ *****************************************************************************/
+/** One test: its name and the check, returns the number of failures */
+typedef struct {
+	const char *name;					///< Name for the report and selection
+	uint32_t (*run)(void);				///< Runs all checks of the test
+} TEST_case_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+bool MEAS_data_wire = false;			///< Defined by main.c on the target
+bool MEAS_data_cable = false;			///< Defined by main.c on the target
+bool MEAS_data_angle = false;			///< Defined by main.c on the target
+
+/** The tables of calculations.c, read from the same files */
+static const int32_t TEST_pad_wire[] = {
+		#include "lut_pad_wire.csv"
+};
+static const int32_t TEST_pad_cable[] = {
+		#include "lut_pad_cable.csv"
+};
+static const int32_t TEST_coil_1_2[] = {
+		#include "lut_coil_1_2.csv"
+};
+static const int32_t TEST_coil_5[] = {
+		#include "lut_coil_5.csv"
+};
+
+/** Samples of the statistics windows, STAT_length of statistics.c */
+static const uint32_t TEST_window[STAT_WINDOWS] = {
+		[STAT_SINGLE] = 10, [STAT_ACCURATE] = CALC_WINDOW,
+		[STAT_SECOND] = STAT_HISTORY
+};
+
+static const char *TEST_name;			///< Test running
+static uint32_t TEST_failures;			///< Failures of the test running
+
+static uint32_t TEST_in[TEST_FRAMES][ADC_NUMS*INPUTS_NUMS];	///< Frames put
+static uint32_t TEST_out[ADC_NUMS*INPUTS_NUMS];	///< Frame read back
+/** Exactly the frames of the round trip, halves and whole acquisitions */
+static uint32_t TEST_history[TEST_STAT_SAMPLES + ADC_NUMS][INPUTS_NUMS];	///< All samples
+static HOST_screen_t TEST_by_string;		///< Drawn by BSP_LCD_DisplayStringAt()
+static HOST_screen_t TEST_by_glyphs;		///< Drawn by FMT_draw()
+static HOST_screen_t TEST_blank;		///< Cleared screen
+static uint32_t TEST_random_state = 1;	///< State of TEST_random()
+static uint8_t TEST_buffer[CAP_HEADER_SIZE + TEST_FRAMES/2*(CAP_FRAME_SIZE(ADC_NUMS)
+		+ CAP_FRAME_SIZE(ADC_STREAM_NUMS))];
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Pseudo random numbers, the same on every run
+ * @return 12 random bits like an ADC sample
+ *****************************************************************************/
+static uint32_t TEST_random(void)
+{
+	TEST_random_state = TEST_random_state * 1664525U + 1013904223U;
+	return TEST_random_state >> 20;
+}
+
+
+/** ***************************************************************************
+ * @brief Count a failed check and report the first ones
+ * @param pass result of the check
+ * @param format printf() format of the report, then its arguments
+ * @return pass
+ *****************************************************************************/
+static bool TEST_expect(bool pass, const char *format, ...)
+{
+	if (!pass) {
+		if (TEST_failures < TEST_REPORT) {
+			va_list args;
+			va_start(args, format);
+			printf("%s: ", TEST_name);
+			vprintf(format, args);
+			printf("\n");
+			va_end(args);
+		}
+		TEST_failures++;
+	}
+	return pass;
+}
+
+
+/** ***************************************************************************
+ * @brief Integer square roots against the truncated root of the C library
+ *
+ * All squares and their neighbours, and steps through the whole range.
+ * sqrt() is exact for 32 bit values. sqrtl() may round up near the top of
+ * 64 bits, its root is corrected with the squares there.
+ *****************************************************************************/
+static uint64_t TEST_root(uint64_t value)
+{
+	uint64_t root = (uint64_t)sqrtl((long double)value);
+	while ((unsigned __int128)root * root > value) {
+		root--;
+	}
+	while ((unsigned __int128)(root + 1) * (root + 1) <= value) {
+		root++;
+	}
+	return root;
+}
+static void TEST_sqrt_one(uint64_t value)
+{
+	uint64_t expected = TEST_root(value);
+	if (value <= UINT32_MAX) {
+		uint32_t root = CALC_sqrt((uint32_t)value);
+		TEST_expect(root == (uint32_t)sqrt((double)value),
+				"CALC_sqrt(%llu) = %u, sqrt() %u", (unsigned long long)value,
+				(unsigned)root, (unsigned)sqrt((double)value));
+	}
+	uint64_t root = CALC_sqrt64(value);
+	TEST_expect(root == expected, "CALC_sqrt64(%llu) = %llu, expected %llu",
+			(unsigned long long)value, (unsigned long long)root,
+			(unsigned long long)expected);
+}
+static uint32_t TEST_sqrt(void)
+{
+	for (uint64_t r = 0; r <= 65536; r++) {
+		TEST_sqrt_one(r * r);
+		TEST_sqrt_one(r * r + r);		// Largest value with root r
+		if (r > 0) {
+			TEST_sqrt_one(r * r - 1);
+		}
+	}
+	for (uint64_t value = 0; value <= UINT32_MAX; value += 65521) {
+		TEST_sqrt_one(value);
+	}
+	for (uint64_t r = 65537; r <= UINT32_MAX; r += r / 8 + 1) {	// 64 bits
+		TEST_sqrt_one(r * r - 1);
+		TEST_sqrt_one(r * r);
+		TEST_sqrt_one(r * r + 2 * r);
+	}
+	TEST_sqrt_one(UINT32_MAX);
+	TEST_sqrt_one(UINT64_MAX);
+	return TEST_failures;
+}
+
+
+/** ***************************************************************************
+ * @brief Distance at the entries of the pad tables and at the limits
+ *
+ * A value of an entry gives its distance, the first one of equal entries.
+ * From the zero limit on it is 0, from the out limit on -1.
+ *****************************************************************************/
+static uint32_t TEST_distance_kind(CALC_kind_t kind, const int32_t *lut,
+		uint32_t length)
+{
+	const CALC_pad_limits_t *pad = &CALC_limits.pad[kind];
+	for (uint32_t mm = 0; mm < length; mm++) {
+		int32_t expected = mm;
+		while ((expected > 0) && (lut[expected - 1] == lut[mm])) {
+			expected--;
+		}
+		if (lut[mm] >= pad->zero) {
+			expected = 0;
+		}
+		else if (lut[mm] <= pad->out) {
+			expected = -1;
+		}
+		int32_t dist = CALC_distance(kind, lut[mm], &CALC_limits);
+		TEST_expect(dist == expected, "kind %d value %d: %d mm, expected %d",
+				(int)kind, (int)lut[mm], (int)dist, (int)expected);
+	}
+	TEST_expect(0 == CALC_distance(kind, pad->zero, &CALC_limits),
+			"kind %d at the zero limit", (int)kind);
+	TEST_expect(0 == CALC_distance(kind, INT32_MAX, &CALC_limits),
+			"kind %d above the zero limit", (int)kind);
+	TEST_expect(-1 == CALC_distance(kind, pad->out, &CALC_limits),
+			"kind %d at the out limit", (int)kind);
+	TEST_expect(-1 == CALC_distance(kind, 0, &CALC_limits),
+			"kind %d below the out limit", (int)kind);
+	TEST_expect(0 < CALC_distance(kind, pad->out + 1, &CALC_limits),
+			"kind %d right above the out limit", (int)kind);
+	return TEST_failures;
+}
+static uint32_t TEST_distance(void)
+{
+	TEST_distance_kind(CALC_WIRE, TEST_pad_wire,
+			sizeof(TEST_pad_wire) / sizeof(TEST_pad_wire[0]));
+	return TEST_distance_kind(CALC_CABLE, TEST_pad_cable,
+			sizeof(TEST_pad_cable) / sizeof(TEST_pad_cable[0]));
+}
+
+
+/** ***************************************************************************
+ * @brief Current at the entries of the coil tables
+ *
+ * The field of the 1.2 A table at its distance is 1.2 A, the one of the
+ * 5 A table 5 A, within 1 mA of the fixed point rounding.
+ *****************************************************************************/
+static uint32_t TEST_current(void)
+{
+	const uint32_t length = sizeof(TEST_coil_1_2) / sizeof(TEST_coil_1_2[0]);
+	for (uint32_t k = 0; k < length; k++) {
+		int32_t mm = k * CALC_COIL_STEP;
+		int32_t half = 0;
+		int32_t low = CALC_estimate_current(mm, -1, TEST_coil_1_2[k], -1, &half);
+		int32_t high = CALC_estimate_current(mm, -1, TEST_coil_5[k], -1, NULL);
+		TEST_expect(abs(low - CALC_CURRENT_LOW) <= 1,
+				"%d mm, 1.2 A entry %d: %d mA", (int)mm, (int)TEST_coil_1_2[k],
+				(int)low);
+		TEST_expect(abs(high - CALC_CURRENT_HIGH) <= 1,
+				"%d mm, 5 A entry %d: %d mA", (int)mm, (int)TEST_coil_5[k],
+				(int)high);
+		TEST_expect(-1 == half, "%d mm: half width %d of an unknown one",
+				(int)mm, (int)half);
+	}
+	TEST_expect(-1 == CALC_estimate_current(-1, -1, TEST_coil_5[0], -1, NULL),
+			"out of range");
+	TEST_expect(0 == CALC_estimate_current(0, -1, 0, -1, NULL),
+			"no field");
+	return TEST_failures;
+}
+
+
+/** ***************************************************************************
+ * @brief RMS() against the double sqrt() it used before
+ *
+ * Random arrays of the lengths in use and the largest deviation,
+ * half of the samples 0 and half 4095.
+ *****************************************************************************/
+static void TEST_rms_one(int32_t n, int32_t arr[])
+{
+	int64_t sum = 0;
+	int64_t squares = 0;
+	for (int32_t i = 0; i < n; i++) {
+		sum += arr[i];
+	}
+	int32_t avg = sum / n;
+	for (int32_t i = 0; i < n; i++) {
+		squares += (int64_t)(arr[i] - avg) * (arr[i] - avg);
+	}
+	int32_t expected = (int32_t)sqrt((double)(squares / n));
+	int32_t rms = RMS(n, arr);
+	TEST_expect(rms == expected, "%d samples from %d: %d, sqrt() %d", (int)n,
+			(int)arr[0], (int)rms, (int)expected);
+}
+static uint32_t TEST_rms(void)
+{
+	static const int32_t lengths[] = { 10, CALC_WINDOW_MIN, CALC_WINDOW, ADC_NUMS };
+	int32_t arr[ADC_NUMS];
+	for (uint32_t a = 0; a < TEST_RMS_ARRAYS; a++) {
+		int32_t n = lengths[a % (sizeof(lengths) / sizeof(lengths[0]))];
+		uint32_t spread = 1U << (a % 13);	// From noise to full scale
+		for (int32_t i = 0; i < n; i++) {
+			arr[i] = 2048 + (int32_t)(TEST_random() % spread) - (int32_t)spread / 2;
+		}
+		TEST_rms_one(n, arr);
+	}
+	for (int32_t i = 0; i < ADC_NUMS; i++) {
+		arr[i] = (i & 1) ? 4095 : 0;
+	}
+	TEST_rms_one(ADC_NUMS, arr);
+	return TEST_failures;
+}
+
+
+/** ***************************************************************************
+ * @brief Sliding windows against a recalculation from all samples
+ *
+ * Frames of different lengths, so the recalculation every STAT_RESYNC
+ * samples falls into a frame. After every frame the count, mean and
+ * deviation of every window and input are calculated again from the
+ * samples put in, the running sums must never have been found wrong.
+ *****************************************************************************/
+static uint32_t TEST_stat(void)
+{
+	static const uint32_t counts[] = { ADC_STREAM_NUMS, 7, ADC_NUMS, 1, 13 };
+	uint32_t total = 0;
+	STAT_reset();
+	STAT_mismatches = 0;
+	for (uint32_t f = 0; total < TEST_STAT_SAMPLES; f++) {
+		FRAME_t frame = { TEST_history[total], counts[f % 5], f, 0, 0 };
+		for (uint32_t i = 0; i < frame.count; i++) {
+			for (uint32_t in = 0; in < INPUTS_NUMS; in++) {
+				TEST_history[total + i][in] = (f & 4) ? TEST_random()	// Noise
+						: 2048 + (TEST_random() & 0x3F) + ((i & 3) << in*2);
+			}
+		}
+		STAT_add(&frame);
+		total += frame.count;
+		for (uint32_t w = 0; w < STAT_WINDOWS; w++) {
+			uint32_t n = (total < TEST_window[w]) ? total : TEST_window[w];
+			TEST_expect(n == STAT_count(w), "%u samples, window %u: count %u",
+					(unsigned)total, (unsigned)w, (unsigned)STAT_count(w));
+			for (uint32_t in = 0; in < INPUTS_NUMS; in++) {
+				uint64_t sum = 0;
+				uint64_t squares = 0;
+				for (uint32_t k = total - n; k < total; k++) {
+					sum += TEST_history[k][in];
+					squares += TEST_history[k][in] * TEST_history[k][in];
+				}
+				int32_t mean = sum / n;
+				int32_t deviation = TEST_root(n * squares - sum * sum) / n;
+				TEST_expect((mean == STAT_mean(in, w))
+						&& (deviation == STAT_deviation(in, w)),
+						"%u samples, window %u, input %u: mean %d deviation %d,"
+						" expected %d %d", (unsigned)total, (unsigned)w,
+						(unsigned)in, (int)STAT_mean(in, w),
+						(int)STAT_deviation(in, w), (int)mean, (int)deviation);
+			}
+		}
+	}
+	TEST_expect(0 == STAT_mismatches, "%u recalculations found other sums",
+			(unsigned)STAT_mismatches);
+	STAT_reset();
+	return TEST_failures;
+}
+
+
+/** ***************************************************************************
+ * @brief Formatted numbers against snprintf()
+ *****************************************************************************/
+static void TEST_format_compare(const FMT_text_t *text, const char *expected)
+{
+	char s[FMT_LEN + 1];
+	FMT_chars(text, s, sizeof(s));
+	TEST_expect(0 == strcmp(s, expected), "\"%s\", expected \"%s\"", s, expected);
+}
+static uint32_t TEST_format(void)
+{
+	static const int32_t values[] = {
+			0, 1, -1, 5, -5, 9, 10, 99, -100, 999, 1000, 1087, -1087, 4999,
+			12073, -12073, 99999, 123456789, INT32_MAX, INT32_MIN + 1, INT32_MIN
+	};
+	static const uint32_t scale[] = { 1, 10, 100, 1000, 10000 };
+	FMT_text_t text;
+	char expected[64];
+	for (uint32_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+		int32_t value = values[i];
+		for (uint32_t width = 0; width <= 12; width += 3) {
+			FMT_clear(&text);
+			FMT_int(&text, value, width);
+			snprintf(expected, sizeof(expected), "%*d", (int)width, (int)value);
+			TEST_format_compare(&text, expected);
+
+			FMT_clear(&text);
+			FMT_unit(&text, value, width, " mm");
+			snprintf(expected, sizeof(expected), "%*d mm", (int)width, (int)value);
+			TEST_format_compare(&text, expected);
+
+			for (uint32_t decimals = 0; decimals <= 4; decimals++) {
+				FMT_clear(&text);
+				FMT_fixed(&text, value, decimals, width);
+				snprintf(expected, sizeof(expected), "%*.*f", (int)width,
+						(int)decimals, (double)value / scale[decimals]);
+				TEST_format_compare(&text, expected);
+			}
+		}
+	}
+	FMT_clear(&text);						// A label and a column like "%-6s"
+	FMT_string(&text, "I:");
+	FMT_column(&text, 6);
+	FMT_fixed(&text, 1087, 3, 6);
+	FMT_string(&text, " A");
+	TEST_format_compare(&text, "I:     1.087 A");
+	return TEST_failures;
+}
+
+
+/** ***************************************************************************
+ * @brief Texts drawn by FMT_draw() against BSP_LCD_DisplayStringAt()
+ *
+ * All fonts and alignments, the screens must be identical pixel by pixel.
+ * A line longer than the display is cut by both the same way.
+ *****************************************************************************/
+static uint32_t TEST_glyphs(void)
+{
+	static sFONT *const fonts[] = { &Font8, &Font12, &Font16, &Font20, &Font24 };
+	static const Text_AlignModeTypdef aligns[] = {
+			LEFT_MODE, CENTER_MODE, RIGHT_MODE
+	};
+	static const char *const strings[] = {
+			"Distance:  123 mm", "I: 1.087 A", "-", "~ !\"#09AZaz{|}",
+	};
+	static const char long_line[] = "Current: 12345 mA +/- 678 mA ..";
+	char s[FMT_LEN + 1];
+	FMT_text_t text;
+	BSP_LCD_Init();						// Same sequence as main()
+	GFX_init();
+	DISP_layers_init();
+	BSP_LCD_DisplayOn();
+	BSP_LCD_Clear(LCD_COLOR_WHITE);
+	GFX_fence();
+	HOST_ltdc_compose(&TEST_blank);
+	BSP_LCD_SetBackColor(LCD_COLOR_YELLOW);
+	BSP_LCD_SetTextColor(LCD_COLOR_BLUE);
+	for (uint32_t f = 0; f < sizeof(fonts) / sizeof(fonts[0]); f++) {
+		BSP_LCD_SetFont(fonts[f]);
+		uint32_t columns = BSP_LCD_GetXSize() / fonts[f]->Width;
+		for (uint32_t t = 0; t <= sizeof(strings) / sizeof(strings[0]); t++) {
+			const char *string = (t < sizeof(strings) / sizeof(strings[0]))
+					? strings[t] : long_line;
+			for (uint32_t a = 0; a < sizeof(aligns) / sizeof(aligns[0]); a++) {
+				if ((LEFT_MODE != aligns[a]) && (strlen(string) > columns)) {
+					continue;			// No room to align
+				}
+				snprintf(s, sizeof(s), "%s", string);
+				BSP_LCD_DisplayStringAt(3, 40, (uint8_t *)s, aligns[a]);
+				GFX_fence();
+				HOST_ltdc_compose(&TEST_by_string);
+				BSP_LCD_Clear(LCD_COLOR_WHITE);
+				GFX_fence();
+
+				FMT_clear(&text);
+				FMT_string(&text, string);
+				FMT_draw(&text, 3, 40, aligns[a]);
+				GFX_fence();
+				HOST_ltdc_compose(&TEST_by_glyphs);
+				BSP_LCD_Clear(LCD_COLOR_WHITE);
+				GFX_fence();
+
+				uint32_t diff = HOST_compare(&TEST_by_string, &TEST_by_glyphs);
+				TEST_expect((0 == diff) && (0 < HOST_compare(&TEST_by_string, &TEST_blank)),
+						"font %u, \"%s\" align %d: %u pixels differ",
+						(unsigned)fonts[f]->Height, string, (int)aligns[a],
+						(unsigned)diff);
+			}
+		}
+	}
+	return TEST_failures;
+}
+
+
+
+/** ***************************************************************************
+ * @brief Frames written with CAP_put() read back by CAP_next()
+ *
+ * Halves and whole acquisitions with all 12 bits in use, the header
+ * values, the end of the capture and a full buffer.
+ *****************************************************************************/
+static uint32_t TEST_capture(void)
+{
+	CAP_t cap;
+	FRAME_t frame;
+	TEST_expect(CAP_create(&cap, TEST_buffer, sizeof(TEST_buffer), ADC_FS,
+			CALC_CALIBRATION), "create");
+	for (uint32_t f = 0; f < TEST_FRAMES; f++) {
+		for (uint32_t i = 0; i < ADC_NUMS*INPUTS_NUMS; i++) {
+			TEST_in[f][i] = (i*2654435761U + f*40503U) >> 20;	// 12 bits
+		}
+		frame.samples = TEST_in[f];
+		frame.count = (f & 1) ? ADC_NUMS : ADC_STREAM_NUMS;
+		frame.seq = 1000 + f;
+		TEST_expect(CAP_put(&cap, &frame), "put frame %u", (unsigned)f);
+	}
+	frame.count = 1;
+	TEST_expect(!CAP_put(&cap, &frame), "put into a full capture");
+
+	TEST_expect(CAP_open(&cap, TEST_buffer, sizeof(TEST_buffer)), "open");
+	TEST_expect((ADC_FS == cap.rate) && (CALC_CALIBRATION == cap.calibration)
+			&& (TEST_FRAMES == cap.frames), "header rate %u calibration %u frames %u",
+			(unsigned)cap.rate, (unsigned)cap.calibration, (unsigned)cap.frames);
+	for (uint32_t f = 0; f < TEST_FRAMES; f++) {
+		uint32_t count = (f & 1) ? ADC_NUMS : ADC_STREAM_NUMS;
+		if (!TEST_expect(CAP_next(&cap, &frame, TEST_out, ADC_NUMS),
+				"next frame %u", (unsigned)f)) {
+			break;
+		}
+		TEST_expect((count == frame.count) && (1000 + f == frame.seq)
+				&& (0 == memcmp(TEST_out, TEST_in[f], count*INPUTS_NUMS*sizeof(uint32_t))),
+				"frame %u: count %u seq %u or samples differ", (unsigned)f,
+				(unsigned)frame.count, (unsigned)frame.seq);
+	}
+	TEST_expect(!CAP_next(&cap, &frame, TEST_out, ADC_NUMS), "end of the capture");
+	CAP_rewind(&cap);
+	TEST_expect(CAP_next(&cap, &frame, TEST_out, ADC_STREAM_NUMS)
+			&& (1000 == frame.seq), "first frame after the rewind");
+	TEST_expect(!CAP_next(&cap, &frame, TEST_out, ADC_STREAM_NUMS),
+			"frame longer than the memory");
+	return TEST_failures;
+}
+
+
+/** ***************************************************************************
+ * @brief Damaged captures are rejected by CAP_open() and CAP_next()
+ *
+ * Each case changes a copy of a valid capture with two frames: a column
+ * map which is no permutation, a truncated file or a damaged frame.
+ *****************************************************************************/
+static bool TEST_damaged_open(const uint8_t *valid, uint32_t offset,
+		uint8_t value, uint32_t size)
+{
+	static uint8_t copy[sizeof(TEST_buffer)];
+	CAP_t cap;
+	memcpy(copy, valid, size);
+	if (offset < size) {
+		copy[offset] = value;
+	}
+	return CAP_open(&cap, copy, size);
+}
+static uint32_t TEST_damaged(void)
+{
+	static const uint8_t maps[][INPUTS_NUMS] = {
+			{ 0, 0, 1, 2 }, { 3, 2, 1, 3 }, { 0, 1, 2, 4 }, { 255, 0, 1, 2 }
+	};
+	CAP_t cap;
+	FRAME_t frame = { TEST_in[0], ADC_STREAM_NUMS, 0, 0, 0 };
+	CAP_create(&cap, TEST_buffer, sizeof(TEST_buffer), ADC_FS, CALC_CALIBRATION);
+	CAP_put(&cap, &frame);
+	CAP_put(&cap, &frame);
+	const uint32_t size = cap.used;
+
+	TEST_expect(TEST_damaged_open(TEST_buffer, size, 0, size), "valid capture");
+	for (uint32_t m = 0; m < sizeof(maps) / sizeof(maps[0]); m++) {
+		static uint8_t copy[sizeof(TEST_buffer)];
+		memcpy(copy, TEST_buffer, size);
+		memcpy(&copy[16], maps[m], INPUTS_NUMS);
+		TEST_expect(!CAP_open(&cap, copy, size), "map %u %u %u %u accepted",
+				maps[m][0], maps[m][1], maps[m][2], maps[m][3]);
+	}
+	uint8_t swapped[INPUTS_NUMS] = { 3, 1, 0, 2 };
+	memcpy(&TEST_buffer[16], swapped, INPUTS_NUMS);
+	TEST_expect(CAP_open(&cap, TEST_buffer, size)
+			&& CAP_next(&cap, &frame, TEST_out, ADC_NUMS)
+			&& (TEST_in[0][0] == TEST_out[3]) && (TEST_in[0][2] == TEST_out[0]),
+			"columns of a permuted map");
+	for (uint32_t i = 0; i < INPUTS_NUMS; i++) {
+		TEST_buffer[16 + i] = i;
+	}
+
+	TEST_expect(!TEST_damaged_open(TEST_buffer, size, 0, size - 1), "truncated frame");
+	TEST_expect(!TEST_damaged_open(TEST_buffer, size, 0, CAP_HEADER_SIZE - 1),
+			"truncated header");
+	TEST_expect(!TEST_damaged_open(TEST_buffer, 0, 'X', size), "magic");
+	TEST_expect(!TEST_damaged_open(TEST_buffer, 4, CAP_VERSION + 1, size),
+			"newer version");
+	TEST_expect(!TEST_damaged_open(TEST_buffer, 12, INPUTS_NUMS + 1, size),
+			"inputs");
+	TEST_expect(!TEST_damaged_open(TEST_buffer, 13, 16, size), "bits");
+	TEST_expect(!TEST_damaged_open(TEST_buffer, 6, CAP_HEADER_SIZE - 1, size),
+			"header size");
+
+	TEST_buffer[CAP_HEADER_SIZE + CAP_FRAME_SIZE(ADC_STREAM_NUMS) + 1] = 0x80;
+	TEST_expect(CAP_open(&cap, TEST_buffer, size)
+			&& CAP_next(&cap, &frame, TEST_out, ADC_NUMS)
+			&& !CAP_next(&cap, &frame, TEST_out, UINT16_MAX),
+			"frame longer than the capture");
+	return TEST_failures;
+}
+
+
+/** ***************************************************************************
+ * @brief Overruns of the frame ring
+ *
+ * The producer puts two frames too many into a full ring, they are
+ * dropped, counted and reported in the next frame which fits.
+ *****************************************************************************/
+static uint32_t TEST_frames(void)
+{
+	static const uint32_t seq[] = { 0, 1, 2, 3, FRAME_SLOTS + 2 };
+	static const uint32_t overruns[] = { 0, 0, 0, 0, 2 };
+	uint32_t samples[ADC_STREAM_NUMS*INPUTS_NUMS];
+	for (uint32_t i = 0; i < ADC_STREAM_NUMS*INPUTS_NUMS; i++) {
+		samples[i] = i;
+	}
+	FRAME_reset();
+	for (uint32_t f = 0; f < FRAME_SLOTS; f++) {
+		TEST_expect(FRAME_put(samples, ADC_STREAM_NUMS), "put %u", (unsigned)f);
+	}
+	TEST_expect(!FRAME_put(samples, ADC_STREAM_NUMS)
+			&& !FRAME_put(samples, ADC_STREAM_NUMS), "put into a full ring");
+	TEST_expect((2 == FRAME_overruns) && (FRAME_SLOTS == FRAME_count()),
+			"%u overruns, %u frames", (unsigned)FRAME_overruns,
+			(unsigned)FRAME_count());
+	uint32_t n = 0;
+	const FRAME_t *frame;
+	while (NULL != (frame = FRAME_peek())) {
+		if (0 == n) {
+			FRAME_release();			// Room for one more
+			TEST_expect(FRAME_put(samples, ADC_STREAM_NUMS), "put after release");
+			n++;
+			continue;
+		}
+		TEST_expect((n < sizeof(seq) / sizeof(seq[0])) && (seq[n] == frame->seq)
+				&& (overruns[n] == frame->overruns)
+				&& (ADC_STREAM_NUMS == frame->count)
+				&& (0 == memcmp(frame->samples, samples, sizeof(samples))),
+				"frame %u: seq %u overruns %u", (unsigned)n,
+				(unsigned)frame->seq, (unsigned)frame->overruns);
+		FRAME_release();
+		n++;
+	}
+	TEST_expect(5 == n, "%u frames taken", (unsigned)n);
+	TEST_expect(2 == FRAME_overruns, "%u overruns in total",
+			(unsigned)FRAME_overruns);
+	FRAME_reset();
+	return TEST_failures;
+}
+
+
+/** All tests in the order they are run */
+static const TEST_case_t TEST_cases[] = {
+		{ "sqrt", TEST_sqrt },
+		{ "distance", TEST_distance },
+		{ "current", TEST_current },
+		{ "rms", TEST_rms },
+		{ "stat", TEST_stat },
+		{ "format", TEST_format },
+		{ "glyphs", TEST_glyphs },
+		{ "capture", TEST_capture },
+		{ "damaged", TEST_damaged },
+		{ "frames", TEST_frames },
+};
+
+
+/** ***************************************************************************
+ * @brief Is a test selected on the command line
+ * @param name of the test
+ * @param argc names given
+ * @param argv the names
+ * @return true if selected or no name is given
+ *****************************************************************************/
+static bool TEST_selected(const char *name, int argc, char *argv[])
+{
+	if (0 == argc) {
+		return true;
+	}
+	for (int i = 0; i < argc; i++) {
+		if (0 == strcmp(name, argv[i])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/** ***************************************************************************
+ * @brief Run all selected tests
+ * @return 0 if all passed, 1 if one failed
+ *****************************************************************************/
+int main(int argc, char *argv[])
+{
+	int result = 0;
+	HOST_reset();
+	for (uint32_t t = 0; t < sizeof(TEST_cases)/sizeof(TEST_cases[0]); t++) {
+		const TEST_case_t *test = &TEST_cases[t];
+		if (!TEST_selected(test->name, argc - 1, &argv[1])) {
+			continue;
+		}
+		TEST_name = test->name;
+		TEST_failures = 0;
+		uint32_t failures = test->run();
+		printf("%-10s %s", test->name, (0 == failures) ? "pass" : "FAIL");
+		if (failures > 0) {
+			printf(", %u failures", (unsigned)failures);
+			result = 1;
+		}
+		printf("\n");
+	}
+	return result;
+}